@@ -6,6 +6,7 @@
 
 #include "editor.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include <random>
 
 using namespace mango;
 
@@ -68,7 +69,7 @@ bool editor::create()
                            scene_handle application_scene = mango_context->get_current_scene();
                            sid main_cam                   = m_main_camera_node_id;
                            mango::custom_info("Mango Editor Custom",
-                                              [&main_cam, &application_scene]()
+                                              [this, &main_cam, &application_scene]()
                                               {
                                                   if (!main_cam.is_valid())
                                                   {
@@ -83,6 +84,13 @@ bool editor::create()
                                                           main_cam                          = application_scene->add_perspective_camera(editor_cam, application_scene->get_root_node());
                                                       }
                                                   }
+
+                                                  // Light stress test, frame times are shown in the graphics info.
+                                                  ImGui::Separator();
+                                                  ImGui::SliderInt("Stress Test Lights", &m_stress_test_light_count, 0, 8192);
+                                                  ImGui::Checkbox("Animate Stress Test Lights", &m_animate_stress_test_lights);
+                                                  if (ImGui::Button("Spawn Stress Test Lights"))
+                                                      spawn_stress_test_lights(application_scene);
                                               });
                            m_main_camera_node_id = main_cam;
                            ImGui::End();
@@ -91,6 +99,10 @@ bool editor::create()
     m_main_ui = mango_context->create_ui(ui_config);
     MANGO_ASSERT(m_main_ui, "UI creation failed!");
 
+    m_stress_test_light_count    = 1024;
+    m_animate_stress_test_lights = true;
+    m_stress_test_time           = 0.0f;
+
     m_current_scene = mango_context->create_scene("text_scene");
     MANGO_ASSERT(m_current_scene, "Scene creation failed!");
 
@@ -217,10 +229,25 @@ bool editor::create()
 void editor::update(float dt)
 {
     PROFILE_ZONE;
-    MANGO_UNUSED(dt);
     shared_ptr<context> mango_context = get_context().lock();
 
     MANGO_ASSERT(mango_context, "Context is expired!");
+
+    if (m_animate_stress_test_lights && !m_stress_test_light_nodes.empty())
+    {
+        m_stress_test_time += dt;
+        scene_handle application_scene = mango_context->get_current_scene();
+        for (int32 i = 0; i < static_cast<int32>(m_stress_test_light_nodes.size()); ++i)
+        {
+            optional<transform&> light_transform = application_scene->get_transform(m_stress_test_light_nodes[i]);
+            if (!light_transform)
+                continue;
+            float phase               = m_stress_test_time + static_cast<float>(i) * 0.37f;
+            light_transform->position = m_stress_test_light_positions[i] + vec3(sinf(phase), 0.0f, cosf(phase));
+            light_transform->update();
+        }
+    }
+
     if (m_main_camera_node_id == mango_context->get_current_scene()->get_active_scene_camera_node_sid())
     {
         optional<perspective_camera&> cam  = mango_context->get_current_scene()->get_perspective_camera(m_main_camera_node_id);
@@ -263,4 +290,41 @@ void editor::update(float dt)
     }
 }
 
-void editor::destroy() {}
\ No newline at end of file
+void editor::destroy() {}
+
+void editor::spawn_stress_test_lights(const scene_handle& application_scene)
+{
+    PROFILE_ZONE;
+    for (sid node_id : m_stress_test_light_nodes)
+    {
+        application_scene->remove_point_light(node_id);
+        application_scene->remove_node(node_id);
+    }
+    m_stress_test_light_nodes.clear();
+    m_stress_test_light_positions.clear();
+
+    // Fixed seed, so that runs are comparable.
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int32 i = 0; i < m_stress_test_light_count; ++i)
+    {
+        vec3 position = vec3(unit(generator) * 24.0f - 12.0f, unit(generator) * 10.0f, unit(generator) * 12.0f - 6.0f);
+
+        node light_node = node("Stress Test Light");
+        sid node_id     = application_scene->add_node(light_node);
+        point_light pl;
+        pl.color     = color_rgb(unit(generator), unit(generator), unit(generator));
+        pl.intensity = default_point_light_intensity;
+        pl.radius    = 2.0f;
+        node_id      = application_scene->add_point_light(pl, node_id);
+
+        optional<transform&> light_transform = application_scene->get_transform(node_id);
+        if (!light_transform)
+            continue;
+        light_transform->position = position;
+        light_transform->update();
+
+        m_stress_test_light_nodes.push_back(node_id);
+        m_stress_test_light_positions.push_back(position);
+    }
+}
\ No newline at end of file
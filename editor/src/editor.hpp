@@ -38,6 +38,22 @@ class editor : public mango::application
     mango::vec2 m_target_offset;
     //! \brief Radius for camera.
     float m_camera_radius;
+
+    //! \brief Spawns point lights to stress test light clustering.
+    //! \details Removes previously spawned lights.
+    //! \param[in] application_scene The current \a scene.
+    void spawn_stress_test_lights(const mango::scene_handle& application_scene);
+
+    //! \brief The number of point lights spawned by the light stress test.
+    mango::int32 m_stress_test_light_count;
+    //! \brief True if the stress test lights should move every frame, else false.
+    bool m_animate_stress_test_lights;
+    //! \brief The time the stress test lights are animated for.
+    float m_stress_test_time;
+    //! \brief The \a sids of the nodes containing the stress test lights.
+    std::vector<mango::sid> m_stress_test_light_nodes;
+    //! \brief The initial positions of the stress test lights.
+    std::vector<mango::vec3> m_stress_test_light_positions;
 };
 
 #endif // EDITOR_HPP
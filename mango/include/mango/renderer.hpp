@@ -74,6 +74,7 @@ namespace mango
             , m_interpolation_range(0.5f)
             , m_filter_mode(shadow_filtering::soft_shadows)
             , m_light_size(4.0f)
+            , m_sample_distribution(false)
         {
         }
 
@@ -100,6 +101,7 @@ namespace mango
             , m_interpolation_range(interpolation_range)
             , m_filter_mode(filter_mode)
             , m_light_size(light_size)
+            , m_sample_distribution(false)
         {
         }
 
@@ -204,6 +206,16 @@ namespace mango
             return *this;
         }
 
+        //! \brief Enables or disables sample distribution shadow maps.
+        //! \details When enabled, the cascades are fitted to the depth range visible in the last frame instead of the complete camera depth range.
+        //! \param[in] enabled True if the cascades should be fitted to the visible depth range, else false.
+        //! \return A reference to the modified \a shadow_settings.
+        inline shadow_settings& set_sample_distribution(bool enabled)
+        {
+            m_sample_distribution = enabled;
+            return *this;
+        }
+
         //! \brief Retrieves and returns the shadow map resolution.
         //! \return The  shadow map resolution.
         inline int32 get_resolution() const
@@ -280,6 +292,13 @@ namespace mango
             return m_light_size;
         }
 
+        //! \brief Retrieves and returns if sample distribution shadow maps are enabled.
+        //! \return True if the cascades are fitted to the visible depth range, else false.
+        inline bool get_sample_distribution() const
+        {
+            return m_sample_distribution;
+        }
+
       private:
         //! \brief The configured shadow map resolution.
         int32 m_resolution;
@@ -303,6 +322,8 @@ namespace mango
         shadow_filtering m_filter_mode;
         //! \brief The configured size of the light for pcss.
         float m_light_size;
+        //! \brief True if the cascades are fitted to the visible depth range, else false.
+        bool m_sample_distribution;
     };
 
     //! \brief The settings for the \a environment_display_step.
@@ -412,8 +433,15 @@ namespace mango
             : m_base_pipeline(render_pipeline::default_pbr)
             , m_vsync(true)
             , m_wireframe(false)
-            , m_frustum_culling(true)
             , m_debug_bounds(false)
+            , m_frustum_culling(true)
+            , m_occlusion_culling(false)
+            , m_software_occlusion_culling(false)
+            , m_depth_prepass(false)
+            , m_tiled_lighting(false)
+            , m_compact_gbuffer(false)
+            , m_dynamic_resolution(false)
+            , m_fused_post_processing(false)
         {
             std::memset(m_render_steps, 0, render_pipeline_step::number_of_steps * sizeof(bool));
         }
@@ -428,8 +456,15 @@ namespace mango
             : m_base_pipeline(base_render_pipeline)
             , m_vsync(vsync)
             , m_wireframe(wireframe)
-            , m_frustum_culling(frustum_culling)
             , m_debug_bounds(draw_debug_bounds)
+            , m_frustum_culling(frustum_culling)
+            , m_occlusion_culling(false)
+            , m_software_occlusion_culling(false)
+            , m_depth_prepass(false)
+            , m_tiled_lighting(false)
+            , m_compact_gbuffer(false)
+            , m_dynamic_resolution(false)
+            , m_fused_post_processing(false)
         {
             std::memset(m_render_steps, 0, render_pipeline_step::number_of_steps * sizeof(bool));
         }
@@ -503,6 +538,81 @@ namespace mango
             return *this;
         }
 
+        //! \brief Sets or changes the setting for occlusion culling in the \a renderer_configuration.
+        //! \details Occlusion culling tests primitives against a depth pyramid of the previous frame. Occluded primitives becoming visible can show up one frame late.
+        //! \param[in] cull The setting for the \a renderer. Spezifies if occlusion culling should be enabled or disabled.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_occlusion_culling(bool cull)
+        {
+            m_occlusion_culling = cull;
+            return *this;
+        }
+
+        //! \brief Sets or changes the setting for software occlusion culling in the \a renderer_configuration.
+        //! \details Software occlusion culling rasterizes large primitives on the cpu and tests primitives against them in the same frame.
+        //! \param[in] cull The setting for the \a renderer. Spezifies if software occlusion culling should be enabled or disabled.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_software_occlusion_culling(bool cull)
+        {
+            m_software_occlusion_culling = cull;
+            return *this;
+        }
+
+        //! \brief Sets or changes the setting for the depth pre-pass in the \a renderer_configuration.
+        //! \details The depth pre-pass renders the depth of opaque geometry first, so that the gbuffer is only written once per pixel.
+        //! Worth it for scenes with a high overdraw, see \a renderer_info.
+        //! \param[in] prepass The setting for the \a renderer. Spezifies if the depth pre-pass should be enabled or disabled.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_depth_prepass(bool prepass)
+        {
+            m_depth_prepass = prepass;
+            return *this;
+        }
+
+        //! \brief Sets or changes the setting for the tiled compute lighting in the \a renderer_configuration.
+        //! \details The tiled lighting classifies screen tiles and lights them with compute shader variants, so that tiles without geometry and without shadows skip the expensive parts.
+        //! \param[in] tiled The setting for the \a renderer. Spezifies if the tiled compute lighting should be enabled or the fullscreen lighting pass should be used.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_tiled_lighting(bool tiled)
+        {
+            m_tiled_lighting = tiled;
+            return *this;
+        }
+
+        //! \brief Sets or changes the gbuffer layout in the \a renderer_configuration.
+        //! \details The compact layout stores octahedral normals and packed emissive, which reduces the memory traffic of the geometry and lighting passes.
+        //! The full precision layout is kept as reference. Only used on creation of the \a renderer.
+        //! \param[in] compact The setting for the \a renderer. Spezifies if the compact gbuffer layout should be used.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_compact_gbuffer(bool compact)
+        {
+            m_compact_gbuffer = compact;
+            return *this;
+        }
+
+        //! \brief Sets or changes the setting for dynamic resolution in the \a renderer_configuration.
+        //! \details The internal render targets are allocated once and rendered into a sub-rectangle scaled to hold a target gpu frame time.
+        //! The composing pass upscales the result to the output. Resizes do not reallocate the internal render targets.
+        //! \param[in] dynamic The setting for the \a renderer. Spezifies if dynamic resolution should be enabled or disabled.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_dynamic_resolution(bool dynamic)
+        {
+            m_dynamic_resolution = dynamic;
+            return *this;
+        }
+
+        //! \brief Sets or changes the setting for fused post-processing in the \a renderer_configuration.
+        //! \details Tonemapping, fxaa and the output conversion run in one compute dispatch instead of the composing pass and the \a fxaa_step.
+        //! Only used when the fxaa step is enabled, while debug bounds are drawn the separate passes are used.
+        //! Disabled by default.
+        //! \param[in] fused The setting for the \a renderer. Spezifies if fused post-processing should be enabled or disabled.
+        //! \return A reference to the modified \a renderer_configuration.
+        inline renderer_configuration& set_fused_post_processing(bool fused)
+        {
+            m_fused_post_processing = fused;
+            return *this;
+        }
+
         //! \brief Sets or changes the setting for drawing debug bounds in the \a renderer_configuration.
         //! \param[in] draw The setting for the \a renderer. Spezifies if debug bounds should be drawn or not.
         //! \return A reference to the modified \a renderer_configuration.
@@ -533,6 +643,55 @@ namespace mango
             return m_frustum_culling;
         }
 
+        //! \brief Retrieves and returns the setting for occlusion culling of the \a renderer_configuration.
+        //! \return The current occlusion culling setting.
+        inline bool is_occlusion_culling_enabled() const
+        {
+            return m_occlusion_culling;
+        }
+
+        //! \brief Retrieves and returns the setting for software occlusion culling of the \a renderer_configuration.
+        //! \return The current software occlusion culling setting.
+        inline bool is_software_occlusion_culling_enabled() const
+        {
+            return m_software_occlusion_culling;
+        }
+
+        //! \brief Retrieves and returns the setting for the depth pre-pass of the \a renderer_configuration.
+        //! \return The current depth pre-pass setting.
+        inline bool is_depth_prepass_enabled() const
+        {
+            return m_depth_prepass;
+        }
+
+        //! \brief Retrieves and returns the setting for the tiled compute lighting of the \a renderer_configuration.
+        //! \return The current tiled compute lighting setting.
+        inline bool is_tiled_lighting_enabled() const
+        {
+            return m_tiled_lighting;
+        }
+
+        //! \brief Retrieves and returns the gbuffer layout setting of the \a renderer_configuration.
+        //! \return True if the compact gbuffer layout is used, else false.
+        inline bool is_compact_gbuffer_enabled() const
+        {
+            return m_compact_gbuffer;
+        }
+
+        //! \brief Retrieves and returns the setting for dynamic resolution of the \a renderer_configuration.
+        //! \return True if dynamic resolution is enabled, else false.
+        inline bool is_dynamic_resolution_enabled() const
+        {
+            return m_dynamic_resolution;
+        }
+
+        //! \brief Retrieves and returns the setting for fused post-processing of the \a renderer_configuration.
+        //! \return True if fused post-processing is enabled, else false.
+        inline bool is_fused_post_processing_enabled() const
+        {
+            return m_fused_post_processing;
+        }
+
         //! \brief Retrieves and returns the setting for drawing debug bounds of the \a renderer_configuration.
         //! \return The current setting for drawing debug bounds.
         inline bool should_draw_debug_bounds() const
@@ -592,6 +751,27 @@ namespace mango
         //! \brief The setting of the \a renderer_configuration to enable or disable culling primitives against camera and shadow frusta.
         bool m_frustum_culling;
 
+        //! \brief The setting of the \a renderer_configuration to enable or disable culling primitives occluded by other geometry.
+        bool m_occlusion_culling;
+
+        //! \brief The setting of the \a renderer_configuration to enable or disable culling primitives occluded by large primitives rasterized on the cpu.
+        bool m_software_occlusion_culling;
+
+        //! \brief The setting of the \a renderer_configuration to enable or disable the depth pre-pass.
+        bool m_depth_prepass;
+
+        //! \brief The setting of the \a renderer_configuration to enable or disable the tiled compute lighting.
+        bool m_tiled_lighting;
+
+        //! \brief The setting of the \a renderer_configuration to use the compact or the full precision gbuffer layout.
+        bool m_compact_gbuffer;
+
+        //! \brief The setting of the \a renderer_configuration to enable or disable dynamic resolution.
+        bool m_dynamic_resolution;
+
+        //! \brief The setting of the \a renderer_configuration to enable or disable the fused compute post-processing.
+        bool m_fused_post_processing;
+
         //! \brief The additional \a render_pipeline_steps of the \a renderer_configuration to enable or disable vertical synchronization.
         bool m_render_steps[render_pipeline_step::number_of_steps];
 
@@ -625,6 +805,8 @@ namespace mango
             int32 vertices;   //!< The number of vertices.
             int32 triangles;  //!< The number of triangles (approx.).
             int32 materials;  //!< The number of materials.
+            int32 occluded;   //!< The number of draws skipped by occlusion culling.
+            float overdraw;   //!< The estimated opaque overdraw. Screen area covered by the bounds of all drawn opaque primitives divided by the screen area.
         } last_frame;         //!< Measured stats from the last rendered frame.
     };
 
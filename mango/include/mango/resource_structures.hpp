@@ -46,6 +46,21 @@ namespace mango
         std::vector<shader_define> defines;
     };
 
+    //! \brief Statistics of the resource cache.
+    struct resource_cache_statistics
+    {
+        int64 memory_budget;  //!< The memory budget in bytes. Unreferenced resources are evicted when the cached size exceeds it.
+        int64 cached_size;    //!< The size of all cached resources in bytes.
+        int64 retained_size;  //!< The size of cached resources that are not referenced anymore in bytes.
+        int32 cached_count;   //!< The number of cached resources.
+        int32 retained_count; //!< The number of cached resources that are not referenced anymore.
+        int32 pinned_count;   //!< The number of pinned resources.
+        int64 hits;           //!< The number of acquisitions served from the cache.
+        int64 misses;         //!< The number of acquisitions that had to load from file.
+        int64 evictions;      //!< The number of evicted resources.
+        int64 evicted_size;   //!< The size of all evicted resources in bytes.
+    };
+
     //! \brief Reference counted base for all resources.
     struct resource_base
     {
@@ -53,6 +68,8 @@ namespace mango
       private:
         //! \brief Reference counter.
         int32 reference_count = 0;
+        //! \brief The id of the resource in the cache. Makes releasing a resource O(1).
+        uint64 id = 0;
     };
 
     //! \brief An image resource.
@@ -13,6 +13,7 @@ namespace mango
 {
     //! \brief The \a resources of mango.
     //! \details Responsible for loading and releasing resources.
+    //! Resources that are not referenced anymore are retained in a least recently used cache as long as the memory budget allows.
     class resources
     {
       public:
@@ -41,6 +42,43 @@ namespace mango
         //! \brief Releases an aquired \a shader_resource.
         //! \param[in] resource The \a shader_resource to release.
         virtual void release(const shader_resource* resource) = 0;
+        //! \brief Acquires multiple variants of a shader in one batch.
+        //! \details Each variant is keyed by the path and its sorted defines, so the order of the defines does not matter.
+        //! The source file and its includes are only read once for all variants.
+        //! \param[in] path The path of the shader source.
+        //! \param[in] variants The defines for each variant.
+        //! \return Pointers to the \a shader_resources in the order of the variants, nullptr for failed ones. Each should be released later on.
+        virtual std::vector<const shader_resource*> acquire_variants(const char* path, const std::vector<std::vector<shader_define>>& variants) = 0;
+
+        //! \brief Loads an \a image_resource into the cache without referencing it.
+        //! \details The \a image_resource is retained as long as the memory budget allows.
+        //! \param[in] description The \a image_resource_description used for loading the \a image_resource.
+        virtual void prefetch(const image_resource_description& description) = 0;
+        //! \brief Loads a \a model_resource into the cache without referencing it.
+        //! \details The \a model_resource is retained as long as the memory budget allows.
+        //! \param[in] description The \a model_resource_description used for loading the \a model_resource.
+        virtual void prefetch(const model_resource_description& description) = 0;
+        //! \brief Loads a \a shader_resource into the cache without referencing it.
+        //! \details The \a shader_resource is retained as long as the memory budget allows.
+        //! \param[in] description The \a shader_resource_resource_description used for loading the \a shader_resource.
+        virtual void prefetch(const shader_resource_resource_description& description) = 0;
+
+        //! \brief Pins an acquired resource, so that it is never evicted from the cache.
+        //! \details Pinned resources stay in the cache after their last release until they get unpinned.
+        //! \param[in] resource The resource to pin.
+        virtual void pin(const resource_base* resource) = 0;
+        //! \brief Unpins a pinned resource.
+        //! \param[in] resource The resource to unpin.
+        virtual void unpin(const resource_base* resource) = 0;
+
+        //! \brief Sets the memory budget of the resource cache.
+        //! \details Unreferenced resources are evicted in least recently used order when the cached size exceeds the budget. Referenced and pinned resources are never evicted.
+        //! \param[in] budget The budget in bytes. 0 frees resources on their last release.
+        virtual void set_memory_budget(int64 budget) = 0;
+
+        //! \brief Retrieves the \a resource_cache_statistics.
+        //! \return The current \a resource_cache_statistics.
+        virtual resource_cache_statistics get_cache_statistics() = 0;
     };
 
 
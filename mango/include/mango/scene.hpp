@@ -55,6 +55,18 @@ namespace mango
         //! \return The node \a sid of the containing \a node.
         virtual sid add_atmospheric_light(atmospheric_light& new_atmospheric_light, sid containing_node_id) = 0;
 
+        //! \brief Adds a \a point_light to the \a scene.
+        //! \param[in] new_point_light The \a point_light to add to the \a scene.
+        //! \param[in] containing_node_id The \a sid of the \a node that should contain the \a point_light.
+        //! \return The node \a sid of the containing \a node.
+        virtual sid add_point_light(point_light& new_point_light, sid containing_node_id) = 0;
+
+        //! \brief Adds a \a spot_light to the \a scene.
+        //! \param[in] new_spot_light The \a spot_light to add to the \a scene.
+        //! \param[in] containing_node_id The \a sid of the \a node that should contain the \a spot_light.
+        //! \return The node \a sid of the containing \a node.
+        virtual sid add_spot_light(spot_light& new_spot_light, sid containing_node_id) = 0;
+
         //! \brief Builds a \a material.
         //! \param[in] new_material The \a material to build.
         //! \return The node \a sid of the created \a material.
@@ -115,6 +127,14 @@ namespace mango
         //! \param[in] node_id The \a sid of the containing \a node of the \a atmospheric_light to remove from the \a scene.
         virtual void remove_atmospheric_light(sid node_id) = 0;
 
+        //! \brief Removes a \a point_light from the \a scene.
+        //! \param[in] node_id The \a sid of the containing \a node of the \a point_light to remove from the \a scene.
+        virtual void remove_point_light(sid node_id) = 0;
+
+        //! \brief Removes a \a spot_light from the \a scene.
+        //! \param[in] node_id The \a sid of the containing \a node of the \a spot_light to remove from the \a scene.
+        virtual void remove_spot_light(sid node_id) = 0;
+
         //! \brief Retrieves a \a node from the \a scene.
         //! \param[in] node_id The \a sid of the \a node to retrieve from the \a scene.
         //! \return An optional \a node reference.
@@ -152,6 +172,16 @@ namespace mango
         //! \return An optional \a atmospheric_light reference.
         virtual optional<atmospheric_light&> get_atmospheric_light(sid node_id) = 0;
 
+        //! \brief Retrieves a \a point_light from the \a scene.
+        //! \param[in] node_id The \a sid of the containing \a node of the \a point_light to retrieve from the \a scene.
+        //! \return An optional \a point_light reference.
+        virtual optional<point_light&> get_point_light(sid node_id) = 0;
+
+        //! \brief Retrieves a \a spot_light from the \a scene.
+        //! \param[in] node_id The \a sid of the containing \a node of the \a spot_light to retrieve from the \a scene.
+        //! \return An optional \a spot_light reference.
+        virtual optional<spot_light&> get_spot_light(sid node_id) = 0;
+
         //! \brief Retrieves a \a model from the \a scene.
         //! \param[in] instance_id The \a sid of the \a model instance to retrieve.
         //! \return An optional \a model reference.
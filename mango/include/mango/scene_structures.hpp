@@ -31,6 +31,8 @@ namespace mango
         scene_structure_directional_light,
         scene_structure_skylight,
         scene_structure_atmospheric_light,
+        scene_structure_point_light,
+        scene_structure_spot_light,
         scene_structure_texture,
         scene_structure_material,
         scene_structure_primitive,
@@ -313,10 +315,125 @@ namespace mango
             , intensity(default_directional_intensity)
             , cast_shadows(false)
             , contribute_to_atmosphere(false)
+            , changed(false)
         {
         }
         //! \brief \a Directional_light is a scene structure.
         DECLARE_SCENE_STRUCTURE(directional_light);
+
+        //! \brief Marks the \a directional_light to be updated.
+        //! \details Optional, changed fields are detected when the light is rendered. Forces the light data to be written again.
+        inline void update()
+        {
+            changed = true;
+        }
+
+        //! \brief Checks if the \a directional_light has been updated.
+        //! \return True if changes were made, else false.
+        inline bool dirty()
+        {
+            return changed;
+        }
+
+      private:
+        friend struct scene_light;
+        //! \brief Change flag. True if changes were made, else false.
+        bool changed;
+    };
+
+    //! \brief Public structure holding informations for a point light.
+    struct point_light
+    {
+        //! \brief The \a sid of the containing node.
+        sid containing_node;
+
+        //! \brief The color of the \a point_light. Values between 0.0 and 1.0.
+        color_rgb color;
+        //! \brief The intensity of the \a point_light in lumen.
+        float intensity;
+        //! \brief The radius of influence of the \a point_light in meters. The light falls off to zero at this distance.
+        float radius;
+
+        point_light()
+            : color(1.0f)
+            , intensity(default_point_light_intensity)
+            , radius(default_light_radius)
+            , changed(false)
+        {
+        }
+        //! \brief \a Point_light is a scene structure.
+        DECLARE_SCENE_STRUCTURE(point_light);
+
+        //! \brief Marks the \a point_light to be updated.
+        //! \details Optional, changed fields are detected when the light is rendered. Forces the light data to be written again.
+        inline void update()
+        {
+            changed = true;
+        }
+
+        //! \brief Checks if the \a point_light has been updated.
+        //! \return True if changes were made, else false.
+        inline bool dirty()
+        {
+            return changed;
+        }
+
+      private:
+        friend struct scene_light;
+        //! \brief Change flag. True if changes were made, else false.
+        bool changed;
+    };
+
+    //! \brief Public structure holding informations for a spot light.
+    struct spot_light
+    {
+        //! \brief The \a sid of the containing node.
+        sid containing_node;
+
+        //! \brief The direction of the \a spot_light from the light into the cone.
+        vec3 direction;
+        //! \brief The color of the \a spot_light. Values between 0.0 and 1.0.
+        color_rgb color;
+        //! \brief The intensity of the \a spot_light in lumen.
+        float intensity;
+        //! \brief The radius of influence of the \a spot_light in meters. The light falls off to zero at this distance.
+        float radius;
+        //! \brief The angle in radians between the direction and the edge of the fully lit inner cone.
+        float inner_cone_angle;
+        //! \brief The angle in radians between the direction and the edge of the outer cone. Nothing is lit outside.
+        float outer_cone_angle;
+
+        spot_light()
+            : direction(0.0f, -1.0f, 0.0f)
+            , color(1.0f)
+            , intensity(default_spot_light_intensity)
+            , radius(default_light_radius)
+            , inner_cone_angle(0.4f)
+            , outer_cone_angle(0.6f)
+            , changed(false)
+        {
+        }
+        //! \brief \a Spot_light is a scene structure.
+        DECLARE_SCENE_STRUCTURE(spot_light);
+
+        //! \brief Marks the \a spot_light to be updated.
+        //! \details Optional, changed fields are detected when the light is rendered. Forces the light data to be written again.
+        inline void update()
+        {
+            changed = true;
+        }
+
+        //! \brief Checks if the \a spot_light has been updated.
+        //! \return True if changes were made, else false.
+        inline bool dirty()
+        {
+            return changed;
+        }
+
+      private:
+        friend struct scene_light;
+        //! \brief Change flag. True if changes were made, else false.
+        bool changed;
     };
 
     //! \brief Public structure holding informations for a skylight.
@@ -341,10 +458,30 @@ namespace mango
             , use_texture(false)
             , dynamic(false)
             , local(false)
+            , changed(false)
         {
         }
         //! \brief \a Skylight is a scene structure.
         DECLARE_SCENE_STRUCTURE(skylight);
+
+        //! \brief Marks the \a skylight to be updated.
+        //! \details Optional, changed fields are detected when the light is rendered. Forces the light data to be written again.
+        inline void update()
+        {
+            changed = true;
+        }
+
+        //! \brief Checks if the \a skylight has been updated.
+        //! \return True if changes were made, else false.
+        inline bool dirty()
+        {
+            return changed;
+        }
+
+      private:
+        friend struct scene_light;
+        //! \brief Change flag. True if changes were made, else false.
+        bool changed;
     };
 
     //! \brief Public structure holding informations for a atmospheric light.
@@ -381,11 +518,30 @@ namespace mango
             , atmosphere_radius(6420e3f)
             , view_height(1e3f)
             , mie_preferred_scattering_dir(0.758f)
-
+            , changed(false)
         {
         }
         //! \brief \a Atmospheric_light is a scene structure.
         DECLARE_SCENE_STRUCTURE(atmospheric_light);
+
+        //! \brief Marks the \a atmospheric_light to be updated.
+        //! \details Optional, changed fields are detected when the light is rendered. Forces the light data to be written again.
+        inline void update()
+        {
+            changed = true;
+        }
+
+        //! \brief Checks if the \a atmospheric_light has been updated.
+        //! \return True if changes were made, else false.
+        inline bool dirty()
+        {
+            return changed;
+        }
+
+      private:
+        friend struct scene_light;
+        //! \brief Change flag. True if changes were made, else false.
+        bool changed;
     };
 
     //! \brief Public structure holding informations for a texture loaded from an image.
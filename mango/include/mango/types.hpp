@@ -311,6 +311,12 @@ namespace mango
 
     //! \brief The default intensity of a directional light. Is approx. the intensity of the sun.
     const float default_directional_intensity = 110000.0f;
+    //! \brief The default intensity of a point light. Is approx. the intensity of a 100 watt light bulb.
+    const float default_point_light_intensity = 1500.0f;
+    //! \brief The default intensity of a spot light.
+    const float default_spot_light_intensity = 1500.0f;
+    //! \brief The default radius of influence of point and spot lights in meters.
+    const float default_light_radius = 10.0f;
     //! \brief The default intensity of a skylight. Is approx. the intensity of a sunny sky.
     const float default_skylight_intensity = 30000.0f;
     //! \brief The default intensity of a emissive object. // TODO Paul: Make something more meaningful.
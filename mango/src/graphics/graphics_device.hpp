@@ -59,6 +59,13 @@ namespace mango
         //! \return A \a gfx_handle of the created compute \a gfx_pipeline.
         virtual gfx_handle<const gfx_pipeline> create_compute_pipeline(const compute_pipeline_create_info& info) const = 0;
 
+        //! \brief Checks without blocking if a \a gfx_pipeline is ready to be bound.
+        //! \details Starts creating the native objects of the \a gfx_pipeline if that did not happen yet.
+        //! Binding a \a gfx_pipeline that is not ready blocks until it is created.
+        //! \param[in] pipeline The \a gfx_pipeline to check.
+        //! \return True if the \a gfx_pipeline can be bound without blocking, else false.
+        virtual bool is_pipeline_ready(const gfx_handle<const gfx_pipeline>& pipeline) const = 0;
+
         //! \brief Creates a \a gfx_buffer.
         //! \param[in] info The \a buffer_create_info providing info for creation.
         //! \return A \a gfx_handle of the \a gfx_buffer.
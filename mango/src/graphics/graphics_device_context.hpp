@@ -53,6 +53,14 @@ namespace mango
         //! \param[in] data Pointer to the data to set.
         virtual void set_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, void* data) = 0;
 
+        //! \brief Reads the data of a \a gfx_texture back from the gpu.
+        //! \details Blocks until all previously submitted work writing the \a gfx_texture is finished. Should not be used in frame critical code.
+        //! \param[in] texture_handle The \a gfx_handle of the \a gfx_texture to read the data from.
+        //! \param[in] desc The \a texture_set_description holding all information how and where exactly to read the data. Cubemap faces are addressed by the z offset and the depth.
+        //! \param[in] size The size of the data buffer in bytes.
+        //! \param[out] data Pointer to the data buffer to read into.
+        virtual void get_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, int32 size, void* data) = 0;
+
         //
         // dynamic state
         //
@@ -169,6 +177,12 @@ namespace mango
         //! \param[in] z The number of work groups to start in z dimension.
         virtual void dispatch(int32 x, int32 y, int32 z) = 0;
 
+        //! \brief Schedules a compute dispatch on the gpu with work group counts read from a buffer.
+        //! \details Requires a bound \a gfx_pipeline.
+        //! \param[in] buffer_handle The \a gfx_buffer containing the number of work groups to start in x, y and z dimension as three consecutive uint32.
+        //! \param[in] offset The offset in bytes to the work group counts in the buffer. Has to be a multiple of four.
+        virtual void dispatch_indirect(gfx_handle<const gfx_buffer> buffer_handle, int32 offset) = 0;
+
         //
         // synchronization
         //
@@ -186,10 +200,25 @@ namespace mango
         //! \param[in] semaphore The \a gfx_semaphore to check for the synchronization status.
         virtual void client_wait(gfx_handle<const gfx_semaphore> semaphore) = 0;
 
+        //! \brief Checks if a certain synchronization point is reached without waiting for it.
+        //! \param[in] semaphore The \a gfx_semaphore to check for the synchronization status.
+        //! \return True if the synchronization point is reached or the \a gfx_semaphore is invalid, else false.
+        virtual bool is_signaled(gfx_handle<const gfx_semaphore> semaphore) = 0;
+
         //! \brief Makes the gpu wait for a certain synchronization point.
         //! \param[in] semaphore The \a gfx_semaphore to check for the synchronization status.
         virtual void wait(gfx_handle<const gfx_semaphore> semaphore) = 0;
 
+        //! \brief Records a timestamp on the gpu after all previous commands are completed.
+        //! \return A \a gfx_handle of the \a gfx_timestamp to query the time with.
+        virtual gfx_handle<const gfx_timestamp> timestamp() = 0;
+
+        //! \brief Queries the time of a \a gfx_timestamp without waiting for it.
+        //! \param[in] timestamp The \a gfx_timestamp to query.
+        //! \param[out] nanoseconds The gpu time in nanoseconds. Only written when the result is available.
+        //! \return True if the result is available, else false.
+        virtual bool get_timestamp(gfx_handle<const gfx_timestamp> timestamp, uint64& nanoseconds) = 0;
+
         //
         // submission
         //
@@ -544,6 +544,17 @@ namespace mango
             return 6;
         };
     };
+
+    //! \brief A \a gfx_device_object representing a timestamp query on the gpu.
+    //! \details Used to measure gpu execution times.
+    class gfx_timestamp : public gfx_device_object
+    {
+      public:
+        int32 get_type_id() const override
+        {
+            return 7;
+        };
+    };
 } // namespace mango
 
 #endif // MANGO_GRAPHICS_RESOURCES_HPP
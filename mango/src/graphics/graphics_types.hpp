@@ -239,6 +239,7 @@ namespace mango
         rgb5               = 0x8050,
         rgb8               = 0x8051,
         rgb10              = 0x8052,
+        r11f_g11f_b10f     = 0x8c3a,
         rgb12              = 0x8053,
         rgb16              = 0x8054,
         srgb8              = 0x8c41,
@@ -14,6 +14,9 @@
 
 using namespace mango;
 
+//! \brief Function pointer type of glMaxShaderCompilerThreadsKHR and glMaxShaderCompilerThreadsARB.
+typedef void(GLAPIENTRY* max_shader_compiler_threads_proc)(uint32 count);
+
 #ifdef MANGO_DEBUG
 static void GLAPIENTRY debugCallback(gl_enum source, gl_enum type, uint32 id, gl_enum severity, int32 length, const char* message, const void* userParam);
 #endif // MANGO DEBUG
@@ -52,8 +55,20 @@ gl_graphics_device::gl_graphics_device(display_impl::native_window_handle displa
 
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS); // TODO Paul: This should at least be a specified feature!
 
+    // Let the driver compile and link shaders in the background if it is able to.
+    max_shader_compiler_threads_proc max_shader_compiler_threads = nullptr;
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+        max_shader_compiler_threads = reinterpret_cast<max_shader_compiler_threads_proc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+        max_shader_compiler_threads = reinterpret_cast<max_shader_compiler_threads_proc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    if (max_shader_compiler_threads)
+    {
+        max_shader_compiler_threads(0xFFFFFFFF); // Implementation specific maximum.
+        MANGO_LOG_INFO("Parallel shader compilation is enabled.");
+    }
+
     m_shared_graphics_state = make_gfx_handle<gl_graphics_state>();
-    m_shader_program_cache  = make_gfx_handle<gl_shader_program_cache>();
+    m_shader_program_cache  = make_gfx_handle<gl_shader_program_cache>(max_shader_compiler_threads != nullptr);
     m_framebuffer_cache     = make_gfx_handle<gl_framebuffer_cache>();
     m_vertex_array_cache    = make_gfx_handle<gl_vertex_array_cache>();
 
@@ -161,6 +176,18 @@ gfx_handle<const gfx_pipeline> gl_graphics_device::create_compute_pipeline(const
     return make_gfx_handle<const gl_compute_pipeline>(std::forward<const compute_pipeline_create_info&>(info));
 }
 
+bool gl_graphics_device::is_pipeline_ready(const gfx_handle<const gfx_pipeline>& pipeline) const
+{
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_pipeline>(pipeline), "Pipeline is not a gl_pipeline!");
+    gfx_handle<const gl_graphics_pipeline> graphics_pipeline = std::dynamic_pointer_cast<const gl_graphics_pipeline>(pipeline);
+    if (graphics_pipeline)
+        return m_shader_program_cache->is_shader_program_ready(graphics_pipeline->m_info.shader_stage_descriptor);
+
+    gfx_handle<const gl_compute_pipeline> compute_pipeline = std::dynamic_pointer_cast<const gl_compute_pipeline>(pipeline);
+    MANGO_ASSERT(compute_pipeline, "Pipeline is not of a valid type!");
+    return m_shader_program_cache->is_shader_program_ready(compute_pipeline->m_info.shader_stage_descriptor);
+}
+
 gfx_handle<const gfx_buffer> gl_graphics_device::create_buffer(const buffer_create_info& info) const
 {
     return make_gfx_handle<const gl_buffer>(std::forward<const buffer_create_info&>(info));
@@ -32,6 +32,7 @@ namespace mango
         compute_pipeline_create_info provide_compute_pipeline_create_info() override;
         gfx_handle<const gfx_pipeline> create_graphics_pipeline(const graphics_pipeline_create_info& info) const override;
         gfx_handle<const gfx_pipeline> create_compute_pipeline(const compute_pipeline_create_info& info) const override;
+        bool is_pipeline_ready(const gfx_handle<const gfx_pipeline>& pipeline) const override;
         gfx_handle<const gfx_buffer> create_buffer(const buffer_create_info& info) const override;
         gfx_handle<const gfx_texture> create_texture(const texture_create_info& info) const override;
         gfx_handle<const gfx_image_texture_view> create_image_texture_view(gfx_handle<const gfx_texture> texture, int32 level) const override;
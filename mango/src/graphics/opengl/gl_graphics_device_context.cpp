@@ -113,9 +113,13 @@ void gl_graphics_device_context::set_texture_data(gfx_handle<const gfx_texture>
 
     gfx_handle<const gl_texture> tex = static_gfx_handle_cast<const gl_texture>(texture_handle);
 
+    // Cubemap faces are addressed as layers.
+    bool cube_map = tex->m_info.texture_type == gfx_texture_type::texture_type_cube_map;
+    int32 layers  = cube_map ? 6 : tex->m_info.array_layers;
+
     MANGO_ASSERT(desc.x_offset <= tex->m_info.width, "Texture access out of bounds!");
     MANGO_ASSERT(desc.y_offset <= tex->m_info.height, "Texture access out of bounds!");
-    MANGO_ASSERT(desc.z_offset <= tex->m_info.array_layers, "Texture access out of bounds!");
+    MANGO_ASSERT(desc.z_offset + desc.depth <= layers, "Texture access out of bounds!");
     MANGO_ASSERT(desc.width >= 0, "Can not set negative data width!");
     MANGO_ASSERT(desc.height >= 0, "Can not set negative data height!");
     MANGO_ASSERT(desc.depth >= 0, "Can not set negative data depth!");
@@ -124,15 +128,10 @@ void gl_graphics_device_context::set_texture_data(gfx_handle<const gfx_texture>
     gl_enum pixel_format   = gfx_format_to_gl(desc.pixel_format);
     gl_enum component_type = gfx_format_to_gl(desc.component_type);
 
-    if (tex->m_info.array_layers > 1)
+    if (layers > 1)
     {
         glTextureSubImage3D(tex->m_texture_gl_handle, desc.level, desc.x_offset, desc.y_offset, desc.z_offset, desc.width, desc.height, desc.depth, pixel_format, component_type, data);
     }
-    else if (tex->m_info.texture_type == gfx_texture_type::texture_type_cube_map)
-    {
-        for (int32 i = 0; i < 6; ++i)
-            glTextureSubImage3D(tex->m_texture_gl_handle, desc.level, 0, 0, i, desc.width, desc.height, desc.depth, pixel_format, component_type, data); // TODO Paul: Is this correct?
-    }
     else
     {
         glTextureSubImage2D(tex->m_texture_gl_handle, desc.level, desc.x_offset, desc.y_offset, desc.width, desc.height, pixel_format, component_type, data);
@@ -141,6 +140,34 @@ void gl_graphics_device_context::set_texture_data(gfx_handle<const gfx_texture>
     // Invalidating the texture is not required!
 }
 
+void gl_graphics_device_context::get_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, int32 size, void* data)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_texture>(texture_handle), "texture is not a gl_texture");
+
+    gfx_handle<const gl_texture> tex = static_gfx_handle_cast<const gl_texture>(texture_handle);
+
+    bool cube_map = tex->m_info.texture_type == gfx_texture_type::texture_type_cube_map;
+    int32 layers  = cube_map ? 6 : tex->m_info.array_layers;
+
+    MANGO_ASSERT(desc.x_offset + desc.width <= tex->m_info.width, "Texture access out of bounds!");
+    MANGO_ASSERT(desc.y_offset + desc.height <= tex->m_info.height, "Texture access out of bounds!");
+    MANGO_ASSERT(desc.z_offset + desc.depth <= layers, "Texture access out of bounds!");
+    MANGO_ASSERT(desc.level < tex->m_info.miplevels, "Texture access out of bounds!");
+    MANGO_UNUSED(layers);
+
+    // Writes by compute shaders have to be visible for the read back.
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    glGetTextureSubImage(tex->m_texture_gl_handle, desc.level, desc.x_offset, desc.y_offset, desc.z_offset, desc.width, desc.height, desc.depth, gfx_format_to_gl(desc.pixel_format),
+                         gfx_format_to_gl(desc.component_type), size, data);
+}
+
 void gl_graphics_device_context::set_viewport(int32 first, int32 count, const gfx_viewport* viewports)
 {
     if (!recording)
@@ -749,6 +776,27 @@ void gl_graphics_device_context::dispatch(int32 x, int32 y, int32 z)
     glDispatchCompute(x, y, z);
 }
 
+void gl_graphics_device_context::dispatch_indirect(gfx_handle<const gfx_buffer> buffer_handle, int32 offset)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(m_shared_graphics_state->bound_pipeline, "No Pipeline is currently bound!");
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_compute_pipeline>(m_shared_graphics_state->bound_pipeline), "Pipeline is not a compute pipeline!");
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_buffer>(buffer_handle), "buffer is not a gl_buffer");
+
+    gfx_handle<const gl_buffer> buf = static_gfx_handle_cast<const gl_buffer>(buffer_handle);
+
+    MANGO_ASSERT(offset % 4 == 0, "Indirect dispatch offset has to be a multiple of four!");
+    MANGO_ASSERT(offset + 3 * static_cast<int32>(sizeof(uint32)) <= buf->m_info.size, "Buffer access out of bounds!");
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buf->m_buffer_gl_handle);
+    glDispatchComputeIndirect(static_cast<GLintptr>(offset));
+}
+
 void gl_graphics_device_context::end()
 {
     if (!recording)
@@ -812,6 +860,27 @@ void gl_graphics_device_context::client_wait(gfx_handle<const gfx_semaphore> sem
     //    MANGO_LOG_DEBUG("Waited {0} ns.", waiting_time);
 }
 
+bool gl_graphics_device_context::is_signaled(gfx_handle<const gfx_semaphore> semaphore)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return false;
+    }
+
+    if (!semaphore)
+        return true;
+
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_semaphore>(semaphore), "Semaphore is not a gl_semaphore!");
+
+    GLsync sync_object = static_cast<GLsync>(static_gfx_handle_cast<const gl_semaphore>(semaphore)->m_semaphore_gl_handle);
+
+    if (!glIsSync(sync_object))
+        return true;
+    gl_enum wait_return = glClientWaitSync(sync_object, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return wait_return == GL_ALREADY_SIGNALED || wait_return == GL_CONDITION_SATISFIED;
+}
+
 void gl_graphics_device_context::wait(gfx_handle<const gfx_semaphore> semaphore)
 {
     if (!recording)
@@ -828,6 +897,38 @@ void gl_graphics_device_context::wait(gfx_handle<const gfx_semaphore> semaphore)
     glDeleteSync(sync_object);
 }
 
+gfx_handle<const gfx_timestamp> gl_graphics_device_context::timestamp()
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return nullptr;
+    }
+
+    return make_gfx_handle<const gl_timestamp>();
+}
+
+bool gl_graphics_device_context::get_timestamp(gfx_handle<const gfx_timestamp> timestamp, uint64& nanoseconds)
+{
+    if (!timestamp)
+        return false;
+
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_timestamp>(timestamp), "Timestamp is not a gl_timestamp!");
+
+    gl_handle query = static_gfx_handle_cast<const gl_timestamp>(timestamp)->m_query_gl_handle;
+
+    // Does not stall, the result is only read when the gpu has passed the timestamp.
+    int32 available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return false;
+
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+    nanoseconds = static_cast<uint64>(result);
+    return true;
+}
+
 void gl_graphics_device_context::present()
 {
     if (!recording)
@@ -35,6 +35,7 @@ namespace mango
         void set_buffer_data(gfx_handle<const gfx_buffer> buffer_handle, int32 offset, int32 size, void* data) override;
         void* map_buffer_data(gfx_handle<const gfx_buffer> buffer_handle, int32 offset, int32 size) override;
         void set_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, void* data) override;
+        void get_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, int32 size, void* data) override;
         void begin() override;
         void set_viewport(int32 first, int32 count, const gfx_viewport* viewports) override;
         void set_scissor(int32 first, int32 count, const gfx_scissor_rectangle* scissors) override;
@@ -53,11 +54,15 @@ namespace mango
         void submit_pipeline_state_resources() override;
         void draw(int32 vertex_count, int32 index_count, int32 instance_count, int32 base_vertex, int32 base_instance, int32 index_offset) override;
         void dispatch(int32 x, int32 y, int32 z) override;
+        void dispatch_indirect(gfx_handle<const gfx_buffer> buffer_handle, int32 offset) override;
         void end() override;
         void barrier(const barrier_description& desc) override;
         gfx_handle<const gfx_semaphore> fence(const semaphore_create_info& info) override;
         void client_wait(gfx_handle<const gfx_semaphore> semaphore) override;
+        bool is_signaled(gfx_handle<const gfx_semaphore> semaphore) override;
         void wait(gfx_handle<const gfx_semaphore> semaphore) override;
+        gfx_handle<const gfx_timestamp> timestamp() override;
+        bool get_timestamp(gfx_handle<const gfx_timestamp> timestamp, uint64& nanoseconds) override;
         void present() override;
         void submit() override;
 
@@ -7,23 +7,36 @@
 #include <glad/glad.h>
 #include <graphics/opengl/gl_graphics_resources.hpp>
 #include <mango/profile.hpp>
+#include <util/hashing.hpp>
 
 using namespace mango;
 
 gl_shader_stage::gl_shader_stage(const shader_stage_create_info& info)
     : m_info(info)
+    , m_source(info.shader_source.source, info.shader_source.size)
 {
-    create_shader_from_source();
+    m_info.shader_source.source = m_source.c_str();
 
-    set_uid(get_uid_low(), m_shader_stage_gl_handle);
+    uint8 stage   = static_cast<uint8>(m_info.stage);
+    m_source_hash = fnv1a_hash::hash(&stage, sizeof(stage));
+    m_source_hash = fnv1a_hash::hash(m_source.data(), m_source.size(), m_source_hash);
 }
 
-void gl_shader_stage::create_shader_from_source()
+gl_handle gl_shader_stage::get_compiled_handle() const
 {
-    m_shader_stage_gl_handle = glCreateShader(gfx_shader_stage_type_to_gl(m_info.stage));
-    glShaderSource(m_shader_stage_gl_handle, 1, &m_info.shader_source.source, &m_info.shader_source.size);
-    MANGO_LOG_INFO("Entry point specification is currently not supported and is \"main\"!"); // TODO Paul
-    glCompileShader(m_shader_stage_gl_handle);
+    if (!m_compiled)
+    {
+        create_shader_from_source();
+        m_compiled = true;
+    }
+    return m_shader_stage_gl_handle;
+}
+
+bool gl_shader_stage::check_compile_status() const
+{
+    if (!m_shader_stage_gl_handle)
+        return false;
+
     int32 status = 0;
     glGetShaderiv(m_shader_stage_gl_handle, GL_COMPILE_STATUS, &status);
     if (GL_FALSE == status)
@@ -32,17 +45,26 @@ void gl_shader_stage::create_shader_from_source()
         glGetShaderiv(m_shader_stage_gl_handle, GL_INFO_LOG_LENGTH, &log_size);
         std::vector<char> info_log(log_size);
         glGetShaderInfoLog(m_shader_stage_gl_handle, log_size, &log_size, info_log.data());
-        glDeleteShader(m_shader_stage_gl_handle);
-        m_shader_stage_gl_handle = 0;
 
         MANGO_LOG_ERROR("Shader compilation failed: {0} !", info_log.data());
-        return;
+        return false;
     }
+    return true;
+}
+
+void gl_shader_stage::create_shader_from_source() const
+{
+    m_shader_stage_gl_handle = glCreateShader(gfx_shader_stage_type_to_gl(m_info.stage));
+    glShaderSource(m_shader_stage_gl_handle, 1, &m_info.shader_source.source, &m_info.shader_source.size);
+    MANGO_LOG_INFO("Entry point specification is currently not supported and is \"main\"!"); // TODO Paul
+    // The status is not queried here, so that drivers supporting parallel shader compilation do not block.
+    glCompileShader(m_shader_stage_gl_handle);
 }
 
 gl_shader_stage::~gl_shader_stage()
 {
-    glDeleteShader(m_shader_stage_gl_handle);
+    if (m_shader_stage_gl_handle)
+        glDeleteShader(m_shader_stage_gl_handle);
 }
 
 gl_buffer::gl_buffer(const buffer_create_info& info)
@@ -168,6 +190,19 @@ gl_semaphore::~gl_semaphore()
         glDeleteSync(sync_object); // TODO Paul: Does this work?
 }
 
+gl_timestamp::gl_timestamp()
+{
+    glCreateQueries(GL_TIMESTAMP, 1, &m_query_gl_handle);
+    glQueryCounter(m_query_gl_handle, GL_TIMESTAMP);
+
+    set_uid(get_uid_low(), m_query_gl_handle);
+}
+
+gl_timestamp::~gl_timestamp()
+{
+    glDeleteQueries(1, &m_query_gl_handle);
+}
+
 bool gl_shader_resource_mapping::set(const string variable_name, gfx_handle<const gfx_device_object> resource)
 {
     auto query = m_name_to_binding_pair.find(variable_name);
@@ -29,18 +29,37 @@ namespace mango
         ~gl_shader_stage();
         void* native_handle() const override
         {
-            return (void*)(uintptr)m_shader_stage_gl_handle;
+            return (void*)(uintptr)get_compiled_handle();
         }
 
+        //! \brief Returns the native opengl handle and starts the compilation of the shader stage if that did not happen yet.
+        //! \details Compilation is deferred, so that shader stages of programs loaded from the program binary cache never get compiled.
+        //! The compilation status is not queried, the driver may still compile in the background.
+        //! \return The native opengl handle.
+        gl_handle get_compiled_handle() const;
+
+        //! \brief Checks if the compilation of the shader stage succeeded and logs the errors if not.
+        //! \details Blocks until the compilation is finished.
+        //! \return True if the compilation succeeded, else false.
+        bool check_compile_status() const;
+
         //! \brief The \a shader_stage_create_info used for creation.
+        //! \details The shader source points to \a m_source.
         shader_stage_create_info m_info;
-        //! \brief The native opengl handle.
-        gl_handle m_shader_stage_gl_handle = 0;
+        //! \brief The native opengl handle. 0 as long as the shader stage is not compiled.
+        mutable gl_handle m_shader_stage_gl_handle = 0;
+        //! \brief Hash of the shader stage type and the shader source.
+        uint64 m_source_hash;
 
       private:
         //! \brief Creates the shader stage from a shader source.
-        void create_shader_from_source();
+        void create_shader_from_source() const;
         // void reflect();
+
+        //! \brief Copy of the shader source, since compilation can happen after the source is released.
+        string m_source;
+        //! \brief True if compilation was already tried, else false.
+        mutable bool m_compiled = false;
     };
 
     //! \brief An opengl \a gfx_buffer.
@@ -175,6 +194,22 @@ namespace mango
         gl_sync m_semaphore_gl_handle = 0;
     };
 
+    //! \brief An opengl \a gfx_timestamp.
+    class gl_timestamp : public gfx_timestamp
+    {
+      public:
+        //! \brief Constructs a \a gl_timestamp and records the timestamp.
+        gl_timestamp();
+        ~gl_timestamp();
+        void* native_handle() const override
+        {
+            return (void*)(uintptr)m_query_gl_handle;
+        }
+
+        //! \brief The native opengl query handle.
+        gl_handle m_query_gl_handle = 0;
+    };
+
     //! \brief An opengl \a shader_resource_mapping.
     class gl_shader_resource_mapping : public shader_resource_mapping
     {
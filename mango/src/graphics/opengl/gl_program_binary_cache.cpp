@@ -0,0 +1,159 @@
+//! \file      gl_program_binary_cache.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <cstdio>
+#include <fstream>
+#include <graphics/opengl/gl_program_binary_cache.hpp>
+#include <util/hashing.hpp>
+#include <util/helpers.hpp>
+
+using namespace mango;
+
+//! \brief Magic number of program binary files. 'MGPB'.
+static const uint32 program_binary_magic = 0x4250474D;
+//! \brief The version of the program binary file layout.
+static const uint32 program_binary_version = 1;
+
+gl_program_binary_cache::gl_program_binary_cache(const string& directory)
+    : m_directory(directory)
+    , m_driver_hash(fnv1a_hash::offset_basis)
+    , m_enabled(false)
+{
+    int32 format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count <= 0)
+    {
+        MANGO_LOG_INFO("Driver does not support program binaries, program binary cache is disabled.");
+        return;
+    }
+
+    const gl_enum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (gl_enum name : names)
+    {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        if (str)
+            m_driver_hash = fnv1a_hash::hash(str, strlen(str), m_driver_hash);
+    }
+
+    if (m_directory.empty() || (m_directory.back() != '/' && m_directory.back() != '\\'))
+        m_directory += '/';
+
+    m_enabled = create_directories(m_directory);
+    if (!m_enabled)
+        MANGO_LOG_WARN("Could not create program binary cache directory '{0}', program binary cache is disabled.", m_directory);
+}
+
+gl_program_binary_cache::~gl_program_binary_cache() {}
+
+uint64 gl_program_binary_cache::create_key(int32 stage_count, const gfx_shader_stage_type* stage_types, const uint64* source_hashes) const
+{
+    uint64 key = m_driver_hash;
+    for (int32 i = 0; i < stage_count; ++i)
+    {
+        uint8 type = static_cast<uint8>(stage_types[i]);
+        key        = fnv1a_hash::hash(&type, sizeof(type), key);
+        key        = fnv1a_hash::hash(&source_hashes[i], sizeof(uint64), key);
+    }
+    return key;
+}
+
+gl_handle gl_program_binary_cache::load(uint64 key)
+{
+    if (!m_enabled)
+        return 0;
+
+    string path = file_path(key);
+    std::ifstream input(path, std::ios::in | std::ios::binary);
+    if (!input.is_open())
+        return 0;
+
+    binary_header header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(binary_header));
+
+    bool valid = input.good() && header.magic == program_binary_magic && header.version == program_binary_version && header.driver_hash == m_driver_hash && header.key == key;
+
+    std::vector<char> binary;
+    if (valid)
+    {
+        binary.resize(header.length);
+        input.read(binary.data(), header.length);
+        valid = input.good();
+    }
+    input.close();
+
+    gl_handle program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<int32>(header.length));
+
+        int32 status = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (GL_FALSE == status)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (!program)
+    {
+        // Stale binary of another driver or rejected by the driver. Delete it, it gets recompiled and stored again.
+        MANGO_LOG_DEBUG("Program binary '{0}' is stale and gets recompiled.", path);
+        std::remove(path.c_str());
+    }
+
+    return program;
+}
+
+void gl_program_binary_cache::store(uint64 key, gl_handle program)
+{
+    if (!m_enabled || !program)
+        return;
+
+    int32 length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    gl_enum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0)
+        return;
+
+    binary_header header;
+    header.magic       = program_binary_magic;
+    header.version     = program_binary_version;
+    header.driver_hash = m_driver_hash;
+    header.key         = key;
+    header.format      = format;
+    header.length      = static_cast<uint32>(length);
+
+    // Written to a temporary file first, so that a crash never leaves a partial binary behind.
+    string path      = file_path(key);
+    string temp_path = path + ".tmp";
+    std::ofstream output(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+        return;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(binary_header));
+    output.write(binary.data(), length);
+    output.close();
+
+    std::remove(path.c_str());
+    if (!output.good() || std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        MANGO_LOG_WARN("Could not write program binary '{0}'.", path);
+        std::remove(temp_path.c_str());
+    }
+}
+
+string gl_program_binary_cache::file_path(uint64 key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_directory + name;
+}
@@ -0,0 +1,76 @@
+//! \file      gl_program_binary_cache.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_GL_PROGRAM_BINARY_CACHE_HPP
+#define MANGO_GL_PROGRAM_BINARY_CACHE_HPP
+
+#include <graphics/opengl/gl_graphics_resources.hpp>
+
+namespace mango
+{
+    //! \brief On disk cache for linked opengl shader programs.
+    //! \details Stores program binaries retrieved with glGetProgramBinary and loads them with glProgramBinary.
+    //! Each file stores the hash of the driver it got created with. Binaries of other drivers or binaries the driver rejects are deleted and have to be recompiled.
+    class gl_program_binary_cache
+    {
+      public:
+        //! \brief Constructs the \a gl_program_binary_cache.
+        //! \details Requires a current opengl context. The cache is disabled if the driver does not support any binary formats.
+        //! \param[in] directory The directory to store the binaries in.
+        gl_program_binary_cache(const string& directory);
+        ~gl_program_binary_cache();
+
+        //! \brief Loads a shader program from the cache.
+        //! \param[in] key The key of the shader program. Should be created with create_key().
+        //! \return The \a gl_handle of the loaded shader program or 0 if there is no valid binary.
+        gl_handle load(uint64 key);
+
+        //! \brief Stores a linked shader program in the cache.
+        //! \param[in] key The key of the shader program. Should be created with create_key().
+        //! \param[in] program The \a gl_handle of the linked shader program.
+        void store(uint64 key, gl_handle program);
+
+        //! \brief Creates the key for a shader program.
+        //! \param[in] stage_count The number of shader stages.
+        //! \param[in] stage_types The \a gfx_shader_stage_types of the shader stages.
+        //! \param[in] source_hashes The hashes of the preprocessed sources of the shader stages.
+        //! \return The key including the driver.
+        uint64 create_key(int32 stage_count, const gfx_shader_stage_type* stage_types, const uint64* source_hashes) const;
+
+        //! \brief Checks if the \a gl_program_binary_cache is usable.
+        //! \return True if the driver supports program binaries, else false.
+        inline bool is_enabled() const
+        {
+            return m_enabled;
+        }
+
+      private:
+        //! \brief Header in front of each stored program binary.
+        struct binary_header
+        {
+            uint32 magic;       //!< Identifies the file as program binary.
+            uint32 version;     //!< The version of the file layout.
+            uint64 driver_hash; //!< Hash of vendor, renderer and version strings of the driver.
+            uint64 key;         //!< The key of the shader program.
+            uint32 format;      //!< The binary format returned by the driver.
+            uint32 length;      //!< The size of the binary following the header in bytes.
+        };
+
+        //! \brief Returns the file path for a key.
+        //! \param[in] key The key of the shader program.
+        //! \return The path of the binary file.
+        string file_path(uint64 key) const;
+
+        //! \brief The directory to store the binaries in.
+        string m_directory;
+        //! \brief Hash of vendor, renderer and version strings of the driver.
+        uint64 m_driver_hash;
+        //! \brief True if the driver supports program binaries, else false.
+        bool m_enabled;
+    };
+} // namespace mango
+
+#endif // MANGO_GL_PROGRAM_BINARY_CACHE_HPP
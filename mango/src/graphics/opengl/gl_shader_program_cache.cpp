@@ -6,9 +6,18 @@
 
 #include <graphics/opengl/gl_shader_program_cache.hpp>
 
+#ifndef GL_COMPLETION_STATUS_KHR
+//! \brief Query for the non blocking completion status of KHR_parallel_shader_compile and ARB_parallel_shader_compile.
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif // GL_COMPLETION_STATUS_KHR
+
 using namespace mango;
 
-gl_shader_program_cache::gl_shader_program_cache() {}
+gl_shader_program_cache::gl_shader_program_cache(bool parallel_compile, const string& binary_directory)
+    : m_binary_cache(binary_directory)
+    , m_parallel_compile(parallel_compile)
+{
+}
 
 gl_shader_program_cache::~gl_shader_program_cache()
 {
@@ -17,15 +26,52 @@ gl_shader_program_cache::~gl_shader_program_cache()
         glDeleteProgram(sp_handle.second);
     }
     cache.clear();
+    for (auto pending : m_pending)
+    {
+        glDeleteProgram(pending.second.program);
+    }
+    m_pending.clear();
 }
 
 gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stage_descriptor& desc)
 {
     shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    build_key(desc, key, stages);
+
+    return get(key, stages);
+}
+
+gl_handle gl_shader_program_cache::get_shader_program(const compute_shader_stage_descriptor& desc)
+{
+    shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    build_key(desc, key, stages);
+
+    return get(key, stages);
+}
+
+bool gl_shader_program_cache::is_shader_program_ready(const graphics_shader_stage_descriptor& desc)
+{
+    shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    build_key(desc, key, stages);
+
+    return is_ready(key, stages);
+}
+
+bool gl_shader_program_cache::is_shader_program_ready(const compute_shader_stage_descriptor& desc)
+{
+    shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    build_key(desc, key, stages);
 
+    return is_ready(key, stages);
+}
+
+void gl_shader_program_cache::build_key(const graphics_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
+{
     key.stage_count = 0;
-    gl_handle handles[3];
-    handles[0] = handles[1] = handles[2] = 0;
 
     if (desc.vertex_shader_stage)
     {
@@ -33,9 +79,8 @@ gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stag
         auto vertex_shader                     = static_gfx_handle_cast<const gl_shader_stage>(desc.vertex_shader_stage);
         key.shader_stage_uids[key.stage_count] = vertex_shader->get_uid();
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_vertex;
+        stages[key.stage_count]                = vertex_shader;
         key.stage_count++;
-
-        handles[0] = vertex_shader->m_shader_stage_gl_handle;
     }
 
     if (desc.geometry_shader_stage)
@@ -44,9 +89,8 @@ gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stag
         auto geometry_shader                   = static_gfx_handle_cast<const gl_shader_stage>(desc.geometry_shader_stage);
         key.shader_stage_uids[key.stage_count] = geometry_shader->get_uid();
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_geometry;
+        stages[key.stage_count]                = geometry_shader;
         key.stage_count++;
-
-        handles[1] = geometry_shader->m_shader_stage_gl_handle;
     }
 
     if (desc.fragment_shader_stage)
@@ -55,33 +99,18 @@ gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stag
         auto fragment_shader                   = static_gfx_handle_cast<const gl_shader_stage>(desc.fragment_shader_stage);
         key.shader_stage_uids[key.stage_count] = fragment_shader->get_uid();
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_fragment;
+        stages[key.stage_count]                = fragment_shader;
         key.stage_count++;
-
-        handles[2] = fragment_shader->m_shader_stage_gl_handle;
     }
 
     // TODO Paul: Check these!
     MANGO_ASSERT(desc.vertex_shader_stage || desc.geometry_shader_stage, "Vertex or Geometry shader has to exist in a graphics pipeline!");
     MANGO_ASSERT(desc.fragment_shader_stage, "Fragment shader has to exist in a graphics pipeline!");
-
-    auto result = cache.find(key);
-
-    if (result != cache.end())
-        return result->second;
-
-    gl_handle created = create(key.stage_count, handles);
-
-    cache.insert({ key, created });
-
-    return created;
 }
 
-gl_handle gl_shader_program_cache::get_shader_program(const compute_shader_stage_descriptor& desc)
+void gl_shader_program_cache::build_key(const compute_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
 {
-    shader_program_key key;
-
     key.stage_count = 0;
-    gl_handle handle;
 
     if (desc.compute_shader_stage)
     {
@@ -89,45 +118,113 @@ gl_handle gl_shader_program_cache::get_shader_program(const compute_shader_stage
         auto compute_shader                    = static_gfx_handle_cast<const gl_shader_stage>(desc.compute_shader_stage);
         key.shader_stage_uids[key.stage_count] = compute_shader->get_uid();
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_compute;
+        stages[key.stage_count]                = compute_shader;
         key.stage_count++;
-
-        handle = compute_shader->m_shader_stage_gl_handle;
     }
 
     MANGO_ASSERT(desc.compute_shader_stage, "Compute pipeline needs a compute shader stage!");
+}
 
+gl_handle gl_shader_program_cache::get(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
+{
     auto result = cache.find(key);
 
     if (result != cache.end())
         return result->second;
 
-    gl_handle created = create(key.stage_count, &handle);
+    gl_handle created;
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end())
+    {
+        created = finish_create(pending->second);
+        m_pending.erase(pending);
+    }
+    else
+        created = finish_create(begin_create(key, stages));
 
     cache.insert({ key, created });
 
     return created;
 }
 
-gl_handle gl_shader_program_cache::create(int32 stage_count, gl_handle handles[max_shader_stages])
+bool gl_shader_program_cache::is_ready(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
 {
-    gl_handle program = glCreateProgram();
+    if (cache.find(key) != cache.end())
+        return true;
 
-    int32 limit = stage_count;
+    auto pending = m_pending.find(key);
+    if (pending == m_pending.end())
+        pending = m_pending.insert({ key, begin_create(key, stages) }).first;
 
-    for (int32 i = 0; i < limit; ++i)
+    if (m_parallel_compile && !pending->second.loaded)
     {
-        if (handles[i] > 0)
-            glAttachShader(program, handles[i]);
-        else
-            limit++;
+        int32 completed = GL_FALSE;
+        glGetProgramiv(pending->second.program, GL_COMPLETION_STATUS_KHR, &completed);
+        if (GL_FALSE == completed)
+            return false;
     }
 
-    glLinkProgram(program);
+    // Failed programs are cached as well (as 0), so that they are not retried each frame.
+    cache.insert({ key, finish_create(pending->second) });
+    m_pending.erase(pending);
+
+    return true;
+}
+
+gl_shader_program_cache::pending_program gl_shader_program_cache::begin_create(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
+{
+    pending_program pending;
+    pending.loaded = false;
+
+    uint64 source_hashes[max_shader_stages];
+    for (int32 i = 0; i < key.stage_count; ++i)
+        source_hashes[i] = stages[i]->m_source_hash;
+
+    pending.binary_key = m_binary_cache.create_key(key.stage_count, key.stage_types, source_hashes);
+
+    pending.program = m_binary_cache.load(pending.binary_key);
+    if (pending.program)
+    {
+        pending.loaded = true;
+        return pending;
+    }
+
+    pending.program = glCreateProgram();
+
+    // The stages are kept alive until the link status got queried.
+    for (int32 i = 0; i < key.stage_count; ++i)
+    {
+        gl_handle handle = stages[i]->get_compiled_handle();
+        if (handle > 0)
+            glAttachShader(pending.program, handle);
+        pending.stages[i] = stages[i];
+    }
+
+    if (m_binary_cache.is_enabled())
+        glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    glLinkProgram(pending.program);
+
+    return pending;
+}
+
+gl_handle gl_shader_program_cache::finish_create(const pending_program& pending)
+{
+    if (pending.loaded)
+        return pending.program;
+
+    gl_handle program = pending.program;
 
     int32 status = 0;
     glGetProgramiv(program, GL_LINK_STATUS, &status);
     if (GL_FALSE == status)
     {
+        for (int32 i = 0; i < max_shader_stages; ++i)
+        {
+            if (pending.stages[i])
+                pending.stages[i]->check_compile_status();
+        }
+
         int32 log_length = 0;
         glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
         std::vector<char> info_log(log_length);
@@ -139,5 +236,7 @@ gl_handle gl_shader_program_cache::create(int32 stage_count, gl_handle handles[m
         return 0;
     }
 
+    m_binary_cache.store(pending.binary_key, program);
+
     return program;
 }
@@ -7,15 +7,21 @@
 #ifndef MANGO_GL_SHADER_PROGRAM_CACHE_HPP
 #define MANGO_GL_SHADER_PROGRAM_CACHE_HPP
 
-#include <graphics/opengl/gl_graphics_resources.hpp>
+#include <graphics/opengl/gl_program_binary_cache.hpp>
 
 namespace mango
 {
     //! \brief Cache for opengl shader programs used internally.
+    //! \details Linked programs are additionally stored in a \a gl_program_binary_cache on disk, so that later runs do not have to compile and link again.
+    //! Programs can be requested without blocking, the driver then compiles and links them in the background if it supports parallel shader compilation.
     class gl_shader_program_cache
     {
       public:
-        gl_shader_program_cache();
+        //! \brief Constructs the \a gl_shader_program_cache.
+        //! \details Requires a current opengl context.
+        //! \param[in] parallel_compile True if the driver supports KHR_parallel_shader_compile or ARB_parallel_shader_compile, else false.
+        //! \param[in] binary_directory The directory to store program binaries in.
+        gl_shader_program_cache(bool parallel_compile, const string& binary_directory = "cache/programs/");
         ~gl_shader_program_cache();
 
         //! \brief Returns the \a gl_handle of a specific gl shader program for a given \a graphics_shader_stage_descriptor.
@@ -30,6 +36,20 @@ namespace mango
         //! \return The \a gl_handle of a specific gl shader program for a given \a compute_shader_stage_descriptor.
         gl_handle get_shader_program(const compute_shader_stage_descriptor& desc);
 
+        //! \brief Checks without blocking if the gl shader program for a given \a graphics_shader_stage_descriptor is ready to use.
+        //! \details Starts compiling and linking the program if that did not happen yet.
+        //! Without parallel shader compilation support this compiles and links the program immediately.
+        //! \param[in] desc The \a graphics_shader_stage_descriptor of the shader program.
+        //! \return True if the shader program is linked, else false.
+        bool is_shader_program_ready(const graphics_shader_stage_descriptor& desc);
+
+        //! \brief Checks without blocking if the gl shader program for a given \a compute_shader_stage_descriptor is ready to use.
+        //! \details Starts compiling and linking the program if that did not happen yet.
+        //! Without parallel shader compilation support this compiles and links the program immediately.
+        //! \param[in] desc The \a compute_shader_stage_descriptor of the shader program.
+        //! \return True if the shader program is linked, else false.
+        bool is_shader_program_ready(const compute_shader_stage_descriptor& desc);
+
         // TODO Paul: Invalidate?
       private:
         //! \brief The maximum number of shader stages.
@@ -89,11 +109,64 @@ namespace mango
             };
         };
 
-        //! \brief Creates a shader program and returns th handle from opengl.
-        //! \param[in] stage_count The number of active stages.
-        //! \param[in] handles The \a gl_handles of the shaders.
-        //! \return The \a gl_handle of the created opengl framebuffer.
-        gl_handle create(int32 stage_count, gl_handle handles[max_shader_stages]);
+        //! \brief A shader program that is compiled and linked in the background.
+        struct pending_program
+        {
+            //! \brief The \a gl_handle of the opengl shader program.
+            gl_handle program;
+            //! \brief The key of the program in the \a gl_program_binary_cache.
+            uint64 binary_key;
+            //! \brief True if the program got loaded from the \a gl_program_binary_cache and is already linked, else false.
+            bool loaded;
+            //! \brief The \a gl_shader_stages linked to the program. Kept alive until the link finished.
+            gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+        };
+
+        //! \brief Fills the \a shader_program_key and the list of \a gl_shader_stages for a given \a graphics_shader_stage_descriptor.
+        //! \param[in] desc The \a graphics_shader_stage_descriptor.
+        //! \param[out] key The \a shader_program_key to fill.
+        //! \param[out] stages The \a gl_shader_stages in the order of the key.
+        void build_key(const graphics_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Fills the \a shader_program_key and the list of \a gl_shader_stages for a given \a compute_shader_stage_descriptor.
+        //! \param[in] desc The \a compute_shader_stage_descriptor.
+        //! \param[out] key The \a shader_program_key to fill.
+        //! \param[out] stages The \a gl_shader_stages in the order of the key.
+        void build_key(const compute_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Returns the \a gl_handle of the shader program for a \a shader_program_key and blocks until it is linked.
+        //! \param[in] key The \a shader_program_key of the program.
+        //! \param[in] stages The \a gl_shader_stages in the order of the key.
+        //! \return The \a gl_handle of the shader program or 0 on failure.
+        gl_handle get(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Checks without blocking if the shader program for a \a shader_program_key is ready to use and starts its creation if required.
+        //! \param[in] key The \a shader_program_key of the program.
+        //! \param[in] stages The \a gl_shader_stages in the order of the key.
+        //! \return True if the shader program is linked, else false.
+        bool is_ready(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Starts the creation of a shader program.
+        //! \details Loads the program from the \a gl_program_binary_cache if possible, else starts compiling the stages and links them.
+        //! \param[in] key The \a shader_program_key of the program.
+        //! \param[in] stages The \a gl_shader_stages in the order of the key.
+        //! \return The \a pending_program.
+        pending_program begin_create(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Finishes the creation of a shader program.
+        //! \details Checks the link status, which blocks if the driver did not finish yet, and stores the binary.
+        //! \param[in] pending The \a pending_program to finish.
+        //! \return The \a gl_handle of the linked opengl shader program or 0 on failure.
+        gl_handle finish_create(const pending_program& pending);
+
+        //! \brief The cache storing linked program binaries on disk.
+        gl_program_binary_cache m_binary_cache;
+
+        //! \brief True if the driver compiles and links in the background, else false.
+        bool m_parallel_compile;
+
+        //! \brief The shader programs that are compiled and linked in the background.
+        std::unordered_map<shader_program_key, pending_program, shader_program_key_hash> m_pending;
 
         //! \brief The cache mapping \a shader_program_keys to \a gl_handles of opengl shader programs.
         std::unordered_map<shader_program_key, gl_handle, shader_program_key_hash> cache;
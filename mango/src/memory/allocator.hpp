@@ -11,6 +11,19 @@
 
 namespace mango
 {
+    //! \brief Statistics describing the state of an \a allocator.
+    struct allocator_statistics
+    {
+        int64 total_size;          //!< Total size of memory managed by the \a allocator in bytes.
+        int64 committed_size;      //!< Size of the memory backed by the system in bytes. Smaller than total_size if the \a allocator commits lazily.
+        int64 used_size;           //!< Size of the memory currently handed out in bytes (without internal headers).
+        int64 free_size;           //!< Size of the memory that is still available in bytes.
+        int64 largest_free_block;  //!< Size of the largest block that could be allocated at once in bytes.
+        int64 free_block_count;    //!< Number of free blocks.
+        int64 allocation_count;    //!< Number of live allocations.
+        float fragmentation;       //!< Fragmentation in [0, 1]. Calculated as 1 - largest_free_block / free_size.
+    };
+
     //! \brief Base class for memory managing classes.
     class allocator
     {
@@ -24,7 +37,7 @@ namespace mango
         {
         }
 
-        ~allocator()
+        virtual ~allocator()
         {
             m_total_size = 0;
             free(m_start);
@@ -55,6 +68,8 @@ namespace mango
         virtual void* allocate(const int64 size)
         {
             int64 unaligned_address = allocate_unaligned(size);
+            if (unaligned_address < 0)
+                return nullptr;
             return reinterpret_cast<void*>(unaligned_address);
         }
 
@@ -107,6 +122,10 @@ namespace mango
             free_memory_unaligned(reinterpret_cast<void*>(unaligned_address));
         }
 
+        //! \brief Retrieves the current \a allocator_statistics.
+        //! \return The current \a allocator_statistics.
+        virtual allocator_statistics get_statistics() const = 0;
+
       protected:
         //! \brief Total size of memory managed by the \a allocator in bytes.
         int64 m_total_size;
@@ -0,0 +1,42 @@
+//! \file      allocator_factory.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_ALLOCATOR_FACTORY_HPP
+#define MANGO_ALLOCATOR_FACTORY_HPP
+
+#include <memory/free_list_allocator.hpp>
+#include <memory/tlsf_allocator.hpp>
+
+namespace mango
+{
+    //! \brief The strategies available for general purpose allocators.
+    enum class allocator_strategy : uint8
+    {
+        first_fit_free_list,     //!< The \a free_list_allocator. Linear search on allocation and free.
+        two_level_segregated_fit //!< The \a tlsf_allocator. O(1) allocation and free.
+    };
+
+    //! \brief Creates an \a allocator with a specific strategy.
+    //! \details Does not initialize the allocator. To use the allocator init() has to be called.
+    //! \param[in] strategy The \a allocator_strategy to use.
+    //! \param[in] size The size of the memory to manage.
+    //! \return A unique pointer to the created \a allocator.
+    inline unique_ptr<allocator> create_allocator(allocator_strategy strategy, const int64 size)
+    {
+        switch (strategy)
+        {
+        case allocator_strategy::first_fit_free_list:
+            return mango::make_unique<free_list_allocator>(size);
+        case allocator_strategy::two_level_segregated_fit:
+            return mango::make_unique<tlsf_allocator>(size);
+        default:
+            MANGO_ASSERT(false, "Unknown allocator strategy!");
+            return nullptr;
+        }
+    }
+} // namespace mango
+
+#endif // MANGO_ALLOCATOR_FACTORY_HPP
@@ -11,6 +11,9 @@ using namespace mango;
 
 free_list_allocator::free_list_allocator(const int64 size)
     : allocator(size)
+    , m_head(nullptr)
+    , m_used_size(0)
+    , m_allocation_count(0)
 {
 }
 
@@ -28,6 +31,8 @@ int64 free_list_allocator::allocate_unaligned(const int64 size)
         MANGO_LOG_ERROR("Free List Allocator Out Of Memory!");
         return -1;
     }
+    m_used_size += fitting_block->size;
+    m_allocation_count++;
     return reinterpret_cast<int64>(fitting_block->data);
 }
 
@@ -37,6 +42,10 @@ void free_list_allocator::free_memory_unaligned(void* mem)
     free_list_memory_block* last       = nullptr;
     free_list_memory_block* next       = m_head;
     int64 free_pos                     = reinterpret_cast<int64>(free_block);
+
+    m_used_size -= free_block->size;
+    m_allocation_count--;
+
     while (next && reinterpret_cast<int64>(next) < free_pos)
     {
         last = next;
@@ -58,7 +67,32 @@ void free_list_allocator::free_memory_unaligned(void* mem)
 
 void free_list_allocator::reset()
 {
-    m_head = create_start_block();
+    m_head             = create_start_block();
+    m_used_size        = 0;
+    m_allocation_count = 0;
+}
+
+allocator_statistics free_list_allocator::get_statistics() const
+{
+    allocator_statistics stats;
+    stats.total_size         = m_total_size;
+    stats.committed_size     = m_total_size;
+    stats.used_size          = m_used_size;
+    stats.free_size          = 0;
+    stats.largest_free_block = 0;
+    stats.free_block_count   = 0;
+    stats.allocation_count   = m_allocation_count;
+
+    // The free list is not indexed, so this has to walk all free blocks.
+    for (free_list_memory_block* block = m_head; block; block = block->next)
+    {
+        stats.free_size += block->size;
+        stats.largest_free_block = std::max(stats.largest_free_block, block->size);
+        stats.free_block_count++;
+    }
+
+    stats.fragmentation = stats.free_size > 0 ? 1.0f - static_cast<float>(stats.largest_free_block) / static_cast<float>(stats.free_size) : 0.0f;
+    return stats;
 }
 
 free_list_memory_block* free_list_allocator::create_start_block()
@@ -73,6 +107,8 @@ free_list_memory_block* free_list_allocator::first_fit(int64 size)
 {
     free_list_memory_block* current = m_head;
     free_list_memory_block* last    = nullptr;
+    if (!current)
+        return nullptr;
     while (current->size < size)
     {
         last    = current;
@@ -103,7 +139,7 @@ void free_list_allocator::split(int64 wanted, int64 got, free_list_memory_block*
 {
     int64 occupied                    = sizeof(free_list_memory_block) + (wanted - sizeof(free_list_memory_block::data));
     free_list_memory_block* new_block = reinterpret_cast<free_list_memory_block*>(reinterpret_cast<int64>(current) + occupied);
-    new_block->size                   = got - (occupied + sizeof(free_list_memory_block)) + sizeof(free_list_memory_block::data);
+    new_block->size                   = got - occupied;
     current->size                     = wanted;
 
     if (last)
@@ -127,7 +163,9 @@ void free_list_allocator::coalesce(free_list_memory_block* last, free_list_memor
         {
             last->size += sizeof(free_list_memory_block) - sizeof(free_list_memory_block::data) + current->size;
             last->next  = next;
-            current     = nullptr;
+            // continue with the merged block, so that next can be merged as well.
+            current     = last;
+            current_pos = last_pos;
         }
     }
     if (next)
@@ -30,10 +30,15 @@ namespace mango
         ~free_list_allocator();
 
         void reset() override;
+        allocator_statistics get_statistics() const override;
 
       private:
         //! \brief Pointer to the head of the internal linked list.
         free_list_memory_block* m_head;
+        //! \brief The size of all blocks currently handed out in bytes.
+        int64 m_used_size;
+        //! \brief The number of live allocations.
+        int64 m_allocation_count;
 
         virtual int64 allocate_unaligned(const int64 size) override;
         void free_memory_unaligned(void* mem) override;
@@ -11,6 +11,7 @@ using namespace mango;
 
 linear_allocator::linear_allocator(const int64 size)
     : allocator(size)
+    , m_offset(0)
 {
 }
 
@@ -44,3 +45,17 @@ void linear_allocator::reset()
 {
     m_offset = 0;
 }
+
+allocator_statistics linear_allocator::get_statistics() const
+{
+    allocator_statistics stats;
+    stats.total_size         = m_total_size;
+    stats.committed_size     = m_total_size;
+    stats.used_size          = m_offset;
+    stats.free_size          = m_total_size - m_offset;
+    stats.largest_free_block = stats.free_size;
+    stats.free_block_count   = stats.free_size > 0 ? 1 : 0;
+    stats.allocation_count   = 0; // Not tracked, memory is only released by reset().
+    stats.fragmentation      = 0.0f;
+    return stats;
+}
@@ -23,6 +23,7 @@ namespace mango
         ~linear_allocator();
 
         void reset() override;
+        allocator_statistics get_statistics() const override;
 
       private:
         //! \brief The current offset from the memory start.
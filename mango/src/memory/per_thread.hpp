@@ -0,0 +1,93 @@
+//! \file      per_thread.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_PER_THREAD_HPP
+#define MANGO_PER_THREAD_HPP
+
+#include <atomic>
+#include <mango/types.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Creates a unique id for a \a per_thread instance.
+    //! \details Ids are never reused, so stale thread local entries of destroyed instances are never accessed.
+    //! \return The unique id.
+    inline uint64 next_per_thread_id()
+    {
+        static std::atomic<uint64> id(1);
+        return id++;
+    }
+
+    //! \brief Holds one instance of \a T for each thread accessing it.
+    //! \details The instances are owned by the \a per_thread object and destroyed with it, not when the thread exits.
+    //! Looking up the instance of the current thread does not lock, creating it does.
+    template <typename T>
+    class per_thread
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(per_thread)
+      public:
+        //! \brief Constructs the \a per_thread.
+        //! \param[in] create The function used to create the instance for a thread.
+        per_thread(std::function<unique_ptr<T>()> create)
+            : m_id(next_per_thread_id())
+            , m_create(create)
+        {
+        }
+
+        //! \brief Retrieves the instance of the calling thread. Creates it on first access.
+        //! \return A reference to the instance of the calling thread.
+        T& local()
+        {
+            static thread_local uint64 last_id = 0;
+            static thread_local T* last        = nullptr;
+            if (last_id == m_id)
+                return *last;
+
+            static thread_local std::unordered_map<uint64, T*> instances;
+            auto it = instances.find(m_id);
+            if (it == instances.end())
+            {
+                unique_ptr<T> instance = m_create();
+                T* ptr                 = instance.get();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_instances.push_back(std::move(instance));
+                }
+                it = instances.insert({ m_id, ptr }).first;
+            }
+
+            last_id = m_id;
+            last    = it->second;
+            return *last;
+        }
+
+        //! \brief Calls a function for the instances of all threads.
+        //! \details The instances could be used by their threads at the same time, synchronization is up to the caller.
+        //! \param[in] function The function to call.
+        void for_each(const std::function<void(T&)>& function)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& instance : m_instances)
+                function(*instance);
+        }
+
+      private:
+        //! \brief The unique id of the \a per_thread.
+        const uint64 m_id;
+        //! \brief The function used to create the instance for a thread.
+        std::function<unique_ptr<T>()> m_create;
+        //! \brief Mutex protecting the list of instances.
+        std::mutex m_mutex;
+        //! \brief The instances of all threads.
+        std::vector<unique_ptr<T>> m_instances;
+    };
+} // namespace mango
+
+#endif // MANGO_PER_THREAD_HPP
@@ -0,0 +1,68 @@
+//! \file      thread_linear_allocator.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <mango/assert.hpp>
+#include <memory/thread_linear_allocator.hpp>
+
+using namespace mango;
+
+thread_linear_allocator::thread_linear_allocator(const int64 size)
+    : allocator(size)
+    , m_arenas([size]() {
+        unique_ptr<linear_allocator> arena = mango::make_unique<linear_allocator>(size);
+        arena->init();
+        return arena;
+    })
+{
+}
+
+thread_linear_allocator::~thread_linear_allocator() {}
+
+void thread_linear_allocator::init()
+{
+    reset();
+}
+
+void thread_linear_allocator::reset()
+{
+    m_arenas.for_each([](linear_allocator& arena) { arena.reset(); });
+}
+
+allocator_statistics thread_linear_allocator::get_statistics() const
+{
+    allocator_statistics stats;
+    stats.total_size         = 0;
+    stats.committed_size     = 0;
+    stats.used_size          = 0;
+    stats.free_size          = 0;
+    stats.largest_free_block = 0;
+    stats.free_block_count   = 0;
+    stats.allocation_count   = 0; // Not tracked, memory is only released by reset().
+    stats.fragmentation      = 0.0f;
+
+    m_arenas.for_each([&stats](linear_allocator& arena) {
+        allocator_statistics arena_stats = arena.get_statistics();
+        stats.total_size += arena_stats.total_size;
+        stats.committed_size += arena_stats.committed_size;
+        stats.used_size += arena_stats.used_size;
+        stats.free_size += arena_stats.free_size;
+        stats.largest_free_block = std::max(stats.largest_free_block, arena_stats.largest_free_block);
+        stats.free_block_count += arena_stats.free_block_count;
+    });
+
+    return stats;
+}
+
+int64 thread_linear_allocator::allocate_unaligned(const int64 size)
+{
+    void* mem = m_arenas.local().allocate(size);
+    return mem ? reinterpret_cast<int64>(mem) : -1;
+}
+
+void thread_linear_allocator::free_memory_unaligned(void*)
+{
+    MANGO_ASSERT(false, "Thread Linear Allocator can not free single blocks, use reset() instead!");
+}
@@ -0,0 +1,42 @@
+//! \file      thread_linear_allocator.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_THREAD_LINEAR_ALLOCATOR_HPP
+#define MANGO_THREAD_LINEAR_ALLOCATOR_HPP
+
+#include <memory/linear_allocator.hpp>
+#include <memory/per_thread.hpp>
+
+namespace mango
+{
+    //! \brief A linear allocator with one arena per thread.
+    //! \details Used for transient data, allocation never locks. Each thread gets its own \a linear_allocator of the given size on first use.
+    //! Freeing memory is not possible without reseting the allocator.
+    class thread_linear_allocator : public allocator
+    {
+      public:
+        //! \brief Constructs the \a thread_linear_allocator.
+        //! \details Does not allocate any memory. The arena of a thread is allocated on its first allocation.
+        //! \param[in] size The size of the arena of each thread.
+        thread_linear_allocator(const int64 size);
+        ~thread_linear_allocator();
+
+        void init() override;
+        //! \brief Resets the arenas of all threads. All memory allocated is invalid after that.
+        //! \details No other thread is allowed to use the \a thread_linear_allocator while resetting.
+        void reset() override;
+        allocator_statistics get_statistics() const override;
+
+      private:
+        //! \brief The arenas of all threads.
+        mutable per_thread<linear_allocator> m_arenas;
+
+        virtual int64 allocate_unaligned(const int64 size) override;
+        void free_memory_unaligned(void* mem) override;
+    };
+} // namespace mango
+
+#endif // MANGO_THREAD_LINEAR_ALLOCATOR_HPP
@@ -0,0 +1,169 @@
+//! \file      thread_safe_allocator.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <mango/assert.hpp>
+#include <memory/thread_safe_allocator.hpp>
+
+using namespace mango;
+
+//! \cond NO_COND
+const int32 thread_safe_allocator::size_class_count;
+const int64 thread_safe_allocator::min_size_class;
+const int32 thread_safe_allocator::magazine_capacity;
+const int64 thread_safe_allocator::block_header_size;
+//! \endcond
+
+thread_safe_allocator::thread_safe_allocator(allocator_strategy strategy, const int64 size)
+    : allocator(size)
+    , m_shared(create_allocator(strategy, size))
+    , m_exit_link(std::make_shared<thread_exit_link>())
+    , m_caches([this]() {
+        unique_ptr<thread_cache> cache = mango::make_unique<thread_cache>();
+        memset(cache->count, 0, sizeof(cache->count));
+
+        // Created on the thread the cache belongs to, so the cache is registered for the exit of that thread.
+        static thread_local thread_exit_flusher flusher;
+        flusher.caches.push_back({ m_exit_link, cache.get() });
+        return cache;
+    })
+    , m_allocation_count(0)
+{
+    m_exit_link->owner = this;
+}
+
+thread_safe_allocator::~thread_safe_allocator()
+{
+    // Exiting threads must not flush into the destroyed allocator.
+    std::lock_guard<std::mutex> lock(m_exit_link->mutex);
+    m_exit_link->owner = nullptr;
+}
+
+thread_safe_allocator::thread_exit_flusher::~thread_exit_flusher()
+{
+    for (auto& entry : caches)
+    {
+        std::lock_guard<std::mutex> lock(entry.first->mutex);
+        if (entry.first->owner)
+            entry.first->owner->flush_all(*entry.second);
+    }
+}
+
+void thread_safe_allocator::init()
+{
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    m_caches.for_each([](thread_cache& cache) { memset(cache.count, 0, sizeof(cache.count)); });
+    m_shared->init();
+    m_allocation_count = 0;
+}
+
+void thread_safe_allocator::reset()
+{
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    m_caches.for_each([](thread_cache& cache) { memset(cache.count, 0, sizeof(cache.count)); });
+    m_shared->reset();
+    m_allocation_count = 0;
+}
+
+allocator_statistics thread_safe_allocator::get_statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    allocator_statistics stats = m_shared->get_statistics();
+    stats.allocation_count     = m_allocation_count;
+    return stats;
+}
+
+int64 thread_safe_allocator::allocate_unaligned(const int64 size)
+{
+    int64 block_size = size + block_header_size;
+    int32 sc         = size_class(block_size);
+    uint8* block     = nullptr;
+
+    if (sc < 0)
+    {
+        std::lock_guard<std::mutex> lock(m_shared_mutex);
+        block = static_cast<uint8*>(m_shared->allocate(block_size));
+    }
+    else
+    {
+        thread_cache& cache = m_caches.local();
+        if (cache.count[sc] == 0)
+            refill(cache, sc);
+        if (cache.count[sc] > 0)
+            block = static_cast<uint8*>(cache.blocks[sc][--cache.count[sc]]);
+    }
+
+    if (!block)
+        return -1;
+
+    *reinterpret_cast<int64*>(block) = sc;
+    m_allocation_count++;
+    return reinterpret_cast<int64>(block + block_header_size);
+}
+
+void thread_safe_allocator::free_memory_unaligned(void* mem)
+{
+    if (!mem)
+        return;
+
+    uint8* block = static_cast<uint8*>(mem) - block_header_size;
+    int32 sc     = static_cast<int32>(*reinterpret_cast<int64*>(block));
+    m_allocation_count--;
+
+    if (sc < 0)
+    {
+        std::lock_guard<std::mutex> lock(m_shared_mutex);
+        m_shared->free_memory(block);
+        return;
+    }
+
+    MANGO_ASSERT(sc < size_class_count, "Block header is corrupted!");
+    thread_cache& cache = m_caches.local();
+    if (cache.count[sc] == magazine_capacity)
+        flush(cache, sc);
+    cache.blocks[sc][cache.count[sc]++] = block;
+}
+
+int32 thread_safe_allocator::size_class(int64 size) const
+{
+    int64 class_size = min_size_class;
+    for (int32 sc = 0; sc < size_class_count; ++sc, class_size <<= 1)
+    {
+        if (size <= class_size)
+            return sc;
+    }
+    return -1;
+}
+
+void thread_safe_allocator::refill(thread_cache& cache, int32 size_class)
+{
+    int64 class_size = min_size_class << size_class;
+
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    while (cache.count[size_class] < magazine_capacity / 2)
+    {
+        void* block = m_shared->allocate(class_size);
+        if (!block)
+            break;
+        cache.blocks[size_class][cache.count[size_class]++] = block;
+    }
+}
+
+void thread_safe_allocator::flush(thread_cache& cache, int32 size_class)
+{
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    while (cache.count[size_class] > magazine_capacity / 2)
+        m_shared->free_memory(cache.blocks[size_class][--cache.count[size_class]]);
+}
+
+void thread_safe_allocator::flush_all(thread_cache& cache)
+{
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    for (int32 sc = 0; sc < size_class_count; ++sc)
+    {
+        while (cache.count[sc] > 0)
+            m_shared->free_memory(cache.blocks[sc][--cache.count[sc]]);
+    }
+}
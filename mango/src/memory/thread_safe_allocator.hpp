@@ -0,0 +1,101 @@
+//! \file      thread_safe_allocator.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_THREAD_SAFE_ALLOCATOR_HPP
+#define MANGO_THREAD_SAFE_ALLOCATOR_HPP
+
+#include <memory/allocator_factory.hpp>
+#include <memory/per_thread.hpp>
+
+namespace mango
+{
+    //! \brief A thread safe allocator in front of a shared general purpose \a allocator.
+    //! \details Small allocations are served from per thread magazines without locking. Magazines are refilled and flushed in batches from the shared \a allocator.
+    //! Large allocations lock the shared \a allocator directly.
+    //! Blocks cached in magazines count as used in the statistics of the shared \a allocator. The magazines of a thread are returned when the thread exits.
+    class thread_safe_allocator : public allocator
+    {
+      public:
+        //! \brief Constructs the \a thread_safe_allocator.
+        //! \details Does not allocate any memory. To use the allocator init() has to be called.
+        //! \param[in] strategy The \a allocator_strategy of the shared \a allocator.
+        //! \param[in] size The size of the memory to manage.
+        thread_safe_allocator(allocator_strategy strategy, const int64 size);
+        ~thread_safe_allocator();
+
+        void init() override;
+        //! \brief Resets the \a thread_safe_allocator. All memory allocated is invalid after that.
+        //! \details No other thread is allowed to use the \a thread_safe_allocator while resetting.
+        void reset() override;
+        allocator_statistics get_statistics() const override;
+
+        //! \brief The number of size classes served by magazines.
+        static const int32 size_class_count = 8;
+        //! \brief The smallest size class in bytes. Each further class doubles the size.
+        static const int64 min_size_class = 32;
+        //! \brief The maximum number of blocks cached per size class and thread.
+        static const int32 magazine_capacity = 64;
+        //! \brief The size of the header in front of each block. Stores the size class and keeps the alignment.
+        static const int64 block_header_size = 16;
+
+      private:
+        //! \brief The magazines of one thread.
+        struct thread_cache
+        {
+            void* blocks[size_class_count][magazine_capacity]; //!< The cached blocks per size class.
+            int32 count[size_class_count];                    //!< The number of cached blocks per size class.
+        };
+
+        //! \brief Connects the threads using a \a thread_safe_allocator with it. Cleared when the allocator is destroyed.
+        struct thread_exit_link
+        {
+            std::mutex mutex;             //!< Mutex protecting the owner.
+            thread_safe_allocator* owner; //!< The \a thread_safe_allocator or nullptr after its destruction.
+        };
+
+        //! \brief Thread local owner returning the magazines of the thread to their allocators when the thread exits.
+        struct thread_exit_flusher
+        {
+            ~thread_exit_flusher();
+            std::vector<std::pair<shared_ptr<thread_exit_link>, thread_cache*>> caches; //!< The \a thread_caches of the thread and the links to their allocators.
+        };
+
+        //! \brief The shared \a allocator.
+        unique_ptr<allocator> m_shared;
+        //! \brief Mutex protecting the shared \a allocator.
+        mutable std::mutex m_shared_mutex;
+        //! \brief The link to this allocator held by all threads using it.
+        shared_ptr<thread_exit_link> m_exit_link;
+        //! \brief The magazines of all threads.
+        per_thread<thread_cache> m_caches;
+        //! \brief The number of live allocations.
+        std::atomic<int64> m_allocation_count;
+
+        virtual int64 allocate_unaligned(const int64 size) override;
+        void free_memory_unaligned(void* mem) override;
+
+        //! \brief Calculates the size class for a block size including the header.
+        //! \param[in] size The block size in bytes.
+        //! \return The size class or -1 if the block is too large for the magazines.
+        int32 size_class(int64 size) const;
+
+        //! \brief Refills a magazine of the calling thread from the shared \a allocator.
+        //! \param[in] cache The \a thread_cache of the calling thread.
+        //! \param[in] size_class The size class to refill.
+        void refill(thread_cache& cache, int32 size_class);
+
+        //! \brief Returns half of a full magazine to the shared \a allocator.
+        //! \param[in] cache The \a thread_cache of the calling thread.
+        //! \param[in] size_class The size class to flush.
+        void flush(thread_cache& cache, int32 size_class);
+
+        //! \brief Returns all blocks of all magazines of a thread to the shared \a allocator.
+        //! \param[in] cache The \a thread_cache of the thread.
+        void flush_all(thread_cache& cache);
+    };
+} // namespace mango
+
+#endif // MANGO_THREAD_SAFE_ALLOCATOR_HPP
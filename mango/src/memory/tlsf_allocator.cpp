@@ -0,0 +1,508 @@
+//! \file      tlsf_allocator.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <mango/assert.hpp>
+#include <memory/tlsf_allocator.hpp>
+#include <memory/virtual_memory.hpp>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace mango;
+
+//! \cond NO_COND
+const int32 tlsf_allocator::sl_index_count_log2;
+const int32 tlsf_allocator::alignment_log2;
+const int32 tlsf_allocator::fl_index_max;
+const int32 tlsf_allocator::sl_index_count;
+const int64 tlsf_allocator::block_alignment;
+const int32 tlsf_allocator::fl_index_shift;
+const int32 tlsf_allocator::fl_index_count;
+const int64 tlsf_allocator::small_block_size;
+const int64 tlsf_allocator::block_header_overhead;
+const int64 tlsf_allocator::block_size_min;
+const int64 tlsf_allocator::commit_chunk_size;
+const int64 tlsf_allocator::discard_threshold;
+const int64 tlsf_allocator::discard_high_water;
+//! \endcond
+
+//! \brief Flag in the block size marking the block as free.
+static const int64 block_free_bit = 1 << 0;
+//! \brief Flag in the block size marking the physically previous block as free.
+static const int64 block_prev_free_bit = 1 << 1;
+//! \brief Flag in the block size marking the pages of a free block as given back to the system.
+static const int64 block_discarded_bit = 1 << 2;
+//! \brief Mask for all flags stored in the block size.
+static const int64 block_flag_mask = block_free_bit | block_prev_free_bit | block_discarded_bit;
+
+//! \brief Finds the index of the most significant set bit.
+//! \param[in] value The value to search in. Has to be non zero.
+//! \return The index of the most significant set bit.
+static inline int32 find_last_set(uint64 value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int32>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+//! \brief Finds the index of the least significant set bit.
+//! \param[in] value The value to search in. Has to be non zero.
+//! \return The index of the least significant set bit.
+static inline int32 find_first_set(uint32 value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<int32>(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+static inline int64 block_size(const tlsf_memory_block* block)
+{
+    return block->size & ~block_flag_mask;
+}
+
+static inline void set_block_size(tlsf_memory_block* block, int64 size)
+{
+    block->size = size | (block->size & block_flag_mask);
+}
+
+static inline bool is_free(const tlsf_memory_block* block)
+{
+    return (block->size & block_free_bit) != 0;
+}
+
+static inline bool is_prev_free(const tlsf_memory_block* block)
+{
+    return (block->size & block_prev_free_bit) != 0;
+}
+
+static inline void set_flag(tlsf_memory_block* block, int64 flag, bool value)
+{
+    block->size = value ? (block->size | flag) : (block->size & ~flag);
+}
+
+static inline void* block_to_payload(const tlsf_memory_block* block)
+{
+    return reinterpret_cast<uint8*>(const_cast<tlsf_memory_block*>(block)) + tlsf_allocator::block_header_overhead;
+}
+
+static inline tlsf_memory_block* payload_to_block(const void* payload)
+{
+    return reinterpret_cast<tlsf_memory_block*>(const_cast<uint8*>(static_cast<const uint8*>(payload)) - tlsf_allocator::block_header_overhead);
+}
+
+static inline tlsf_memory_block* next_physical(const tlsf_memory_block* block)
+{
+    return reinterpret_cast<tlsf_memory_block*>(static_cast<uint8*>(block_to_payload(block)) + block_size(block));
+}
+
+static inline int64 align_up(int64 value, int64 alignment)
+{
+    return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+tlsf_allocator::tlsf_allocator(const int64 size)
+    : allocator(size)
+    , m_fl_bitmap(0)
+    , m_used_size(0)
+    , m_free_size(0)
+    , m_free_block_count(0)
+    , m_allocation_count(0)
+    , m_reserved_size(0)
+    , m_committed_size(0)
+    , m_freed_since_trim(0)
+{
+    memset(m_sl_bitmap, 0, sizeof(m_sl_bitmap));
+    memset(m_blocks, 0, sizeof(m_blocks));
+}
+
+tlsf_allocator::~tlsf_allocator()
+{
+    release_virtual_memory(m_start, m_reserved_size);
+    m_start = nullptr;
+}
+
+void tlsf_allocator::init()
+{
+    if (m_start)
+    {
+        release_virtual_memory(m_start, m_reserved_size);
+        m_start = nullptr;
+    }
+    MANGO_ASSERT(m_total_size < (static_cast<int64>(1) << fl_index_max), "TLSF Allocator can not manage more than 1 TiB!");
+
+    int64 page_size  = virtual_memory_page_size();
+    m_reserved_size  = align_up(m_total_size, page_size);
+    m_committed_size = 0;
+    m_start          = reserve_virtual_memory(m_reserved_size);
+    if (!m_start)
+    {
+        MANGO_LOG_ERROR("Reserving memory failed! Allocator broken!");
+        return;
+    }
+
+    reset();
+}
+
+void tlsf_allocator::reset()
+{
+    m_fl_bitmap = 0;
+    memset(m_sl_bitmap, 0, sizeof(m_sl_bitmap));
+    memset(m_blocks, 0, sizeof(m_blocks));
+    m_used_size        = 0;
+    m_free_size        = 0;
+    m_free_block_count = 0;
+    m_allocation_count = 0;
+    m_freed_since_trim = 0;
+
+    if (!m_start)
+        return;
+
+    // Only keep the first chunk committed.
+    int64 initial_size = std::min(align_up(commit_chunk_size, virtual_memory_page_size()), m_reserved_size);
+    if (m_committed_size > initial_size)
+        decommit_virtual_memory(static_cast<uint8*>(m_start) + initial_size, m_committed_size - initial_size);
+    else if (m_committed_size < initial_size && !commit_virtual_memory(static_cast<uint8*>(m_start) + m_committed_size, initial_size - m_committed_size))
+        return;
+    m_committed_size = initial_size;
+
+    // Layout: [first block header | payload ... | sentinel header]
+    // The sentinel is a zero sized used block, so that every real block has a physical successor.
+    int64 start = reinterpret_cast<int64>(m_start);
+    int64 size  = m_committed_size - 2 * block_header_overhead;
+    if (size < block_size_min)
+    {
+        MANGO_LOG_ERROR("TLSF Allocator memory too small!");
+        return;
+    }
+
+    tlsf_memory_block* block = reinterpret_cast<tlsf_memory_block*>(start);
+    block->prev_physical     = nullptr;
+    block->size              = size;
+    set_flag(block, block_free_bit, true);
+    set_flag(block, block_prev_free_bit, false);
+    set_flag(block, block_discarded_bit, false);
+    insert_free_block(block);
+
+    tlsf_memory_block* sentinel = next_physical(block);
+    sentinel->prev_physical     = block;
+    sentinel->size              = 0;
+    set_flag(sentinel, block_prev_free_bit, true);
+}
+
+allocator_statistics tlsf_allocator::get_statistics() const
+{
+    allocator_statistics stats;
+    stats.total_size         = m_total_size;
+    stats.committed_size     = m_committed_size;
+    stats.used_size          = m_used_size;
+    stats.free_size          = m_free_size;
+    stats.free_block_count   = m_free_block_count;
+    stats.allocation_count   = m_allocation_count;
+    stats.largest_free_block = 0;
+
+    // The largest block is in the highest non empty list, only that list has to be searched.
+    if (m_fl_bitmap)
+    {
+        int32 fl = find_last_set(m_fl_bitmap);
+        int32 sl = find_last_set(m_sl_bitmap[fl]);
+        for (tlsf_memory_block* block = m_blocks[fl][sl]; block; block = block->next_free)
+            stats.largest_free_block = std::max(stats.largest_free_block, block_size(block));
+    }
+
+    // The uncommitted address space is still available and extends the last block if that one is free.
+    int64 uncommitted = m_reserved_size - m_committed_size;
+    if (m_start && uncommitted > 0)
+    {
+        const tlsf_memory_block* sentinel = reinterpret_cast<const tlsf_memory_block*>(static_cast<uint8*>(m_start) + m_committed_size - block_header_overhead);
+        int64 tail_size                   = is_prev_free(sentinel) ? block_size(sentinel->prev_physical) : 0;
+        stats.free_size += uncommitted;
+        stats.largest_free_block = std::max(stats.largest_free_block, tail_size + uncommitted);
+    }
+
+    stats.fragmentation = stats.free_size > 0 ? 1.0f - static_cast<float>(stats.largest_free_block) / static_cast<float>(stats.free_size) : 0.0f;
+    return stats;
+}
+
+int64 tlsf_allocator::allocate_unaligned(const int64 size)
+{
+    if (size <= 0)
+        return -1;
+
+    int64 adjusted_size = std::max(align_up(size, block_alignment), block_size_min);
+    if (adjusted_size >= (static_cast<int64>(1) << fl_index_max))
+    {
+        MANGO_LOG_ERROR("TLSF Allocator can not allocate {0} bytes at once!", size);
+        return -1;
+    }
+
+    int32 fl, sl;
+    mapping_search(adjusted_size, fl, sl);
+    tlsf_memory_block* block = search_suitable_block(fl, sl);
+    if (!block && grow(adjusted_size))
+    {
+        mapping_search(adjusted_size, fl, sl);
+        block = search_suitable_block(fl, sl);
+    }
+    if (!block)
+    {
+        MANGO_LOG_ERROR("TLSF Allocator Out Of Memory!");
+        return -1;
+    }
+
+    remove_free_block(block);
+    split(block, adjusted_size);
+
+    set_flag(block, block_free_bit, false);
+    set_flag(block, block_discarded_bit, false);
+    set_flag(next_physical(block), block_prev_free_bit, false);
+
+    m_used_size += block_size(block);
+    m_allocation_count++;
+
+    return reinterpret_cast<int64>(block_to_payload(block));
+}
+
+void tlsf_allocator::free_memory_unaligned(void* mem)
+{
+    if (!mem)
+        return;
+
+    tlsf_memory_block* block = payload_to_block(mem);
+    MANGO_ASSERT(!is_free(block), "Double free detected in TLSF Allocator!");
+
+    int64 size = block_size(block);
+    m_used_size -= size;
+    m_allocation_count--;
+
+    set_flag(block, block_free_bit, true);
+    block = coalesce(block);
+
+    set_flag(next_physical(block), block_prev_free_bit, true);
+    insert_free_block(block);
+
+    // Discarding on every free makes reusing the block expensive, so discards are batched.
+    // Up to discard_high_water bytes of free memory stay resident, those pages would be touched again soon.
+    m_freed_since_trim += size;
+    if (m_freed_since_trim >= discard_high_water && m_free_size > discard_high_water)
+        trim();
+}
+
+void tlsf_allocator::trim()
+{
+    m_freed_since_trim = 0;
+
+    // Only the lists with blocks of at least discard_threshold bytes are visited.
+    int32 fl, sl;
+    mapping_insert(discard_threshold, fl, sl);
+    uint32 fl_map = m_fl_bitmap & (~0U << fl);
+    while (fl_map)
+    {
+        int32 current_fl = find_first_set(fl_map);
+        fl_map &= fl_map - 1;
+        uint32 sl_map = m_sl_bitmap[current_fl];
+        while (sl_map)
+        {
+            int32 current_sl = find_first_set(sl_map);
+            sl_map &= sl_map - 1;
+            for (tlsf_memory_block* block = m_blocks[current_fl][current_sl]; block; block = block->next_free)
+                discard(block);
+        }
+    }
+}
+
+void tlsf_allocator::mapping_insert(int64 size, int32& fl, int32& sl) const
+{
+    if (size < small_block_size)
+    {
+        fl = 0;
+        sl = static_cast<int32>(size / (small_block_size / sl_index_count));
+    }
+    else
+    {
+        int32 msb = find_last_set(static_cast<uint64>(size));
+        sl        = static_cast<int32>((size >> (msb - sl_index_count_log2)) ^ (static_cast<int64>(1) << sl_index_count_log2));
+        fl        = msb - (fl_index_shift - 1);
+    }
+}
+
+void tlsf_allocator::mapping_search(int64 size, int32& fl, int32& sl) const
+{
+    if (size >= small_block_size)
+    {
+        int64 round = (static_cast<int64>(1) << (find_last_set(static_cast<uint64>(size)) - sl_index_count_log2)) - 1;
+        size += round;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+tlsf_memory_block* tlsf_allocator::search_suitable_block(int32& fl, int32& sl) const
+{
+    if (fl >= fl_index_count)
+        return nullptr;
+
+    // search in the current first level for a list with big enough blocks.
+    uint32 sl_map = m_sl_bitmap[fl] & (~0U << sl);
+    if (!sl_map)
+    {
+        // none there, take the next bigger first level.
+        uint32 fl_map = (fl + 1 < 32) ? (m_fl_bitmap & (~0U << (fl + 1))) : 0;
+        if (!fl_map)
+            return nullptr;
+
+        fl     = find_first_set(fl_map);
+        sl_map = m_sl_bitmap[fl];
+    }
+    MANGO_ASSERT(sl_map, "TLSF Allocator bitmaps are corrupted!");
+    sl = find_first_set(sl_map);
+
+    return m_blocks[fl][sl];
+}
+
+void tlsf_allocator::insert_free_block(tlsf_memory_block* block)
+{
+    int32 fl, sl;
+    mapping_insert(block_size(block), fl, sl);
+
+    tlsf_memory_block* current = m_blocks[fl][sl];
+    block->next_free           = current;
+    block->prev_free           = nullptr;
+    if (current)
+        current->prev_free = block;
+
+    m_blocks[fl][sl] = block;
+    m_fl_bitmap |= 1U << fl;
+    m_sl_bitmap[fl] |= 1U << sl;
+
+    m_free_size += block_size(block);
+    m_free_block_count++;
+}
+
+void tlsf_allocator::remove_free_block(tlsf_memory_block* block)
+{
+    int32 fl, sl;
+    mapping_insert(block_size(block), fl, sl);
+
+    tlsf_memory_block* prev = block->prev_free;
+    tlsf_memory_block* next = block->next_free;
+    if (next)
+        next->prev_free = prev;
+    if (prev)
+        prev->next_free = next;
+
+    if (m_blocks[fl][sl] == block)
+    {
+        m_blocks[fl][sl] = next;
+        if (!next)
+        {
+            m_sl_bitmap[fl] &= ~(1U << sl);
+            if (!m_sl_bitmap[fl])
+                m_fl_bitmap &= ~(1U << fl);
+        }
+    }
+
+    m_free_size -= block_size(block);
+    m_free_block_count--;
+}
+
+void tlsf_allocator::split(tlsf_memory_block* block, int64 size)
+{
+    int64 remaining = block_size(block) - size - block_header_overhead;
+    if (remaining < block_size_min) // Smaller does not really make sense.
+        return;
+
+    tlsf_memory_block* remainder = reinterpret_cast<tlsf_memory_block*>(static_cast<uint8*>(block_to_payload(block)) + size);
+    remainder->prev_physical     = block;
+    remainder->size              = remaining;
+    set_flag(remainder, block_free_bit, true);
+    set_flag(remainder, block_prev_free_bit, false); // block gets used.
+    set_flag(remainder, block_discarded_bit, false); // Conservative, the header of the remainder may be on a used page.
+
+    set_block_size(block, size);
+
+    tlsf_memory_block* next = next_physical(remainder);
+    next->prev_physical     = remainder;
+    set_flag(next, block_prev_free_bit, true);
+
+    insert_free_block(remainder);
+}
+
+bool tlsf_allocator::grow(int64 size)
+{
+    // The search rounds up to the next list, the new block has to be big enough for that as well.
+    // The committed memory grows geometrically, so large scenes only grow a few times.
+    int64 page_size = virtual_memory_page_size();
+    int64 needed    = size + (size >> sl_index_count_log2) + block_header_overhead;
+    int64 grow_size = align_up(std::max(needed, std::max(commit_chunk_size, m_committed_size)), page_size);
+    grow_size       = std::min(grow_size, m_reserved_size - m_committed_size);
+    if (grow_size <= 0)
+        return false;
+
+    if (!commit_virtual_memory(static_cast<uint8*>(m_start) + m_committed_size, grow_size))
+        return false;
+
+    // The old sentinel becomes the header of the new free block.
+    tlsf_memory_block* block = reinterpret_cast<tlsf_memory_block*>(static_cast<uint8*>(m_start) + m_committed_size - block_header_overhead);
+    m_committed_size += grow_size;
+    set_block_size(block, grow_size - block_header_overhead);
+    set_flag(block, block_free_bit, true);
+    set_flag(block, block_discarded_bit, false);
+
+    tlsf_memory_block* sentinel = next_physical(block);
+    sentinel->prev_physical     = block;
+    sentinel->size              = 0;
+
+    block = coalesce(block);
+    set_flag(next_physical(block), block_prev_free_bit, true);
+    insert_free_block(block);
+
+    return true;
+}
+
+void tlsf_allocator::discard(tlsf_memory_block* block)
+{
+    if (block_size(block) < discard_threshold || (block->size & block_discarded_bit))
+        return;
+    set_flag(block, block_discarded_bit, true);
+
+    // Keep the header and the free list pointers.
+    int64 page_size = virtual_memory_page_size();
+    int64 start     = align_up(reinterpret_cast<int64>(block) + sizeof(tlsf_memory_block), page_size);
+    int64 end       = (reinterpret_cast<int64>(block_to_payload(block)) + block_size(block)) & ~(page_size - 1);
+    if (end > start)
+        discard_virtual_memory(reinterpret_cast<void*>(start), end - start);
+}
+
+tlsf_memory_block* tlsf_allocator::coalesce(tlsf_memory_block* block)
+{
+    if (is_prev_free(block))
+    {
+        tlsf_memory_block* prev = block->prev_physical;
+        MANGO_ASSERT(prev && is_free(prev), "TLSF Allocator physical block list is corrupted!");
+        remove_free_block(prev);
+        set_block_size(prev, block_size(prev) + block_header_overhead + block_size(block));
+        set_flag(prev, block_discarded_bit, false); // The merged block contains pages still in use.
+        block = prev;
+        next_physical(block)->prev_physical = block;
+    }
+
+    tlsf_memory_block* next = next_physical(block);
+    if (is_free(next))
+    {
+        remove_free_block(next);
+        set_block_size(block, block_size(block) + block_header_overhead + block_size(next));
+        next_physical(block)->prev_physical = block;
+    }
+
+    return block;
+}
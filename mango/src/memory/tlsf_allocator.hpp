@@ -0,0 +1,151 @@
+//! \file      tlsf_allocator.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_TLSF_ALLOCATOR_HPP
+#define MANGO_TLSF_ALLOCATOR_HPP
+
+#include <memory/allocator.hpp>
+
+namespace mango
+{
+    //! \brief A block used for the \a tlsf_allocator.
+    //! \details The header of each block is 16 bytes (prev_physical and size). The free list pointers are only valid while the block is free and live in the payload.
+    struct tlsf_memory_block
+    {
+        tlsf_memory_block* prev_physical; //!< Pointer to the physically previous block.
+        int64 size;                       //!< Size of the block payload. The lower bits are used as flags.
+        tlsf_memory_block* next_free;     //!< Pointer to the next free block in the same size class. Only valid if the block is free.
+        tlsf_memory_block* prev_free;     //!< Pointer to the previous free block in the same size class. Only valid if the block is free.
+    };
+
+    //! \brief A two level segregated fit allocator.
+    //! \details Reserves address space on init and manages it with segregated free lists indexed by two levels of bitmaps.
+    //! Allocation and freeing is O(1), free blocks are coalesced with their physical neighbours immediately.
+    //! Committed memory grows geometrically when it runs out. Pages of large coalesced free blocks are given back to the system in batches,
+    //! once enough memory was freed since the last trim() or when trim() is called explicitly.
+    class tlsf_allocator : public allocator
+    {
+      public:
+        //! \brief Constructs the \a tlsf_allocator.
+        //! \details Does not allocate any memory. To use the allocator init() has to be called.
+        //! \param[in] size The size of the memory to manage. This is reserved as address space and is the hard limit of the \a tlsf_allocator.
+        tlsf_allocator(const int64 size);
+        ~tlsf_allocator();
+
+        void init() override;
+        void reset() override;
+        allocator_statistics get_statistics() const override;
+
+        //! \brief Gives the pages of all free blocks bigger than discard_threshold back to the system.
+        //! \details Called automatically once discard_high_water bytes were freed and more than that is free. Can be called explicitly in idle time.
+        void trim();
+
+        //! \brief Log2 of the number of second level subdivisions.
+        static const int32 sl_index_count_log2 = 5;
+        //! \brief Log2 of the alignment of all blocks.
+        static const int32 alignment_log2 = 4;
+        //! \brief The highest first level index. Limits the maximum block size to 2^fl_index_max bytes.
+        static const int32 fl_index_max = 40;
+
+        //! \brief The number of second level subdivisions.
+        static const int32 sl_index_count = 1 << sl_index_count_log2;
+        //! \brief The alignment of all blocks.
+        static const int64 block_alignment = 1 << alignment_log2;
+        //! \brief The first level index shift. Blocks smaller than 2^fl_index_shift are managed in the first level 0.
+        static const int32 fl_index_shift = sl_index_count_log2 + alignment_log2;
+        //! \brief The number of first level indices.
+        static const int32 fl_index_count = fl_index_max - fl_index_shift + 1;
+        //! \brief The size limit of small blocks.
+        static const int64 small_block_size = 1 << fl_index_shift;
+        //! \brief The size of the header stored in front of each block payload.
+        static const int64 block_header_overhead = 2 * sizeof(void*);
+        //! \brief The minimum payload size of a block. Free blocks need to store the free list pointers.
+        static const int64 block_size_min = 2 * sizeof(void*);
+        //! \brief The minimum size committed at once. Growing commits at least the already committed size again.
+        static const int64 commit_chunk_size = 4194304; // 4 MiB
+        //! \brief The minimum size of a free block to give its pages back to the system.
+        static const int64 discard_threshold = 1048576; // 1 MiB
+        //! \brief The size of free memory that stays resident. trim() is called automatically when more was freed since the last trim() and is free.
+        static const int64 discard_high_water = 67108864; // 64 MiB
+
+      private:
+        //! \brief Bitmap of non empty first level lists.
+        uint32 m_fl_bitmap;
+        //! \brief Bitmaps of non empty second level lists.
+        uint32 m_sl_bitmap[fl_index_count];
+        //! \brief Heads of the segregated free lists.
+        tlsf_memory_block* m_blocks[fl_index_count][sl_index_count];
+
+        //! \brief The size of all blocks currently handed out in bytes.
+        int64 m_used_size;
+        //! \brief The size of all free block payloads in bytes.
+        int64 m_free_size;
+        //! \brief The number of free blocks.
+        int64 m_free_block_count;
+        //! \brief The number of live allocations.
+        int64 m_allocation_count;
+        //! \brief The size of the reserved address space in bytes.
+        int64 m_reserved_size;
+        //! \brief The size of the committed memory at the start of the reserved address space in bytes.
+        int64 m_committed_size;
+        //! \brief The size of memory freed since the last trim() in bytes.
+        int64 m_freed_since_trim;
+
+        virtual int64 allocate_unaligned(const int64 size) override;
+        void free_memory_unaligned(void* mem) override;
+
+        //! \brief Calculates the first and second level index a block of a specific size is stored in.
+        //! \param[in] size The block size.
+        //! \param[out] fl The first level index.
+        //! \param[out] sl The second level index.
+        void mapping_insert(int64 size, int32& fl, int32& sl) const;
+
+        //! \brief Calculates the first and second level index to start the search for a block of a specific size.
+        //! \details Rounds up the size to the next list, so that every block in that list is big enough.
+        //! \param[in] size The requested size.
+        //! \param[out] fl The first level index.
+        //! \param[out] sl The second level index.
+        void mapping_search(int64 size, int32& fl, int32& sl) const;
+
+        //! \brief Searches a free block in the list with the given indices or in any list with bigger blocks.
+        //! \param[in,out] fl The first level index to start with. Set to the index of the found block.
+        //! \param[in,out] sl The second level index to start with. Set to the index of the found block.
+        //! \return A suitable \a tlsf_memory_block or nullptr if out of memory.
+        tlsf_memory_block* search_suitable_block(int32& fl, int32& sl) const;
+
+        //! \brief Inserts a free block in the matching free list.
+        //! \param[in] block The block to insert.
+        void insert_free_block(tlsf_memory_block* block);
+
+        //! \brief Removes a free block from the matching free list.
+        //! \param[in] block The block to remove.
+        void remove_free_block(tlsf_memory_block* block);
+
+        //! \brief Splits a block after finding a fitting block beeing to large.
+        //! \details The remainder gets inserted in the free lists.
+        //! \param[in] block The block to split.
+        //! \param[in] size The required size.
+        void split(tlsf_memory_block* block, int64 size);
+
+        //! \brief Commits more memory and appends it to the managed blocks.
+        //! \details The sentinel block at the end of the committed memory gets the new free block.
+        //! \param[in] size The minimum size in bytes to commit.
+        //! \return True on success, false if the hard limit is reached.
+        bool grow(int64 size);
+
+        //! \brief Gives the pages inside a free block back to the system.
+        //! \details Only done for blocks bigger than discard_threshold and not discarded yet. The block header and free list pointers stay intact.
+        //! \param[in] block The free block.
+        void discard(tlsf_memory_block* block);
+
+        //! \brief Merges a freed block with its free physical neighbours.
+        //! \param[in] block The block that was freed. Has to be removed from the free lists.
+        //! \return The merged block.
+        tlsf_memory_block* coalesce(tlsf_memory_block* block);
+    };
+} // namespace mango
+
+#endif // MANGO_TLSF_ALLOCATOR_HPP
@@ -0,0 +1,95 @@
+//! \file      virtual_memory.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <mango/log.hpp>
+#include <memory/virtual_memory.hpp>
+#if defined(WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace mango;
+
+//! \brief Queries the page size from the system.
+//! \return The page size in bytes.
+static int64 query_page_size()
+{
+#if defined(WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<int64>(info.dwPageSize);
+#else
+    return static_cast<int64>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+int64 mango::virtual_memory_page_size()
+{
+    static const int64 page_size = query_page_size();
+    return page_size;
+}
+
+void* mango::reserve_virtual_memory(int64 size)
+{
+#if defined(WIN32)
+    void* address = VirtualAlloc(nullptr, static_cast<SIZE_T>(size), MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* address = mmap(nullptr, static_cast<size_t>(size), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (address == MAP_FAILED)
+        address = nullptr;
+#endif
+    if (!address)
+        MANGO_LOG_ERROR("Reserving {0} bytes of virtual memory failed!", size);
+    return address;
+}
+
+bool mango::commit_virtual_memory(void* address, int64 size)
+{
+#if defined(WIN32)
+    bool success = VirtualAlloc(address, static_cast<SIZE_T>(size), MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    bool success = mprotect(address, static_cast<size_t>(size), PROT_READ | PROT_WRITE) == 0;
+#endif
+    if (!success)
+        MANGO_LOG_ERROR("Committing {0} bytes of virtual memory failed!", size);
+    return success;
+}
+
+void mango::decommit_virtual_memory(void* address, int64 size)
+{
+#if defined(WIN32)
+    VirtualFree(address, static_cast<SIZE_T>(size), MEM_DECOMMIT);
+#else
+    madvise(address, static_cast<size_t>(size), MADV_DONTNEED);
+    mprotect(address, static_cast<size_t>(size), PROT_NONE);
+#endif
+}
+
+void mango::discard_virtual_memory(void* address, int64 size)
+{
+#if defined(WIN32)
+    VirtualAlloc(address, static_cast<SIZE_T>(size), MEM_RESET, PAGE_READWRITE);
+#else
+    madvise(address, static_cast<size_t>(size), MADV_DONTNEED);
+#endif
+}
+
+void mango::release_virtual_memory(void* address, int64 size)
+{
+    if (!address)
+        return;
+#if defined(WIN32)
+    MANGO_UNUSED(size);
+    VirtualFree(address, 0, MEM_RELEASE);
+#else
+    munmap(address, static_cast<size_t>(size));
+#endif
+}
@@ -0,0 +1,49 @@
+//! \file      virtual_memory.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_VIRTUAL_MEMORY_HPP
+#define MANGO_VIRTUAL_MEMORY_HPP
+
+#include <mango/types.hpp>
+
+namespace mango
+{
+    //! \brief Retrieves the page size of the system.
+    //! \return The page size in bytes.
+    int64 virtual_memory_page_size();
+
+    //! \brief Reserves address space without backing it with physical memory.
+    //! \details The reserved memory can not be accessed before it gets committed.
+    //! \param[in] size The size in bytes to reserve. Has to be a multiple of the page size.
+    //! \return A pointer to the start of the reserved address space or nullptr on failure.
+    void* reserve_virtual_memory(int64 size);
+
+    //! \brief Commits pages of reserved address space, so that they can be read and written.
+    //! \details Physical memory is only used when the pages are touched for the first time.
+    //! \param[in] address The start of the range to commit. Has to be page aligned.
+    //! \param[in] size The size of the range to commit in bytes. Has to be a multiple of the page size.
+    //! \return True on success, else false.
+    bool commit_virtual_memory(void* address, int64 size);
+
+    //! \brief Decommits pages, so that they are only reserved again.
+    //! \details The physical memory is given back to the system, accessing the range afterwards is invalid.
+    //! \param[in] address The start of the range to decommit. Has to be page aligned.
+    //! \param[in] size The size of the range to decommit in bytes. Has to be a multiple of the page size.
+    void decommit_virtual_memory(void* address, int64 size);
+
+    //! \brief Discards the content of committed pages.
+    //! \details The physical memory is given back to the system, but the range stays accessible. The content is undefined afterwards.
+    //! \param[in] address The start of the range to discard. Has to be page aligned.
+    //! \param[in] size The size of the range to discard in bytes. Has to be a multiple of the page size.
+    void discard_virtual_memory(void* address, int64 size);
+
+    //! \brief Releases address space reserved with reserve_virtual_memory().
+    //! \param[in] address The pointer returned by reserve_virtual_memory().
+    //! \param[in] size The size passed to reserve_virtual_memory().
+    void release_virtual_memory(void* address, int64 size);
+} // namespace mango
+
+#endif // MANGO_VIRTUAL_MEMORY_HPP
@@ -0,0 +1,357 @@
+//! \file      hi_z_culler.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <mango/profile.hpp>
+#include <rendering/hi_z_culler.hpp>
+#include <resources/resources_impl.hpp>
+#include <util/helpers.hpp>
+
+using namespace mango;
+
+//! \brief Largest element difference of the view projection matrices for which the results of a test are still used.
+static const float max_view_projection_delta = 0.05f;
+
+//! \brief Calculates the largest element difference of two matrices.
+//! \param[in] a The first matrix.
+//! \param[in] b The second matrix.
+//! \return The largest absolute difference of two elements.
+static float max_element_delta(const mat4& a, const mat4& b)
+{
+    float delta = 0.0f;
+    for (int32 c = 0; c < 4; ++c)
+    {
+        for (int32 r = 0; r < 4; ++r)
+            delta = std::max(delta, std::abs(a[c][r] - b[c][r]));
+    }
+    return delta;
+}
+
+hi_z_culler::hi_z_culler()
+    : m_visibility_mapping(nullptr)
+    , m_visibility_pending(false)
+    , m_enabled(false)
+    , m_frame_view_projection(1.0f)
+    , m_tested_view_projection(1.0f)
+    , m_result_view_projection(1.0f)
+{
+    m_hi_z_data.source_level = 0;
+    m_hi_z_data.draw_count   = 0;
+    m_hi_z_data.level_count  = 0;
+}
+
+bool hi_z_culler::init(const shared_ptr<context_impl>& context)
+{
+    PROFILE_ZONE;
+    m_shared_context = context;
+
+    auto& graphics_device    = m_shared_context->get_graphics_device();
+    auto& internal_resources = m_shared_context->get_internal_resources();
+
+    // buffers
+    buffer_create_info buffer_info;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_uniform;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+    buffer_info.size          = sizeof(hi_z_data);
+
+    m_hi_z_data_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_hi_z_data_buffer.get(), "hi z data buffer"))
+        return false;
+
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+    buffer_info.size          = max_hi_z_draws * 2 * sizeof(vec4);
+
+    m_bounds_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_bounds_buffer.get(), "hi z bounds buffer"))
+        return false;
+
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_mapped_access_read_write;
+    buffer_info.size          = max_hi_z_draws * sizeof(uint32);
+
+    m_visibility_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_visibility_buffer.get(), "hi z visibility buffer"))
+        return false;
+
+    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+    device_context->begin();
+    m_visibility_mapping = static_cast<uint32*>(device_context->map_buffer_data(m_visibility_buffer, 0, max_hi_z_draws * sizeof(uint32)));
+    device_context->end();
+    device_context->submit();
+    if (!check_mapping(m_visibility_mapping, "hi z visibility buffer"))
+        return false;
+
+    // samplers
+    sampler_create_info sampler_info;
+    sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_nearest_mipmap_nearest;
+    sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_nearest;
+    sampler_info.enable_comparison_mode  = false;
+    sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
+    sampler_info.edge_value_wrap_u       = gfx_sampler_edge_wrap::sampler_edge_wrap_clamp_to_edge;
+    sampler_info.edge_value_wrap_v       = gfx_sampler_edge_wrap::sampler_edge_wrap_clamp_to_edge;
+    sampler_info.edge_value_wrap_w       = gfx_sampler_edge_wrap::sampler_edge_wrap_clamp_to_edge;
+    sampler_info.border_color[0]         = 0;
+    sampler_info.border_color[1]         = 0;
+    sampler_info.border_color[2]         = 0;
+    sampler_info.border_color[3]         = 0;
+    sampler_info.enable_seamless_cubemap = false;
+
+    m_pyramid_sampler = graphics_device->create_sampler(sampler_info);
+    if (!check_creation(m_pyramid_sampler.get(), "hi z pyramid sampler"))
+        return false;
+
+    // shader stages
+    shader_stage_create_info shader_info;
+    shader_resource_resource_description res_resource_desc;
+    shader_source_description source_desc;
+
+    gfx_handle<const gfx_shader_stage> pyramid_compute;
+    gfx_handle<const gfx_shader_stage> cull_compute;
+    // depth pyramid compute stage
+    {
+        res_resource_desc.path = "res/shader/hi_z/c_hi_z_pyramid.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 4;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_DATA_BUFFER_BINDING_POINT, "hi_z_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, "texture_hi_z_input", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, "sampler_hi_z_input", gfx_shader_resource_type::shader_resource_sampler, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_OUTPUT, "image_hi_z_output", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+        } };
+
+        pyramid_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(pyramid_compute.get(), "hi z pyramid compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // occlusion test compute stage
+    {
+        res_resource_desc.path = "res/shader/hi_z/c_hi_z_cull.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 6;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_DATA_BUFFER_BINDING_POINT, "hi_z_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_BOUNDS_BUFFER_BINDING_POINT, "hi_z_bounds", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_VISIBILITY_BUFFER_BINDING_POINT, "hi_z_visibility", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, "texture_hi_z_input", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, "sampler_hi_z_input", gfx_shader_resource_type::shader_resource_sampler, 1 },
+        } };
+
+        cull_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(cull_compute.get(), "hi z cull compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+
+    // pipelines
+    {
+        compute_pipeline_create_info pyramid_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto pyramid_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_OUTPUT, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        pyramid_pass_info.pipeline_layout = pyramid_pass_pipeline_layout;
+
+        pyramid_pass_info.shader_stage_descriptor.compute_shader_stage = pyramid_compute;
+
+        m_pyramid_pipeline = graphics_device->create_compute_pipeline(pyramid_pass_info);
+        if (!check_creation(m_pyramid_pipeline.get(), "hi z pyramid pipeline"))
+            return false;
+    }
+    {
+        compute_pipeline_create_info cull_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto cull_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_BOUNDS_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_VISIBILITY_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_SAMPLER_INPUT, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        cull_pass_info.pipeline_layout = cull_pass_pipeline_layout;
+
+        cull_pass_info.shader_stage_descriptor.compute_shader_stage = cull_compute;
+
+        m_cull_pipeline = graphics_device->create_compute_pipeline(cull_pass_info);
+        if (!check_creation(m_cull_pipeline.get(), "hi z cull pipeline"))
+            return false;
+    }
+
+    m_queued_bounds.reserve(max_hi_z_draws * 2);
+    m_queued_draws.reserve(max_hi_z_draws);
+    m_tested_draws.reserve(max_hi_z_draws);
+
+    return true;
+}
+
+bool hi_z_culler::create_pyramid(int32 width, int32 height)
+{
+    auto& graphics_device = m_shared_context->get_graphics_device();
+
+    texture_create_info pyramid_info;
+    pyramid_info.texture_type   = gfx_texture_type::texture_type_2d;
+    pyramid_info.width          = width;
+    pyramid_info.height         = height;
+    pyramid_info.miplevels      = graphics::calculate_mip_count(width, height);
+    pyramid_info.array_layers   = 1;
+    pyramid_info.texture_format = gfx_format::r32f;
+
+    m_pyramid = graphics_device->create_texture(pyramid_info);
+    if (!check_creation(m_pyramid.get(), "hi z depth pyramid"))
+        return false;
+
+    m_pyramid_views.clear();
+    for (int32 level = 0; level < pyramid_info.miplevels; ++level)
+        m_pyramid_views.push_back(graphics_device->create_image_texture_view(m_pyramid, level));
+
+    m_hi_z_data.level_count = pyramid_info.miplevels;
+
+    return true;
+}
+
+void hi_z_culler::begin_frame(const graphics_device_context_handle& device_context, bool enabled, const sid& camera_id, const mat4& view_projection)
+{
+    m_enabled = enabled && m_cull_pipeline && m_visibility_mapping;
+    m_queued_bounds.clear();
+    m_queued_draws.clear();
+    m_frame_camera          = camera_id;
+    m_frame_view_projection = view_projection;
+
+    if (!m_enabled)
+    {
+        m_occluded_draws.clear();
+        return;
+    }
+
+    if (m_visibility_pending && device_context->is_signaled(m_visibility_semaphore))
+    {
+        m_visibility_pending = false;
+
+        m_occluded_draws.clear();
+        for (int32 i = 0; i < static_cast<int32>(m_tested_draws.size()); ++i)
+        {
+            if (!m_visibility_mapping[i])
+                m_occluded_draws.insert(m_tested_draws[i]);
+        }
+        m_result_camera          = m_tested_camera;
+        m_result_view_projection = m_tested_view_projection;
+    }
+
+    // The results are not reprojected, so they are only valid for the camera and roughly the view they were tested with.
+    if (!(m_result_camera == m_frame_camera) || max_element_delta(m_result_view_projection, m_frame_view_projection) > max_view_projection_delta)
+        m_occluded_draws.clear();
+}
+
+bool hi_z_culler::check_occlusion(const sid& node_id, const sid& primitive_id, const axis_aligned_bounding_box& bounding_box)
+{
+    if (!m_enabled)
+        return false;
+
+    draw_id id{ node_id, primitive_id };
+    if (static_cast<int32>(m_queued_draws.size()) < max_hi_z_draws)
+    {
+        m_queued_bounds.push_back(vec4(bounding_box.center, 0.0f));
+        m_queued_bounds.push_back(vec4(bounding_box.extents, 0.0f));
+        m_queued_draws.push_back(id);
+    }
+
+    return m_occluded_draws.find(id) != m_occluded_draws.end();
+}
+
+void hi_z_culler::cull(const graphics_device_context_handle& device_context, gfx_handle<const gfx_texture> depth_texture, gfx_handle<const gfx_buffer> camera_data_buffer)
+{
+    // The test results are still in use as long as they are not read back.
+    if (!m_enabled || m_visibility_pending || m_queued_draws.empty())
+        return;
+
+    vec2 size    = depth_texture->get_size();
+    int32 width  = static_cast<int32>(size.x);
+    int32 height = static_cast<int32>(size.y);
+    if (!m_pyramid || m_pyramid->get_size() != size)
+    {
+        if (!create_pyramid(width, height))
+            return;
+    }
+
+    barrier_description bd;
+    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit | gfx_barrier_bit::texture_fetch_barrier_bit;
+
+    // depth pyramid, level 0 is a copy of the depth, each following level stores the farthest depth of the previous one.
+    device_context->bind_pipeline(m_pyramid_pipeline);
+    m_pyramid_pipeline->get_resource_mapping()->set("hi_z_data", m_hi_z_data_buffer);
+    m_pyramid_pipeline->get_resource_mapping()->set("sampler_hi_z_input", m_pyramid_sampler);
+    for (int32 level = 0; level < m_hi_z_data.level_count; ++level)
+    {
+        m_hi_z_data.source_level = std::max(0, level - 1);
+        device_context->set_buffer_data(m_hi_z_data_buffer, 0, sizeof(hi_z_data), &m_hi_z_data);
+
+        m_pyramid_pipeline->get_resource_mapping()->set("texture_hi_z_input", level == 0 ? depth_texture : m_pyramid);
+        m_pyramid_pipeline->get_resource_mapping()->set("image_hi_z_output", m_pyramid_views[level]);
+        device_context->submit_pipeline_state_resources();
+
+        int32 level_width  = std::max(1, width >> level);
+        int32 level_height = std::max(1, height >> level);
+        device_context->dispatch((level_width + 15) / 16, (level_height + 15) / 16, 1);
+        device_context->barrier(bd);
+    }
+
+    // occlusion test
+    m_hi_z_data.source_level = 0;
+    m_hi_z_data.draw_count   = static_cast<int32>(m_queued_draws.size());
+    device_context->set_buffer_data(m_hi_z_data_buffer, 0, sizeof(hi_z_data), &m_hi_z_data);
+    device_context->set_buffer_data(m_bounds_buffer, 0, static_cast<int32>(m_queued_bounds.size() * sizeof(vec4)), m_queued_bounds.data());
+
+    device_context->bind_pipeline(m_cull_pipeline);
+    m_cull_pipeline->get_resource_mapping()->set("camera_data", camera_data_buffer);
+    m_cull_pipeline->get_resource_mapping()->set("hi_z_data", m_hi_z_data_buffer);
+    m_cull_pipeline->get_resource_mapping()->set("hi_z_bounds", m_bounds_buffer);
+    m_cull_pipeline->get_resource_mapping()->set("hi_z_visibility", m_visibility_buffer);
+    m_cull_pipeline->get_resource_mapping()->set("texture_hi_z_input", m_pyramid);
+    m_cull_pipeline->get_resource_mapping()->set("sampler_hi_z_input", m_pyramid_sampler);
+    device_context->submit_pipeline_state_resources();
+
+    device_context->dispatch((m_hi_z_data.draw_count + 63) / 64, 1, 1);
+
+    m_visibility_semaphore   = device_context->fence(semaphore_create_info());
+    m_visibility_pending     = true;
+    m_tested_camera          = m_frame_camera;
+    m_tested_view_projection = m_frame_view_projection;
+    m_tested_draws.swap(m_queued_draws);
+}
@@ -0,0 +1,152 @@
+//! \file      hi_z_culler.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_HI_Z_CULLER_HPP
+#define MANGO_HI_Z_CULLER_HPP
+
+#include <mango/scene_structures.hpp>
+#include <rendering/renderer_impl.hpp>
+#include <unordered_set>
+#include <util/intersect.hpp>
+
+namespace mango
+{
+    //! \brief Uniform buffer struct for the depth pyramid construction and the occlusion test.
+    struct hi_z_data
+    {
+        std140_int source_level; //!< The level of the input texture to reduce.
+        std140_int draw_count;   //!< The number of bounds to test.
+        std140_int level_count;  //!< The number of levels of the depth pyramid.
+        std140_int padding0;     //!< Padding.
+    };
+
+    //! \brief Occlusion culling against a hierarchical depth pyramid.
+    //! \details The pyramid is built from the geometry depth of a frame and the bounds of all draws of that frame are tested against it on the gpu.
+    //! The results are read back without waiting and used to skip draws in the following frames, so disoccluded draws can show up one frame late.
+    //! Draws skipped because of occlusion are tested again each frame and drawn as soon as they are visible.
+    //! The results are not reprojected, they are dropped when the camera changed or its view projection moved too far since the tested frame.
+    class hi_z_culler
+    {
+      public:
+        hi_z_culler();
+        ~hi_z_culler() = default;
+
+        //! \brief Initializes the \a hi_z_culler.
+        //! \param[in] context The internally shared context of mango.
+        //! \return True on success, else false.
+        bool init(const shared_ptr<context_impl>& context);
+
+        //! \brief Begins a frame and reads back finished visibility results.
+        //! \details Never waits for the gpu. Has to be called before the first check_occlusion() of the frame.
+        //! \param[in] device_context The \a graphics_device_context of the frame.
+        //! \param[in] enabled True if occlusion culling is enabled, else false. Disabling drops all results.
+        //! \param[in] camera_id The \a sid of the camera of the frame.
+        //! \param[in] view_projection The view projection matrix of the camera of the frame.
+        void begin_frame(const graphics_device_context_handle& device_context, bool enabled, const sid& camera_id, const mat4& view_projection);
+
+        //! \brief Checks if a draw was occluded in the last test and queues its bounds for the next one.
+        //! \param[in] node_id The \a sid of the node of the draw.
+        //! \param[in] primitive_id The \a sid of the primitive of the draw.
+        //! \param[in] bounding_box The world space \a axis_aligned_bounding_box of the draw.
+        //! \return True if the draw was occluded and can be skipped, else false.
+        bool check_occlusion(const sid& node_id, const sid& primitive_id, const axis_aligned_bounding_box& bounding_box);
+
+        //! \brief Builds the depth pyramid and tests all queued bounds against it.
+        //! \details Does nothing while the previous test is still in flight.
+        //! \param[in] device_context The \a graphics_device_context of the frame.
+        //! \param[in] depth_texture The depth of the opaque geometry of the frame.
+        //! \param[in] camera_data_buffer The buffer containing the \a camera_data of the frame.
+        void cull(const graphics_device_context_handle& device_context, gfx_handle<const gfx_texture> depth_texture, gfx_handle<const gfx_buffer> camera_data_buffer);
+
+        //! \brief The maximum number of draws tested per frame. Further draws are never culled.
+        static const int32 max_hi_z_draws = 8192;
+
+      private:
+        //! \brief Identifies a draw by node and primitive.
+        struct draw_id
+        {
+            sid node_id;      //!< The \a sid of the node.
+            sid primitive_id; //!< The \a sid of the primitive.
+
+            bool operator==(const draw_id& other) const
+            {
+                return node_id == other.node_id && primitive_id == other.primitive_id;
+            }
+        };
+
+        //! \brief Hash for the \a draw_id structure.
+        struct draw_id_hash
+        {
+            std::size_t operator()(const draw_id& k) const
+            {
+                return sid_hash()(k.node_id) * 31 + sid_hash()(k.primitive_id);
+            }
+        };
+
+        //! \brief Creates the depth pyramid matching the size of the depth texture.
+        //! \param[in] width The width of the depth texture.
+        //! \param[in] height The height of the depth texture.
+        //! \return True on success, else false.
+        bool create_pyramid(int32 width, int32 height);
+
+        //! \brief Mangos internal context for shared usage.
+        shared_ptr<context_impl> m_shared_context;
+
+        //! \brief The depth pyramid. Each texel stores the farthest depth of the area it covers.
+        gfx_handle<const gfx_texture> m_pyramid;
+        //! \brief Image views for all levels of the depth pyramid.
+        std::vector<gfx_handle<const gfx_image_texture_view>> m_pyramid_views;
+        //! \brief Sampler with nearest filtering used to fetch from the depth pyramid and the depth texture.
+        gfx_handle<const gfx_sampler> m_pyramid_sampler;
+
+        //! \brief The current \a hi_z_data.
+        hi_z_data m_hi_z_data;
+        //! \brief The graphics uniform buffer for uploading \a hi_z_data.
+        gfx_handle<const gfx_buffer> m_hi_z_data_buffer;
+        //! \brief The shader storage buffer with the world space bounds to test. Center and extents for each draw.
+        gfx_handle<const gfx_buffer> m_bounds_buffer;
+        //! \brief The shader storage buffer with the visibility results.
+        gfx_handle<const gfx_buffer> m_visibility_buffer;
+        //! \brief The mapped visibility results.
+        uint32* m_visibility_mapping;
+
+        //! \brief The \a gfx_semaphore signaled when the occlusion test finished.
+        gfx_handle<const gfx_semaphore> m_visibility_semaphore;
+        //! \brief True if an occlusion test was not read back yet, else false.
+        bool m_visibility_pending;
+
+        //! \brief Bounds queued for the next test. Center and extents for each draw.
+        std::vector<vec4> m_queued_bounds;
+        //! \brief The \a draw_ids of the queued bounds.
+        std::vector<draw_id> m_queued_draws;
+        //! \brief The \a draw_ids of the test in flight.
+        std::vector<draw_id> m_tested_draws;
+        //! \brief The draws occluded in the last finished test.
+        std::unordered_set<draw_id, draw_id_hash> m_occluded_draws;
+        //! \brief True if occlusion culling is enabled for the current frame, else false.
+        bool m_enabled;
+
+        //! \brief The \a sid of the camera of the current frame.
+        sid m_frame_camera;
+        //! \brief The view projection matrix of the current frame.
+        mat4 m_frame_view_projection;
+        //! \brief The \a sid of the camera of the test in flight.
+        sid m_tested_camera;
+        //! \brief The view projection matrix of the test in flight.
+        mat4 m_tested_view_projection;
+        //! \brief The \a sid of the camera of the last finished test.
+        sid m_result_camera;
+        //! \brief The view projection matrix of the last finished test.
+        mat4 m_result_view_projection;
+
+        //! \brief Compute pipeline building the levels of the depth pyramid.
+        gfx_handle<const gfx_pipeline> m_pyramid_pipeline;
+        //! \brief Compute pipeline testing bounds against the depth pyramid.
+        gfx_handle<const gfx_pipeline> m_cull_pipeline;
+    };
+} // namespace mango
+
+#endif // MANGO_HI_Z_CULLER_HPP
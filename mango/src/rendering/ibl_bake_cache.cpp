@@ -0,0 +1,168 @@
+//! \file      ibl_bake_cache.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <cstdio>
+#include <fstream>
+#include <rendering/ibl_bake_cache.hpp>
+#include <util/hashing.hpp>
+#include <util/helpers.hpp>
+
+using namespace mango;
+
+//! \brief Magic number of ibl bake files. 'MGIB'.
+static const uint32 ibl_bake_magic = 0x4249474D;
+//! \brief The version of the ibl bake file layout.
+static const uint32 ibl_bake_version = 1;
+
+ibl_bake_cache::ibl_bake_cache(const string& directory)
+    : m_directory(directory)
+    , m_enabled(false)
+{
+    if (m_directory.empty() || (m_directory.back() != '/' && m_directory.back() != '\\'))
+        m_directory += '/';
+
+    m_enabled = create_directories(m_directory);
+    if (!m_enabled)
+        MANGO_LOG_WARN("Could not create ibl bake cache directory '{0}', ibl bake cache is disabled.", m_directory);
+}
+
+ibl_bake_cache::~ibl_bake_cache() {}
+
+uint64 ibl_bake_cache::create_key(const string& source_path, const uint64* parameters, int32 parameter_count) const
+{
+    uint64 key = fnv1a_hash::hash(parameters, sizeof(uint64) * parameter_count);
+
+    if (!source_path.empty())
+    {
+        std::ifstream input(source_path, std::ios::in | std::ios::binary);
+        if (!input.is_open())
+            return 0;
+
+        std::vector<char> chunk(1 << 20);
+        while (input)
+        {
+            input.read(chunk.data(), chunk.size());
+            key = fnv1a_hash::hash(chunk.data(), static_cast<size_t>(input.gcount()), key);
+        }
+    }
+
+    // 0 signals an invalid key.
+    return key ? key : 1;
+}
+
+bool ibl_bake_cache::load(uint64 key, std::vector<ibl_bake_texture>& textures)
+{
+    textures.clear();
+    if (!m_enabled)
+        return false;
+
+    string path = file_path(key);
+    std::ifstream input(path, std::ios::in | std::ios::binary);
+    if (!input.is_open())
+        return false;
+
+    bake_header header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(bake_header));
+
+    bool valid = input.good() && header.magic == ibl_bake_magic && header.version == ibl_bake_version && header.key == key;
+
+    for (uint32 i = 0; valid && i < header.texture_count; ++i)
+    {
+        texture_header tex_header;
+        input.read(reinterpret_cast<char*>(&tex_header), sizeof(texture_header));
+        if (!input.good())
+        {
+            valid = false;
+            break;
+        }
+
+        ibl_bake_texture texture;
+        texture.width           = tex_header.width;
+        texture.height          = tex_header.height;
+        texture.faces           = tex_header.faces;
+        texture.miplevels       = tex_header.miplevels;
+        texture.bytes_per_texel = tex_header.bytes_per_texel;
+        texture.texture_format  = static_cast<gfx_format>(tex_header.texture_format);
+        texture.pixel_format    = static_cast<gfx_format>(tex_header.pixel_format);
+        texture.component_type  = static_cast<gfx_format>(tex_header.component_type);
+
+        valid = texture.width > 0 && texture.height > 0 && texture.faces > 0 && texture.miplevels > 0 && texture.bytes_per_texel > 0 &&
+                static_cast<uint64>(texture.level_offset(texture.miplevels)) == tex_header.size;
+        if (!valid)
+            break;
+
+        texture.data.resize(tex_header.size);
+        input.read(reinterpret_cast<char*>(texture.data.data()), tex_header.size);
+        valid = input.good();
+
+        textures.push_back(std::move(texture));
+    }
+    input.close();
+
+    if (!valid)
+    {
+        // Broken or outdated bake. Delete it, it gets baked and stored again.
+        MANGO_LOG_DEBUG("Ibl bake '{0}' is stale and gets baked again.", path);
+        std::remove(path.c_str());
+        textures.clear();
+    }
+
+    return valid;
+}
+
+void ibl_bake_cache::store(uint64 key, const std::vector<ibl_bake_texture>& textures)
+{
+    if (!m_enabled || textures.empty())
+        return;
+
+    bake_header header;
+    header.magic         = ibl_bake_magic;
+    header.version       = ibl_bake_version;
+    header.key           = key;
+    header.texture_count = static_cast<uint32>(textures.size());
+
+    // Written to a temporary file first, so that a crash never leaves a partial bake behind.
+    string path      = file_path(key);
+    string temp_path = path + ".tmp";
+    std::ofstream output(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+        return;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(bake_header));
+
+    for (const ibl_bake_texture& texture : textures)
+    {
+        MANGO_ASSERT(static_cast<int64>(texture.data.size()) == texture.level_offset(texture.miplevels), "Baked texture data does not match the layout!");
+
+        texture_header tex_header;
+        tex_header.width           = texture.width;
+        tex_header.height          = texture.height;
+        tex_header.faces           = texture.faces;
+        tex_header.miplevels       = texture.miplevels;
+        tex_header.bytes_per_texel = texture.bytes_per_texel;
+        tex_header.texture_format  = static_cast<uint32>(texture.texture_format);
+        tex_header.pixel_format    = static_cast<uint32>(texture.pixel_format);
+        tex_header.component_type  = static_cast<uint32>(texture.component_type);
+        tex_header.size            = texture.data.size();
+
+        output.write(reinterpret_cast<const char*>(&tex_header), sizeof(texture_header));
+        output.write(reinterpret_cast<const char*>(texture.data.data()), texture.data.size());
+    }
+    output.close();
+
+    std::remove(path.c_str());
+    if (!output.good() || std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        MANGO_LOG_WARN("Could not write ibl bake '{0}'.", path);
+        std::remove(temp_path.c_str());
+    }
+}
+
+string ibl_bake_cache::file_path(uint64 key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.ibl", static_cast<unsigned long long>(key));
+    return m_directory + name;
+}
@@ -0,0 +1,121 @@
+//! \file      ibl_bake_cache.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_IBL_BAKE_CACHE_HPP
+#define MANGO_IBL_BAKE_CACHE_HPP
+
+#include <graphics/graphics.hpp>
+
+namespace mango
+{
+    //! \brief A baked texture with its complete mip chain.
+    struct ibl_bake_texture
+    {
+        int32 width;               //!< The width of the first level in pixels.
+        int32 height;              //!< The height of the first level in pixels.
+        int32 faces;               //!< The number of faces or layers. 6 for cubemaps.
+        int32 miplevels;           //!< The number of stored mip levels.
+        int32 bytes_per_texel;     //!< The size of one texel in bytes.
+        gfx_format texture_format; //!< The internal \a gfx_format of the texture.
+        gfx_format pixel_format;   //!< The pixel \a gfx_format of the stored data.
+        gfx_format component_type; //!< The \a gfx_format of each component of the stored data.
+        std::vector<uint8> data;   //!< The texel data of all levels, beginning with level 0. Faces are stored consecutive in each level.
+
+        //! \brief Calculates the size of one mip level.
+        //! \param[in] level The mip level.
+        //! \return The size of the level with all faces in bytes.
+        inline int64 level_size(int32 level) const
+        {
+            int64 w = std::max(1, width >> level);
+            int64 h = std::max(1, height >> level);
+            return w * h * faces * bytes_per_texel;
+        }
+
+        //! \brief Calculates the offset of a mip level in the data.
+        //! \param[in] level The mip level.
+        //! \return The offset of the level in bytes.
+        inline int64 level_offset(int32 level) const
+        {
+            int64 offset = 0;
+            for (int32 i = 0; i < level; ++i)
+                offset += level_size(i);
+            return offset;
+        }
+    };
+
+    //! \brief On disk cache for baked image based lighting textures.
+    //! \details Stores baked textures with all mip levels in the layout they get uploaded with, so that loading does not require any conversion.
+    //! Bakes are keyed by the content of the source file and all parameters changing the result. Files with a different key or layout are deleted and have to be baked again.
+    class ibl_bake_cache
+    {
+      public:
+        //! \brief Constructs the \a ibl_bake_cache.
+        //! \param[in] directory The directory to store the bakes in.
+        ibl_bake_cache(const string& directory);
+        ~ibl_bake_cache();
+
+        //! \brief Creates the key for a bake.
+        //! \param[in] source_path The path of the source file the bake is created from. The content of the file is hashed. Can be empty for bakes without source.
+        //! \param[in] parameters Pointer to the parameters changing the bake.
+        //! \param[in] parameter_count The number of parameters.
+        //! \return The key of the bake or 0 if the source file can not be read.
+        uint64 create_key(const string& source_path, const uint64* parameters, int32 parameter_count) const;
+
+        //! \brief Loads a bake from the cache.
+        //! \param[in] key The key of the bake. Should be created with create_key().
+        //! \param[out] textures The baked textures.
+        //! \return True if a valid bake was loaded, else false.
+        bool load(uint64 key, std::vector<ibl_bake_texture>& textures);
+
+        //! \brief Stores a bake in the cache.
+        //! \param[in] key The key of the bake. Should be created with create_key().
+        //! \param[in] textures The baked textures.
+        void store(uint64 key, const std::vector<ibl_bake_texture>& textures);
+
+        //! \brief Checks if the \a ibl_bake_cache is usable.
+        //! \return True if the cache directory exists, else false.
+        inline bool is_enabled() const
+        {
+            return m_enabled;
+        }
+
+      private:
+        //! \brief Header in front of each stored bake.
+        struct bake_header
+        {
+            uint32 magic;         //!< Identifies the file as ibl bake.
+            uint32 version;       //!< The version of the file layout.
+            uint64 key;           //!< The key of the bake.
+            uint32 texture_count; //!< The number of textures following the header.
+        };
+
+        //! \brief Header in front of each stored texture.
+        struct texture_header
+        {
+            int32 width;           //!< The width of the first level in pixels.
+            int32 height;          //!< The height of the first level in pixels.
+            int32 faces;           //!< The number of faces or layers.
+            int32 miplevels;       //!< The number of stored mip levels.
+            int32 bytes_per_texel; //!< The size of one texel in bytes.
+            uint32 texture_format; //!< The internal \a gfx_format of the texture.
+            uint32 pixel_format;   //!< The pixel \a gfx_format of the stored data.
+            uint32 component_type; //!< The \a gfx_format of each component of the stored data.
+            uint64 size;           //!< The size of the data following the header in bytes.
+        };
+
+        //! \brief Returns the file path for a key.
+        //! \param[in] key The key of the bake.
+        //! \return The path of the bake file.
+        string file_path(uint64 key) const;
+
+        //! \brief The directory to store the bakes in.
+        string m_directory;
+        //! \brief True if the cache directory exists, else false.
+        bool m_enabled;
+    };
+} // namespace mango
+
+#endif // MANGO_IBL_BAKE_CACHE_HPP
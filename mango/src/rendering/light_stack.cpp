@@ -4,15 +4,70 @@
 //! \date      2021
 //! \copyright Apache License 2.0
 
+#include <cstring>
 #include <mango/profile.hpp>
+#include <new>
 #include <rendering/light_stack.hpp>
 #include <resources/resources_impl.hpp>
+#include <util/hashing.hpp>
 #include <util/helpers.hpp>
 
 using namespace mango;
 
-light_stack::light_stack()
-    : m_allocator(524288) // 0.5 MiB
+//! \brief Hashes all parameters of a \a directional_light contributing to the light data.
+//! \param[in] light The \a directional_light.
+//! \return The hash.
+static uint64 hash_light(const directional_light& light)
+{
+    uint64 key = fnv1a_hash::hash(&light.direction, sizeof(vec3));
+    key        = fnv1a_hash::hash(&light.color.values, sizeof(vec3), key);
+    key        = fnv1a_hash::hash(&light.intensity, sizeof(float), key);
+    key        = fnv1a_hash::hash(&light.cast_shadows, sizeof(bool), key);
+    key        = fnv1a_hash::hash(&light.contribute_to_atmosphere, sizeof(bool), key);
+    return key;
+}
+
+//! \brief Hashes all parameters of a \a skylight contributing to the light data.
+//! \param[in] light The \a skylight.
+//! \return The hash.
+static uint64 hash_light(const skylight& light)
+{
+    uint32 texture_id = light.hdr_texture.id().get();
+    uint64 key        = fnv1a_hash::hash(&texture_id, sizeof(uint32));
+    key               = fnv1a_hash::hash(&light.intensity, sizeof(float), key);
+    key               = fnv1a_hash::hash(&light.use_texture, sizeof(bool), key);
+    key               = fnv1a_hash::hash(&light.dynamic, sizeof(bool), key);
+    key               = fnv1a_hash::hash(&light.local, sizeof(bool), key);
+    return key;
+}
+
+//! \brief Hashes all parameters of an \a atmospheric_light.
+//! \param[in] light The \a atmospheric_light.
+//! \return The hash.
+static uint64 hash_light(const atmospheric_light& light)
+{
+    uint64 key = fnv1a_hash::hash(&light.intensity_multiplier, sizeof(float));
+    key        = fnv1a_hash::hash(&light.scatter_points, sizeof(int32), key);
+    key        = fnv1a_hash::hash(&light.scatter_points_second_ray, sizeof(int32), key);
+    key        = fnv1a_hash::hash(&light.rayleigh_scattering_coefficients, sizeof(vec3), key);
+    key        = fnv1a_hash::hash(&light.mie_scattering_coefficient, sizeof(float), key);
+    key        = fnv1a_hash::hash(&light.density_multiplier, sizeof(vec2), key);
+    key        = fnv1a_hash::hash(&light.ground_radius, sizeof(float), key);
+    key        = fnv1a_hash::hash(&light.atmosphere_radius, sizeof(float), key);
+    key        = fnv1a_hash::hash(&light.view_height, sizeof(float), key);
+    key        = fnv1a_hash::hash(&light.mie_preferred_scattering_dir, sizeof(float), key);
+    return key;
+}
+
+light_stack::light_stack(allocator_strategy strategy)
+    : m_allocator(create_allocator(strategy, 524288)) // 0.5 MiB
+    , m_frame(0)
+    , m_used_entries(0)
+    , m_light_data_changed(true)
+    , m_sky_changed(false)
+    , m_punctual_dirty_begin(0)
+    , m_punctual_dirty_end(0)
+    , m_punctual_limit_warned(false)
 {
     m_current_light_data.directional_light.direction    = vec3(0.5f, 0.5f, 0.5f);
     m_current_light_data.directional_light.color        = vec3(1.0f);
@@ -22,246 +77,523 @@ light_stack::light_stack()
 
     m_current_light_data.skylight.intensity = default_skylight_intensity;
     m_current_light_data.skylight.valid     = false;
+
+    m_current_light_data.punctual_light_count = 0;
 }
 
-light_stack::~light_stack() {}
+light_stack::~light_stack()
+{
+    for (auto& c : m_light_cache)
+        release_render_data(c.second);
+    m_punctual_lights.clear();
+    m_punctual_light_ids.clear();
+    m_light_cache.clear();
+}
 
 bool light_stack::init(const shared_ptr<context_impl>& context)
 {
-    m_allocator.init();
+    m_allocator->init();
     m_shared_context = context;
 
     if (!m_skylight_builder.init(m_shared_context))
         return false;
 
-    // success &= m_atmosphere_builder.init();
+    if (!m_atmosphere_builder.init(m_shared_context))
+        return false;
+
+    auto& graphics_device    = m_shared_context->get_graphics_device();
+    auto& internal_resources = m_shared_context->get_internal_resources();
+
+    buffer_create_info buffer_info;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+    buffer_info.size          = max_punctual_lights * sizeof(punctual_light_data);
+
+    m_punctual_light_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_punctual_light_buffer.get(), "punctual light buffer"))
+        return false;
+
+    // counts for all clusters followed by the light indices of all clusters.
+    int32 cluster_count       = cluster_count_x * cluster_count_y * cluster_count_z;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_none;
+    buffer_info.size          = cluster_count * (1 + max_lights_per_cluster) * sizeof(uint32);
+
+    m_light_cluster_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_light_cluster_buffer.get(), "light cluster buffer"))
+        return false;
+
+    shader_stage_create_info shader_info;
+    shader_resource_resource_description res_resource_desc;
+    shader_source_description source_desc;
+
+    res_resource_desc.path        = "res/shader/light_clustering/c_light_clustering.glsl";
+    const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+    source_desc.entry_point = "main";
+    source_desc.source      = source->source.c_str();
+    source_desc.size        = static_cast<int32>(source->source.size());
+
+    shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+    shader_info.shader_source = source_desc;
+
+    shader_info.resource_count = 4;
+
+    shader_info.resources = { {
+        { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        { gfx_shader_stage_type::shader_stage_compute, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        { gfx_shader_stage_type::shader_stage_compute, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, "punctual_light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        { gfx_shader_stage_type::shader_stage_compute, LIGHT_CLUSTER_BUFFER_BINDING_POINT, "light_cluster_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+    } };
+
+    auto light_clustering_compute = graphics_device->create_shader_stage(shader_info);
+    if (!check_creation(light_clustering_compute.get(), "light clustering compute shader"))
+        return false;
+
+    compute_pipeline_create_info light_clustering_pass_info = graphics_device->provide_compute_pipeline_create_info();
+    auto light_clustering_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+        { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+          gfx_shader_resource_access::shader_access_dynamic },
+        { gfx_shader_stage_type::shader_stage_compute, LIGHT_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+          gfx_shader_resource_access::shader_access_dynamic },
+        { gfx_shader_stage_type::shader_stage_compute, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+          gfx_shader_resource_access::shader_access_dynamic },
+        { gfx_shader_stage_type::shader_stage_compute, LIGHT_CLUSTER_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+          gfx_shader_resource_access::shader_access_dynamic },
+    });
+
+    light_clustering_pass_info.pipeline_layout = light_clustering_pass_pipeline_layout;
+
+    light_clustering_pass_info.shader_stage_descriptor.compute_shader_stage = light_clustering_compute;
+
+    m_light_clustering_pipeline = graphics_device->create_compute_pipeline(light_clustering_pass_info);
+    if (!check_creation(m_light_clustering_pipeline.get(), "light clustering pipeline"))
+        return false;
+
+    m_punctual_lights.reserve(max_punctual_lights);
+    m_punctual_light_ids.reserve(max_punctual_lights);
 
     return true;
 }
 
-void light_stack::push(const scene_light& light)
+void light_stack::push(const sid& id, scene_light& light, const mat4& world_transformation)
 {
+    vec3 position = vec3(world_transformation[3]);
     // push to correct stack
     switch (light.type)
     {
     case light_type::directional:
-        m_directional_stack.emplace_back(light.public_data_as_directional_light.value());
+        m_directional_stack.push_back({ id, light.public_data_as_directional_light.value(), light.public_data_as_directional_light->dirty(), position });
         break;
     case light_type::atmospheric:
-        m_atmosphere_stack.emplace_back(light.public_data_as_atmospheric_light.value());
+        m_atmosphere_stack.push_back({ id, light.public_data_as_atmospheric_light.value(), light.public_data_as_atmospheric_light->dirty(), position });
         break;
     case light_type::skylight:
-        m_skylight_stack.emplace_back(light.public_data_as_skylight.value());
+        m_skylight_stack.push_back({ id, light.public_data_as_skylight.value(), light.public_data_as_skylight->dirty(), position });
+        break;
+    case light_type::point:
+        m_point_stack.push_back({ id, light.public_data_as_point_light.value(), light.public_data_as_point_light->dirty(), position });
+        break;
+    case light_type::spot:
+    {
+        // The direction is given in the space of the containing node, like the position.
+        spot_light spot = light.public_data_as_spot_light.value();
+        spot.direction  = mat3(world_transformation) * spot.direction;
+        m_spot_stack.push_back({ id, spot, light.public_data_as_spot_light->dirty(), position });
         break;
+    }
     default:
         break;
     }
+    light.changes_handled();
 }
 
 void light_stack::update(scene_impl* scene)
 {
     PROFILE_ZONE;
     GL_NAMED_PROFILE_ZONE("Light Stack Update");
-    for (auto& c : m_light_cache)
-        c.second.expired = true;
+    m_frame++;
+    m_used_entries       = 0;
+    m_light_data_changed = false;
 
     m_current_shadow_casters.clear();
-    m_last_skylight = m_global_skylight;
-    m_global_skylight = 0;
+    sid last_skylight = m_global_skylight;
+    m_global_skylight = invalid_sid;
 
     // order is important!
     update_directional_lights();
-    // update_atmosphere_lights();
+    update_atmosphere_lights();
     update_skylights(scene);
+    update_punctual_lights();
 
-    for (auto it = m_light_cache.begin(); it != m_light_cache.end();)
+    // Only search for removed lights when not all cache entries got used.
+    if (m_used_entries != static_cast<int64>(m_light_cache.size()))
     {
-        if (it->second.expired)
+        for (auto it = m_light_cache.begin(); it != m_light_cache.end();)
         {
-            if (it->second.data)
-                m_allocator.free_memory(it->second.data);
-            it->second.data = nullptr;
-
-            it = m_light_cache.erase(it);
+            if (it->second.last_frame != m_frame)
+            {
+                if (it->second.type != light_type::atmospheric)
+                    m_light_data_changed = true;
+                release_punctual_slot(it->second);
+                release_render_data(it->second);
+                it = m_light_cache.erase(it);
+            }
+            else
+                it++;
         }
-        else
-            it++;
+    }
+
+    if (last_skylight != m_global_skylight)
+        m_light_data_changed = true;
+    if (m_light_data_changed)
+        update_light_data();
+
+    // Builds are time sliced, the active maps are only replaced when the new ones are complete.
+    m_skylight_builder.execute_pending_work();
+    auto global = m_light_cache.find(m_global_skylight);
+    if (global == m_light_cache.end() || !global->second.data)
+        m_active_skylight = skylight_cache();
+    else
+    {
+        skylight_cache* data = static_cast<skylight_cache*>(global->second.data);
+        if (!m_skylight_builder.is_building(data))
+            m_active_skylight = *data;
     }
 
     m_directional_stack.clear();
     m_atmosphere_stack.clear();
     m_skylight_stack.clear();
+    m_point_stack.clear();
+    m_spot_stack.clear();
+}
+
+void light_stack::cluster_lights(const graphics_device_context_handle& device_context, gfx_handle<const gfx_buffer> camera_data_buffer, gfx_handle<const gfx_buffer> light_data_buffer)
+{
+    PROFILE_ZONE;
+    GL_NAMED_PROFILE_ZONE("Light Clustering");
+
+    // Only changed slots are uploaded, static lights do not cost any bandwidth.
+    m_punctual_dirty_end = std::min(m_punctual_dirty_end, static_cast<int32>(m_punctual_lights.size()));
+    if (m_punctual_dirty_end > m_punctual_dirty_begin)
+    {
+        int32 offset = m_punctual_dirty_begin * static_cast<int32>(sizeof(punctual_light_data));
+        int32 size   = (m_punctual_dirty_end - m_punctual_dirty_begin) * static_cast<int32>(sizeof(punctual_light_data));
+        device_context->set_buffer_data(m_punctual_light_buffer, offset, size, &m_punctual_lights[m_punctual_dirty_begin]);
+    }
+    m_punctual_dirty_begin = 0;
+    m_punctual_dirty_end   = 0;
+
+    // The lights are binned every frame, since the clusters depend on the camera.
+    if (m_punctual_lights.empty())
+        return;
+
+    device_context->bind_pipeline(m_light_clustering_pipeline);
+    m_light_clustering_pipeline->get_resource_mapping()->set("camera_data", camera_data_buffer);
+    m_light_clustering_pipeline->get_resource_mapping()->set("light_data", light_data_buffer);
+    m_light_clustering_pipeline->get_resource_mapping()->set("punctual_light_data", m_punctual_light_buffer);
+    m_light_clustering_pipeline->get_resource_mapping()->set("light_cluster_data", m_light_cluster_buffer);
+    device_context->submit_pipeline_state_resources();
+
+    // one thread per cluster, 4 depth slices per group.
+    device_context->dispatch(1, 1, cluster_count_z / 4);
+
+    barrier_description bd;
+    bd.barrier_bit = gfx_barrier_bit::shader_storage_barrier_bit;
+    device_context->barrier(bd);
 }
 
 void light_stack::update_directional_lights()
 {
     for (auto& d : m_directional_stack)
     {
-        int64 checksum = calculate_checksum(reinterpret_cast<uint8*>(&d.cast_shadows), sizeof(bool));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&d.color), sizeof(color_rgb));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&d.contribute_to_atmosphere), sizeof(bool));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&d.direction), sizeof(vec3));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&d.intensity), sizeof(float));
-
-        // find in light cache
-        auto entry = m_light_cache.find(checksum);
-        bool found = entry != m_light_cache.end();
-        if (found)
-            m_light_cache.at(checksum).expired = false;
-
-        // create light cache entry if non existent or update it on change
-        if (!found)
-        {
-            cache_entry new_entry;
-            new_entry.expired = false;
-            // No additional render data required for directional lights.
-            m_light_cache.insert({ checksum, new_entry });
-        }
+        bool created;
+        cache_entry& entry = acquire_entry(d.id, light_type::directional, created);
+        // No additional render data required for directional lights.
+        // Fields can be changed without update(), so they are compared as well.
+        uint64 data_key = hash_light(d.light);
+        if (created || d.dirty || entry.data_key != data_key)
+            m_light_data_changed = true;
+        entry.data_key = data_key;
     }
 
     if (m_directional_stack.empty())
         return;
     // atm there is only one directional light bound :D
-    const auto& light                                   = m_directional_stack.back();
-    m_current_light_data.directional_light.valid        = true;
-    m_current_light_data.directional_light.direction    = light.direction;
-    m_current_light_data.directional_light.color        = light.color.values;
-    m_current_light_data.directional_light.intensity    = light.intensity;
-    m_current_light_data.directional_light.cast_shadows = light.cast_shadows;
+    const auto& light = m_directional_stack.back().light;
     if (light.cast_shadows)
         m_current_shadow_casters.push_back(light);
 }
 
 void light_stack::update_atmosphere_lights()
 {
-    // TODO Paul: TBD!
+    m_sky_changed                = false;
+    atmosphere_cache* atmosphere = nullptr;
     for (auto& a : m_atmosphere_stack)
     {
-        int64 checksum = 0; // calculate_checksum(...)
-
-        // find in light cache
-        auto entry = m_light_cache.find(checksum);
-        bool found = entry != m_light_cache.end();
-        if (found)
-            m_light_cache.at(checksum).expired = false;
-
-        MANGO_UNUSED(a);
-
-        // check dependencies
-        // (dependencies are only directional lights for now)
-        // Cases:
-        // Dependency added -> a.dirty |= d.dirty
-        // Dependency still here -> a.dirty |= d.dirty
-        // Dependency removed -> new_dependency size smaller -> a.dirty = true
-        // Dependency removed but other added -> new_dependency size the same -> a.dirty |= d.dirty (= true, because light is new)
-
-        /*
-                std::vector<entity> new_dependencies;
-                for (auto& d : directional_stack)
-                {
-                    auto data = static_cast<directional_light_component*>(d.light_pointer);
-                    if (data->atmospherical)
-                    {
-                        new_dependencies.push_back(d.light_entity);
-                        a.dirty |= d.dirty;
-                    }
-                }
-
-        if (found && new_dependencies.size() != entry->second.dependencies.size())
-            a.dirty = true;
-
-
-        // create light cache entry if non existent or update it on change
-        if (a.dirty)
+        bool created;
+        cache_entry& entry = acquire_entry(a.id, light_type::atmospheric, created);
+        uint64 data_key    = hash_light(a.light);
+        bool changed       = created || a.dirty || entry.data_key != data_key;
+        entry.data_key     = data_key;
+        if (!changed)
         {
-            // recreate atmosphere LUTs
-            // auto light                    = static_cast<atmosphere_light*>(a.light);
-            atmosphere_cache* cached_data = static_cast<atmosphere_cache*>(m_allocator.allocate(sizeof(atmosphere_cache)));
-            MANGO_ASSERT(cached_data, "Light Stack Out Of Memory!");
-            // (cached_data, 0, sizeof(atmosphere_cache));
-            // m_atmosphere_builder.build(light, cached_data);
-
-            if (found)
-            {
-                m_light_cache.at(a.id).light_checksum = checksum;
-                m_allocator.free_memory(m_light_cache.at(a.id).data);
-                m_light_cache.at(a.id).data = cached_data;
-            }
-            else
-            {
-                cache_entry new_entry;
-                new_entry.light_checksum = checksum;
-                new_entry.data           = cached_data;
-                new_entry.expired        = false;
-                m_light_cache.insert({ a.id, new_entry });
-            }
+            if (!atmosphere)
+                atmosphere = static_cast<atmosphere_cache*>(entry.data);
+            continue;
         }
-        */
+
+        // The lookups only depend on the scattering parameters, the intensity only changes the sky.
+        uint64 build_key = fnv1a_hash::hash(&a.light.scatter_points, sizeof(int32));
+        build_key        = fnv1a_hash::hash(&a.light.rayleigh_scattering_coefficients, sizeof(vec3), build_key);
+        build_key        = fnv1a_hash::hash(&a.light.mie_scattering_coefficient, sizeof(float), build_key);
+        build_key        = fnv1a_hash::hash(&a.light.density_multiplier, sizeof(vec2), build_key);
+        build_key        = fnv1a_hash::hash(&a.light.ground_radius, sizeof(float), build_key);
+        build_key        = fnv1a_hash::hash(&a.light.atmosphere_radius, sizeof(float), build_key);
+        build_key        = fnv1a_hash::hash(&a.light.view_height, sizeof(float), build_key);
+        build_key        = fnv1a_hash::hash(&a.light.mie_preferred_scattering_dir, sizeof(float), build_key);
+
+        if (created)
+        {
+            void* memory = m_allocator->allocate(sizeof(atmosphere_cache));
+            MANGO_ASSERT(memory, "Light Stack Out Of Memory!");
+            entry.data = new (memory) atmosphere_cache();
+        }
+
+        atmosphere_cache* data = static_cast<atmosphere_cache*>(entry.data);
+        if (created || entry.build_key != build_key)
+            m_atmosphere_builder.build(nullptr, a.light, data);
+        else
+            data->parameters = a.light;
+        entry.build_key = build_key;
+
+        // atm there is only one atmosphere :D
+        if (!atmosphere)
+            atmosphere = data;
+    }
+
+    if (!atmosphere)
+    {
+        m_skylight_builder.set_sky_cubemap(nullptr, 0);
+        return;
+    }
+
+    // The sky only depends on the directional light contributing to the atmosphere.
+    for (auto& d : m_directional_stack)
+    {
+        if (!d.light.contribute_to_atmosphere)
+            continue;
+
+        m_sky_changed = m_atmosphere_builder.update_sky(d.light, atmosphere);
+        break;
     }
+
+    m_skylight_builder.set_sky_cubemap(atmosphere->sky_cubemap, atmosphere_builder::sky_cubemap_size);
 }
 
 void light_stack::update_skylights(scene_impl* scene)
 {
     for (auto& s : m_skylight_stack)
     {
-        int64 checksum = calculate_checksum(reinterpret_cast<uint8*>(&s.dynamic), sizeof(bool));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&s.hdr_texture), sizeof(sid));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&s.intensity), sizeof(float));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&s.local), sizeof(bool));
-        checksum += calculate_checksum(reinterpret_cast<uint8*>(&s.use_texture), sizeof(bool));
-
-        if(m_global_skylight == 0)
-            m_global_skylight = checksum;
-
-        // find in light cache
-        auto entry = m_light_cache.find(checksum);
-        bool found = entry != m_light_cache.end();
-        if (found)
-            m_light_cache.at(checksum).expired = false;
-
-        // if skylight captures (does not depend on hdr image) check dependencies
-        // (dependencies are only atmosphere lights for now)
-
-        // if (!s.use_texture)
-        // {
-        //     for (auto& a : m_atmosphere_stack)
-        //     {
-        //         // m_skylight_builder.add_atmosphere_influence(static_cast<atmosphere_light*>(a.light));
-        //         s.dirty |= a.dirty;
-        //     }
-        //     s.dirty |= m_skylight_builder.needs_rebuild();
-        // }
-
-        // create light cache entry if non existent or update it on change
-        if (!found)
+        if (m_global_skylight == invalid_sid)
+            m_global_skylight = s.id;
+
+        bool created;
+        cache_entry& entry = acquire_entry(s.id, light_type::skylight, created);
+        uint64 data_key    = hash_light(s.light);
+        if (created || s.dirty || entry.data_key != data_key)
+            m_light_data_changed = true;
+        entry.data_key = data_key;
+
+        // Only the source of the maps requires a rebuild, the intensity is applied when shading.
+        uint64 build_key = fnv1a_hash::hash(&s.light.use_texture, sizeof(bool));
+        if (s.light.use_texture)
+        {
+            uint32 texture_id = s.light.hdr_texture.id().get();
+            build_key         = fnv1a_hash::hash(&texture_id, sizeof(uint32), build_key);
+        }
+
+        bool rebuild = created || entry.build_key != build_key;
+        // skylights without texture capture the sky and have to be rebuilt when it changes
+        rebuild |= !s.light.use_texture && m_sky_changed;
+
+        if (created)
+        {
+            void* memory = m_allocator->allocate(sizeof(skylight_cache));
+            MANGO_ASSERT(memory, "Light Stack Out Of Memory!");
+            entry.data = new (memory) skylight_cache();
+        }
+
+        if (rebuild)
+            m_skylight_builder.build(scene, s.light, static_cast<skylight_cache*>(entry.data));
+        entry.build_key = build_key;
+    }
+}
+
+void light_stack::update_punctual_lights()
+{
+    int32 count = static_cast<int32>(m_punctual_lights.size());
+
+    for (auto& p : m_point_stack)
+    {
+        punctual_light_data data;
+        data.position_radius = vec4(p.position, std::max(p.light.radius, 1e-3f));
+        data.color_intensity = vec4(p.light.color.values, p.light.intensity / (4.0f * PI)); // lumen to candela
+        data.direction_type  = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+        data.spot_cone       = vec4(0.0f);
+        write_punctual_light(p.id, light_type::point, data, p.dirty);
+    }
+
+    for (auto& s : m_spot_stack)
+    {
+        float cos_outer = std::cos(std::max(s.light.outer_cone_angle, 1e-3f));
+        float cos_inner = std::cos(glm::clamp(s.light.inner_cone_angle, 0.0f, s.light.outer_cone_angle));
+
+        punctual_light_data data;
+        data.position_radius = vec4(s.position, std::max(s.light.radius, 1e-3f));
+        data.color_intensity = vec4(s.light.color.values, s.light.intensity / PI); // lumen to candela
+        data.direction_type  = vec4(glm::normalize(s.light.direction), 1.0f);
+        data.spot_cone       = vec4(cos_outer, 1.0f / std::max(cos_inner - cos_outer, 1e-4f), 0.0f, 0.0f);
+        write_punctual_light(s.id, light_type::spot, data, s.dirty);
+    }
+
+    if (count != static_cast<int32>(m_punctual_lights.size()))
+        m_light_data_changed = true;
+}
+
+void light_stack::write_punctual_light(const sid& id, light_type type, punctual_light_data data, bool dirty)
+{
+    bool created;
+    cache_entry& entry = acquire_entry(id, type, created);
+
+    if (entry.punctual_slot < 0)
+    {
+        if (static_cast<int32>(m_punctual_lights.size()) >= max_punctual_lights)
         {
-            // recreate skylight cubemaps
-            void* cached_data = m_allocator.allocate(sizeof(skylight_cache));
-            MANGO_ASSERT(cached_data, "Light Stack Out Of Memory!");
-            memset(cached_data, 0, sizeof(skylight_cache));
-            m_skylight_builder.build(scene, s, static_cast<skylight_cache*>(cached_data));
-
-            cache_entry new_entry;
-            new_entry.data    = static_cast<skylight_cache*>(cached_data);
-            new_entry.expired = false;
-            m_light_cache.insert({ checksum, new_entry });
+            if (!m_punctual_limit_warned)
+                MANGO_LOG_WARN("More than {0} point and spot lights in the scene! Skipping remaining lights.", max_punctual_lights);
+            m_punctual_limit_warned = true;
+            return;
         }
 
+        entry.punctual_slot = static_cast<int32>(m_punctual_lights.size());
+        m_punctual_lights.push_back(data);
+        m_punctual_light_ids.push_back(id);
+        mark_punctual_slot(entry.punctual_slot);
+        return;
+    }
+
+    // Moved, rotated or edited lights have to be written again, even if they are not marked dirty.
+    // The data only consists of floats, so comparing the bytes is enough.
+    punctual_light_data& current = m_punctual_lights[entry.punctual_slot];
+    if (!created && !dirty && std::memcmp(&current, &data, sizeof(punctual_light_data)) == 0)
+        return;
+
+    current = data;
+    mark_punctual_slot(entry.punctual_slot);
+}
+
+void light_stack::mark_punctual_slot(int32 slot)
+{
+    if (m_punctual_dirty_end <= m_punctual_dirty_begin)
+    {
+        m_punctual_dirty_begin = slot;
+        m_punctual_dirty_end   = slot + 1;
+        return;
+    }
+    m_punctual_dirty_begin = std::min(m_punctual_dirty_begin, slot);
+    m_punctual_dirty_end   = std::max(m_punctual_dirty_end, slot + 1);
+}
+
+void light_stack::update_light_data()
+{
+    m_current_light_data.directional_light.valid = false;
+    if (!m_directional_stack.empty())
+    {
+        // atm there is only one directional light bound :D
+        const auto& light                                   = m_directional_stack.back().light;
+        m_current_light_data.directional_light.valid        = true;
+        m_current_light_data.directional_light.direction    = light.direction;
+        m_current_light_data.directional_light.color        = light.color.values;
+        m_current_light_data.directional_light.intensity    = light.intensity;
+        m_current_light_data.directional_light.cast_shadows = light.cast_shadows;
+    }
+
+    m_current_light_data.skylight.valid = false;
+    for (auto& s : m_skylight_stack)
+    {
         // atm there is only one skylight bound and ist has to be the global one :D
-        if (!s.local)
+        if (!s.light.local)
         {
             m_current_light_data.skylight.valid     = true;
-            m_current_light_data.skylight.intensity = s.intensity;
+            m_current_light_data.skylight.intensity = s.light.intensity;
         }
     }
+
+    m_current_light_data.punctual_light_count = static_cast<int32>(m_punctual_lights.size());
+}
+
+light_stack::cache_entry& light_stack::acquire_entry(const sid& id, light_type type, bool& created)
+{
+    cache_entry& entry = m_light_cache[id];
+    created            = entry.last_frame == 0 || entry.type != type;
+    if (created)
+    {
+        release_punctual_slot(entry);
+        release_render_data(entry);
+        entry.type      = type;
+        entry.build_key = 0;
+        entry.data_key  = 0;
+    }
+
+    if (entry.last_frame != m_frame)
+        m_used_entries++;
+    entry.last_frame = m_frame;
+    return entry;
+}
+
+void light_stack::release_punctual_slot(cache_entry& entry)
+{
+    if (entry.punctual_slot < 0)
+        return;
+
+    int32 slot          = entry.punctual_slot;
+    int32 last          = static_cast<int32>(m_punctual_lights.size()) - 1;
+    entry.punctual_slot = -1;
+
+    if (slot != last)
+    {
+        m_punctual_lights[slot]    = m_punctual_lights[last];
+        m_punctual_light_ids[slot] = m_punctual_light_ids[last];
+        auto moved                 = m_light_cache.find(m_punctual_light_ids[slot]);
+        MANGO_ASSERT(moved != m_light_cache.end(), "Punctual light slot without cache entry!");
+        moved->second.punctual_slot = slot;
+        mark_punctual_slot(slot);
+    }
+    m_punctual_lights.pop_back();
+    m_punctual_light_ids.pop_back();
 }
 
-int64 light_stack::calculate_checksum(uint8* bytes, int64 size)
+void light_stack::release_render_data(cache_entry& entry)
 {
-    int64 sum = 0;
-    for (int64 i = 0; i < size; ++i)
+    if (!entry.data)
+        return;
+
+    switch (entry.type)
     {
-        sum += bytes[i];
+    case light_type::atmospheric:
+        static_cast<atmosphere_cache*>(entry.data)->~atmosphere_cache();
+        break;
+    case light_type::skylight:
+    {
+        skylight_cache* data = static_cast<skylight_cache*>(entry.data);
+        m_skylight_builder.cancel(data);
+        data->~skylight_cache();
+        break;
     }
-    return sum;
+    default:
+        break;
+    }
+
+    m_allocator->free_memory(entry.data);
+    entry.data = nullptr;
 }
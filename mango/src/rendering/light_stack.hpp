@@ -7,7 +7,7 @@
 #ifndef MANGO_LIGHT_STACK_HPP
 #define MANGO_LIGHT_STACK_HPP
 
-#include <memory/free_list_allocator.hpp>
+#include <memory/allocator_factory.hpp>
 #include <rendering/render_data_builder.hpp>
 #include <rendering/renderer_impl.hpp>
 #include <scene/scene_internals.hpp>
@@ -20,7 +20,8 @@ namespace mango
     {
       public:
         //! \brief Constructs a new \a light_stack.
-        light_stack();
+        //! \param[in] strategy The \a allocator_strategy used for the render data.
+        light_stack(allocator_strategy strategy = allocator_strategy::two_level_segregated_fit);
         ~light_stack();
 
         //! \brief Initializes the light stack.
@@ -29,13 +30,37 @@ namespace mango
         bool init(const shared_ptr<context_impl>& context);
 
         //! \brief Pushes a light on the stack.
+        //! \details The changes of the light are handled by the stack and marked as handled.
+        //! \param[in] id The \a sid of the light.
         //! \param[in] light A reference to the \a scene_light to push.
-        void push(const scene_light& light);
+        //! \param[in] world_transformation The global transformation of the node containing the light. Positions point and spot lights.
+        void push(const sid& id, scene_light& light, const mat4& world_transformation);
 
         //! \brief Updates the stack.
         //! \param[in] scene A pointer to the current scene.
         void update(scene_impl* scene);
 
+        //! \brief Uploads changed point and spot lights and bins them into the light clusters.
+        //! \details Has to be called after the update and after the camera data for the frame is set.
+        //! \param[in] device_context The \a graphics_device_context to record the commands to.
+        //! \param[in] camera_data_buffer The buffer containing the \a camera_data of the frame.
+        //! \param[in] light_data_buffer The buffer containing the current \a light_data.
+        void cluster_lights(const graphics_device_context_handle& device_context, gfx_handle<const gfx_buffer> camera_data_buffer, gfx_handle<const gfx_buffer> light_data_buffer);
+
+        //! \brief Returns a handle to the buffer containing the \a punctual_light_data of all point and spot lights.
+        //! \return A \a gfx_handle of the punctual light buffer.
+        inline gfx_handle<const gfx_buffer> get_punctual_light_buffer()
+        {
+            return m_punctual_light_buffer;
+        }
+
+        //! \brief Returns a handle to the buffer containing the light counts and light indices for each cluster.
+        //! \return A \a gfx_handle of the light cluster buffer.
+        inline gfx_handle<const gfx_buffer> get_light_cluster_buffer()
+        {
+            return m_light_cluster_buffer;
+        }
+
         //! \brief Retrieves the current \a light_data of the \a light_stack.
         //! \return The current \a light_data of the \a light_stack.
         inline light_data& get_light_data()
@@ -43,6 +68,14 @@ namespace mango
             return m_current_light_data;
         }
 
+        //! \brief Checks if the \a light_data changed in the last update.
+        //! \details The \a light_data only has to be uploaded if it changed.
+        //! \return True if the \a light_data changed, else false.
+        inline bool light_data_changed() const
+        {
+            return m_light_data_changed;
+        }
+
         //! \brief Retrieves all lights casting shadows (atm only directional lights).
         //! \return A vector of lights that cast shadows.
         inline std::vector<directional_light> get_shadow_casters()
@@ -54,24 +87,14 @@ namespace mango
         //! \return A \a gfx_handle of the skylight irradiance map.
         inline gfx_handle<const gfx_texture> get_skylight_irradiance_map()
         {
-            auto entry = m_light_cache.find(m_global_skylight);
-            if (entry != m_light_cache.end())
-            {
-                return static_cast<skylight_cache*>(entry->second.data)->irradiance_cubemap;
-            }
-            return nullptr;
+            return m_active_skylight.irradiance_cubemap;
         }
 
         //! \brief Returns a handle to the active skylight radiance map.
         //! \return A \a gfx_handle of the skylight radiance map.
         inline gfx_handle<const gfx_texture> get_skylight_specular_prefilter_map()
         {
-            auto entry = m_light_cache.find(m_global_skylight);
-            if (entry != m_light_cache.end())
-            {
-                return static_cast<skylight_cache*>(entry->second.data)->specular_prefiltered_cubemap;
-            }
-            return nullptr;
+            return m_active_skylight.specular_prefiltered_cubemap;
         }
 
         //! \brief Returns a handle to the skylight brdf lookup.
@@ -81,6 +104,17 @@ namespace mango
             return m_skylight_builder.get_skylight_brdf_lookup();
         }
 
+        //! \brief The number of clusters in x direction. Has to match light_clusters.glsl.
+        static const int32 cluster_count_x = 16;
+        //! \brief The number of clusters in y direction. Has to match light_clusters.glsl.
+        static const int32 cluster_count_y = 9;
+        //! \brief The number of exponential depth slices. Has to match light_clusters.glsl.
+        static const int32 cluster_count_z = 24;
+        //! \brief The maximum number of lights binned into one cluster. Has to match light_clusters.glsl.
+        static const int32 max_lights_per_cluster = 128;
+        //! \brief The maximum number of point and spot lights.
+        static const int32 max_punctual_lights = 8192;
+
       private:
         //! \brief Mangos internal context for shared usage.
         shared_ptr<context_impl> m_shared_context;
@@ -88,8 +122,22 @@ namespace mango
         //! \brief A light render data cache entry.
         struct cache_entry
         {
-            light_render_data* data = nullptr; //!< Pointer to render data.
-            bool expired;                      //!< True if the cache entry is expired, else false.
+            light_type type         = light_type::directional; //!< The \a light_type of the light.
+            light_render_data* data = nullptr;                 //!< Pointer to render data.
+            uint64 build_key        = 0;                       //!< Hash of the parameters the render data got built with.
+            uint64 data_key         = 0;                       //!< Hash of all parameters of the light when it got pushed the last time.
+            int64 last_frame        = 0;                       //!< The last frame the light got pushed. 0 if the entry is new.
+            int32 punctual_slot     = -1;                      //!< The index in the punctual light buffer. -1 for other lights.
+        };
+
+        //! \brief A light pushed on the stack for the current frame.
+        template <typename T>
+        struct pushed_light
+        {
+            sid id;        //!< The \a sid of the light.
+            T light;       //!< The public light data.
+            bool dirty;    //!< True if the light changed since it got pushed the last time, else false.
+            vec3 position; //!< The world space position of the light. Only used for point and spot lights. Spot light directions are in world space as well.
         };
 
         //! \brief Updates directional lights.
@@ -99,33 +147,69 @@ namespace mango
         //! \brief Updates skylights.
         //! \param[in] scene A pointer to the current scene.
         void update_skylights(scene_impl* scene);
-
-        //! \brief Calculates the checksum of some bytes.
-        //! \param[in] bytes Pointer to the bytes to calculate checksum for.
-        //! \param[in] size The size of the bytes array.
-        //! \return The checksum value.
-        int64 calculate_checksum(uint8* bytes, int64 size); // TODO Paul: Maybe should be moved elsewhere.
+        //! \brief Updates point and spot lights in the punctual light buffer.
+        void update_punctual_lights();
+        //! \brief Writes a point or spot light into its slot of the punctual light buffer, if it changed.
+        //! \param[in] id The \a sid of the light.
+        //! \param[in] type The \a light_type of the light.
+        //! \param[in] data The \a punctual_light_data of the light.
+        //! \param[in] dirty True if the light changed since it got pushed the last time, else false.
+        void write_punctual_light(const sid& id, light_type type, punctual_light_data data, bool dirty);
+        //! \brief Marks a slot of the punctual light buffer to be uploaded.
+        //! \param[in] slot The slot to upload.
+        void mark_punctual_slot(int32 slot);
+        //! \brief Updates the \a light_data from the light stacks.
+        void update_light_data();
+
+        //! \brief Retrieves the cache entry of a light and marks it as used in this frame.
+        //! \details Creates the entry if it does not exist. Entries with a different \a light_type are released and created again.
+        //! \param[in] id The \a sid of the light.
+        //! \param[in] type The \a light_type of the light.
+        //! \param[out] created True if the entry got created, else false.
+        //! \return A reference to the \a cache_entry.
+        cache_entry& acquire_entry(const sid& id, light_type type, bool& created);
+
+        //! \brief Frees the slot of a cache entry in the punctual light buffer.
+        //! \details The last slot is moved into the free one to keep the buffer compact.
+        //! \param[in,out] entry The \a cache_entry to release the slot for.
+        void release_punctual_slot(cache_entry& entry);
+
+        //! \brief Destroys and frees the render data of a cache entry.
+        //! \param[in,out] entry The \a cache_entry to release the render data for.
+        void release_render_data(cache_entry& entry);
 
         //! \brief Directional light stack.
-        std::vector<directional_light> m_directional_stack;
+        std::vector<pushed_light<directional_light>> m_directional_stack;
         //! \brief Atmospheric light stack.
-        std::vector<atmospheric_light> m_atmosphere_stack;
+        std::vector<pushed_light<atmospheric_light>> m_atmosphere_stack;
         //! \brief Skylight stack.
-        std::vector<skylight> m_skylight_stack;
+        std::vector<pushed_light<skylight>> m_skylight_stack;
+        //! \brief Point light stack.
+        std::vector<pushed_light<point_light>> m_point_stack;
+        //! \brief Spot light stack.
+        std::vector<pushed_light<spot_light>> m_spot_stack;
 
         //! \brief The allocator for render data.
-        free_list_allocator m_allocator;
+        unique_ptr<allocator> m_allocator;
 
-        //! \brief The light cache mapping checksum to render data.
-        std::unordered_map<int64, cache_entry> m_light_cache;
+        //! \brief The light cache mapping light \a sids to render data.
+        std::unordered_map<sid, cache_entry, sid_hash> m_light_cache;
+        //! \brief The current frame, used to detect lights that are not pushed anymore.
+        int64 m_frame;
+        //! \brief The number of cache entries used in the current frame.
+        int64 m_used_entries;
 
         //! \brief The current \a light_data.
         light_data m_current_light_data;
 
+        //! \brief True if the current \a light_data changed in the last update, else false.
+        bool m_light_data_changed;
+
         //! \brief The current global active skylight.
-        int64 m_global_skylight;
-        //! \brief The last global active skylight.
-        int64 m_last_skylight;
+        sid m_global_skylight;
+        //! \brief The maps of the global skylight currently in use.
+        //! \details Keeps the previous maps while new ones are built incrementally.
+        skylight_cache m_active_skylight;
 
         //! \brief List of current shadows casters.
         std::vector<directional_light> m_current_shadow_casters;
@@ -133,7 +217,28 @@ namespace mango
         //! \brief The render data builder for skylights.
         skylight_builder m_skylight_builder;
 
-        // atmosphere_builder m_atmosphere_builder;
+        //! \brief The render data builder for atmospheres.
+        atmosphere_builder m_atmosphere_builder;
+        //! \brief True if the sky cubemap of the atmosphere changed this frame, else false.
+        bool m_sky_changed;
+
+        //! \brief Cpu copy of the punctual light buffer. Compact, one slot per point or spot light.
+        std::vector<punctual_light_data> m_punctual_lights;
+        //! \brief The \a sids of the lights in the slots of the punctual light buffer.
+        std::vector<sid> m_punctual_light_ids;
+        //! \brief The first slot of the punctual light buffer that has to be uploaded.
+        int32 m_punctual_dirty_begin;
+        //! \brief One past the last slot of the punctual light buffer that has to be uploaded.
+        int32 m_punctual_dirty_end;
+        //! \brief True if the limit of point and spot lights got exceeded, used to warn only once.
+        bool m_punctual_limit_warned;
+
+        //! \brief The gpu buffer storing the \a punctual_light_data of all point and spot lights.
+        gfx_handle<const gfx_buffer> m_punctual_light_buffer;
+        //! \brief The gpu buffer storing the light counts and light indices for each cluster.
+        gfx_handle<const gfx_buffer> m_light_cluster_buffer;
+        //! \brief The compute pipeline binning the point and spot lights into the clusters.
+        gfx_handle<const gfx_pipeline> m_light_clustering_pipeline;
     };
 } // namespace mango
 
@@ -24,6 +24,32 @@ gfx_handle<const gfx_texture> default_texture_cube;
 //! \brief Default array \a gfx_texture to bind when no other texture is available.
 gfx_handle<const gfx_texture> default_texture_array;
 
+//! \brief The maximum number of primitives rasterized as occluders by the software occlusion culling each frame.
+static const int32 max_software_occluders = 32;
+//! \brief The minimum size of an occluder relative to its distance to the camera.
+static const float min_software_occluder_size = 0.1f;
+
+//! \brief Estimates the part of the screen covered by a bounding box.
+//! \param[in] bounding_box The world space \a axis_aligned_bounding_box.
+//! \param[in] view_projection The view projection matrix of the camera.
+//! \return The area of the screen space rectangle of the box clamped to the screen divided by the screen area. 1 if the box reaches behind the camera.
+static float screen_coverage(const axis_aligned_bounding_box& bounding_box, const mat4& view_projection)
+{
+    vec2 min_ndc = vec2(std::numeric_limits<float>::max());
+    vec2 max_ndc = vec2(std::numeric_limits<float>::lowest());
+    for (const vec3& corner : bounding_box.get_corners())
+    {
+        vec4 clip = view_projection * vec4(corner, 1.0f);
+        if (clip.w <= 0.0f)
+            return 1.0f;
+        vec2 ndc = vec2(clip.x, clip.y) / clip.w;
+        min_ndc  = glm::min(min_ndc, ndc);
+        max_ndc  = glm::max(max_ndc, ndc);
+    }
+    vec2 size = glm::max(glm::clamp(max_ndc, vec2(-1.0f), vec2(1.0f)) - glm::clamp(min_ndc, vec2(-1.0f), vec2(1.0f)), vec2(0.0f));
+    return size.x * size.y * 0.25f;
+}
+
 deferred_pbr_renderer::deferred_pbr_renderer(const renderer_configuration& configuration, const shared_ptr<context_impl>& context)
     : renderer_impl(configuration, context)
     , m_pipeline_cache(context)
@@ -37,6 +63,13 @@ deferred_pbr_renderer::deferred_pbr_renderer(const renderer_configuration& confi
 
     m_frame_context = m_graphics_device->create_graphics_device_context();
 
+    // Required by the resource creation.
+    m_compact_gbuffer      = configuration.is_compact_gbuffer_enabled();
+    m_dynamic_resolution   = configuration.is_dynamic_resolution_enabled();
+    m_internal_target_size = ivec2(0);
+    m_internal_resolution  = ivec2(0);
+    m_timestamp_slot       = 0;
+
     if (!create_renderer_resources())
     {
         MANGO_LOG_ERROR("Resource Creation Failed! Renderer is not available!");
@@ -46,6 +79,9 @@ deferred_pbr_renderer::deferred_pbr_renderer(const renderer_configuration& confi
     // create light stack
     m_light_stack.init(m_shared_context);
 
+    if (!m_hi_z_culler.init(m_shared_context))
+        MANGO_LOG_WARN("Hi-Z culler creation failed! Occlusion culling is not available!");
+
     m_renderer_data.shadow_step_enabled         = false;
     m_renderer_data.debug_view_enabled          = false;
     m_renderer_data.position_debug_view         = false;
@@ -59,10 +95,15 @@ deferred_pbr_renderer::deferred_pbr_renderer(const renderer_configuration& confi
     m_renderer_data.metallic_debug_view         = false;
     m_renderer_data.show_cascades               = false;
 
-    m_vsync           = configuration.is_vsync_enabled();
-    m_wireframe       = configuration.should_draw_wireframe();
-    m_frustum_culling = configuration.is_frustum_culling_enabled();
-    m_debug_bounds    = configuration.should_draw_debug_bounds();
+    m_vsync                      = configuration.is_vsync_enabled();
+    m_wireframe                  = configuration.should_draw_wireframe();
+    m_frustum_culling            = configuration.is_frustum_culling_enabled();
+    m_occlusion_culling          = configuration.is_occlusion_culling_enabled();
+    m_software_occlusion_culling = configuration.is_software_occlusion_culling_enabled();
+    m_depth_prepass              = configuration.is_depth_prepass_enabled();
+    m_tiled_lighting             = configuration.is_tiled_lighting_enabled();
+    m_fused_post_processing      = configuration.is_fused_post_processing_enabled();
+    m_debug_bounds               = configuration.should_draw_debug_bounds();
 
     auto device_context = m_graphics_device->create_graphics_device_context();
     device_context->begin();
@@ -143,9 +184,6 @@ bool deferred_pbr_renderer::create_renderer_resources()
 
 bool deferred_pbr_renderer::create_textures_and_samplers()
 {
-    const int32& w = m_renderer_info.canvas.width;
-    const int32& h = m_renderer_info.canvas.height;
-
     texture_create_info attachment_info;
     attachment_info.texture_type   = gfx_texture_type::texture_type_2d;
     attachment_info.width          = 1;
@@ -177,11 +215,12 @@ bool deferred_pbr_renderer::create_textures_and_samplers()
     set_desc.pixel_format   = gfx_format::rgba;
     set_desc.component_type = gfx_format::t_unsigned_byte;
 
-    uint8 albedo[4] = { 1, 1, 1, 255 };
+    uint8 albedo[24] = { 1, 1, 1, 255, 1, 1, 1, 255, 1, 1, 1, 255, 1, 1, 1, 255, 1, 1, 1, 255, 1, 1, 1, 255 };
 
     auto device_context = m_graphics_device->create_graphics_device_context();
     device_context->begin();
     device_context->set_texture_data(default_texture_2D, set_desc, albedo);
+    set_desc.depth = 6; // all faces
     device_context->set_texture_data(default_texture_cube, set_desc, albedo);
     set_desc.pixel_format = gfx_format::rgb;
     set_desc.depth        = 3;
@@ -189,74 +228,9 @@ bool deferred_pbr_renderer::create_textures_and_samplers()
     device_context->end();
     device_context->submit();
 
-    attachment_info.width        = w;
-    attachment_info.height       = h;
-    attachment_info.array_layers = 1;
-    attachment_info.texture_type = gfx_texture_type::texture_type_2d;
-
-    m_gbuffer_render_targets.clear();
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::rgb10_a2;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::rgba32f;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-
-    for (auto rt : m_gbuffer_render_targets)
-    {
-        if (!check_creation(rt.get(), "gbuffer render targets"))
-            return false;
-    }
-
-    // HDR for auto exposure
-    m_hdr_buffer_render_targets.clear();
-    attachment_info.miplevels      = graphics::calculate_mip_count(w, h);
-    attachment_info.texture_format = gfx_format::rgba32f;
-    m_hdr_buffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.miplevels      = 1;
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_hdr_buffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-
-    for (auto rt : m_hdr_buffer_render_targets)
-    {
-        if (!check_creation(rt.get(), "hdr buffer render targets"))
-            return false;
-    }
-
-    // output
-    attachment_info.miplevels      = 1;
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_output_target                = m_graphics_device->create_texture(attachment_info);
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_ouput_depth_target           = m_graphics_device->create_texture(attachment_info);
-
-    if (!check_creation(m_output_target.get(), "output target"))
-        return false;
-    if (!check_creation(m_ouput_depth_target.get(), "output depth target"))
+    if (!create_render_targets())
         return false;
 
-    auto fxaa_pass = std::static_pointer_cast<fxaa_step>(m_pipeline_steps[mango::render_pipeline_step::fxaa]);
-    if (fxaa_pass)
-        fxaa_pass->set_output_targets(m_output_target, m_ouput_depth_target);
-
-    // postprocessing render targets
-    m_post_render_targets.clear();
-    attachment_info.miplevels      = 1;
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_post_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_post_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-
-    for (auto rt : m_post_render_targets)
-    {
-        if (!check_creation(rt.get(), "postprocessing buffer render targets"))
-            return false;
-    }
-
     sampler_create_info sampler_info;
     sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_nearest;
     sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_nearest;
@@ -291,6 +265,92 @@ bool deferred_pbr_renderer::create_textures_and_samplers()
     return true;
 }
 
+bool deferred_pbr_renderer::create_render_targets()
+{
+    texture_create_info attachment_info;
+    attachment_info.texture_type = gfx_texture_type::texture_type_2d;
+    attachment_info.array_layers = 1;
+
+    // With dynamic resolution the internal targets only grow, each frame renders into a scaled sub-rectangle of them.
+    ivec2 canvas_size = ivec2(m_renderer_info.canvas.width, m_renderer_info.canvas.height);
+    if (!m_dynamic_resolution || m_gbuffer_target_infos.empty() || canvas_size.x > m_internal_target_size.x || canvas_size.y > m_internal_target_size.y)
+    {
+        m_internal_target_size = m_dynamic_resolution ? glm::max(m_internal_target_size, canvas_size) : canvas_size;
+
+        const int32& w = m_internal_target_size.x;
+        const int32& h = m_internal_target_size.y;
+
+        attachment_info.width     = w;
+        attachment_info.height    = h;
+        attachment_info.miplevels = 1;
+
+        // The frame targets are transient, the render graph allocates them and aliases targets with disjoint lifetimes.
+        // The compact layout needs 20 instead of 32 bytes per pixel, the encoding is selected in the shaders with COMPACT_GBUFFER.
+        m_gbuffer_target_infos.clear();
+        attachment_info.texture_format = gfx_format::rgba8;
+        m_gbuffer_target_infos.push_back(attachment_info);
+        attachment_info.texture_format = m_compact_gbuffer ? gfx_format::rg16 : gfx_format::rgb10_a2;
+        m_gbuffer_target_infos.push_back(attachment_info);
+        attachment_info.texture_format = m_compact_gbuffer ? gfx_format::r11f_g11f_b10f : gfx_format::rgba32f;
+        m_gbuffer_target_infos.push_back(attachment_info);
+        attachment_info.texture_format = gfx_format::rgba8;
+        m_gbuffer_target_infos.push_back(attachment_info);
+        attachment_info.texture_format = gfx_format::depth_component32f;
+        m_gbuffer_target_infos.push_back(attachment_info);
+
+        // HDR for auto exposure
+        m_hdr_buffer_target_infos.clear();
+        attachment_info.miplevels      = graphics::calculate_mip_count(w, h);
+        attachment_info.texture_format = gfx_format::rgba32f;
+        m_hdr_buffer_target_infos.push_back(attachment_info);
+        attachment_info.miplevels      = 1;
+        attachment_info.texture_format = gfx_format::depth_component32f;
+        m_hdr_buffer_target_infos.push_back(attachment_info);
+
+        // Tile lists for the tiled lighting. Each class has its dispatch arguments and room for all tiles.
+        // The tile counts of the rendered sub-rectangle are set each frame.
+        int32 tile_count_x = (w + lighting_tile_size - 1) / lighting_tile_size;
+        int32 tile_count_y = (h + lighting_tile_size - 1) / lighting_tile_size;
+
+        buffer_create_info tile_buffer_info;
+        tile_buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+        tile_buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+        tile_buffer_info.size          = tile_class_count * (4 + tile_count_x * tile_count_y) * static_cast<int32>(sizeof(uint32));
+
+        m_tile_classification_buffer = m_graphics_device->create_buffer(tile_buffer_info);
+        if (!check_creation(m_tile_classification_buffer.get(), "tile classification buffer"))
+            return false;
+    }
+
+    // output
+    attachment_info.width          = m_renderer_info.canvas.width;
+    attachment_info.height         = m_renderer_info.canvas.height;
+    attachment_info.miplevels      = 1;
+    attachment_info.texture_format = gfx_format::rgba8;
+    m_output_target                = m_graphics_device->create_texture(attachment_info);
+    attachment_info.texture_format = gfx_format::depth_component32f;
+    m_ouput_depth_target           = m_graphics_device->create_texture(attachment_info);
+
+    if (!check_creation(m_output_target.get(), "output target"))
+        return false;
+    if (!check_creation(m_ouput_depth_target.get(), "output depth target"))
+        return false;
+
+    auto fxaa_pass = std::static_pointer_cast<fxaa_step>(m_pipeline_steps[mango::render_pipeline_step::fxaa]);
+    if (fxaa_pass)
+        fxaa_pass->set_output_targets(m_output_target, m_ouput_depth_target);
+
+    // postprocessing render targets
+    m_post_target_infos.clear();
+    attachment_info.miplevels      = 1;
+    attachment_info.texture_format = gfx_format::rgba8;
+    m_post_target_infos.push_back(attachment_info);
+    attachment_info.texture_format = gfx_format::depth_component32f;
+    m_post_target_infos.push_back(attachment_info);
+
+    return true;
+}
+
 bool deferred_pbr_renderer::create_buffers()
 {
     buffer_create_info buffer_info;
@@ -322,23 +382,38 @@ bool deferred_pbr_renderer::create_buffers()
     if (!check_creation(m_light_data_buffer.get(), "light data buffer"))
         return false;
 
+    buffer_info.size            = sizeof(tile_lighting_data);
+    m_tile_lighting_data_buffer = m_graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_tile_lighting_data_buffer.get(), "tile lighting data buffer"))
+        return false;
+
+    buffer_info.size         = sizeof(post_stack_data);
+    m_post_stack_data_buffer = m_graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_post_stack_data_buffer.get(), "post stack data buffer"))
+        return false;
+
     buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
     buffer_info.buffer_access = gfx_buffer_access::buffer_access_mapped_access_read_write;
     buffer_info.size          = sizeof(luminance_data);
-    m_luminance_data_buffer   = m_graphics_device->create_buffer(buffer_info);
-    if (!check_creation(m_luminance_data_buffer.get(), "luminance data buffer"))
-        return false;
-    m_luminance_data_mapping                      = nullptr;
-    graphics_device_context_handle device_context = m_graphics_device->create_graphics_device_context();
-    device_context->begin();
-    m_luminance_data_mapping = static_cast<luminance_data*>(device_context->map_buffer_data(m_luminance_data_buffer, 0, sizeof(luminance_data)));
-    device_context->end();
-    device_context->submit();
-    if (!check_mapping(m_luminance_data_mapping, "luminance data buffer"))
-        return false;
+    m_luminance_slot          = 0;
+    for (int32 i = 0; i < luminance_ring_size; ++i)
+    {
+        m_luminance_data_buffers[i] = m_graphics_device->create_buffer(buffer_info);
+        if (!check_creation(m_luminance_data_buffers[i].get(), "luminance data buffer"))
+            return false;
+        m_luminance_data_mappings[i]                  = nullptr;
+        graphics_device_context_handle device_context = m_graphics_device->create_graphics_device_context();
+        device_context->begin();
+        m_luminance_data_mappings[i] = static_cast<luminance_data*>(device_context->map_buffer_data(m_luminance_data_buffers[i], 0, sizeof(luminance_data)));
+        device_context->end();
+        device_context->submit();
+        if (!check_mapping(m_luminance_data_mappings[i], "luminance data buffer"))
+            return false;
 
-    memset(&m_luminance_data_mapping->histogram[0], 0, 256 * sizeof(int32));
-    m_luminance_data_mapping->luminance = 1.0f;
+        memset(&m_luminance_data_mappings[i]->histogram[0], 0, 256 * sizeof(int32));
+        m_luminance_data_mappings[i]->luminance = 1.0f;
+        m_luminance_pending[i]                  = false;
+    }
 
     return true;
 }
@@ -380,6 +455,8 @@ bool deferred_pbr_renderer::create_shader_stages()
     {
         res_resource_desc.path = "res/shader/forward/f_scene_gltf.glsl";
         res_resource_desc.defines.push_back({ "GBUFFER_FRAGMENT", "" });
+        if (m_compact_gbuffer)
+            res_resource_desc.defines.push_back({ "COMPACT_GBUFFER", "" });
         const shader_resource* source = internal_resources->acquire(res_resource_desc);
 
         source_desc.entry_point = "main";
@@ -416,6 +493,29 @@ bool deferred_pbr_renderer::create_shader_stages()
 
         res_resource_desc.defines.clear();
     }
+    // Geometry Pass Fallback Fragment Stage
+    {
+        res_resource_desc.path = "res/shader/forward/f_scene_fallback_gltf.glsl";
+        res_resource_desc.defines.push_back({ "GBUFFER_FRAGMENT", "" });
+        if (m_compact_gbuffer)
+            res_resource_desc.defines.push_back({ "COMPACT_GBUFFER", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
+        shader_info.shader_source = source_desc;
+
+        // Same resources as the geometry pass fragment stage, so that the resource mapping does not change.
+
+        m_geometry_pass_fallback_fragment = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_geometry_pass_fallback_fragment.get(), "geometry pass fallback fragment shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
     // Transparent Forward Lighting Fragment Stage
     {
         res_resource_desc.path = "res/shader/forward/f_scene_transparent_gltf.glsl";
@@ -429,7 +529,7 @@ bool deferred_pbr_renderer::create_shader_stages()
         shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
         shader_info.shader_source = source_desc;
 
-        shader_info.resource_count = 26;
+        shader_info.resource_count = 28;
 
         shader_info.resources = { {
             { gfx_shader_stage_type::shader_stage_fragment, MATERIAL_DATA_BUFFER_BINDING_POINT, "material_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
@@ -438,6 +538,8 @@ bool deferred_pbr_renderer::create_shader_stages()
             { gfx_shader_stage_type::shader_stage_fragment, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, "punctual_light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, "light_cluster_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
 
             { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, "texture_base_color", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, "sampler_base_color", gfx_shader_resource_type::shader_resource_sampler, 1 },
@@ -476,6 +578,51 @@ bool deferred_pbr_renderer::create_shader_stages()
 
         res_resource_desc.defines.clear();
     }
+    // Depth Pre-Pass Vertex Stage
+    {
+        res_resource_desc.path        = "res/shader/forward/v_depth_prepass.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_vertex;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 2;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_vertex, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, "model_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        } };
+
+        m_depth_prepass_vertex = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_depth_prepass_vertex.get(), "depth pre-pass vertex shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // Depth Pre-Pass Fragment Stage
+    {
+        res_resource_desc.path        = "res/shader/forward/f_depth_prepass.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 0;
+
+        m_depth_prepass_fragment = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_depth_prepass_fragment.get(), "depth pre-pass fragment shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
     // Screen Space Quad for Lighting Pass Vertex Stage and Compositing
     {
         res_resource_desc.path        = "res/shader/v_screen_space_triangle.glsl";
@@ -498,7 +645,9 @@ bool deferred_pbr_renderer::create_shader_stages()
     }
     // Lighting Pass Fragment Stage
     {
-        res_resource_desc.path        = "res/shader/deferred/f_deferred_lighting.glsl";
+        res_resource_desc.path = "res/shader/deferred/f_deferred_lighting.glsl";
+        if (m_compact_gbuffer)
+            res_resource_desc.defines.push_back({ "COMPACT_GBUFFER", "" });
         const shader_resource* source = internal_resources->acquire(res_resource_desc);
 
         source_desc.entry_point = "main";
@@ -508,13 +657,15 @@ bool deferred_pbr_renderer::create_shader_stages()
         shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
         shader_info.shader_source = source_desc;
 
-        shader_info.resource_count = 24;
+        shader_info.resource_count = 26;
 
         shader_info.resources = { {
             { gfx_shader_stage_type::shader_stage_fragment, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, "punctual_light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, "light_cluster_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
 
             { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_TARGET0, "texture_gbuffer_c0", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_TARGET0, "sampler_gbuffer_c0", gfx_shader_resource_type::shader_resource_sampler, 1 },
@@ -553,6 +704,171 @@ bool deferred_pbr_renderer::create_shader_stages()
 
         res_resource_desc.defines.clear();
     }
+    // Depth Copy Fragment Stage
+    {
+        res_resource_desc.path        = "res/shader/deferred/f_depth_copy.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 2;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_DEPTH, "texture_gbuffer_depth", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_DEPTH, "sampler_gbuffer_depth", gfx_shader_resource_type::shader_resource_sampler, 1 },
+        } };
+
+        m_depth_copy_fragment = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_depth_copy_fragment.get(), "depth copy fragment shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // Tile Classification Compute Stage
+    {
+        res_resource_desc.path = "res/shader/deferred/c_tile_classification.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        if (m_compact_gbuffer)
+            res_resource_desc.defines.push_back({ "COMPACT_GBUFFER", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 9;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, TILE_DATA_BUFFER_BINDING_POINT, "tile_lighting_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, TILE_CLASSIFICATION_BUFFER_BINDING_POINT, "tile_classification", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, "texture_gbuffer_c1", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, "sampler_gbuffer_c1", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, "texture_gbuffer_depth", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, "sampler_gbuffer_depth", gfx_shader_resource_type::shader_resource_sampler, 1 },
+        } };
+
+        m_tile_classification_compute = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_tile_classification_compute.get(), "tile classification compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // Tiled Lighting Compute Stages
+    for (int32 c = 0; c < tile_class_count; ++c)
+    {
+        res_resource_desc.path = "res/shader/deferred/c_deferred_lighting.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        if (m_compact_gbuffer)
+            res_resource_desc.defines.push_back({ "COMPACT_GBUFFER", "" });
+        if (c & tile_class_shadowed)
+            res_resource_desc.defines.push_back({ "TILE_SHADOWED", "" });
+        if (c & tile_class_skylight)
+            res_resource_desc.defines.push_back({ "TILE_SKYLIGHT", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 29;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, "punctual_light_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, LIGHT_CLUSTER_BUFFER_BINDING_POINT, "light_cluster_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET0, "texture_gbuffer_c0", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET0, "sampler_gbuffer_c0", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, "texture_gbuffer_c1", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, "sampler_gbuffer_c1", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET2, "texture_gbuffer_c2", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET2, "sampler_gbuffer_c2", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET3, "texture_gbuffer_c3", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET3, "sampler_gbuffer_c3", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, "texture_gbuffer_depth", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, "sampler_gbuffer_depth", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_IRRADIANCE_MAP, "texture_irradiance_map", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_IRRADIANCE_MAP, "sampler_irradiance_map", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_RADIANCE_MAP, "texture_radiance_map", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_RADIANCE_MAP, "sampler_radiance_map", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_LOOKUP, "texture_brdf_integration_lut", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_LOOKUP, "sampler_brdf_integration_lut", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_SHADOW_MAP, "texture_shadow_map_comp", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_SHADOW_MAP, "sampler_shadow_shadow_map", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_MAP, "texture_shadow_map", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_MAP, "sampler_shadow_map", gfx_shader_resource_type::shader_resource_sampler, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, TILE_DATA_BUFFER_BINDING_POINT, "tile_lighting_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, TILE_CLASSIFICATION_BUFFER_BINDING_POINT, "tile_classification", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HDR_IMAGE_LIGHTING_OUTPUT, "image_hdr_output", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+        } };
+
+        m_tiled_lighting_compute[c] = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_tiled_lighting_compute[c].get(), "tiled lighting compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // Post Stack Compute Stage
+    {
+        res_resource_desc.path = "res/shader/post/c_post_stack.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        res_resource_desc.defines.push_back({ "POST_STACK", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 6;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, POST_STACK_DATA_BUFFER_BINDING_POINT, "post_stack_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, COMPOSING_HDR_SAMPLER, "texture_hdr_input", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, COMPOSING_HDR_SAMPLER, "sampler_hdr_input", gfx_shader_resource_type::shader_resource_sampler, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, POST_STACK_IMAGE_OUTPUT, "image_post_output", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+        } };
+
+        m_post_stack_compute = m_graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_post_stack_compute.get(), "post stack compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
     // Composing Pass Fragment Stage
     {
         res_resource_desc.path = "res/shader/post/f_composing.glsl";
@@ -693,6 +1009,39 @@ bool deferred_pbr_renderer::create_pipeline_resources()
         geometry_pass_info.dynamic_state.dynamic_states = gfx_dynamic_state_flag_bits::dynamic_state_viewport | gfx_dynamic_state_flag_bits::dynamic_state_scissor;
 
         m_pipeline_cache.set_opaque_base(geometry_pass_info);
+
+        graphics_shader_stage_descriptor fallback_stages;
+        fallback_stages.vertex_shader_stage   = m_geometry_pass_vertex;
+        fallback_stages.fragment_shader_stage = m_geometry_pass_fallback_fragment;
+        m_pipeline_cache.set_opaque_fallback(fallback_stages);
+    }
+    // Depth Pre-Pass Pipeline
+    {
+        graphics_pipeline_create_info depth_prepass_info = m_graphics_device->provide_graphics_pipeline_create_info();
+        auto depth_prepass_pipeline_layout               = m_graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_vertex, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        depth_prepass_info.pipeline_layout = depth_prepass_pipeline_layout;
+
+        depth_prepass_info.shader_stage_descriptor.vertex_shader_stage   = m_depth_prepass_vertex;
+        depth_prepass_info.shader_stage_descriptor.fragment_shader_stage = m_depth_prepass_fragment;
+
+        // vertex_input_descriptor comes from the mesh to render, reduced to the position.
+        // input_assembly_descriptor comes from the mesh to render.
+
+        // viewport_descriptor is dynamic
+
+        // rasterization_state -> keep default
+        // depth_stencil_state -> keep default
+        depth_prepass_info.blend_state.blend_description.color_write_mask = gfx_color_component_flag_bits::component_none;
+
+        depth_prepass_info.dynamic_state.dynamic_states = gfx_dynamic_state_flag_bits::dynamic_state_viewport | gfx_dynamic_state_flag_bits::dynamic_state_scissor;
+
+        m_pipeline_cache.set_depth_prepass_base(depth_prepass_info);
     }
     // Transparent Pass Pipeline
     {
@@ -715,6 +1064,10 @@ bool deferred_pbr_renderer::create_pipeline_resources()
               gfx_shader_resource_access::shader_access_dynamic },
             { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
               gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
 
             { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, gfx_shader_resource_type::shader_resource_input_attachment,
               gfx_shader_resource_access::shader_access_dynamic },
@@ -793,6 +1146,10 @@ bool deferred_pbr_renderer::create_pipeline_resources()
               gfx_shader_resource_access::shader_access_dynamic },
             { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
               gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
 
             { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_TARGET0, gfx_shader_resource_type::shader_resource_input_attachment,
               gfx_shader_resource_access::shader_access_dynamic },
@@ -850,6 +1207,151 @@ bool deferred_pbr_renderer::create_pipeline_resources()
 
         m_lighting_pass_pipeline = m_graphics_device->create_graphics_pipeline(lighting_pass_info);
     }
+    // Depth Copy Pipeline
+    {
+        graphics_pipeline_create_info depth_copy_info = m_graphics_device->provide_graphics_pipeline_create_info();
+        auto depth_copy_pipeline_layout               = m_graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        depth_copy_info.pipeline_layout = depth_copy_pipeline_layout;
+
+        depth_copy_info.shader_stage_descriptor.vertex_shader_stage   = m_screen_space_triangle_vertex;
+        depth_copy_info.shader_stage_descriptor.fragment_shader_stage = m_depth_copy_fragment;
+
+        depth_copy_info.vertex_input_state.attribute_description_count = 0;
+        depth_copy_info.vertex_input_state.binding_description_count   = 0;
+
+        depth_copy_info.input_assembly_state.topology = gfx_primitive_topology::primitive_topology_triangle_list; // Not relevant.
+
+        // viewport_descriptor is dynamic
+
+        // rasterization_state -> keep default
+        depth_copy_info.depth_stencil_state.depth_compare_operator = gfx_compare_operator::compare_operator_always; // Do not disable since it writes the depth in the fragment shader.
+        // The color is written by the tiled lighting.
+        depth_copy_info.blend_state.blend_description.color_write_mask = gfx_color_component_flag_bits::component_none;
+
+        depth_copy_info.dynamic_state.dynamic_states = gfx_dynamic_state_flag_bits::dynamic_state_viewport | gfx_dynamic_state_flag_bits::dynamic_state_scissor;
+
+        m_depth_copy_pipeline = m_graphics_device->create_graphics_pipeline(depth_copy_info);
+    }
+    // Tile Classification Pipeline
+    {
+        compute_pipeline_create_info tile_classification_info = m_graphics_device->provide_compute_pipeline_create_info();
+        auto tile_classification_pipeline_layout              = m_graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, RENDERER_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, LIGHT_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, TILE_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, TILE_CLASSIFICATION_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        tile_classification_info.pipeline_layout = tile_classification_pipeline_layout;
+
+        tile_classification_info.shader_stage_descriptor.compute_shader_stage = m_tile_classification_compute;
+
+        m_tile_classification_pipeline = m_graphics_device->create_compute_pipeline(tile_classification_info);
+    }
+    // Tiled Lighting Pipelines
+    for (int32 c = 0; c < tile_class_count; ++c)
+    {
+        compute_pipeline_create_info tiled_lighting_info = m_graphics_device->provide_compute_pipeline_create_info();
+        auto tiled_lighting_pipeline_layout              = m_graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, RENDERER_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, LIGHT_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, LIGHT_CLUSTER_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET0, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET0, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET1, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET2, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET2, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET3, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_TARGET3, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, GBUFFER_TEXTURE_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_IRRADIANCE_MAP, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_IRRADIANCE_MAP, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_RADIANCE_MAP, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_RADIANCE_MAP, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_LOOKUP, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, IBL_SAMPLER_LOOKUP, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_SHADOW_MAP, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_SHADOW_MAP, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_MAP, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, SAMPLER_SHADOW_MAP, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, TILE_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, TILE_CLASSIFICATION_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, HDR_IMAGE_LIGHTING_OUTPUT, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        tiled_lighting_info.pipeline_layout = tiled_lighting_pipeline_layout;
+
+        tiled_lighting_info.shader_stage_descriptor.compute_shader_stage = m_tiled_lighting_compute[c];
+
+        m_tiled_lighting_pipelines[c] = m_graphics_device->create_compute_pipeline(tiled_lighting_info);
+    }
+    // Post Stack Pipeline
+    {
+        compute_pipeline_create_info post_stack_info = m_graphics_device->provide_compute_pipeline_create_info();
+        auto post_stack_pipeline_layout              = m_graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, RENDERER_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, POST_STACK_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, COMPOSING_HDR_SAMPLER, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, COMPOSING_HDR_SAMPLER, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, POST_STACK_IMAGE_OUTPUT, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        post_stack_info.pipeline_layout = post_stack_pipeline_layout;
+
+        post_stack_info.shader_stage_descriptor.compute_shader_stage = m_post_stack_compute;
+
+        m_post_stack_pipeline = m_graphics_device->create_compute_pipeline(post_stack_info);
+    }
     // Composing Pass Pipeline
     {
         graphics_pipeline_create_info composing_pass_info = m_graphics_device->provide_graphics_pipeline_create_info();
@@ -933,40 +1435,42 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
     m_renderer_info.last_frame.meshes     = 0;
     m_renderer_info.last_frame.primitives = 0;
     m_renderer_info.last_frame.materials  = 0;
+    m_renderer_info.last_frame.occluded   = 0;
+    m_renderer_info.last_frame.overdraw   = 0.0f;
 
     m_frame_context->begin();
     m_frame_context->client_wait(m_frame_semaphore);
-    float clear_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f }; // TODO Paul: member or dynamic?
-    auto swap_buffer     = m_graphics_device->get_swap_chain_render_target();
 
-    auto shadow_pass = std::static_pointer_cast<shadow_map_step>(m_pipeline_steps[mango::render_pipeline_step::shadow_map]);
-
-    // clear all framebuffers
+    // Dynamic resolution: Frame times of earlier frames are read back without waiting and adjust the scale of the internal targets.
+    if (m_dynamic_resolution)
     {
-        GL_NAMED_PROFILE_ZONE("Clear Framebuffers");
-        NAMED_PROFILE_ZONE("Clear Framebuffers");
-        if (shadow_pass)
+        for (int32 i = timestamp_ring_size - 1; i > 0; --i)
         {
-            m_frame_context->set_render_targets(0, nullptr, shadow_pass->get_shadow_maps_texture());
-            m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
+            int32 slot = (m_timestamp_slot - i + timestamp_ring_size) % timestamp_ring_size;
+            uint64 frame_begin, frame_end;
+            if (!m_frame_context->get_timestamp(m_frame_timestamps[slot][0], frame_begin) || !m_frame_context->get_timestamp(m_frame_timestamps[slot][1], frame_end))
+                continue;
+            m_resolution_controller.update(static_cast<float>(frame_end - frame_begin) * 1e-6f);
+            m_frame_timestamps[slot][0] = nullptr;
+            m_frame_timestamps[slot][1] = nullptr;
         }
-        m_frame_context->set_render_targets(static_cast<int32>(m_gbuffer_render_targets.size()) - 1, m_gbuffer_render_targets.data(), m_gbuffer_render_targets.back());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        m_frame_context->set_render_targets(static_cast<int32>(m_post_render_targets.size()) - 1, m_post_render_targets.data(), m_post_render_targets.back());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        m_frame_context->set_render_targets(1, &m_output_target, m_ouput_depth_target);
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        // TODO Paul: Is the renderer in charge here?
-        m_frame_context->set_render_targets(1, &swap_buffer, m_graphics_device->get_swap_chain_depth_stencil_target());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
+        m_frame_timestamps[m_timestamp_slot][0] = m_frame_context->timestamp();
+
+        vec2 scaled_size      = vec2(m_renderer_info.canvas.width, m_renderer_info.canvas.height) * m_resolution_controller.get_scale() + 0.5f;
+        m_internal_resolution = glm::clamp(ivec2(scaled_size), ivec2(1), glm::max(m_internal_target_size, ivec2(1)));
     }
+    else
+        m_internal_resolution = m_internal_target_size;
+
+    m_tile_lighting_data.tile_count_x = (m_internal_resolution.x + lighting_tile_size - 1) / lighting_tile_size;
+    m_tile_lighting_data.tile_count_y = (m_internal_resolution.y + lighting_tile_size - 1) / lighting_tile_size;
+    m_tile_lighting_data.padding0     = 0;
+    m_tile_lighting_data.padding1     = 0;
+
+    float clear_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f }; // TODO Paul: member or dynamic?
+    auto swap_buffer     = m_graphics_device->get_swap_chain_render_target();
+
+    auto shadow_pass = std::static_pointer_cast<shadow_map_step>(m_pipeline_steps[mango::render_pipeline_step::shadow_map]);
 
     m_frame_context->set_buffer_data(m_renderer_data_buffer, 0, sizeof(m_renderer_data), &m_renderer_data);
 
@@ -978,6 +1482,8 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
         float view_depth;
         bool transparent;
         axis_aligned_bounding_box bounding_box; // Does not contribute to order.
+        bool static_caster;                     // Does not contribute to order.
+        bool depth_prepass;                     // Does not contribute to order.
 
         bool operator<(const draw_key& other) const
         {
@@ -986,9 +1492,10 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
             if (other.transparent < transparent)
                 return false;
 
-            if (view_depth > other.view_depth)
+            // Opaque front to back to reduce overdraw, transparent back to front for blending.
+            if (transparent ? view_depth > other.view_depth : view_depth < other.view_depth)
                 return true;
-            if (other.view_depth > view_depth)
+            if (transparent ? other.view_depth > view_depth : other.view_depth < view_depth)
                 return false;
 
             if (material_id < other.material_id)
@@ -1075,14 +1582,21 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
     }
     m_camera_data.camera_position = camera_position;
 
-    static float camera_exposure = 1.0f;                                                 // TODO Paul: Does the static variable here make sense?
-    camera_exposure              = apply_exposure(active_camera.value(), auto_exposure); // with last frames data.
-
-    m_camera_data.camera_exposure = camera_exposure;
+    m_camera_data.camera_exposure = apply_exposure(active_camera.value(), auto_exposure, dt); // with data of previous frames.
+    m_camera_data.render_scale    = vec2(m_internal_resolution) / glm::max(vec2(m_internal_target_size), vec2(1.0f));
 
     m_frame_context->set_buffer_data(m_camera_data_buffer, 0, sizeof(m_camera_data), &m_camera_data);
 
+    struct occluder_candidate
+    {
+        float screen_size;
+        shared_ptr<const occluder_geometry> geometry;
+        mat4 model_matrix;
+        bool double_sided;
+    };
+
     std::vector<draw_key> draws;
+    std::vector<occluder_candidate> occluder_candidates;
     int32 opaque_count = 0;
     auto instances     = scene->get_render_instances();
     if (m_debug_bounds)
@@ -1113,6 +1627,8 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
         }
     }
 
+    if (shadow_pass)
+        shadow_pass->begin_caster_tracking();
     for (auto instance : instances)
     {
         optional<scene_node&> node = scene->get_scene_node(instance.node_id);
@@ -1120,20 +1636,21 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
 
         if ((node->type & node_type::light) != node_type::empty_leaf)
         {
-            for (int32 i = 0; i < 3; ++i)
+            for (int32 i = 0; i < static_cast<int32>(light_type::count); ++i)
             {
                 if (node->light_ids[i] == invalid_sid)
                     continue;
 
                 optional<scene_light&> light = scene->get_scene_light(node->light_ids[i]);
                 MANGO_ASSERT(light, "Non existing light in instances!");
-                m_light_stack.push(light.value());
+                m_light_stack.push(node->light_ids[i], light.value(), node->global_transformation_matrix);
             }
         }
         if ((node->type & node_type::mesh) != node_type::empty_leaf)
         {
             draw_key a_draw;
-            a_draw.node_id = node->public_data.instance_id;
+            a_draw.node_id       = node->public_data.instance_id;
+            a_draw.static_caster = shadow_pass ? shadow_pass->track_caster(a_draw.node_id, node->global_transformation_matrix) : false;
 
             optional<scene_mesh&> mesh = scene->get_scene_mesh(node->mesh_id);
             MANGO_ASSERT(mesh, "Non existing mesh in instances!");
@@ -1151,12 +1668,24 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
                 MANGO_ASSERT(mat, "Non existing material in instances!");
 
                 a_draw.transparent = mat->public_data.alpha_mode > material_alpha_mode::mode_mask;
+                // Alpha masked primitives need the material to discard fragments and are not part of the depth pre-pass.
+                a_draw.depth_prepass = mat->public_data.alpha_mode == material_alpha_mode::mode_opaque;
                 opaque_count += a_draw.transparent ? 0 : 1;
 
                 a_draw.view_depth = (mat4(m_camera_data.view_projection_matrix) * node->global_transformation_matrix * vec4(0, 0, 0, 1)).z;
 
                 a_draw.bounding_box = p.bounding_box.get_transformed(node->global_transformation_matrix);
 
+                // Large opaque primitives near the camera are candidates for the software occlusion culling.
+                if (m_software_occlusion_culling && p.occluder && mat->public_data.alpha_mode == material_alpha_mode::mode_opaque &&
+                    (!m_frustum_culling || camera_frustum.intersects(a_draw.bounding_box)))
+                {
+                    float distance = glm::length(a_draw.bounding_box.center - camera_position);
+                    float size     = glm::length(a_draw.bounding_box.extents) / glm::max(distance, 1e-3f);
+                    if (size > min_software_occluder_size)
+                        occluder_candidates.push_back({ size, p.occluder, node->global_transformation_matrix, mat->public_data.double_sided });
+                }
+
                 draws.push_back(a_draw);
             }
         }
@@ -1166,38 +1695,105 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
         }
     }
 
+    if (shadow_pass)
+        shadow_pass->end_caster_tracking();
+
+    // The biggest occluders are rasterized on the cpu, so that draws can be tested against them in this frame.
+    if (m_software_occlusion_culling)
+    {
+        NAMED_PROFILE_ZONE("Software Occlusion Culling");
+        int32 occluder_count = std::min(max_software_occluders, static_cast<int32>(occluder_candidates.size()));
+        std::partial_sort(occluder_candidates.begin(), occluder_candidates.begin() + occluder_count, occluder_candidates.end(),
+                          [](const occluder_candidate& a, const occluder_candidate& b) { return a.screen_size > b.screen_size; });
+
+        m_software_occlusion_culler.begin_frame(mat4(m_camera_data.view_projection_matrix));
+        for (int32 i = 0; i < occluder_count; ++i)
+        {
+            const occluder_candidate& candidate = occluder_candidates[i];
+            m_software_occlusion_culler.add_occluder(candidate.geometry->vertices.data(), candidate.geometry->indices.data(), static_cast<int32>(candidate.geometry->indices.size()),
+                                                     candidate.model_matrix, candidate.double_sided);
+        }
+        m_software_occlusion_culler.rasterize();
+    }
+
     m_light_stack.update(scene);
 
-    m_frame_context->set_buffer_data(m_light_data_buffer, 0, sizeof(light_data), &(m_light_stack.get_light_data()));
+    // The light data buffer is persistent and only updated when lights changed.
+    if (m_light_stack.light_data_changed())
+        m_frame_context->set_buffer_data(m_light_data_buffer, 0, sizeof(light_data), &(m_light_stack.get_light_data()));
+
+    // Bins point and spot lights into the clusters of the current camera.
+    m_light_stack.cluster_lights(m_frame_context, m_camera_data_buffer, m_light_data_buffer);
 
     std::sort(begin(draws), end(draws));
 
     auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
 
+    // The frame is described as render graph, passes are recorded in order when the graph is executed.
+    // Targets of the frame are transient, so the graph can alias them and skip clears where they are fully overwritten.
+    m_render_graph.reset();
+    m_render_graph.set_clear_color(clear_color);
+
+    // The internal passes render into a sub-rectangle of the internal targets, the composing pass scales it to the canvas.
+    gfx_viewport internal_viewport{ 0.0f, 0.0f, static_cast<float>(m_internal_resolution.x), static_cast<float>(m_internal_resolution.y) };
+
+    const char* gbuffer_target_names[5] = { "GBuffer Base Color", "GBuffer Normal", "GBuffer Emissive", "GBuffer Occlusion Roughness Metallic", "GBuffer Depth" };
+    std::vector<render_graph_texture> gbuffer_targets;
+    for (int32 i = 0; i < static_cast<int32>(m_gbuffer_target_infos.size()); ++i)
+        gbuffer_targets.push_back(m_render_graph.create_texture(gbuffer_target_names[i], m_gbuffer_target_infos[i]));
+    render_graph_texture gbuffer_depth = gbuffer_targets.back();
+
+    render_graph_texture hdr_color        = m_render_graph.create_texture("HDR Color", m_hdr_buffer_target_infos[0]);
+    render_graph_texture hdr_depth        = m_render_graph.create_texture("HDR Depth", m_hdr_buffer_target_infos[1]);
+    render_graph_texture post_color       = m_render_graph.create_texture("Postprocessing Color", m_post_target_infos[0]);
+    render_graph_texture post_depth       = m_render_graph.create_texture("Postprocessing Depth", m_post_target_infos[1]);
+    render_graph_texture output_color     = m_render_graph.import_texture("Output Color", m_output_target);
+    render_graph_texture output_depth     = m_render_graph.import_texture("Output Depth", m_ouput_depth_target);
+    render_graph_texture swap_chain_color = m_render_graph.import_texture("Swap Chain Color", swap_buffer);
+    render_graph_texture swap_chain_depth = m_render_graph.import_texture("Swap Chain Depth", m_graphics_device->get_swap_chain_depth_stencil_target());
+    render_graph_texture shadow_maps      = shadow_pass ? m_render_graph.import_texture("Shadow Maps", shadow_pass->get_shadow_maps_texture()) : -1;
+    m_render_graph.mark_output(output_color);
+    m_render_graph.mark_output(swap_chain_color);
+
     // shadow pass
     // draw objects
-    {
+    int32 shadow_node = m_render_graph.add_pass("Shadow Pass", [&]() {
         GL_NAMED_PROFILE_ZONE("Shadow Pass");
         NAMED_PROFILE_ZONE("Shadow Pass");
         auto shadow_casters = m_light_stack.get_shadow_casters(); // currently only directional.
 
         if (shadow_pass && !m_renderer_data.debug_view_enabled && !shadow_casters.empty())
         {
+            shadow_pass->read_depth_bounds(m_frame_context);
             for (auto sc : shadow_casters)
             {
                 shadow_pass->update_cascades(dt, m_camera_data.camera_near, m_camera_data.camera_far, m_camera_data.view_projection_matrix, sc.direction);
                 auto& shadow_data_buffer = shadow_pass->get_shadow_data_buffer();
-                m_frame_context->set_render_targets(0, nullptr, shadow_pass->get_shadow_maps_texture());
-                for (int32 casc = 0; casc < shadow_pass->get_shadow_data().cascade_count; ++casc)
+                // Uploaded once even if all cascades are cached, since the lighting reads it as well.
+                m_frame_context->set_buffer_data(shadow_data_buffer, 0, sizeof(shadow_map_step::shadow_data), &(shadow_pass->get_shadow_data()));
+                const int32 cascade_count = shadow_pass->get_shadow_data().cascade_count;
+
+                // Cull all casters against all cascades at once, each caster is drawn once for all cascades it touches.
+                std::vector<int32> cascade_masks(draws.size(), 0);
+                int32 dynamic_mask = 0;
+                for (uint32 c = 0; c < draws.size(); ++c)
                 {
-                    auto& cascade_frustum = shadow_pass->get_cascade_frustum(casc);
-
-                    auto& data   = shadow_pass->get_shadow_data();
-                    data.cascade = casc;
+                    for (int32 casc = 0; casc < cascade_count; ++casc)
+                    {
+                        if (!m_frustum_culling || shadow_pass->get_cascade_frustum(casc).intersects(draws[c].bounding_box))
+                            cascade_masks[c] |= 1 << casc;
+                    }
+                    if (!draws[c].static_caster)
+                        dynamic_mask |= cascade_masks[c];
+                }
 
+                int32 static_mask   = 0;
+                int32 outdated_mask = 0;
+                for (int32 casc = 0; casc < cascade_count; ++casc)
+                {
                     if (m_debug_bounds)
                     {
-                        auto corners = bounding_frustum::get_corners(mat4(data.view_projection_matrices[casc]));
+                        auto corners = bounding_frustum::get_corners(mat4(shadow_pass->get_shadow_data().view_projection_matrices[casc]));
                         m_debug_drawer.set_color(color_rgb(0.5f));
                         m_debug_drawer.add(corners[0], corners[1]);
                         m_debug_drawer.add(corners[1], corners[3]);
@@ -1216,120 +1812,171 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
                         m_debug_drawer.add(corners[5], corners[7]);
                     }
 
-                    for (uint32 c = 0; c < draws.size(); ++c)
-                    {
-                        auto& dc = draws[c];
+                    // Static casters are cached, so a cascade only has to be rendered when it moved or something changed.
+                    if (shadow_pass->static_cascade_outdated(casc))
+                        static_mask |= 1 << casc;
+                    if (shadow_pass->cascade_outdated(casc, (dynamic_mask & (1 << casc)) != 0))
+                        outdated_mask |= 1 << casc;
+                }
 
-                        if (m_frustum_culling)
-                        {
-                            auto& bb = dc.bounding_box;
-                            if (!cascade_frustum.intersects(bb))
-                                continue;
-                        }
+                if (!outdated_mask)
+                    continue;
 
-                        optional<scene_primitive&> prim = scene->get_scene_primitive(dc.primitive_id);
-                        if (!prim)
-                        {
-                            warn_missing_draw("Primitive");
-                            continue;
-                        }
-                        optional<scene_node&> node = scene->get_scene_node(dc.node_id);
-                        if (!node)
-                        {
-                            warn_missing_draw("Node");
-                            continue;
-                        }
-                        optional<scene_material&> mat = scene->get_scene_material(dc.material_id);
-                        if (!mat)
-                        {
-                            warn_missing_draw("Material");
-                            continue;
-                        }
+                auto cascade_mask_count = [](int32 mask) { return ((mask >> 0) & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1); };
+
+                bool static_complete = true;
+                gfx_handle<const gfx_pipeline> bound_pipeline;
+                auto render_caster = [&](const draw_key& dc, int32 cascade_mask)
+                {
+                    optional<scene_primitive&> prim = scene->get_scene_primitive(dc.primitive_id);
+                    if (!prim)
+                    {
+                        warn_missing_draw("Primitive");
+                        return;
+                    }
+                    optional<scene_node&> node = scene->get_scene_node(dc.node_id);
+                    if (!node)
+                    {
+                        warn_missing_draw("Node");
+                        return;
+                    }
+                    optional<scene_material&> mat = scene->get_scene_material(dc.material_id);
+                    if (!mat)
+                    {
+                        warn_missing_draw("Material");
+                        return;
+                    }
 
-                        gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache.get_shadow(prim->vertex_layout, prim->input_assembly);
+                    gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache.get_shadow(prim->vertex_layout, prim->input_assembly);
+                    if (!dc_pipeline)
+                    {
+                        static_complete &= !dc.static_caster;
+                        return; // Still compiling.
+                    }
 
+                    if (dc_pipeline != bound_pipeline)
+                    {
                         m_frame_context->bind_pipeline(dc_pipeline);
                         gfx_viewport shadow_viewport{ 0.0f, 0.0f, static_cast<float>(shadow_pass->resolution()), static_cast<float>(shadow_pass->resolution()) };
                         m_frame_context->set_viewport(0, 1, &shadow_viewport);
+                        bound_pipeline = dc_pipeline;
+                    }
 
-                        m_frame_context->set_buffer_data(shadow_data_buffer, 0, sizeof(shadow_map_step::shadow_data), &(data));
-                        dc_pipeline->get_resource_mapping()->set("shadow_data", shadow_data_buffer);
+                    dc_pipeline->get_resource_mapping()->set("shadow_data", shadow_data_buffer);
 
-                        m_model_data.model_matrix  = node->global_transformation_matrix;
-                        m_model_data.normal_matrix = std140_mat3(mat3(glm::transpose(glm::inverse(node->global_transformation_matrix))));
-                        m_model_data.has_normals   = prim->public_data.has_normals;
-                        m_model_data.has_tangents  = prim->public_data.has_tangents;
+                    m_model_data.model_matrix        = node->global_transformation_matrix;
+                    m_model_data.normal_matrix       = std140_mat3(mat3(glm::transpose(glm::inverse(node->global_transformation_matrix))));
+                    m_model_data.has_normals         = prim->public_data.has_normals;
+                    m_model_data.has_tangents        = prim->public_data.has_tangents;
+                    m_model_data.shadow_cascade_mask = cascade_mask;
 
-                        m_frame_context->set_buffer_data(m_model_data_buffer, 0, sizeof(m_model_data), &m_model_data);
+                    m_frame_context->set_buffer_data(m_model_data_buffer, 0, sizeof(m_model_data), &m_model_data);
 
-                        dc_pipeline->get_resource_mapping()->set("model_data", m_model_data_buffer);
+                    dc_pipeline->get_resource_mapping()->set("model_data", m_model_data_buffer);
 
-                        m_material_data.base_color   = mat->public_data.base_color;
-                        m_material_data.alpha_mode   = static_cast<uint8>(mat->public_data.alpha_mode);
-                        m_material_data.alpha_cutoff = mat->public_data.alpha_cutoff;
+                    m_material_data.base_color   = mat->public_data.base_color;
+                    m_material_data.alpha_mode   = static_cast<uint8>(mat->public_data.alpha_mode);
+                    m_material_data.alpha_cutoff = mat->public_data.alpha_cutoff;
 
-                        if (m_material_data.alpha_mode > 1)
-                            continue; // TODO Paul: Transparent shadows?!
+                    if (m_material_data.alpha_mode > 1)
+                        return; // TODO Paul: Transparent shadows?!
 
-                        m_material_data.base_color_texture = mat->public_data.base_color_texture.is_valid();
+                    m_material_data.base_color_texture = mat->public_data.base_color_texture.is_valid();
 
-                        m_frame_context->set_buffer_data(m_material_data_buffer, 0, sizeof(m_material_data), &m_material_data);
+                    m_frame_context->set_buffer_data(m_material_data_buffer, 0, sizeof(m_material_data), &m_material_data);
 
-                        dc_pipeline->get_resource_mapping()->set("material_data", m_material_data_buffer);
+                    dc_pipeline->get_resource_mapping()->set("material_data", m_material_data_buffer);
 
-                        if (m_material_data.base_color_texture)
-                        {
-                            optional<scene_texture&> tex = scene->get_scene_texture(mat->public_data.base_color_texture);
-                            if (!tex)
-                            {
-                                warn_missing_draw("Base Color Texture");
-                                continue;
-                            }
-                            dc_pipeline->get_resource_mapping()->set("texture_base_color", tex->graphics_texture);
-                            dc_pipeline->get_resource_mapping()->set("sampler_base_color", tex->graphics_sampler);
-                        }
-                        else
+                    if (m_material_data.base_color_texture)
+                    {
+                        optional<scene_texture&> tex = scene->get_scene_texture(mat->public_data.base_color_texture);
+                        if (!tex)
                         {
-                            dc_pipeline->get_resource_mapping()->set("texture_base_color", default_texture_2D);
+                            warn_missing_draw("Base Color Texture");
+                            return;
                         }
+                        dc_pipeline->get_resource_mapping()->set("texture_base_color", tex->graphics_texture);
+                        dc_pipeline->get_resource_mapping()->set("sampler_base_color", tex->graphics_sampler);
+                    }
+                    else
+                    {
+                        dc_pipeline->get_resource_mapping()->set("texture_base_color", default_texture_2D);
+                    }
 
-                        m_frame_context->submit_pipeline_state_resources();
+                    m_frame_context->submit_pipeline_state_resources();
 
-                        m_frame_context->set_index_buffer(prim->index_buffer_view.graphics_buffer, prim->index_type);
+                    m_frame_context->set_index_buffer(prim->index_buffer_view.graphics_buffer, prim->index_type);
 
-                        std::vector<gfx_handle<const gfx_buffer>> vbs;
-                        vbs.reserve(prim->vertex_buffer_views.size());
-                        std::vector<int32> bindings;
-                        bindings.reserve(prim->vertex_buffer_views.size());
-                        std::vector<int32> offsets;
-                        offsets.reserve(prim->vertex_buffer_views.size());
-                        int32 idx = 0;
-                        for (auto vbv : prim->vertex_buffer_views)
-                        {
-                            vbs.push_back(vbv.graphics_buffer);
-                            bindings.push_back(idx++);
-                            offsets.push_back(vbv.offset);
-                        }
+                    std::vector<gfx_handle<const gfx_buffer>> vbs;
+                    vbs.reserve(prim->vertex_buffer_views.size());
+                    std::vector<int32> bindings;
+                    bindings.reserve(prim->vertex_buffer_views.size());
+                    std::vector<int32> offsets;
+                    offsets.reserve(prim->vertex_buffer_views.size());
+                    int32 idx = 0;
+                    for (auto vbv : prim->vertex_buffer_views)
+                    {
+                        vbs.push_back(vbv.graphics_buffer);
+                        bindings.push_back(idx++);
+                        offsets.push_back(vbv.offset);
+                    }
 
-                        m_frame_context->set_vertex_buffers(static_cast<int32>(prim->vertex_buffer_views.size()), vbs.data(), bindings.data(), offsets.data());
+                    m_frame_context->set_vertex_buffers(static_cast<int32>(prim->vertex_buffer_views.size()), vbs.data(), bindings.data(), offsets.data());
 
-                        m_renderer_info.last_frame.draw_calls++;
-                        m_renderer_info.last_frame.primitives++;
-                        m_renderer_info.last_frame.vertices += std::max(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count);
-                        m_frame_context->draw(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count, prim->draw_call_desc.instance_count, prim->draw_call_desc.base_vertex,
-                                              prim->draw_call_desc.base_instance, prim->draw_call_desc.index_offset);
+                    m_renderer_info.last_frame.draw_calls++;
+                    m_renderer_info.last_frame.primitives++;
+                    m_renderer_info.last_frame.vertices += std::max(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count);
+                    // Each instance of the primitive is drawn once per cascade in the mask, the vertex shader selects the layer.
+                    m_frame_context->draw(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count, prim->draw_call_desc.instance_count * cascade_mask_count(cascade_mask),
+                                          prim->draw_call_desc.base_vertex, prim->draw_call_desc.base_instance, prim->draw_call_desc.index_offset);
+                };
+
+                if (static_mask)
+                {
+                    for (int32 casc = 0; casc < cascade_count; ++casc)
+                    {
+                        if (static_mask & (1 << casc))
+                            shadow_pass->clear_static_cascade(m_frame_context, casc);
+                    }
+                    bound_pipeline = nullptr;
+                    for (uint32 c = 0; c < draws.size(); ++c)
+                    {
+                        if (draws[c].static_caster && (cascade_masks[c] & static_mask))
+                            render_caster(draws[c], cascade_masks[c] & static_mask);
                     }
                 }
+
+                for (int32 casc = 0; casc < cascade_count; ++casc)
+                {
+                    if (outdated_mask & (1 << casc))
+                        shadow_pass->restore_static_cascade(m_frame_context, casc);
+                }
+                bound_pipeline = nullptr;
+                for (uint32 c = 0; c < draws.size() && (dynamic_mask & outdated_mask); ++c)
+                {
+                    if (!draws[c].static_caster && (cascade_masks[c] & outdated_mask))
+                        render_caster(draws[c], cascade_masks[c] & outdated_mask);
+                }
+
+                for (int32 casc = 0; casc < cascade_count; ++casc)
+                {
+                    if (outdated_mask & (1 << casc))
+                        shadow_pass->cascade_rendered(casc, (dynamic_mask & (1 << casc)) != 0, static_complete);
+                }
             }
         }
-    }
+    });
+    if (shadow_pass)
+        m_render_graph.write(shadow_node, shadow_maps, render_graph_access::depth_target, render_graph_load_op::load);
 
-    // gbuffer pass
-    // draw objects
+    // Occlusion results of previous frames, drawn geometry is tested again after the transparent pass.
+    m_hi_z_culler.begin_frame(m_frame_context, m_occlusion_culling, scene->get_active_camera_sid(), mat4(m_camera_data.view_projection_matrix));
+
+    // Opaque draws are culled once, so that the depth pre-pass and the gbuffer pass render the same draws.
+    std::vector<bool> opaque_visible(opaque_count, false);
+    std::vector<bool> opaque_prepassed(opaque_count, false);
     {
-        GL_NAMED_PROFILE_ZONE("GBuffer Pass");
-        NAMED_PROFILE_ZONE("GBuffer Pass");
-        m_frame_context->set_render_targets(static_cast<int32>(m_gbuffer_render_targets.size()) - 1, m_gbuffer_render_targets.data(), m_gbuffer_render_targets.back());
+        mat4 view_projection = mat4(m_camera_data.view_projection_matrix);
         for (int32 c = 0; c < opaque_count; ++c)
         {
             auto& dc = draws[c];
@@ -1340,6 +1987,93 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
                 if (!camera_frustum.intersects(bb))
                     continue;
             }
+            if (m_hi_z_culler.check_occlusion(dc.node_id, dc.primitive_id, dc.bounding_box))
+            {
+                m_renderer_info.last_frame.occluded++;
+                continue;
+            }
+            if (m_software_occlusion_culling && m_software_occlusion_culler.is_occluded(dc.bounding_box))
+            {
+                m_renderer_info.last_frame.occluded++;
+                continue;
+            }
+            opaque_visible[c] = true;
+            m_renderer_info.last_frame.overdraw += screen_coverage(dc.bounding_box, view_projection);
+        }
+    }
+
+    // depth pre-pass
+    // Lays down the depth of fully opaque draws, so that the gbuffer pass only shades the visible fragments.
+    bool depth_prepass = m_depth_prepass && !m_wireframe;
+    if (depth_prepass)
+    {
+        int32 depth_prepass_node = m_render_graph.add_pass("Depth Pre-Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Depth Pre-Pass");
+            NAMED_PROFILE_ZONE("Depth Pre-Pass");
+            m_frame_context->set_render_targets(static_cast<int32>(m_gbuffer_render_targets.size()) - 1, m_gbuffer_render_targets.data(), m_gbuffer_render_targets.back());
+            for (int32 c = 0; c < opaque_count; ++c)
+            {
+                auto& dc = draws[c];
+                if (!opaque_visible[c] || !dc.depth_prepass)
+                    continue;
+
+                // Missing data is reported in the gbuffer pass.
+                optional<scene_primitive&> prim = scene->get_scene_primitive(dc.primitive_id);
+                optional<scene_node&> node      = scene->get_scene_node(dc.node_id);
+                if (!prim || !node)
+                    continue;
+
+                vertex_input_descriptor position_layout = renderer_pipeline_cache::position_only(prim->vertex_layout);
+                if (position_layout.binding_description_count == 0)
+                    continue;
+
+                gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache.get_depth_prepass(prim->vertex_layout, prim->input_assembly);
+                if (!dc_pipeline)
+                    continue;
+
+                m_frame_context->bind_pipeline(dc_pipeline);
+                m_frame_context->set_viewport(0, 1, &internal_viewport);
+
+                dc_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+
+                m_model_data.model_matrix = node->global_transformation_matrix;
+                m_frame_context->set_buffer_data(m_model_data_buffer, 0, sizeof(m_model_data), &m_model_data);
+
+                dc_pipeline->get_resource_mapping()->set("model_data", m_model_data_buffer);
+
+                m_frame_context->submit_pipeline_state_resources();
+
+                m_frame_context->set_index_buffer(prim->index_buffer_view.graphics_buffer, prim->index_type);
+
+                // Only the position stream is bound, at the binding it has in the full vertex layout.
+                int32 binding                         = position_layout.binding_descriptions[0].binding;
+                const scene_buffer_view& position_vbv = prim->vertex_buffer_views[binding];
+                gfx_handle<const gfx_buffer> vb       = position_vbv.graphics_buffer;
+                int32 offset                          = position_vbv.offset;
+                m_frame_context->set_vertex_buffers(1, &vb, &binding, &offset);
+
+                m_renderer_info.last_frame.draw_calls++;
+                m_frame_context->draw(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count, prim->draw_call_desc.instance_count, prim->draw_call_desc.base_vertex,
+                                      prim->draw_call_desc.base_instance, prim->draw_call_desc.index_offset);
+
+                opaque_prepassed[c] = true;
+            }
+        });
+        m_render_graph.write(depth_prepass_node, gbuffer_depth, render_graph_access::depth_target, render_graph_load_op::clear);
+    }
+
+    // gbuffer pass
+    // draw objects
+    int32 gbuffer_node = m_render_graph.add_pass("GBuffer Pass", [&]() {
+        GL_NAMED_PROFILE_ZONE("GBuffer Pass");
+        NAMED_PROFILE_ZONE("GBuffer Pass");
+        m_frame_context->set_render_targets(static_cast<int32>(m_gbuffer_render_targets.size()) - 1, m_gbuffer_render_targets.data(), m_gbuffer_render_targets.back());
+        for (int32 c = 0; c < opaque_count; ++c)
+        {
+            auto& dc = draws[c];
+
+            if (!opaque_visible[c])
+                continue;
             if (m_debug_bounds)
             {
                 auto& bb     = dc.bounding_box;
@@ -1381,12 +2115,12 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
                 continue;
             }
 
-            gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache.get_opaque(prim->vertex_layout, prim->input_assembly, m_wireframe);
+            // Draws in the depth pre-pass only pass equal depth and do not write it again.
+            gfx_handle<const gfx_pipeline> dc_pipeline = opaque_prepassed[c] ? m_pipeline_cache.get_opaque_prepassed(prim->vertex_layout, prim->input_assembly)
+                                                                             : m_pipeline_cache.get_opaque(prim->vertex_layout, prim->input_assembly, m_wireframe);
 
             m_frame_context->bind_pipeline(dc_pipeline);
-            gfx_viewport window_viewport{ static_cast<float>(m_renderer_info.canvas.x), static_cast<float>(m_renderer_info.canvas.y), static_cast<float>(m_renderer_info.canvas.width),
-                                          static_cast<float>(m_renderer_info.canvas.height) };
-            m_frame_context->set_viewport(0, 1, &window_viewport);
+            m_frame_context->set_viewport(0, 1, &internal_viewport);
 
             dc_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
 
@@ -1521,96 +2255,167 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
             m_frame_context->draw(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count, prim->draw_call_desc.instance_count, prim->draw_call_desc.base_vertex,
                                   prim->draw_call_desc.base_instance, prim->draw_call_desc.index_offset);
         }
+    });
+    // Lighting skips pixels without geometry, so the gbuffer colors do not require a clear.
+    for (int32 i = 0; i < static_cast<int32>(gbuffer_targets.size()) - 1; ++i)
+        m_render_graph.write(gbuffer_node, gbuffer_targets[i], render_graph_access::color_target, render_graph_load_op::dont_care);
+    m_render_graph.write(gbuffer_node, gbuffer_depth, render_graph_access::depth_target, depth_prepass ? render_graph_load_op::load : render_graph_load_op::clear);
+
+    // depth reduction for sample distribution shadow maps, read back in the next frame.
+    if (shadow_pass && !m_renderer_data.debug_view_enabled)
+    {
+        int32 depth_reduction_node = m_render_graph.add_pass("Shadow Depth Reduction", [&]() {
+            GL_NAMED_PROFILE_ZONE("Shadow Depth Reduction");
+            NAMED_PROFILE_ZONE("Shadow Depth Reduction");
+            shadow_pass->reduce_depth(m_frame_context, m_gbuffer_render_targets.back(), m_camera_data_buffer);
+        });
+        m_render_graph.read(depth_reduction_node, gbuffer_depth, render_graph_access::sampled);
+        m_render_graph.set_side_effects(depth_reduction_node);
     }
 
     auto irradiance = m_light_stack.get_skylight_irradiance_map();
     auto specular   = m_light_stack.get_skylight_specular_prefilter_map();
     // lighting pass
+    if (m_tiled_lighting)
     {
-        GL_NAMED_PROFILE_ZONE("Deferred Lighting Pass");
-        NAMED_PROFILE_ZONE("Deferred Lighting Pass");
-        m_frame_context->bind_pipeline(m_lighting_pass_pipeline);
+        int32 tiled_lighting_node = m_render_graph.add_pass("Tiled Lighting Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Tiled Lighting Pass");
+            NAMED_PROFILE_ZONE("Tiled Lighting Pass");
+            // Classify tiles by shadow and skylight requirements and append them to the tile lists, sky tiles are dropped.
+            m_frame_context->bind_pipeline(m_tile_classification_pipeline);
+
+            uint32 dispatch_reset[tile_class_count * 4];
+            for (int32 i = 0; i < tile_class_count; ++i)
+            {
+                dispatch_reset[i * 4 + 0] = 0; // Incremented for each tile of the class.
+                dispatch_reset[i * 4 + 1] = 1;
+                dispatch_reset[i * 4 + 2] = 1;
+                dispatch_reset[i * 4 + 3] = 0;
+            }
+            m_frame_context->set_buffer_data(m_tile_classification_buffer, 0, sizeof(dispatch_reset), dispatch_reset);
+            m_frame_context->set_buffer_data(m_tile_lighting_data_buffer, 0, sizeof(tile_lighting_data), &m_tile_lighting_data);
+
+            m_tile_classification_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+            m_tile_classification_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer);
+            m_tile_classification_pipeline->get_resource_mapping()->set("light_data", m_light_data_buffer);
+            m_tile_classification_pipeline->get_resource_mapping()->set("tile_lighting_data", m_tile_lighting_data_buffer);
+            m_tile_classification_pipeline->get_resource_mapping()->set("tile_classification", m_tile_classification_buffer);
+            m_tile_classification_pipeline->get_resource_mapping()->set("texture_gbuffer_c1", m_gbuffer_render_targets[1]);
+            m_tile_classification_pipeline->get_resource_mapping()->set("sampler_gbuffer_c1", m_nearest_sampler);
+            m_tile_classification_pipeline->get_resource_mapping()->set("texture_gbuffer_depth", m_gbuffer_render_targets[4]);
+            m_tile_classification_pipeline->get_resource_mapping()->set("sampler_gbuffer_depth", m_nearest_sampler);
 
-        gfx_viewport window_viewport{ static_cast<float>(m_renderer_info.canvas.x), static_cast<float>(m_renderer_info.canvas.y), static_cast<float>(m_renderer_info.canvas.width),
-                                      static_cast<float>(m_renderer_info.canvas.height) };
-        m_frame_context->set_viewport(0, 1, &window_viewport);
+            m_frame_context->submit_pipeline_state_resources();
 
-        m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
+            m_frame_context->dispatch(m_tile_lighting_data.tile_count_x, m_tile_lighting_data.tile_count_y, 1);
 
-        m_lighting_pass_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer); // TODO Paul: Refill (Atm only filled on construction).
-        m_lighting_pass_pipeline->get_resource_mapping()->set("light_data", m_light_data_buffer);
-        // m_lighting_pass_pipeline->get_resource_mapping()->set("shadow_data", ); // TODO Paul: Should be filled in the shadow step. Nothing here yet.
-
-        m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c0", m_gbuffer_render_targets[0]);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c0", m_nearest_sampler);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c1", m_gbuffer_render_targets[1]);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c1", m_nearest_sampler);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c2", m_gbuffer_render_targets[2]);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c2", m_nearest_sampler);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c3", m_gbuffer_render_targets[3]);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c3", m_nearest_sampler);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_depth", m_gbuffer_render_targets[4]);
-        m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_depth", m_nearest_sampler);
-
-        if (irradiance && specular) // If this exists the rest has to exist too
-        {
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_irradiance_map", irradiance);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_irradiance_map", m_mipmapped_linear_sampler);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_radiance_map", specular);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_radiance_map", m_mipmapped_linear_sampler);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_brdf_integration_lut", m_light_stack.get_skylight_brdf_lookup());
-            m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_brdf_integration_lut", m_linear_sampler);
-        }
-        else
-        {
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_irradiance_map", default_texture_cube);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_radiance_map", default_texture_cube);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_brdf_integration_lut", default_texture_2D);
-        }
+            barrier_description bd;
+            bd.barrier_bit = gfx_barrier_bit::shader_storage_barrier_bit | gfx_barrier_bit::command_barrier_bit;
+            m_frame_context->barrier(bd);
 
+            // Light each class with its variant, the work group counts come from the classification. Sky tiles are never dispatched.
+            auto hdr_view = m_graphics_device->create_image_texture_view(m_hdr_buffer_render_targets[0], 0);
+
+            for (int32 i = 0; i < tile_class_count; ++i)
+            {
+                m_frame_context->bind_pipeline(m_tiled_lighting_pipelines[i]);
+
+                set_lighting_resources(m_tiled_lighting_pipelines[i], shadow_pass, irradiance, specular);
+                m_tiled_lighting_pipelines[i]->get_resource_mapping()->set("tile_lighting_data", m_tile_lighting_data_buffer);
+                m_tiled_lighting_pipelines[i]->get_resource_mapping()->set("tile_classification", m_tile_classification_buffer);
+                m_tiled_lighting_pipelines[i]->get_resource_mapping()->set("image_hdr_output", hdr_view);
+
+                m_frame_context->submit_pipeline_state_resources();
+
+                m_frame_context->dispatch_indirect(m_tile_classification_buffer, i * 4 * static_cast<int32>(sizeof(uint32)));
+            }
+        });
+        for (int32 i = 0; i < static_cast<int32>(gbuffer_targets.size()); ++i)
+            m_render_graph.read(tiled_lighting_node, gbuffer_targets[i], render_graph_access::sampled);
         if (shadow_pass)
-        {
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_shadow_map_comp", shadow_pass->get_shadow_maps_texture());
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_shadow_map", shadow_pass->get_shadow_maps_texture());
-            m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_shadow_shadow_map", shadow_pass->get_shadow_maps_shadow_sampler());
-            m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_shadow_map", shadow_pass->get_shadow_maps_sampler());
-        }
-        else
-        {
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_shadow_map_comp", default_texture_array);
-            m_lighting_pass_pipeline->get_resource_mapping()->set("texture_shadow_map", default_texture_array);
-        }
+            m_render_graph.read(tiled_lighting_node, shadow_maps, render_graph_access::sampled);
+        // Sky tiles are not written.
+        m_render_graph.write(tiled_lighting_node, hdr_color, render_graph_access::image_store, render_graph_load_op::clear);
+
+        int32 depth_copy_node = m_render_graph.add_pass("Depth Copy Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Depth Copy Pass");
+            NAMED_PROFILE_ZONE("Depth Copy Pass");
+            // Compute shaders can not write the depth attachment, so the geometry depth is copied for transparent objects and cubemap.
+            m_frame_context->bind_pipeline(m_depth_copy_pipeline);
+
+            m_frame_context->set_viewport(0, 1, &internal_viewport);
+
+            m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
+
+            m_depth_copy_pipeline->get_resource_mapping()->set("texture_gbuffer_depth", m_gbuffer_render_targets[4]);
+            m_depth_copy_pipeline->get_resource_mapping()->set("sampler_gbuffer_depth", m_nearest_sampler);
 
-        m_frame_context->submit_pipeline_state_resources();
+            m_frame_context->submit_pipeline_state_resources();
+
+            m_frame_context->set_index_buffer(nullptr, gfx_format::invalid);
+            m_frame_context->set_vertex_buffers(0, nullptr, nullptr, nullptr);
+
+            m_renderer_info.last_frame.draw_calls++;
+            m_renderer_info.last_frame.vertices += 3;
+            m_frame_context->draw(3, 0, 1, 0, 0, 0); // Triangle gets created in geometry shader.
+        });
+        m_render_graph.read(depth_copy_node, gbuffer_depth, render_graph_access::sampled);
+        m_render_graph.write(depth_copy_node, hdr_color, render_graph_access::color_target, render_graph_load_op::load);
+        m_render_graph.write(depth_copy_node, hdr_depth, render_graph_access::depth_target, render_graph_load_op::dont_care);
+    }
+    else
+    {
+        int32 lighting_node = m_render_graph.add_pass("Deferred Lighting Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Deferred Lighting Pass");
+            NAMED_PROFILE_ZONE("Deferred Lighting Pass");
+            m_frame_context->bind_pipeline(m_lighting_pass_pipeline);
+
+            m_frame_context->set_viewport(0, 1, &internal_viewport);
+
+            m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
+
+            set_lighting_resources(m_lighting_pass_pipeline, shadow_pass, irradiance, specular);
 
-        m_frame_context->set_index_buffer(nullptr, gfx_format::invalid);
-        m_frame_context->set_vertex_buffers(0, nullptr, nullptr, nullptr);
+            m_frame_context->submit_pipeline_state_resources();
+
+            m_frame_context->set_index_buffer(nullptr, gfx_format::invalid);
+            m_frame_context->set_vertex_buffers(0, nullptr, nullptr, nullptr);
 
-        m_renderer_info.last_frame.draw_calls++;
-        m_renderer_info.last_frame.vertices += 3;
-        m_frame_context->draw(3, 0, 1, 0, 0, 0); // Triangle gets created in geometry shader.
+            m_renderer_info.last_frame.draw_calls++;
+            m_renderer_info.last_frame.vertices += 3;
+            m_frame_context->draw(3, 0, 1, 0, 0, 0); // Triangle gets created in geometry shader.
+        });
+        for (int32 i = 0; i < static_cast<int32>(gbuffer_targets.size()); ++i)
+            m_render_graph.read(lighting_node, gbuffer_targets[i], render_graph_access::sampled);
+        if (shadow_pass)
+            m_render_graph.read(lighting_node, shadow_maps, render_graph_access::sampled);
+        // Pixels without geometry are discarded.
+        m_render_graph.write(lighting_node, hdr_color, render_graph_access::color_target, render_graph_load_op::clear);
+        m_render_graph.write(lighting_node, hdr_depth, render_graph_access::depth_target, render_graph_load_op::clear);
     }
 
     // cubemap pass
-    if (!m_renderer_data.debug_view_enabled)
+    auto environment_display_pass = std::static_pointer_cast<environment_display_step>(m_pipeline_steps[mango::render_pipeline_step::environment_display]);
+    if (!m_renderer_data.debug_view_enabled && environment_display_pass && specular)
     {
-        GL_NAMED_PROFILE_ZONE("Environment Display Pass");
-        NAMED_PROFILE_ZONE("Environment Display Pass");
-        auto environment_display_pass = std::static_pointer_cast<environment_display_step>(m_pipeline_steps[mango::render_pipeline_step::environment_display]);
-        if (environment_display_pass && specular)
-        {
+        int32 environment_display_node = m_render_graph.add_pass("Environment Display Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Environment Display Pass");
+            NAMED_PROFILE_ZONE("Environment Display Pass");
+            m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
             environment_display_pass->set_cubemap(specular);
             m_renderer_info.last_frame.draw_calls++;
             m_renderer_info.last_frame.vertices += 18;
             environment_display_pass->execute();
-        }
+        });
+        m_render_graph.write(environment_display_node, hdr_color, render_graph_access::color_target, render_graph_load_op::load);
+        m_render_graph.write(environment_display_node, hdr_depth, render_graph_access::depth_target, render_graph_load_op::load);
     }
 
     // transparent pass
-    {
+    int32 transparent_node = m_render_graph.add_pass("Transparent Pass", [&]() {
         GL_NAMED_PROFILE_ZONE("Transparent Pass");
         NAMED_PROFILE_ZONE("Transparent Pass");
+        m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
         for (uint32 c = opaque_count; c < draws.size(); ++c)
         {
             auto& dc = draws[c];
@@ -1621,6 +2426,16 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
                 if (!camera_frustum.intersects(bb))
                     continue;
             }
+            if (m_hi_z_culler.check_occlusion(dc.node_id, dc.primitive_id, dc.bounding_box))
+            {
+                m_renderer_info.last_frame.occluded++;
+                continue;
+            }
+            if (m_software_occlusion_culling && m_software_occlusion_culler.is_occluded(dc.bounding_box))
+            {
+                m_renderer_info.last_frame.occluded++;
+                continue;
+            }
             if (m_debug_bounds)
             {
                 auto& bb     = dc.bounding_box;
@@ -1662,14 +2477,16 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
             }
 
             gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache.get_transparent(prim->vertex_layout, prim->input_assembly, m_wireframe);
+            if (!dc_pipeline)
+                continue; // Still compiling.
 
             m_frame_context->bind_pipeline(dc_pipeline);
 
-            gfx_viewport window_viewport{ static_cast<float>(m_renderer_info.canvas.x), static_cast<float>(m_renderer_info.canvas.y), static_cast<float>(m_renderer_info.canvas.width),
-                                          static_cast<float>(m_renderer_info.canvas.height) };
-            m_frame_context->set_viewport(0, 1, &window_viewport);
+            m_frame_context->set_viewport(0, 1, &internal_viewport);
 
             dc_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+            dc_pipeline->get_resource_mapping()->set("punctual_light_data", m_light_stack.get_punctual_light_buffer());
+            dc_pipeline->get_resource_mapping()->set("light_cluster_data", m_light_stack.get_light_cluster_buffer());
 
             m_model_data.model_matrix  = node->global_transformation_matrix;
             m_model_data.normal_matrix = std140_mat3(mat3(glm::transpose(glm::inverse(node->global_transformation_matrix))));
@@ -1829,6 +2646,22 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
             m_frame_context->draw(prim->draw_call_desc.vertex_count, prim->draw_call_desc.index_count, prim->draw_call_desc.instance_count, prim->draw_call_desc.base_vertex,
                                   prim->draw_call_desc.base_instance, prim->draw_call_desc.index_offset);
         }
+    });
+    if (shadow_pass)
+        m_render_graph.read(transparent_node, shadow_maps, render_graph_access::sampled);
+    m_render_graph.write(transparent_node, hdr_color, render_graph_access::color_target, render_graph_load_op::load);
+    m_render_graph.write(transparent_node, hdr_depth, render_graph_access::depth_target, render_graph_load_op::load);
+
+    // occlusion test against the depth pyramid of this frame, read back in the next frames.
+    if (m_occlusion_culling)
+    {
+        int32 occlusion_culling_node = m_render_graph.add_pass("Occlusion Culling", [&]() {
+            GL_NAMED_PROFILE_ZONE("Occlusion Culling");
+            NAMED_PROFILE_ZONE("Occlusion Culling");
+            m_hi_z_culler.cull(m_frame_context, m_gbuffer_render_targets.back(), m_camera_data_buffer);
+        });
+        m_render_graph.read(occlusion_culling_node, gbuffer_depth, render_graph_access::sampled);
+        m_render_graph.set_side_effects(occlusion_culling_node);
     }
 
     m_debug_drawer.update_buffer();
@@ -1836,118 +2669,218 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
     // auto exposure
     if (auto_exposure)
     {
-        GL_NAMED_PROFILE_ZONE("Auto Exposure Calculation");
-        NAMED_PROFILE_ZONE("Auto Exposure Calculation");
-        m_frame_context->bind_pipeline(m_luminance_construction_pipeline);
+        int32 auto_exposure_node = m_render_graph.add_pass("Auto Exposure Calculation", [&]() {
+            GL_NAMED_PROFILE_ZONE("Auto Exposure Calculation");
+            NAMED_PROFILE_ZONE("Auto Exposure Calculation");
+            m_frame_context->bind_pipeline(m_luminance_construction_pipeline);
 
-        m_frame_context->calculate_mipmaps(m_hdr_buffer_render_targets[0]);
+            m_frame_context->calculate_mipmaps(m_hdr_buffer_render_targets[0]);
 
-        int32 mip_level = 0;
-        int32 hr_width  = m_renderer_info.canvas.width;
-        int32 hr_height = m_renderer_info.canvas.height;
-        while (hr_width >> mip_level > 512 && hr_height >> mip_level > 512) // we can make it smaller, when we have some better focussing.
-        {
-            ++mip_level;
-        }
-        hr_width >>= mip_level;
-        hr_height >>= mip_level;
+            int32 mip_level = 0;
+            int32 hr_width  = m_internal_resolution.x;
+            int32 hr_height = m_internal_resolution.y;
+            while (hr_width >> mip_level > 512 && hr_height >> mip_level > 512) // we can make it smaller, when we have some better focussing.
+            {
+                ++mip_level;
+            }
+            hr_width >>= mip_level;
+            hr_height >>= mip_level;
 
-        barrier_description bd;
-        bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit;
-        m_frame_context->barrier(bd);
+            barrier_description bd;
+            bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit;
+            m_frame_context->barrier(bd);
 
-        auto hdr_view = m_graphics_device->create_image_texture_view(m_hdr_buffer_render_targets[0], mip_level);
+            auto hdr_view = m_graphics_device->create_image_texture_view(m_hdr_buffer_render_targets[0], mip_level);
 
-        m_frame_context->client_wait(m_luminance_semaphore);
+            // The slot was used luminance_ring_size frames ago, so this does usually not wait.
+            int32 slot = m_luminance_slot;
+            m_frame_context->client_wait(m_luminance_semaphores[slot]);
 
-        // time coefficient with tau = 1.1;
-        float tau                        = 1.1f;
-        float time_coefficient           = 1.0f - expf(-dt * tau);
-        m_luminance_data_mapping->params = vec4(-8.0f, 1.0f / 31.0f, time_coefficient, hr_width * hr_height); // min -8.0, max +23.0
+            m_luminance_data_mappings[slot]->params = vec4(-8.0f, 1.0f / 31.0f, 0.0f, hr_width * hr_height); // min -8.0, max +23.0
 
-        m_luminance_construction_pipeline->get_resource_mapping()->set("image_hdr_color", hdr_view);
-        m_luminance_construction_pipeline->get_resource_mapping()->set("luminance_data", m_luminance_data_buffer);
-        m_frame_context->submit_pipeline_state_resources();
+            m_luminance_construction_pipeline->get_resource_mapping()->set("image_hdr_color", hdr_view);
+            m_luminance_construction_pipeline->get_resource_mapping()->set("luminance_data", m_luminance_data_buffers[slot]);
+            m_frame_context->submit_pipeline_state_resources();
 
-        m_frame_context->dispatch(hr_width / 16, hr_height / 16, 1);
+            m_frame_context->dispatch(hr_width / 16, hr_height / 16, 1);
 
-        bd.barrier_bit = gfx_barrier_bit::shader_storage_barrier_bit;
-        m_frame_context->barrier(bd);
+            bd.barrier_bit = gfx_barrier_bit::shader_storage_barrier_bit;
+            m_frame_context->barrier(bd);
 
-        m_frame_context->bind_pipeline(m_luminance_reduction_pipeline);
+            m_frame_context->bind_pipeline(m_luminance_reduction_pipeline);
 
-        m_luminance_reduction_pipeline->get_resource_mapping()->set("luminance_data", m_luminance_data_buffer);
-        m_frame_context->submit_pipeline_state_resources();
+            m_luminance_reduction_pipeline->get_resource_mapping()->set("luminance_data", m_luminance_data_buffers[slot]);
+            m_frame_context->submit_pipeline_state_resources();
 
-        m_frame_context->dispatch(1, 1, 1);
+            m_frame_context->dispatch(1, 1, 1);
 
-        m_luminance_semaphore = m_frame_context->fence(semaphore_create_info());
+            m_luminance_semaphores[slot] = m_frame_context->fence(semaphore_create_info());
+            m_luminance_pending[slot]    = true;
+            m_luminance_slot             = (slot + 1) % luminance_ring_size;
+        });
+        m_render_graph.read(auto_exposure_node, hdr_color, render_graph_access::image_load);
+        m_render_graph.set_side_effects(auto_exposure_node);
     }
 
     auto fxaa_pass             = std::static_pointer_cast<fxaa_step>(m_pipeline_steps[mango::render_pipeline_step::fxaa]);
     bool postprocessing_buffer = fxaa_pass != nullptr;
+    // Debug lines are drawn into the composed image with depth test, so they require the separate passes.
+    bool fused_post_processing = fxaa_pass && m_fused_post_processing && !m_debug_bounds;
 
-    // composing pass
-    {
-        GL_NAMED_PROFILE_ZONE("Composing Pass");
-        NAMED_PROFILE_ZONE("Composing Pass");
-        m_frame_context->bind_pipeline(m_composing_pass_pipeline);
-
-        gfx_viewport window_viewport{ static_cast<float>(m_renderer_info.canvas.x), static_cast<float>(m_renderer_info.canvas.y), static_cast<float>(m_renderer_info.canvas.width),
-                                      static_cast<float>(m_renderer_info.canvas.height) };
-        m_frame_context->set_viewport(0, 1, &window_viewport);
-
+    render_graph_texture composing_color = postprocessing_buffer ? post_color : output_color;
+    render_graph_texture composing_depth = postprocessing_buffer ? post_depth : output_depth;
+    auto set_composing_targets           = [&]() {
         if (postprocessing_buffer)
             m_frame_context->set_render_targets(static_cast<int32>(m_post_render_targets.size()) - 1, m_post_render_targets.data(), m_post_render_targets.back());
         else
             m_frame_context->set_render_targets(1, &m_output_target, m_ouput_depth_target);
+    };
+
+    // Tonemapping, fxaa and the output conversion in one dispatch, the composed image never goes through memory.
+    if (fused_post_processing)
+    {
+        int32 post_stack_node = m_render_graph.add_pass("Post Stack Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Post Stack Pass");
+            NAMED_PROFILE_ZONE("Post Stack Pass");
+            m_frame_context->bind_pipeline(m_post_stack_pipeline);
+
+            // The settings rarely change, so they are only uploaded on changes.
+            vec2 inverse_screen_size = 1.0f / m_output_target->get_size();
+            int32 quality_preset     = fxaa_pass->get_quality_preset();
+            float subpixel_filter    = fxaa_pass->get_subpixel_filter();
+            if (static_cast<vec2&>(m_post_stack_data.inverse_screen_size) != inverse_screen_size || m_post_stack_data.quality_preset != quality_preset ||
+                m_post_stack_data.subpixel_filter != subpixel_filter)
+            {
+                m_post_stack_data.inverse_screen_size = inverse_screen_size;
+                m_post_stack_data.quality_preset      = quality_preset;
+                m_post_stack_data.subpixel_filter     = subpixel_filter;
+                m_frame_context->set_buffer_data(m_post_stack_data_buffer, 0, sizeof(post_stack_data), &m_post_stack_data);
+            }
+
+            auto output_view = m_graphics_device->create_image_texture_view(m_output_target, 0);
+
+            m_post_stack_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+            m_post_stack_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer);
+            m_post_stack_pipeline->get_resource_mapping()->set("post_stack_data", m_post_stack_data_buffer);
+            m_post_stack_pipeline->get_resource_mapping()->set("texture_hdr_input", m_hdr_buffer_render_targets[0]);
+            // Texel centers are sampled exactly without scaling, the filtering is only required for upscaling and the edge search.
+            m_post_stack_pipeline->get_resource_mapping()->set("sampler_hdr_input", m_linear_sampler);
+            m_post_stack_pipeline->get_resource_mapping()->set("image_post_output", output_view);
+
+            m_frame_context->submit_pipeline_state_resources();
+
+            m_frame_context->dispatch((m_renderer_info.canvas.width + post_tile_size - 1) / post_tile_size, (m_renderer_info.canvas.height + post_tile_size - 1) / post_tile_size, 1);
+
+            // The output is sampled or blitted outside of the render graph.
+            barrier_description bd;
+            bd.barrier_bit = gfx_barrier_bit::texture_fetch_barrier_bit | gfx_barrier_bit::framebuffer_barrier_bit;
+            m_frame_context->barrier(bd);
+        });
+        m_render_graph.read(post_stack_node, hdr_color, render_graph_access::sampled);
+        m_render_graph.write(post_stack_node, output_color, render_graph_access::image_store, render_graph_load_op::dont_care);
+        // The output depth is only cleared, like in the fxaa pass.
+        m_render_graph.write(post_stack_node, output_depth, render_graph_access::depth_target, render_graph_load_op::clear);
+    }
+    else
+    {
+        // composing pass
+        int32 composing_node = m_render_graph.add_pass("Composing Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Composing Pass");
+            NAMED_PROFILE_ZONE("Composing Pass");
+            m_frame_context->bind_pipeline(m_composing_pass_pipeline);
+
+            gfx_viewport window_viewport{ static_cast<float>(m_renderer_info.canvas.x), static_cast<float>(m_renderer_info.canvas.y), static_cast<float>(m_renderer_info.canvas.width),
+                                          static_cast<float>(m_renderer_info.canvas.height) };
+            m_frame_context->set_viewport(0, 1, &window_viewport);
+
+            set_composing_targets();
 
-        m_composing_pass_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
-        m_composing_pass_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer);
-        m_composing_pass_pipeline->get_resource_mapping()->set("texture_hdr_input", m_hdr_buffer_render_targets[0]);
-        m_composing_pass_pipeline->get_resource_mapping()->set("sampler_hdr_input", m_nearest_sampler);
-        m_composing_pass_pipeline->get_resource_mapping()->set("texture_geometry_depth_input", m_hdr_buffer_render_targets.back());
-        m_composing_pass_pipeline->get_resource_mapping()->set("sampler_geometry_depth_input", m_nearest_sampler);
+            m_composing_pass_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+            m_composing_pass_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer);
+            m_composing_pass_pipeline->get_resource_mapping()->set("texture_hdr_input", m_hdr_buffer_render_targets[0]);
+            // A scaled sub-rectangle is upscaled with bilinear filtering.
+            bool upscale = m_internal_resolution != ivec2(m_renderer_info.canvas.width, m_renderer_info.canvas.height);
+            m_composing_pass_pipeline->get_resource_mapping()->set("sampler_hdr_input", upscale ? m_linear_sampler : m_nearest_sampler);
+            m_composing_pass_pipeline->get_resource_mapping()->set("texture_geometry_depth_input", m_hdr_buffer_render_targets.back());
+            m_composing_pass_pipeline->get_resource_mapping()->set("sampler_geometry_depth_input", m_nearest_sampler);
 
-        m_frame_context->submit_pipeline_state_resources();
+            m_frame_context->submit_pipeline_state_resources();
 
-        m_frame_context->set_index_buffer(nullptr, gfx_format::invalid);
-        m_frame_context->set_vertex_buffers(0, nullptr, nullptr, nullptr);
+            m_frame_context->set_index_buffer(nullptr, gfx_format::invalid);
+            m_frame_context->set_vertex_buffers(0, nullptr, nullptr, nullptr);
 
-        m_renderer_info.last_frame.draw_calls++;
-        m_renderer_info.last_frame.vertices += 3;
-        m_frame_context->draw(3, 0, 1, 0, 0, 0); // Triangle gets created in geometry shader.
+            m_renderer_info.last_frame.draw_calls++;
+            m_renderer_info.last_frame.vertices += 3;
+            m_frame_context->draw(3, 0, 1, 0, 0, 0); // Triangle gets created in geometry shader.
+        });
+        m_render_graph.read(composing_node, hdr_color, render_graph_access::sampled);
+        m_render_graph.read(composing_node, hdr_depth, render_graph_access::sampled);
+        // The fullscreen triangle writes color and depth of every pixel.
+        m_render_graph.write(composing_node, composing_color, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_render_graph.write(composing_node, composing_depth, render_graph_access::depth_target, render_graph_load_op::dont_care);
     }
 
     // debug lines
     if (m_debug_bounds)
     {
-        m_renderer_info.last_frame.draw_calls++;
-        m_renderer_info.last_frame.vertices += m_debug_drawer.vertex_count();
-        // use the already set render targets ...
-        m_debug_drawer.execute();
+        int32 debug_lines_node = m_render_graph.add_pass("Debug Lines", [&]() {
+            set_composing_targets();
+            m_renderer_info.last_frame.draw_calls++;
+            m_renderer_info.last_frame.vertices += m_debug_drawer.vertex_count();
+            m_debug_drawer.execute();
+        });
+        m_render_graph.write(debug_lines_node, composing_color, render_graph_access::color_target, render_graph_load_op::load);
+        m_render_graph.write(debug_lines_node, composing_depth, render_graph_access::depth_target, render_graph_load_op::load);
     }
 
     // fxaa
+    if (fxaa_pass && !fused_post_processing)
     {
-        GL_NAMED_PROFILE_ZONE("Fxaa Pass");
-        NAMED_PROFILE_ZONE("Fxaa Pass");
-        if (fxaa_pass)
-        {
-            fxaa_pass->set_input_texture(m_post_render_targets[0]); // TODO Paul Hardcoded post targets -> meh.
+        int32 fxaa_node = m_render_graph.add_pass("Fxaa Pass", [&]() {
+            GL_NAMED_PROFILE_ZONE("Fxaa Pass");
+            NAMED_PROFILE_ZONE("Fxaa Pass");
+            fxaa_pass->set_input_texture(m_post_render_targets[0]);
             m_renderer_info.last_frame.draw_calls++;
             m_renderer_info.last_frame.vertices += 3;
             fxaa_pass->execute();
-        }
+        });
+        m_render_graph.read(fxaa_node, post_color, render_graph_access::sampled);
+        m_render_graph.write(fxaa_node, output_color, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_render_graph.write(fxaa_node, output_depth, render_graph_access::depth_target, render_graph_load_op::clear);
     }
 
-    m_frame_context->bind_pipeline(nullptr);
     // TODO Paul: Is the renderer in charge here?
-    m_frame_context->set_render_targets(1, &swap_buffer, m_graphics_device->get_swap_chain_depth_stencil_target());
+    // The swap chain is not drawn by the renderer, so it is cleared and left bound for the user interface.
+    int32 swap_chain_node = m_render_graph.add_pass("Swap Chain", [&]() {
+        m_frame_context->bind_pipeline(nullptr);
+        m_frame_context->set_render_targets(1, &swap_buffer, m_graphics_device->get_swap_chain_depth_stencil_target());
+    });
+    m_render_graph.write(swap_chain_node, swap_chain_color, render_graph_access::color_target, render_graph_load_op::clear);
+    m_render_graph.write(swap_chain_node, swap_chain_depth, render_graph_access::depth_target, render_graph_load_op::clear);
+
+    m_render_graph.compile();
+    if (!m_render_graph.allocate(m_graphics_device))
+    {
+        MANGO_LOG_ERROR("Allocating the render graph textures failed!");
+        return;
+    }
+
+    m_gbuffer_render_targets.clear();
+    for (auto t : gbuffer_targets)
+        m_gbuffer_render_targets.push_back(m_render_graph.get_texture(t));
+    m_hdr_buffer_render_targets = { m_render_graph.get_texture(hdr_color), m_render_graph.get_texture(hdr_depth) };
+    m_post_render_targets       = { m_render_graph.get_texture(post_color), m_render_graph.get_texture(post_depth) };
+
+    m_render_graph.execute(m_frame_context);
 }
 
 void deferred_pbr_renderer::present()
 {
+    if (m_dynamic_resolution && m_frame_timestamps[m_timestamp_slot][0])
+    {
+        m_frame_timestamps[m_timestamp_slot][1] = m_frame_context->timestamp();
+        m_timestamp_slot                        = (m_timestamp_slot + 1) % timestamp_ring_size;
+    }
     m_frame_context->present();
     m_frame_semaphore = m_frame_context->fence(semaphore_create_info());
     m_frame_context->end();
@@ -1961,7 +2894,7 @@ void deferred_pbr_renderer::set_viewport(int32 x, int32 y, int32 width, int32 he
     MANGO_ASSERT(width >= 0, "Viewport width has to be positive!");
     MANGO_ASSERT(height >= 0, "Viewport height has to be positive!");
 
-    // Resize everything ... Samplers are not required ... But ...
+    // Samplers and default textures do not depend on the size, only the render targets are recreated.
     if (m_renderer_info.canvas.x != x || m_renderer_info.canvas.y != y || m_renderer_info.canvas.width != width || m_renderer_info.canvas.height != height)
     {
         m_renderer_info.canvas.x      = x;
@@ -1969,7 +2902,7 @@ void deferred_pbr_renderer::set_viewport(int32 x, int32 y, int32 width, int32 he
         m_renderer_info.canvas.width  = width;
         m_renderer_info.canvas.height = height;
 
-        create_textures_and_samplers();
+        create_render_targets();
     }
 }
 
@@ -1988,6 +2921,35 @@ void deferred_pbr_renderer::on_ui_widget()
         device_context->submit();
     }
     checkbox("Frustum Culling", &m_frustum_culling, true);
+    checkbox("Occlusion Culling (Hi-Z)", &m_occlusion_culling, false);
+    checkbox("Occlusion Culling (Software)", &m_software_occlusion_culling, false);
+    checkbox("Depth Pre-Pass", &m_depth_prepass, false);
+    checkbox("Tiled Lighting (Compute)", &m_tiled_lighting, false);
+    checkbox("Fused Post-Processing", &m_fused_post_processing, false);
+    if (checkbox("Dynamic Resolution", &m_dynamic_resolution, false))
+    {
+        // Enabling keeps the internal targets, disabling shrinks them to the canvas again.
+        m_resolution_controller.reset();
+        for (int32 i = 0; i < timestamp_ring_size; ++i)
+        {
+            m_frame_timestamps[i][0] = nullptr;
+            m_frame_timestamps[i][1] = nullptr;
+        }
+        create_render_targets();
+    }
+    if (m_dynamic_resolution)
+    {
+        float target_frame_time = m_resolution_controller.get_target_frame_time();
+        float default_value     = 16.0f;
+        if (slider_float_n("Target GPU Time (ms)", &target_frame_time, 1, &default_value, 2.0f, 50.0f, "%.1f"))
+            m_resolution_controller.set_target_frame_time(target_frame_time);
+        custom_info("Resolution Scale:", [this]() {
+            ImGui::Text("%.2f (%d x %d), %.2f ms", m_resolution_controller.get_scale(), m_internal_resolution.x, m_internal_resolution.y, m_resolution_controller.get_frame_time());
+        });
+    }
+    custom_info("GBuffer Layout:", [this]() { ImGui::Text(m_compact_gbuffer ? "Compact" : "Reference"); });
+    custom_info("Render Graph Passes:", [this]() { ImGui::Text("%d (%d culled)", m_render_graph.pass_count(), m_render_graph.culled_pass_count()); });
+    custom_info("Render Graph Textures:", [this]() { ImGui::Text("%d in %d targets", m_render_graph.transient_texture_count(), m_render_graph.slot_count()); });
     ImGui::Separator();
     bool has_environment_display = m_pipeline_steps[mango::render_pipeline_step::environment_display] != nullptr;
     bool has_shadow_map          = m_pipeline_steps[mango::render_pipeline_step::shadow_map] != nullptr;
@@ -2106,7 +3068,63 @@ void deferred_pbr_renderer::on_ui_widget()
     ImGui::PopID();
 }
 
-float deferred_pbr_renderer::apply_exposure(scene_camera& camera, bool adaptive)
+void deferred_pbr_renderer::warm_up_pipelines(const vertex_input_descriptor& vertex_layout, const input_assembly_descriptor& input_assembly)
+{
+    m_pipeline_cache.warm_up(vertex_layout, input_assembly);
+}
+
+void deferred_pbr_renderer::set_lighting_resources(const gfx_handle<const gfx_pipeline>& pipeline, const shared_ptr<shadow_map_step>& shadow_pass, gfx_handle<const gfx_texture> irradiance,
+                                                   gfx_handle<const gfx_texture> specular)
+{
+    pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+    pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer); // TODO Paul: Refill (Atm only filled on construction).
+    pipeline->get_resource_mapping()->set("light_data", m_light_data_buffer);
+    pipeline->get_resource_mapping()->set("punctual_light_data", m_light_stack.get_punctual_light_buffer());
+    pipeline->get_resource_mapping()->set("light_cluster_data", m_light_stack.get_light_cluster_buffer());
+    // pipeline->get_resource_mapping()->set("shadow_data", ); // TODO Paul: Should be filled in the shadow step. Nothing here yet.
+
+    pipeline->get_resource_mapping()->set("texture_gbuffer_c0", m_gbuffer_render_targets[0]);
+    pipeline->get_resource_mapping()->set("sampler_gbuffer_c0", m_nearest_sampler);
+    pipeline->get_resource_mapping()->set("texture_gbuffer_c1", m_gbuffer_render_targets[1]);
+    pipeline->get_resource_mapping()->set("sampler_gbuffer_c1", m_nearest_sampler);
+    pipeline->get_resource_mapping()->set("texture_gbuffer_c2", m_gbuffer_render_targets[2]);
+    pipeline->get_resource_mapping()->set("sampler_gbuffer_c2", m_nearest_sampler);
+    pipeline->get_resource_mapping()->set("texture_gbuffer_c3", m_gbuffer_render_targets[3]);
+    pipeline->get_resource_mapping()->set("sampler_gbuffer_c3", m_nearest_sampler);
+    pipeline->get_resource_mapping()->set("texture_gbuffer_depth", m_gbuffer_render_targets[4]);
+    pipeline->get_resource_mapping()->set("sampler_gbuffer_depth", m_nearest_sampler);
+
+    if (irradiance && specular) // If this exists the rest has to exist too
+    {
+        pipeline->get_resource_mapping()->set("texture_irradiance_map", irradiance);
+        pipeline->get_resource_mapping()->set("sampler_irradiance_map", m_mipmapped_linear_sampler);
+        pipeline->get_resource_mapping()->set("texture_radiance_map", specular);
+        pipeline->get_resource_mapping()->set("sampler_radiance_map", m_mipmapped_linear_sampler);
+        pipeline->get_resource_mapping()->set("texture_brdf_integration_lut", m_light_stack.get_skylight_brdf_lookup());
+        pipeline->get_resource_mapping()->set("sampler_brdf_integration_lut", m_linear_sampler);
+    }
+    else
+    {
+        pipeline->get_resource_mapping()->set("texture_irradiance_map", default_texture_cube);
+        pipeline->get_resource_mapping()->set("texture_radiance_map", default_texture_cube);
+        pipeline->get_resource_mapping()->set("texture_brdf_integration_lut", default_texture_2D);
+    }
+
+    if (shadow_pass)
+    {
+        pipeline->get_resource_mapping()->set("texture_shadow_map_comp", shadow_pass->get_shadow_maps_texture());
+        pipeline->get_resource_mapping()->set("texture_shadow_map", shadow_pass->get_shadow_maps_texture());
+        pipeline->get_resource_mapping()->set("sampler_shadow_shadow_map", shadow_pass->get_shadow_maps_shadow_sampler());
+        pipeline->get_resource_mapping()->set("sampler_shadow_map", shadow_pass->get_shadow_maps_sampler());
+    }
+    else
+    {
+        pipeline->get_resource_mapping()->set("texture_shadow_map_comp", default_texture_array);
+        pipeline->get_resource_mapping()->set("texture_shadow_map", default_texture_array);
+    }
+}
+
+float deferred_pbr_renderer::apply_exposure(scene_camera& camera, bool adaptive, float dt)
 {
     PROFILE_ZONE;
     float ape = default_camera_aperture;
@@ -2114,8 +3132,24 @@ float deferred_pbr_renderer::apply_exposure(scene_camera& camera, bool adaptive)
     float iso = default_camera_iso;
     if (adaptive)
     {
-        m_frame_context->client_wait(m_luminance_semaphore);
-        float avg_luminance = m_luminance_data_mapping->luminance;
+        // Use the newest finished luminance calculation, newer ones are still in flight.
+        for (int32 i = 1; i <= luminance_ring_size; ++i)
+        {
+            int32 slot = (m_luminance_slot - i + luminance_ring_size) % luminance_ring_size;
+            if (!m_luminance_pending[slot] || !m_frame_context->is_signaled(m_luminance_semaphores[slot]))
+                continue;
+
+            // time coefficient with tau = 1.1;
+            float tau                = 1.1f;
+            float time_coefficient   = 1.0f - expf(-dt * tau);
+            camera.adapted_luminance = camera.adapted_luminance + (m_luminance_data_mappings[slot]->luminance - camera.adapted_luminance) * time_coefficient;
+
+            // Older calculations finished as well and are outdated.
+            for (int32 j = i; j <= luminance_ring_size; ++j)
+                m_luminance_pending[(m_luminance_slot - j + luminance_ring_size) % luminance_ring_size] = false;
+            break;
+        }
+        float avg_luminance = camera.adapted_luminance;
 
         // K is a light meter calibration constant
         static const float K = 12.5f;
@@ -8,13 +8,19 @@
 #define MANGO_DEFERRED_PBR_RENDERER_HPP
 
 #include <rendering/debug_drawer.hpp>
+#include <rendering/hi_z_culler.hpp>
 #include <rendering/light_stack.hpp>
+#include <rendering/render_graph.hpp>
 #include <rendering/renderer_impl.hpp>
 #include <rendering/renderer_pipeline_cache.hpp>
+#include <rendering/resolution_scale_controller.hpp>
+#include <rendering/software_occlusion_culler.hpp>
 #include <rendering/steps/render_step.hpp>
 
 namespace mango
 {
+    class shadow_map_step;
+
     //! \brief A \a renderer using a deferred base pipeline supporting physically based rendering.
     //! \details This system supports physically based materials with and without textures.
     class deferred_pbr_renderer : public renderer_impl
@@ -31,6 +37,7 @@ namespace mango
         void present() override;
         void set_viewport(int32 x, int32 y, int32 width, int32 height) override;
         void on_ui_widget() override;
+        void warm_up_pipelines(const vertex_input_descriptor& vertex_layout, const input_assembly_descriptor& input_assembly) override;
 
         inline render_pipeline get_base_render_pipeline() override
         {
@@ -50,11 +57,19 @@ namespace mango
 
         //! \brief The \a graphics_device of the \a renderer.
         const graphics_device_handle& m_graphics_device;
-        //! \brief The gbuffer render targets of the deferred pipeline.
+        //! \brief The \a render_graph describing the passes of a frame.
+        render_graph m_render_graph;
+        //! \brief The create infos of the transient gbuffer render targets.
+        std::vector<texture_create_info> m_gbuffer_target_infos;
+        //! \brief The create infos of the transient hdr buffer render targets.
+        std::vector<texture_create_info> m_hdr_buffer_target_infos;
+        //! \brief The create infos of the transient postprocessing render targets.
+        std::vector<texture_create_info> m_post_target_infos;
+        //! \brief The gbuffer render targets of the deferred pipeline. Assigned by the \a render_graph each frame.
         std::vector<gfx_handle<const gfx_texture>> m_gbuffer_render_targets;
-        //! \brief The hdr buffer render targets of the deferred pipeline. Used for auto exposure.
+        //! \brief The hdr buffer render targets of the deferred pipeline. Used for auto exposure. Assigned by the \a render_graph each frame.
         std::vector<gfx_handle<const gfx_texture>> m_hdr_buffer_render_targets;
-        //! \brief The postprocessing render targets of the deferred pipeline.
+        //! \brief The postprocessing render targets of the deferred pipeline. Assigned by the \a render_graph each frame.
         std::vector<gfx_handle<const gfx_texture>> m_post_render_targets;
 
         //! \brief A sampler with nearest filtering and "clamp to edge" edge handling.
@@ -87,18 +102,55 @@ namespace mango
         //! \brief The graphics uniform buffer for uploading \a light_data. Filled with data provided by the \a light_stack.
         gfx_handle<const gfx_buffer> m_light_data_buffer;
 
+        //! \brief The width and height of the tiles classified for the tiled lighting.
+        static const int32 lighting_tile_size = 16;
+        //! \brief The number of tile classes with a lighting variant. Tiles without geometry are skipped.
+        //! \details A class is a combination of the flags \a tile_class_shadowed and \a tile_class_skylight.
+        static const int32 tile_class_count = 4;
+        //! \brief Tile class flag for tiles with at least one pixel requiring the directional shadow.
+        static const int32 tile_class_shadowed = 1;
+        //! \brief Tile class flag for tiles requiring the image based skylight.
+        static const int32 tile_class_skylight = 2;
+
+        //! \brief The current \a tile_lighting_data.
+        tile_lighting_data m_tile_lighting_data;
+        //! \brief The graphics uniform buffer for uploading \a tile_lighting_data.
+        gfx_handle<const gfx_buffer> m_tile_lighting_data_buffer;
+        //! \brief The shader storage buffer with the indirect dispatch arguments and tile lists for each tile class.
+        gfx_handle<const gfx_buffer> m_tile_classification_buffer;
+
+        //! \brief The \a post_stack_data uploaded last.
+        post_stack_data m_post_stack_data;
+        //! \brief The graphics uniform buffer for uploading \a post_stack_data.
+        gfx_handle<const gfx_buffer> m_post_stack_data_buffer;
+
         //! \brief The vertex \a shader_stage for the deferred geometry pass.
         gfx_handle<const gfx_shader_stage> m_geometry_pass_vertex;
         //! \brief The fragment \a shader_stage for the deferred geometry pass.
         gfx_handle<const gfx_shader_stage> m_geometry_pass_fragment;
+        //! \brief The fragment \a shader_stage for the deferred geometry pass used until \a m_geometry_pass_fragment is compiled.
+        gfx_handle<const gfx_shader_stage> m_geometry_pass_fallback_fragment;
         //! \brief The fragment \a shader_stage for the forward transparent pass.
         gfx_handle<const gfx_shader_stage> m_transparent_pass_fragment;
+        //! \brief The vertex \a shader_stage for the depth pre-pass. Only reads positions.
+        gfx_handle<const gfx_shader_stage> m_depth_prepass_vertex;
+        //! \brief The fragment \a shader_stage for the depth pre-pass.
+        gfx_handle<const gfx_shader_stage> m_depth_prepass_fragment;
         //! \brief The vertex \a shader_stage producing a screen space triangle.
         gfx_handle<const gfx_shader_stage> m_screen_space_triangle_vertex;
         //! \brief The fragment \a shader_stage for the deferred lighting pass.
         gfx_handle<const gfx_shader_stage> m_lighting_pass_fragment;
         //! \brief The fragment \a shader_stage for the composing pass.
         gfx_handle<const gfx_shader_stage> m_composing_pass_fragment;
+        //! \brief The fragment \a shader_stage copying the geometry depth after the tiled lighting.
+        gfx_handle<const gfx_shader_stage> m_depth_copy_fragment;
+
+        //! \brief The compute \a shader_stage classifying screen tiles for the tiled lighting.
+        gfx_handle<const gfx_shader_stage> m_tile_classification_compute;
+        //! \brief The compute \a shader_stage variants lighting the tiles of each tile class.
+        gfx_handle<const gfx_shader_stage> m_tiled_lighting_compute[tile_class_count];
+        //! \brief The compute \a shader_stage applying tonemapping and fxaa in one dispatch.
+        gfx_handle<const gfx_shader_stage> m_post_stack_compute;
 
         //! \brief The compute \a shader_stage for the luminance buffer construction pass.
         gfx_handle<const gfx_shader_stage> m_luminance_construction_compute;
@@ -113,6 +165,14 @@ namespace mango
         gfx_handle<const gfx_pipeline> m_luminance_construction_pipeline;
         //! \brief Compute pipeline reducing a luminance buffer and calculating an average luminance.
         gfx_handle<const gfx_pipeline> m_luminance_reduction_pipeline;
+        //! \brief Graphics pipeline copying the geometry depth to the hdr depth target after the tiled lighting.
+        gfx_handle<const gfx_pipeline> m_depth_copy_pipeline;
+        //! \brief Compute pipeline classifying screen tiles and filling the tile lists.
+        gfx_handle<const gfx_pipeline> m_tile_classification_pipeline;
+        //! \brief Compute pipelines lighting the tiles of each tile class.
+        gfx_handle<const gfx_pipeline> m_tiled_lighting_pipelines[tile_class_count];
+        //! \brief Compute pipeline applying tonemapping and fxaa and writing the output target in one dispatch.
+        gfx_handle<const gfx_pipeline> m_post_stack_pipeline;
 
         //! \brief The \a renderers \a renderer_pipeline_cache to create and cache \a gfx_pipelines for the geometry.
         renderer_pipeline_cache m_pipeline_cache;
@@ -127,6 +187,10 @@ namespace mango
         //! \brief Function used to create textures and samplers.
         //! \return True on success, else false.
         bool create_textures_and_samplers();
+        //! \brief Function used to create the render targets depending on the canvas size.
+        //! \details With dynamic resolution the internal targets only grow, so resizes only reallocate the output targets.
+        //! \return True on success, else false.
+        bool create_render_targets();
         //! \brief Function used to create buffers.
         //! \return True on success, else false.
         bool create_buffers();
@@ -137,23 +201,50 @@ namespace mango
         //! \return True on success, else false.
         bool create_pipeline_resources();
 
+        //! \brief Sets the resources shared by the fullscreen and the tiled lighting in the resource mapping of a lighting pipeline.
+        //! \param[in] pipeline The lighting \a gfx_pipeline.
+        //! \param[in] shadow_pass The \a shadow_map_step or nullptr if it is disabled.
+        //! \param[in] irradiance The irradiance map of the skylight or nullptr.
+        //! \param[in] specular The prefiltered specular map of the skylight or nullptr.
+        void set_lighting_resources(const gfx_handle<const gfx_pipeline>& pipeline, const shared_ptr<shadow_map_step>& shadow_pass, gfx_handle<const gfx_texture> irradiance,
+                                    gfx_handle<const gfx_texture> specular);
+
+        //! \brief The width and height of the tiles of the fused post-processing. Has to match POST_TILE_SIZE in the shader.
+        static const int32 post_tile_size = 16;
+
         //! \brief The light stack managing all lights.
         light_stack m_light_stack;
 
         //! \brief The \a debug_drawer to debug draw.
         debug_drawer m_debug_drawer;
 
+        //! \brief The \a hi_z_culler testing draws for occlusion.
+        hi_z_culler m_hi_z_culler;
+
+        //! \brief The \a software_occlusion_culler testing draws against large primitives rasterized on the cpu.
+        software_occlusion_culler m_software_occlusion_culler;
+
         //! \brief Optional additional steps of the deferred pipeline.
         shared_ptr<render_step> m_pipeline_steps[mango::render_pipeline_step::number_of_steps];
 
-        //! \brief The shader storage buffer mapping for the luminance data.
-        gfx_handle<const gfx_buffer> m_luminance_data_buffer;
+        //! \brief The number of luminance result slots.
+        //! \details Luminance results are read back without waiting, with up to luminance_ring_size - 1 frames latency.
+        static const int32 luminance_ring_size = 3;
+
+        //! \brief The shader storage buffers for the luminance data, one per slot.
+        gfx_handle<const gfx_buffer> m_luminance_data_buffers[luminance_ring_size];
 
-        //! \brief The mapped luminance data from the data calculation.
-        luminance_data* m_luminance_data_mapping;
+        //! \brief The mapped luminance data from the data calculation, one per slot.
+        luminance_data* m_luminance_data_mappings[luminance_ring_size];
 
-        //! \brief The \a gfx_semaphore used to synchronize luminance calculation.
-        gfx_handle<const gfx_semaphore> m_luminance_semaphore;
+        //! \brief The \a gfx_semaphores signaled when the luminance calculation of a slot finished.
+        gfx_handle<const gfx_semaphore> m_luminance_semaphores[luminance_ring_size];
+
+        //! \brief True for slots with a luminance calculation that was not read back yet, else false.
+        bool m_luminance_pending[luminance_ring_size];
+
+        //! \brief The slot the next luminance calculation writes to.
+        int32 m_luminance_slot;
 
         //! \brief True if the renderer should draw wireframe, else false.
         bool m_wireframe;
@@ -164,14 +255,56 @@ namespace mango
         //! \brief True if the renderer should cull primitives against camera and shadow frusta, else false.
         bool m_frustum_culling;
 
+        //! \brief True if the renderer should cull primitives occluded by other geometry, else false.
+        bool m_occlusion_culling;
+
+        //! \brief True if the renderer should cull primitives occluded by large primitives rasterized on the cpu, else false.
+        bool m_software_occlusion_culling;
+
+        //! \brief True if the renderer should render the depth of opaque geometry before the gbuffer pass, else false.
+        bool m_depth_prepass;
+
+        //! \brief True if the renderer should light with classified tiles in compute shaders instead of the fullscreen lighting pass, else false.
+        bool m_tiled_lighting;
+
+        //! \brief True if the gbuffer uses the compact layout, else false. Fixed after creation, since all gbuffer shaders depend on it.
+        bool m_compact_gbuffer;
+
+        //! \brief True if the internal render targets are rendered with a scale controlled by the gpu frame time, else false.
+        bool m_dynamic_resolution;
+
+        //! \brief True if tonemapping and fxaa should run fused in one compute dispatch instead of the composing pass and the \a fxaa_step, else false.
+        bool m_fused_post_processing;
+
+        //! \brief The \a resolution_scale_controller adjusting the scale of the internal render targets.
+        resolution_scale_controller m_resolution_controller;
+
+        //! \brief The size of the internal render targets (gbuffer and hdr buffer). Only grows with dynamic resolution.
+        ivec2 m_internal_target_size;
+
+        //! \brief The size of the sub-rectangle of the internal render targets rendered in the current frame.
+        ivec2 m_internal_resolution;
+
+        //! \brief The number of gpu frame time measurement slots.
+        //! \details Timestamps are read back without waiting, with up to timestamp_ring_size - 1 frames latency.
+        static const int32 timestamp_ring_size = 4;
+
+        //! \brief The \a gfx_timestamps recorded at the beginning and the end of the frame, one pair per slot.
+        gfx_handle<const gfx_timestamp> m_frame_timestamps[timestamp_ring_size][2];
+
+        //! \brief The slot the timestamps of the next frame are recorded to.
+        int32 m_timestamp_slot;
+
         //! \brief The \a gfx_semaphore used to synchronize \a renderer frames.
         gfx_handle<const gfx_semaphore> m_frame_semaphore;
 
         //! \brief Calculates exposure and adapts physical camera parameters.
+        //! \details The adaptive exposure uses the newest finished luminance calculation and never waits for the gpu.
         //! \param[in,out] camera The current \a scene_camera.
         //! \param[in] adaptive True if the exposure should be adaptive, else false.
+        //! \param[in] dt Past time since last call.
         //! \return Returns the calculated camera exposure.
-        float apply_exposure(scene_camera& camera, bool adaptive);
+        float apply_exposure(scene_camera& camera, bool adaptive, float dt);
     };
 
 } // namespace mango
@@ -8,10 +8,19 @@
 #include <rendering/render_data_builder.hpp>
 #include <resources/resources_impl.hpp>
 #include <scene/scene_impl.hpp>
+#include <util/hashing.hpp>
 #include <util/helpers.hpp>
 
 using namespace mango;
 
+skylight_builder::skylight_builder()
+    : m_time_budget(1.0f)
+    , m_sky_cubemap_size(0)
+    , m_bake_cache("cache/ibl/")
+    , m_ibl_shader_hash(fnv1a_hash::offset_basis)
+{
+}
+
 bool skylight_builder::init(const shared_ptr<context_impl>& context)
 {
     m_shared_context = context;
@@ -25,6 +34,7 @@ bool skylight_builder::init(const shared_ptr<context_impl>& context)
     {
         res_resource_desc.path        = "res/shader/c_equi_to_cubemap.glsl";
         const shader_resource* source = internal_resources->acquire(res_resource_desc);
+        m_ibl_shader_hash             = fnv1a_hash::hash(source->source.data(), source->source.size(), m_ibl_shader_hash);
 
         source_desc.entry_point = "main";
         source_desc.source      = source->source.c_str();
@@ -61,46 +71,10 @@ bool skylight_builder::init(const shared_ptr<context_impl>& context)
         m_equi_to_cubemap_pipeline = graphics_device->create_compute_pipeline(cubemap_compute_pass_info);
     }
 
-    {
-        res_resource_desc.path        = "res/shader/atmospheric_scattering/c_atmospheric_scattering_cubemap.glsl";
-        const shader_resource* source = internal_resources->acquire(res_resource_desc);
-
-        source_desc.entry_point = "main";
-        source_desc.source      = source->source.c_str();
-        source_desc.size        = static_cast<int32>(source->source.size());
-
-        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
-        shader_info.shader_source = source_desc;
-
-        shader_info.resource_count = 3;
-
-        shader_info.resources = { {
-            { gfx_shader_stage_type::shader_stage_compute, 0, "cubemap_out", gfx_shader_resource_type::shader_resource_image_storage, 1 },
-            { gfx_shader_stage_type::shader_stage_compute, 3, "ibl_generation_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
-            { gfx_shader_stage_type::shader_stage_compute, 4, "atmosphere_ub_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
-        } };
-
-        m_atmospheric_cubemap = graphics_device->create_shader_stage(shader_info);
-        if (!check_creation(m_atmospheric_cubemap.get(), "atmospheric cubemap compute shader"))
-            return false;
-
-        compute_pipeline_create_info atmospheric_cubemap_compute_pass_info = graphics_device->provide_compute_pipeline_create_info();
-        auto atmospheric_cubemap_compute_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
-            { gfx_shader_stage_type::shader_stage_compute, 0, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_static },
-            { gfx_shader_stage_type::shader_stage_compute, 3, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_static },
-            { gfx_shader_stage_type::shader_stage_compute, 3, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_static },
-        });
-
-        atmospheric_cubemap_compute_pass_info.pipeline_layout = atmospheric_cubemap_compute_pass_pipeline_layout;
-
-        atmospheric_cubemap_compute_pass_info.shader_stage_descriptor.compute_shader_stage = m_atmospheric_cubemap;
-
-        m_generate_atmospheric_cubemap_pipeline = graphics_device->create_compute_pipeline(atmospheric_cubemap_compute_pass_info);
-    }
-
     {
         res_resource_desc.path        = "res/shader/pbr_compute/c_irradiance_map.glsl";
         const shader_resource* source = internal_resources->acquire(res_resource_desc);
+        m_ibl_shader_hash             = fnv1a_hash::hash(source->source.data(), source->source.size(), m_ibl_shader_hash);
 
         source_desc.entry_point = "main";
         source_desc.source      = source->source.c_str();
@@ -140,6 +114,7 @@ bool skylight_builder::init(const shared_ptr<context_impl>& context)
     {
         res_resource_desc.path        = "res/shader/pbr_compute/c_prefilter_specular_map.glsl";
         const shader_resource* source = internal_resources->acquire(res_resource_desc);
+        m_ibl_shader_hash             = fnv1a_hash::hash(source->source.data(), source->source.size(), m_ibl_shader_hash);
 
         source_desc.entry_point = "main";
         source_desc.source      = source->source.c_str();
@@ -176,6 +151,24 @@ bool skylight_builder::init(const shared_ptr<context_impl>& context)
         m_build_specular_prefiltered_map_pipeline = graphics_device->create_compute_pipeline(spec_prefiltered_map_compute_pass_info);
     }
 
+    sampler_create_info sampler_info;
+    sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear_mipmap_linear;
+    sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_linear;
+    sampler_info.enable_comparison_mode  = false;
+    sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
+    sampler_info.edge_value_wrap_u       = gfx_sampler_edge_wrap::sampler_edge_wrap_clamp_to_edge;
+    sampler_info.edge_value_wrap_v       = gfx_sampler_edge_wrap::sampler_edge_wrap_clamp_to_edge;
+    sampler_info.edge_value_wrap_w       = gfx_sampler_edge_wrap::sampler_edge_wrap_clamp_to_edge;
+    sampler_info.border_color[0]         = 0;
+    sampler_info.border_color[1]         = 0;
+    sampler_info.border_color[2]         = 0;
+    sampler_info.border_color[3]         = 0;
+    sampler_info.enable_seamless_cubemap = true;
+
+    m_mipmapped_cubemap_sampler = graphics_device->create_sampler(sampler_info);
+    if (!check_creation(m_mipmapped_cubemap_sampler.get(), "ibl generation sampler"))
+        return false;
+
     // Lookup for all skylights
     create_brdf_lookup();
     if (!m_brdf_integration_lut)
@@ -216,6 +209,7 @@ void skylight_builder::create_brdf_lookup()
 
     res_resource_desc.path        = "res/shader/pbr_compute/c_brdf_integration.glsl";
     const shader_resource* source = internal_resources->acquire(res_resource_desc);
+    m_ibl_shader_hash             = fnv1a_hash::hash(source->source.data(), source->source.size(), m_ibl_shader_hash);
 
     source_desc.entry_point = "main";
     source_desc.source      = source->source.c_str();
@@ -249,6 +243,19 @@ void skylight_builder::create_brdf_lookup()
 
     graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
 
+    uint64 parameters[] = { m_ibl_shader_hash, static_cast<uint64>(brdf_lut_size), static_cast<uint64>(gfx_format::rgba16f) };
+    uint64 bake_key     = m_bake_cache.is_enabled() ? m_bake_cache.create_key("", parameters, 3) : 0;
+    std::vector<ibl_bake_texture> baked;
+    if (bake_key && m_bake_cache.load(bake_key, baked) && baked.size() == 1 && baked[0].width == brdf_lut_size && baked[0].height == brdf_lut_size && baked[0].faces == 1 &&
+        baked[0].miplevels == 1)
+    {
+        device_context->begin();
+        upload_texture(device_context, m_brdf_integration_lut, baked[0]);
+        device_context->end();
+        device_context->submit();
+        return;
+    }
+
     device_context->begin();
     GL_NAMED_PROFILE_ZONE("Generating brdf lookup");
 
@@ -268,8 +275,18 @@ void skylight_builder::create_brdf_lookup()
     barrier_description bd;
     bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit;
     device_context->barrier(bd);
+
+    if (bake_key)
+    {
+        baked.clear();
+        baked.push_back(download_texture(device_context, m_brdf_integration_lut, brdf_lut_size, 1, 1));
+    }
+
     device_context->end();
     device_context->submit();
+
+    if (bake_key)
+        m_bake_cache.store(bake_key, baked);
 }
 
 bool skylight_builder::needs_rebuild()
@@ -304,83 +321,92 @@ void skylight_builder::build(scene_impl* scene, const skylight& light, skylight_
     {
         if (light.hdr_texture == invalid_sid)
         {
+            cancel(render_data);
             clear(render_data);
             return;
         }
         load_from_hdr(scene, light, render_data);
     }
-    else // TODO Paul: capture ... will be done soon....
+    else
     {
-        // capture(compute_commands, render_data);
+        capture(render_data);
     }
 }
 
-/*
-void skylight_builder::capture(const command_buffer_ptr<min_key>& compute_commands, skylight_cache* render_data)
+void skylight_builder::capture(skylight_cache* render_data)
 {
     PROFILE_ZONE;
-    texture_configuration texture_config;
-    texture_config.generate_mipmaps        = calculate_mip_count(global_cubemap_size, global_cubemap_size);
-    texture_config.is_standard_color_space = false;
-    texture_config.is_cubemap              = true;
-    texture_config.texture_min_filter      = texture_parameter::filter_linear_mipmap_linear;
-    texture_config.texture_mag_filter      = texture_parameter::filter_linear;
-    texture_config.texture_wrap_s          = texture_parameter::wrap_clamp_to_edge;
-    texture_config.texture_wrap_t          = texture_parameter::wrap_clamp_to_edge;
-
-    if (render_data->cubemap)
-        render_data->cubemap->release();
-    render_data->cubemap = texture::create(texture_config);
-    if (!check_creation(render_data->cubemap.get(), "environment cubemap texture"))
+    cancel(render_data);
+    if (!m_sky_cubemap)
+    {
+        clear(render_data);
+        return;
+    }
+
+    // The sky is smooth, so the prefiltered specular map does not need more resolution than the sky cubemap.
+    ibl_build_job job;
+    job.target         = render_data;
+    job.result.cubemap = m_sky_cubemap;
+    job.specular_size  = m_sky_cubemap_size;
+    job.convert_hdr    = false;
+    job.next_item      = 0;
+    job.bake_key       = 0;
+    if (!prepare_build(job))
         return;
 
-    render_data->cubemap->set_data(format::rgba16f, global_cubemap_size, global_cubemap_size, format::rgba, format::t_float, nullptr);
-
-    // creating a temporal command buffer for compute shader execution.
-
-    // capturing shader (we can try to do it in one call like with the shadows)
-    // bind_shader_program_command* bsp = compute_commands->create<bind_shader_program_command>(command_keys::no_sort);
-    // bsp->shader_program_name         = m_capture_scene->get_name();
-
-    // bind output cubemap
-    bind_image_texture_command* bit = compute_commands->create<bind_image_texture_command>(command_keys::no_sort);
-    bit->binding                    = 1;
-    bit->texture_name               = render_data->cubemap->get_name();
-    bit->level                      = 0;
-    bit->layered                    = true;
-    bit->layer                      = 0;
-    bit->access                     = base_access::write_only;
-    bit->element_format             = format::rgba16f;
-
-    // bind uniforms
-    vec2 out                    = vec2(render_data->cubemap->get_width(), render_data->cubemap->get_height());
-    bind_single_uniform_command* bsu = compute_commands->create<bind_single_uniform_command>(command_keys::no_sort, sizeof(out));
-    bsu->count                       = 1;
-    bsu->location                    = 1;
-    bsu->type                        = shader_resource_type::fvec2;
-    bsu->uniform_value               = compute_commands->map_spare<bind_single_uniform_command>();
-    memcpy(bsu->uniform_value, &out, sizeof(out));
-
-    // execute draw calls
-    if (m_draw_commands)
+    m_jobs.push_back(std::move(job));
+}
+
+void skylight_builder::load_from_hdr(scene_impl* scene, const skylight& light, skylight_cache* render_data)
+{
+    PROFILE_ZONE;
+    auto input_hdr = scene->get_scene_texture(light.hdr_texture);
+    if (!input_hdr)
     {
-        m_draw_commands->execute();
-        m_draw_commands->invalidate();
+        MANGO_LOG_WARN("Hdr texture to build ibl does not exist.");
+        return;
     }
 
-    // We need to recalculate mipmaps
-    calculate_mipmaps_command* cm = compute_commands->create<calculate_mipmaps_command>(command_keys::no_sort);
-    cm->texture_name              = render_data->cubemap->get_name();
+    // The bake is keyed by the hdr file content, so that renamed or copied files still hit and changed files miss.
+    uint64 parameters[] = { m_ibl_shader_hash, static_cast<uint64>(global_cubemap_size), static_cast<uint64>(global_irradiance_map_size),
+                            static_cast<uint64>(global_specular_convolution_map_size), static_cast<uint64>(gfx_format::rgba16f) };
+    uint64 bake_key = m_bake_cache.is_enabled() ? m_bake_cache.create_key(input_hdr->public_data.file_path, parameters, 5) : 0;
+
+    cancel(render_data);
+    if (bake_key && load_baked_maps(bake_key, render_data))
+        return;
 
-    add_memory_barrier_command* amb = compute_commands->create<add_memory_barrier_command>(command_keys::no_sort);
-    amb->barrier_bit                = memory_barrier_bit::shader_image_access_barrier_bit;
+    ibl_build_job job;
+    job.target      = render_data;
+    job.hdr_texture = input_hdr->graphics_texture;
+    job.hdr_sampler   = input_hdr->graphics_sampler;
+    job.specular_size = global_specular_convolution_map_size;
+    job.convert_hdr   = true;
+    job.next_item     = 0;
+    job.bake_key      = bake_key;
+    if (!prepare_build(job))
+        return;
 
-    calculate_ibl_maps(compute_commands, render_data);
+    m_jobs.push_back(std::move(job));
 }
-*/
-void skylight_builder::load_from_hdr(scene_impl* scene, const skylight& light, skylight_cache* render_data)
+
+//! \brief Estimated number of filtered texture samples the gpu processes per millisecond.
+//! \details Used to convert the sample counts of the ibl shaders into gpu time.
+static const float ibl_samples_per_millisecond = 50000000.0f;
+
+//! \brief Estimates the gpu time of one face of a prefiltered specular mip level.
+//! \details Mirrors the sample count calculation in c_prefilter_specular_map.glsl.
+//! \param[in] size The size of the mip level.
+//! \param[in] roughness The roughness of the mip level.
+//! \return The estimated gpu time in milliseconds.
+static float specular_face_cost(int32 size, float roughness)
+{
+    float samples = roughness == 0.0f ? 1.0f : 32.0f + 480.0f * std::sqrt(roughness);
+    return static_cast<float>(size) * static_cast<float>(size) * samples / ibl_samples_per_millisecond;
+}
+
+bool skylight_builder::prepare_build(ibl_build_job& job)
 {
-    PROFILE_ZONE;
     auto& graphics_device = m_shared_context->get_graphics_device();
 
     texture_create_info texture_info;
@@ -391,71 +417,462 @@ void skylight_builder::load_from_hdr(scene_impl* scene, const skylight& light, s
     texture_info.array_layers   = 1;
     texture_info.texture_format = gfx_format::rgba16f;
 
-    render_data->cubemap = graphics_device->create_texture(texture_info);
-    if (!check_creation(render_data->cubemap.get(), "environment cubemap texture"))
+    if (job.convert_hdr)
+    {
+        job.result.cubemap = graphics_device->create_texture(texture_info);
+        if (!check_creation(job.result.cubemap.get(), "environment cubemap texture"))
+            return false;
+    }
+
+    int32 specular_mip_count = graphics::calculate_mip_count(job.specular_size, job.specular_size);
+    texture_info.width       = job.specular_size;
+    texture_info.height      = job.specular_size;
+    texture_info.miplevels   = specular_mip_count;
+
+    job.result.specular_prefiltered_cubemap = graphics_device->create_texture(texture_info);
+    if (!check_creation(job.result.specular_prefiltered_cubemap.get(), "environment specular prefiltered texture"))
+        return false;
+
+    texture_info.width            = global_irradiance_map_size;
+    texture_info.height           = global_irradiance_map_size;
+    texture_info.miplevels        = 1;
+    job.result.irradiance_cubemap = graphics_device->create_texture(texture_info);
+    if (!check_creation(job.result.irradiance_cubemap.get(), "environment irradiance texture"))
+        return false;
+
+    // Work is split per face and per mip level, the cubemap has to be complete before the convolutions start.
+    float cubemap_face_cost    = static_cast<float>(global_cubemap_size * global_cubemap_size) / ibl_samples_per_millisecond;
+    float irradiance_face_cost = static_cast<float>(global_irradiance_map_size * global_irradiance_map_size) * 1024.0f / ibl_samples_per_millisecond; // 2 * 512 samples
+
+    if (job.convert_hdr)
+    {
+        for (int32 face = 0; face < 6; ++face)
+            job.work.push_back({ ibl_work_type::cubemap_face, face, 0, cubemap_face_cost });
+        job.work.push_back({ ibl_work_type::cubemap_mipmaps, 0, 0, cubemap_face_cost * 2.0f });
+    }
+    for (int32 face = 0; face < 6; ++face)
+        job.work.push_back({ ibl_work_type::irradiance_face, face, 0, irradiance_face_cost });
+    for (int32 mip = 0; mip < specular_mip_count; ++mip)
+    {
+        float roughness = static_cast<float>(mip) / static_cast<float>(specular_mip_count - 1);
+        float cost      = specular_face_cost(std::max(1, job.specular_size >> mip), roughness);
+        for (int32 face = 0; face < 6; ++face)
+            job.work.push_back({ ibl_work_type::specular_face, face, mip, cost });
+    }
+
+    return true;
+}
+
+void skylight_builder::execute_pending_work()
+{
+    if (m_jobs.empty())
         return;
 
+    PROFILE_ZONE;
+    auto& graphics_device                         = m_shared_context->get_graphics_device();
     graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
 
+    std::vector<ibl_build_job> finished;
+    float spent = 0.0f;
+
     device_context->begin();
-    GL_NAMED_PROFILE_ZONE("Generating IBL Cubemap");
-    // equirectangular to cubemap
-    device_context->bind_pipeline(m_equi_to_cubemap_pipeline);
-    auto input_hdr = scene->get_scene_texture(light.hdr_texture);
-    if (!input_hdr)
+    GL_NAMED_PROFILE_ZONE("Incremental IBL Build");
+    while (!m_jobs.empty())
     {
-        MANGO_LOG_WARN("Hdr texture to build ibl does not exist.");
-        return;
-    }
-    m_current_ibl_generator_data.out_size = vec2(static_cast<float>(global_cubemap_size));
-    m_current_ibl_generator_data.data     = vec2(0.0f); // unused here
-    device_context->set_buffer_data(m_ibl_generator_data_buffer, 0, sizeof(ibl_generator_data), &m_current_ibl_generator_data);
+        ibl_build_job& job = m_jobs.front();
+        while (job.next_item < static_cast<int32>(job.work.size()))
+        {
+            const ibl_work_item& item = job.work[job.next_item];
+            // At least one item is executed per call, so that every build makes progress.
+            if (spent > 0.0f && spent + item.cost > m_time_budget)
+                break;
+            execute_work_item(device_context, job, item);
+            spent += item.cost;
+            job.next_item++;
+        }
 
-    m_equi_to_cubemap_pipeline->get_resource_mapping()->set("texture_hdr_in", input_hdr->graphics_texture);
-    m_equi_to_cubemap_pipeline->get_resource_mapping()->set("sampler_hdr_in", input_hdr->graphics_sampler);
-    auto cubemap_view = graphics_device->create_image_texture_view(render_data->cubemap);
-    m_equi_to_cubemap_pipeline->get_resource_mapping()->set("cubemap_out", cubemap_view);
-    m_equi_to_cubemap_pipeline->get_resource_mapping()->set("ibl_generation_data", m_ibl_generator_data_buffer);
+        if (job.next_item < static_cast<int32>(job.work.size()))
+            break;
 
-    device_context->submit_pipeline_state_resources();
+        finished.push_back(std::move(job));
+        m_jobs.pop_front();
+    }
+    device_context->end();
+    device_context->submit();
 
-    device_context->dispatch(global_cubemap_size / 32, global_cubemap_size / 32, 6);
+    for (ibl_build_job& job : finished)
+    {
+        // Swap all maps at once, the previous ones stay in use until now.
+        *job.target = job.result;
+        if (job.bake_key)
+            store_baked_maps(job.bake_key, job.target);
+    }
+}
+
+void skylight_builder::execute_work_item(const graphics_device_context_handle& device_context, const ibl_build_job& job, const ibl_work_item& item)
+{
+    auto& graphics_device = m_shared_context->get_graphics_device();
 
     barrier_description bd;
-    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit;
-    device_context->barrier(bd);
+    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit | gfx_barrier_bit::texture_fetch_barrier_bit;
 
-    device_context->calculate_mipmaps(render_data->cubemap);
+    switch (item.type)
+    {
+    case ibl_work_type::cubemap_face:
+    {
+        // equirectangular to cubemap
+        device_context->bind_pipeline(m_equi_to_cubemap_pipeline);
+        m_current_ibl_generator_data.out_size = vec2(static_cast<float>(global_cubemap_size));
+        m_current_ibl_generator_data.data     = vec2(0.0f, static_cast<float>(item.face));
+        device_context->set_buffer_data(m_ibl_generator_data_buffer, 0, sizeof(ibl_generator_data), &m_current_ibl_generator_data);
 
-    device_context->end();
-    device_context->submit();
+        m_equi_to_cubemap_pipeline->get_resource_mapping()->set("texture_hdr_in", job.hdr_texture);
+        m_equi_to_cubemap_pipeline->get_resource_mapping()->set("sampler_hdr_in", job.hdr_sampler);
+        auto cubemap_view = graphics_device->create_image_texture_view(job.result.cubemap);
+        m_equi_to_cubemap_pipeline->get_resource_mapping()->set("cubemap_out", cubemap_view);
+        m_equi_to_cubemap_pipeline->get_resource_mapping()->set("ibl_generation_data", m_ibl_generator_data_buffer);
+
+        device_context->submit_pipeline_state_resources();
+
+        device_context->dispatch(global_cubemap_size / 32, global_cubemap_size / 32, 1);
+        break;
+    }
+    case ibl_work_type::cubemap_mipmaps:
+        device_context->calculate_mipmaps(job.result.cubemap);
+        break;
+    case ibl_work_type::irradiance_face:
+    {
+        device_context->bind_pipeline(m_build_irradiance_map_pipeline);
+        m_current_ibl_generator_data.out_size = vec2(static_cast<float>(global_irradiance_map_size));
+        m_current_ibl_generator_data.data     = vec2(0.0f, static_cast<float>(item.face));
+        device_context->set_buffer_data(m_ibl_generator_data_buffer, 0, sizeof(ibl_generator_data), &m_current_ibl_generator_data);
+
+        m_build_irradiance_map_pipeline->get_resource_mapping()->set("texture_cubemap_in", job.result.cubemap);
+        m_build_irradiance_map_pipeline->get_resource_mapping()->set("sampler_cubemap_in", m_mipmapped_cubemap_sampler);
+        auto irradiance_view = graphics_device->create_image_texture_view(job.result.irradiance_cubemap);
+        m_build_irradiance_map_pipeline->get_resource_mapping()->set("irradiance_map_out", irradiance_view);
+        m_build_irradiance_map_pipeline->get_resource_mapping()->set("ibl_generation_data", m_ibl_generator_data_buffer);
+
+        device_context->submit_pipeline_state_resources();
+
+        int32 groups = std::max(1, (global_irradiance_map_size + 31) / 32);
+        device_context->dispatch(groups, groups, 1);
+        break;
+    }
+    case ibl_work_type::specular_face:
+    {
+        // build prefiltered specular mipchain
+        int32 specular_mip_count = graphics::calculate_mip_count(job.specular_size, job.specular_size);
+        int32 mipmap_size        = std::max(1, job.specular_size >> item.mip);
+        float roughness          = static_cast<float>(item.mip) / static_cast<float>(specular_mip_count - 1);
+
+        device_context->bind_pipeline(m_build_specular_prefiltered_map_pipeline);
+        m_current_ibl_generator_data.out_size = vec2(static_cast<float>(mipmap_size));
+        m_current_ibl_generator_data.data     = vec2(roughness, static_cast<float>(item.face));
+        device_context->set_buffer_data(m_ibl_generator_data_buffer, 0, sizeof(ibl_generator_data), &m_current_ibl_generator_data);
+
+        m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("texture_cubemap_in", job.result.cubemap);
+        m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("sampler_cubemap_in", m_mipmapped_cubemap_sampler);
+        auto mip_view = graphics_device->create_image_texture_view(job.result.specular_prefiltered_cubemap, item.mip);
+        m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("prefiltered_spec_out", mip_view);
+        m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("ibl_generation_data", m_ibl_generator_data_buffer);
 
-    calculate_ibl_maps(render_data);
+        device_context->submit_pipeline_state_resources();
+
+        int32 groups = std::max(1, (mipmap_size + 31) / 32);
+        device_context->dispatch(groups, groups, 1);
+        break;
+    }
+    }
+
+    device_context->barrier(bd);
 }
 
-void skylight_builder::calculate_ibl_maps(skylight_cache* render_data)
+void skylight_builder::cancel(skylight_cache* render_data)
 {
-    if (!render_data->cubemap)
+    for (auto it = m_jobs.begin(); it != m_jobs.end();)
     {
-        MANGO_LOG_ERROR("Can not calculate ibl maps without a cubemap!");
-        return; // Should not be possible;
+        if (it->target == render_data)
+            it = m_jobs.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool skylight_builder::is_building(const skylight_cache* render_data) const
+{
+    for (const ibl_build_job& job : m_jobs)
+    {
+        if (job.target == render_data)
+            return true;
     }
+    return false;
+}
+
+void skylight_builder::clear(skylight_cache* render_data)
+{
+    PROFILE_ZONE;
+    render_data->cubemap                      = nullptr;
+    render_data->irradiance_cubemap           = nullptr;
+    render_data->specular_prefiltered_cubemap = nullptr;
+    return;
+}
+
+bool skylight_builder::load_baked_maps(uint64 key, skylight_cache* render_data)
+{
+    PROFILE_ZONE;
+    std::vector<ibl_bake_texture> baked;
+    if (!m_bake_cache.load(key, baked) || baked.size() != 3)
+        return false;
 
     auto& graphics_device = m_shared_context->get_graphics_device();
 
-    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+    // cubemap, irradiance map, prefiltered specular map
+    const int32 sizes[3] = { global_cubemap_size, global_irradiance_map_size, global_specular_convolution_map_size };
+    gfx_handle<const gfx_texture> textures[3];
 
     texture_create_info texture_info;
     texture_info.texture_type   = gfx_texture_type::texture_type_cube_map;
-    texture_info.width          = global_specular_convolution_map_size;
-    texture_info.height         = global_specular_convolution_map_size;
-    int32 specular_mip_count    = graphics::calculate_mip_count(global_specular_convolution_map_size, global_specular_convolution_map_size);
-    texture_info.miplevels      = specular_mip_count;
     texture_info.array_layers   = 1;
     texture_info.texture_format = gfx_format::rgba16f;
 
+    for (int32 i = 0; i < 3; ++i)
+    {
+        if (baked[i].width != sizes[i] || baked[i].height != sizes[i] || baked[i].faces != 6 || baked[i].texture_format != gfx_format::rgba16f)
+            return false;
+
+        texture_info.width     = sizes[i];
+        texture_info.height    = sizes[i];
+        texture_info.miplevels = baked[i].miplevels;
+        textures[i]            = graphics_device->create_texture(texture_info);
+        if (!check_creation(textures[i].get(), "baked environment texture"))
+            return false;
+    }
+
+    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+    device_context->begin();
+    GL_NAMED_PROFILE_ZONE("Uploading baked IBL Maps");
+    for (int32 i = 0; i < 3; ++i)
+        upload_texture(device_context, textures[i], baked[i]);
+    device_context->end();
+    device_context->submit();
+
+    render_data->cubemap                      = textures[0];
+    render_data->irradiance_cubemap           = textures[1];
+    render_data->specular_prefiltered_cubemap = textures[2];
+    return true;
+}
+
+void skylight_builder::store_baked_maps(uint64 key, const skylight_cache* render_data)
+{
+    PROFILE_ZONE;
+    auto& graphics_device = m_shared_context->get_graphics_device();
+
+    std::vector<ibl_bake_texture> baked;
+    baked.reserve(3);
+
+    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+    device_context->begin();
+    GL_NAMED_PROFILE_ZONE("Reading back IBL Maps");
+    baked.push_back(download_texture(device_context, render_data->cubemap, global_cubemap_size, 6, graphics::calculate_mip_count(global_cubemap_size, global_cubemap_size)));
+    baked.push_back(download_texture(device_context, render_data->irradiance_cubemap, global_irradiance_map_size, 6, 1));
+    baked.push_back(download_texture(device_context, render_data->specular_prefiltered_cubemap, global_specular_convolution_map_size, 6,
+                                     graphics::calculate_mip_count(global_specular_convolution_map_size, global_specular_convolution_map_size)));
+    device_context->end();
+    device_context->submit();
+
+    m_bake_cache.store(key, baked);
+}
+
+ibl_bake_texture skylight_builder::download_texture(const graphics_device_context_handle& device_context, const gfx_handle<const gfx_texture>& texture, int32 size, int32 faces, int32 miplevels)
+{
+    ibl_bake_texture baked;
+    baked.width           = size;
+    baked.height          = size;
+    baked.faces           = faces;
+    baked.miplevels       = miplevels;
+    baked.bytes_per_texel = 8; // rgba16f
+    baked.texture_format  = gfx_format::rgba16f;
+    baked.pixel_format    = gfx_format::rgba;
+    baked.component_type  = gfx_format::t_half_float;
+    baked.data.resize(static_cast<size_t>(baked.level_offset(miplevels)));
+
+    texture_set_description desc;
+    desc.x_offset       = 0;
+    desc.y_offset       = 0;
+    desc.z_offset       = 0;
+    desc.depth          = faces;
+    desc.pixel_format   = baked.pixel_format;
+    desc.component_type = baked.component_type;
+
+    int64 offset = 0;
+    for (int32 mip = 0; mip < miplevels; ++mip)
+    {
+        desc.level  = mip;
+        desc.width  = std::max(1, size >> mip);
+        desc.height = std::max(1, size >> mip);
+
+        int64 level_size = baked.level_size(mip);
+        device_context->get_texture_data(texture, desc, static_cast<int32>(level_size), baked.data.data() + offset);
+        offset += level_size;
+    }
+
+    return baked;
+}
+
+void skylight_builder::upload_texture(const graphics_device_context_handle& device_context, const gfx_handle<const gfx_texture>& texture, ibl_bake_texture& baked)
+{
+    texture_set_description desc;
+    desc.x_offset       = 0;
+    desc.y_offset       = 0;
+    desc.z_offset       = 0;
+    desc.depth          = baked.faces;
+    desc.pixel_format   = baked.pixel_format;
+    desc.component_type = baked.component_type;
+
+    int64 offset = 0;
+    for (int32 mip = 0; mip < baked.miplevels; ++mip)
+    {
+        desc.level  = mip;
+        desc.width  = std::max(1, baked.width >> mip);
+        desc.height = std::max(1, baked.height >> mip);
+
+        device_context->set_texture_data(texture, desc, baked.data.data() + offset);
+        offset += baked.level_size(mip);
+    }
+}
+
+atmosphere_builder::atmosphere_builder() {}
+
+bool atmosphere_builder::init(const shared_ptr<context_impl>& context)
+{
+    m_shared_context = context;
+
+    auto& graphics_device    = m_shared_context->get_graphics_device();
+    auto& internal_resources = m_shared_context->get_internal_resources();
+    shader_stage_create_info shader_info;
+    shader_resource_resource_description res_resource_desc;
+    shader_source_description source_desc;
+
+    {
+        res_resource_desc.path        = "res/shader/atmospheric_scattering/c_transmittance_lut.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 2;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, 0, "transmittance_lut_out", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 4, "atmosphere_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        } };
+
+        auto transmittance_lut_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(transmittance_lut_compute.get(), "transmittance lookup compute shader"))
+            return false;
+
+        compute_pipeline_create_info transmittance_lut_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto transmittance_lut_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, 0, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 4, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        transmittance_lut_pass_info.pipeline_layout = transmittance_lut_pass_pipeline_layout;
+
+        transmittance_lut_pass_info.shader_stage_descriptor.compute_shader_stage = transmittance_lut_compute;
+
+        m_transmittance_lut_pipeline = graphics_device->create_compute_pipeline(transmittance_lut_pass_info);
+    }
+
+    {
+        res_resource_desc.path        = "res/shader/atmospheric_scattering/c_multi_scattering_lut.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 4;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, 0, "multi_scattering_lut_out", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 1, "texture_transmittance_lut", gfx_shader_resource_type::shader_resource_texture, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 1, "sampler_transmittance_lut", gfx_shader_resource_type::shader_resource_sampler, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 4, "atmosphere_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        } };
+
+        auto multi_scattering_lut_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(multi_scattering_lut_compute.get(), "multiple scattering lookup compute shader"))
+            return false;
+
+        compute_pipeline_create_info multi_scattering_lut_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto multi_scattering_lut_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, 0, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 1, gfx_shader_resource_type::shader_resource_texture, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 1, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 4, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        multi_scattering_lut_pass_info.pipeline_layout = multi_scattering_lut_pass_pipeline_layout;
+
+        multi_scattering_lut_pass_info.shader_stage_descriptor.compute_shader_stage = multi_scattering_lut_compute;
+
+        m_multi_scattering_lut_pipeline = graphics_device->create_compute_pipeline(multi_scattering_lut_pass_info);
+    }
+
+    {
+        res_resource_desc.path        = "res/shader/atmospheric_scattering/c_atmospheric_scattering_cubemap.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 6;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, 0, "cubemap_out", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 1, "texture_transmittance_lut", gfx_shader_resource_type::shader_resource_texture, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 1, "sampler_transmittance_lut", gfx_shader_resource_type::shader_resource_sampler, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 2, "texture_multi_scattering_lut", gfx_shader_resource_type::shader_resource_texture, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 2, "sampler_multi_scattering_lut", gfx_shader_resource_type::shader_resource_sampler, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, 4, "atmosphere_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        } };
+
+        auto sky_cubemap_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(sky_cubemap_compute.get(), "atmospheric cubemap compute shader"))
+            return false;
+
+        compute_pipeline_create_info sky_cubemap_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto sky_cubemap_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, 0, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 1, gfx_shader_resource_type::shader_resource_texture, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 1, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 2, gfx_shader_resource_type::shader_resource_texture, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 2, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, 4, gfx_shader_resource_type::shader_resource_buffer_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        sky_cubemap_pass_info.pipeline_layout = sky_cubemap_pass_pipeline_layout;
+
+        sky_cubemap_pass_info.shader_stage_descriptor.compute_shader_stage = sky_cubemap_compute;
+
+        m_sky_cubemap_pipeline = graphics_device->create_compute_pipeline(sky_cubemap_pass_info);
+    }
+
     sampler_create_info sampler_info;
-    sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear_mipmap_linear;
+    sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear;
     sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_linear;
     sampler_info.enable_comparison_mode  = false;
     sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
@@ -466,71 +883,87 @@ void skylight_builder::calculate_ibl_maps(skylight_cache* render_data)
     sampler_info.border_color[1]         = 0;
     sampler_info.border_color[2]         = 0;
     sampler_info.border_color[3]         = 0;
-    sampler_info.enable_seamless_cubemap = true;
+    sampler_info.enable_seamless_cubemap = false;
 
-    auto mipmapped_gen_sampler = graphics_device->create_sampler(sampler_info);
+    m_lut_sampler = graphics_device->create_sampler(sampler_info);
+    if (!check_creation(m_lut_sampler.get(), "atmosphere lookup sampler"))
+        return false;
 
-    sampler_info.sampler_min_filter = gfx_sampler_filter::sampler_filter_linear;
-    auto gen_sampler                = graphics_device->create_sampler(sampler_info);
+    buffer_create_info buffer_info;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_uniform;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+    buffer_info.size          = sizeof(atmosphere_ub_data);
 
-    render_data->specular_prefiltered_cubemap = graphics_device->create_texture(texture_info);
-    if (!check_creation(render_data->specular_prefiltered_cubemap.get(), "environment specular prefiltered texture"))
-        return;
+    m_atmosphere_data_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_atmosphere_data_buffer.get(), "atmosphere data buffer"))
+        return false;
 
-    texture_info.width              = global_irradiance_map_size;
-    texture_info.height             = global_irradiance_map_size;
-    texture_info.miplevels          = 1;
-    render_data->irradiance_cubemap = graphics_device->create_texture(texture_info);
-    if (!check_creation(render_data->irradiance_cubemap.get(), "environment irradiance texture"))
-        return;
+    return true;
+}
 
-    device_context->begin();
-    GL_NAMED_PROFILE_ZONE("Generating IBL Maps");
-    // build irradiance map
-    device_context->bind_pipeline(m_build_irradiance_map_pipeline);
+bool atmosphere_builder::needs_rebuild()
+{
+    return false;
+}
 
-    m_current_ibl_generator_data.out_size = vec2(static_cast<float>(global_irradiance_map_size));
-    m_current_ibl_generator_data.data     = vec2(0.0f); // unused here
-    device_context->set_buffer_data(m_ibl_generator_data_buffer, 0, sizeof(ibl_generator_data), &m_current_ibl_generator_data);
+void atmosphere_builder::build(scene_impl* scene, const atmospheric_light& light, atmosphere_cache* render_data)
+{
+    PROFILE_ZONE;
+    MANGO_UNUSED(scene);
+    auto& graphics_device = m_shared_context->get_graphics_device();
 
-    m_build_irradiance_map_pipeline->get_resource_mapping()->set("texture_cubemap_in", render_data->cubemap);
-    m_build_irradiance_map_pipeline->get_resource_mapping()->set("sampler_cubemap_in", mipmapped_gen_sampler);
-    auto irradiance_view = graphics_device->create_image_texture_view(render_data->irradiance_cubemap);
-    m_build_irradiance_map_pipeline->get_resource_mapping()->set("irradiance_map_out", irradiance_view);
-    m_build_irradiance_map_pipeline->get_resource_mapping()->set("ibl_generation_data", m_ibl_generator_data_buffer);
+    render_data->parameters  = light;
+    render_data->sky_cubemap = nullptr;
 
-    device_context->submit_pipeline_state_resources();
+    texture_create_info texture_info;
+    texture_info.texture_type   = gfx_texture_type::texture_type_2d;
+    texture_info.width          = transmittance_lut_width;
+    texture_info.height         = transmittance_lut_height;
+    texture_info.miplevels      = 1;
+    texture_info.array_layers   = 1;
+    texture_info.texture_format = gfx_format::rgba16f;
+
+    render_data->transmittance_lut = graphics_device->create_texture(texture_info);
+    if (!check_creation(render_data->transmittance_lut.get(), "transmittance lookup texture"))
+        return;
 
-    device_context->dispatch(global_irradiance_map_size / 4, global_irradiance_map_size / 4, 6);
+    texture_info.width                = multi_scattering_lut_size;
+    texture_info.height               = multi_scattering_lut_size;
+    render_data->multi_scattering_lut = graphics_device->create_texture(texture_info);
+    if (!check_creation(render_data->multi_scattering_lut.get(), "multiple scattering lookup texture"))
+        return;
+
+    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+
+    device_context->begin();
+    GL_NAMED_PROFILE_ZONE("Generating Atmosphere Lookups");
+    // The lookups do not depend on the sun.
+    set_atmosphere_data(device_context, light, vec3(0.0f, 1.0f, 0.0f), 0.0f);
 
     barrier_description bd;
-    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit;
-    device_context->barrier(bd);
+    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit | gfx_barrier_bit::texture_fetch_barrier_bit;
 
-    // build prefiltered specular mipchain
-    device_context->bind_pipeline(m_build_specular_prefiltered_map_pipeline);
+    device_context->bind_pipeline(m_transmittance_lut_pipeline);
+    auto transmittance_view = graphics_device->create_image_texture_view(render_data->transmittance_lut);
+    m_transmittance_lut_pipeline->get_resource_mapping()->set("transmittance_lut_out", transmittance_view);
+    m_transmittance_lut_pipeline->get_resource_mapping()->set("atmosphere_data", m_atmosphere_data_buffer);
 
-    m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("texture_cubemap_in", render_data->cubemap);
-    m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("sampler_cubemap_in", mipmapped_gen_sampler);
+    device_context->submit_pipeline_state_resources();
 
-    for (int32 mip = 0; mip < specular_mip_count; ++mip)
-    {
-        const uint32 mipmap_width  = global_specular_convolution_map_size >> mip;
-        const uint32 mipmap_height = global_specular_convolution_map_size >> mip;
-        float roughness            = (float)mip / (float)(specular_mip_count - 1);
+    device_context->dispatch(transmittance_lut_width / 8, transmittance_lut_height / 8, 1);
 
-        m_current_ibl_generator_data.out_size = vec2(mipmap_width, mipmap_height);
-        m_current_ibl_generator_data.data     = vec2(roughness, 0.0f);
-        device_context->set_buffer_data(m_ibl_generator_data_buffer, 0, sizeof(ibl_generator_data), &m_current_ibl_generator_data);
+    device_context->barrier(bd);
 
-        auto mip_view = graphics_device->create_image_texture_view(render_data->specular_prefiltered_cubemap, mip);
-        m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("prefiltered_spec_out", mip_view);
-        m_build_specular_prefiltered_map_pipeline->get_resource_mapping()->set("ibl_generation_data", m_ibl_generator_data_buffer);
+    device_context->bind_pipeline(m_multi_scattering_lut_pipeline);
+    auto multi_scattering_view = graphics_device->create_image_texture_view(render_data->multi_scattering_lut);
+    m_multi_scattering_lut_pipeline->get_resource_mapping()->set("multi_scattering_lut_out", multi_scattering_view);
+    m_multi_scattering_lut_pipeline->get_resource_mapping()->set("texture_transmittance_lut", render_data->transmittance_lut);
+    m_multi_scattering_lut_pipeline->get_resource_mapping()->set("sampler_transmittance_lut", m_lut_sampler);
+    m_multi_scattering_lut_pipeline->get_resource_mapping()->set("atmosphere_data", m_atmosphere_data_buffer);
 
-        device_context->submit_pipeline_state_resources();
+    device_context->submit_pipeline_state_resources();
 
-        device_context->dispatch(global_specular_convolution_map_size / 32, global_specular_convolution_map_size / 32, 6);
-    }
+    device_context->dispatch(multi_scattering_lut_size / 8, multi_scattering_lut_size / 8, 1);
 
     device_context->barrier(bd);
 
@@ -538,132 +971,84 @@ void skylight_builder::calculate_ibl_maps(skylight_cache* render_data)
     device_context->submit();
 }
 
-void skylight_builder::clear(skylight_cache* render_data)
+bool atmosphere_builder::update_sky(const directional_light& sun, atmosphere_cache* render_data)
 {
+    if (!render_data->transmittance_lut || !render_data->multi_scattering_lut)
+        return false;
+
+    vec3 sun_direction  = glm::normalize(sun.direction);
+    float sun_intensity = sun.intensity * render_data->parameters.intensity_multiplier * 0.0025f; // scale of the brute force implementation.
+
+    if (render_data->sky_cubemap)
+    {
+        bool direction_changed = glm::dot(sun_direction, render_data->sun_direction) < sun_direction_threshold;
+        bool intensity_changed = std::abs(sun_intensity - render_data->sun_intensity) > sun_intensity_threshold * std::max(render_data->sun_intensity, 1e-5f);
+        if (!direction_changed && !intensity_changed)
+            return false;
+    }
+
     PROFILE_ZONE;
-    render_data->cubemap                      = nullptr;
-    render_data->irradiance_cubemap           = nullptr;
-    render_data->specular_prefiltered_cubemap = nullptr;
-    return;
-}
+    auto& graphics_device = m_shared_context->get_graphics_device();
 
-/*
-bool atmosphere_builder::init()
-{
-    return false;
-}
+    texture_create_info texture_info;
+    texture_info.texture_type   = gfx_texture_type::texture_type_cube_map;
+    texture_info.width          = sky_cubemap_size;
+    texture_info.height         = sky_cubemap_size;
+    texture_info.miplevels      = graphics::calculate_mip_count(sky_cubemap_size, sky_cubemap_size);
+    texture_info.array_layers   = 1;
+    texture_info.texture_format = gfx_format::rgba16f;
 
-bool atmosphere_builder::needs_rebuild()
-{
-    return false;
+    auto sky_cubemap = graphics_device->create_texture(texture_info);
+    if (!check_creation(sky_cubemap.get(), "sky cubemap texture"))
+        return false;
+
+    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+
+    device_context->begin();
+    GL_NAMED_PROFILE_ZONE("Generating Sky Cubemap");
+    set_atmosphere_data(device_context, render_data->parameters, sun_direction, sun_intensity);
+
+    device_context->bind_pipeline(m_sky_cubemap_pipeline);
+    auto sky_view = graphics_device->create_image_texture_view(sky_cubemap);
+    m_sky_cubemap_pipeline->get_resource_mapping()->set("cubemap_out", sky_view);
+    m_sky_cubemap_pipeline->get_resource_mapping()->set("texture_transmittance_lut", render_data->transmittance_lut);
+    m_sky_cubemap_pipeline->get_resource_mapping()->set("sampler_transmittance_lut", m_lut_sampler);
+    m_sky_cubemap_pipeline->get_resource_mapping()->set("texture_multi_scattering_lut", render_data->multi_scattering_lut);
+    m_sky_cubemap_pipeline->get_resource_mapping()->set("sampler_multi_scattering_lut", m_lut_sampler);
+    m_sky_cubemap_pipeline->get_resource_mapping()->set("atmosphere_data", m_atmosphere_data_buffer);
+
+    device_context->submit_pipeline_state_resources();
+
+    device_context->dispatch(sky_cubemap_size / 8, sky_cubemap_size / 8, 6);
+
+    barrier_description bd;
+    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit | gfx_barrier_bit::texture_fetch_barrier_bit;
+    device_context->barrier(bd);
+
+    device_context->calculate_mipmaps(sky_cubemap);
+
+    device_context->end();
+    device_context->submit();
+
+    render_data->sky_cubemap   = sky_cubemap;
+    render_data->sun_direction = sun_direction;
+    render_data->sun_intensity = sun_intensity;
+    return true;
 }
 
-void atmosphere_builder::build(atmosphere_light* light, atmosphere_cache* render_data)
+void atmosphere_builder::set_atmosphere_data(const graphics_device_context_handle& device_context, const atmospheric_light& light, const vec3& sun_direction, float sun_intensity)
 {
-    MANGO_UNUSED(light);
-    MANGO_UNUSED(render_data);
+    m_current_atmosphere_data.sun_dir                          = sun_direction;
+    m_current_atmosphere_data.rayleigh_scattering_coefficients = light.rayleigh_scattering_coefficients;
+    m_current_atmosphere_data.ray_origin                       = vec3(0.0f, light.ground_radius + light.view_height, 0.0f);
+    m_current_atmosphere_data.density_multiplier               = light.density_multiplier;
+    m_current_atmosphere_data.sun_intensity                    = sun_intensity;
+    m_current_atmosphere_data.mie_scattering_coefficient       = light.mie_scattering_coefficient;
+    m_current_atmosphere_data.ground_radius                    = light.ground_radius;
+    m_current_atmosphere_data.atmosphere_radius                = light.atmosphere_radius;
+    m_current_atmosphere_data.mie_preferred_scattering_dir     = light.mie_preferred_scattering_dir;
+    m_current_atmosphere_data.scatter_points                   = light.scatter_points;
+    m_current_atmosphere_data.scatter_points_second_ray        = light.scatter_points_second_ray;
+
+    device_context->set_buffer_data(m_atmosphere_data_buffer, 0, sizeof(atmosphere_ub_data), &m_current_atmosphere_data);
 }
-
-// buffer_ptr m_atmosphere_data_buffer;
-// struct atmosphere_ub_data
-// {
-//     std140_vec3 sun_dir;
-//     std140_vec3 rayleigh_scattering_coefficients;
-//     std140_vec3 ray_origin;
-//     std140_vec2 density_multiplier;
-//     std140_float sun_intensity;
-//     std140_float mie_scattering_coefficient;
-//     std140_float ground_radius;
-//     std140_float atmosphere_radius;
-//     std140_float mie_preferred_scattering_dir;
-//     std140_int scatter_points;
-//     std140_int scatter_points_second_ray;
-// };
-// atmosphere_ub_data* m_atmosphere_data_mapping;
-
-// void environment_display_step::create_with_atmosphere(const mango::environment_light_data* el_data)
-// {
-//     PROFILE_ZONE;
-//     m_atmosphere_data_mapping->sun_dir                          = glm::normalize(el_data->sun_data.direction);
-//     m_atmosphere_data_mapping->sun_intensity                    = el_data->sun_data.intensity * 0.0025f;
-//     m_atmosphere_data_mapping->scatter_points                   = el_data->scatter_points;
-//     m_atmosphere_data_mapping->scatter_points_second_ray        = el_data->scatter_points_second_ray;
-//     m_atmosphere_data_mapping->rayleigh_scattering_coefficients = el_data->rayleigh_scattering_coefficients;
-//     m_atmosphere_data_mapping->mie_scattering_coefficient       = el_data->mie_scattering_coefficient;
-//     m_atmosphere_data_mapping->density_multiplier               = el_data->density_multiplier;
-//     m_atmosphere_data_mapping->ground_radius                    = el_data->ground_radius;
-//     m_atmosphere_data_mapping->atmosphere_radius                = el_data->atmosphere_radius;
-//     m_atmosphere_data_mapping->ray_origin                       = vec3(0.0f, el_data->ground_radius + el_data->view_height, 0.0f);
-//     m_atmosphere_data_mapping->mie_preferred_scattering_dir     = el_data->mie_preferred_scattering_dir;
-//
-//     texture_configuration texture_config;
-//     texture_config.generate_mipmaps        = calculate_mip_count(m_cube_width, m_cube_height);
-//     texture_config.is_standard_color_space = false;
-//     texture_config.is_cubemap              = true;
-//     texture_config.texture_min_filter      = texture_parameter::filter_linear_mipmap_linear;
-//     texture_config.texture_mag_filter      = texture_parameter::filter_linear;
-//     texture_config.texture_wrap_s          = texture_parameter::wrap_clamp_to_edge;
-//     texture_config.texture_wrap_t          = texture_parameter::wrap_clamp_to_edge;
-//
-//     if (m_cubemap)
-//         m_cubemap->release();
-//     m_cubemap = texture::create(texture_config);
-//     if (!check_creation(m_cubemap.get(), "environment cubemap texture"))
-//         return;
-//
-//     m_cubemap->set_data(format::rgba16f, m_cube_width, m_cube_height, format::rgba, format::t_float, nullptr);
-//
-//     // creating a temporal command buffer for compute shader execution.
-//     command_buffer_ptr<min_key> compute_commands = command_buffer<min_key>::create(4096);
-//
-//     // atmospheric scattering to cubemap
-//     bind_shader_program_command* bsp = compute_commands->create<bind_shader_program_command>(command_keys::no_sort);
-//     bsp->shader_program_name         = m_atmospheric_cubemap->get_name();
-//
-//     // bind output cubemap
-//     bind_image_texture_command* bit = compute_commands->create<bind_image_texture_command>(command_keys::no_sort);
-//     bit->binding                    = 0;
-//     bit->texture_name               = m_cubemap->get_name();
-//     bit->level                      = 0;
-//     bit->layered                    = true;
-//     bit->layer                      = 0;
-//     bit->access                     = base_access::write_only;
-//     bit->element_format             = format::rgba16f;
-//
-//     // bind uniforms
-//     vec2 out                    = vec2(m_cubemap->get_width(), m_cubemap->get_height());
-//     bind_single_uniform_command* bsu = compute_commands->create<bind_single_uniform_command>(command_keys::no_sort, sizeof(out));
-//     bsu->count                       = 1;
-//     bsu->location                    = 0;
-//     bsu->type                        = shader_resource_type::fvec2;
-//     bsu->uniform_value               = compute_commands->map_spare<bind_single_uniform_command>();
-//     memcpy(bsu->uniform_value, &out, sizeof(out));
-//
-//     bind_buffer_command* bb = compute_commands->create<bind_buffer_command>(command_keys::no_sort);
-//     bb->index               = UB_SLOT_COMPUTE_DATA;
-//     bb->buffer_name         = m_atmosphere_data_buffer->get_name();
-//     bb->offset              = 0;
-//     bb->target              = buffer_target::uniform_buffer;
-//     bb->size                = m_atmosphere_data_buffer->byte_length();
-//
-//     // execute compute
-//     dispatch_compute_command* dp = compute_commands->create<dispatch_compute_command>(command_keys::no_sort);
-//     dp->num_x_groups             = m_cubemap->get_width() / 32;
-//     dp->num_y_groups             = m_cubemap->get_height() / 32;
-//     dp->num_z_groups             = 6;
-//
-//     // We need to recalculate mipmaps
-//     calculate_mipmaps_command* cm = compute_commands->create<calculate_mipmaps_command>(command_keys::no_sort);
-//     cm->texture_name              = m_cubemap->get_name();
-//
-//     add_memory_barrier_command* amb = compute_commands->create<add_memory_barrier_command>(command_keys::no_sort);
-//     amb->barrier_bit                = memory_barrier_bit::shader_image_access_barrier_bit;
-//
-//     calculate_ibl_maps(compute_commands);
-//
-//     {
-//         GL_NAMED_PROFILE_ZONE("Generating IBL");
-//         compute_commands->execute();
-//     }
-// }
-*/
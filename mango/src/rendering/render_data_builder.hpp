@@ -7,6 +7,8 @@
 #ifndef MANGO_RENDER_DATA_BUILDER_HPP
 #define MANGO_RENDER_DATA_BUILDER_HPP
 
+#include <deque>
+#include <rendering/ibl_bake_cache.hpp>
 #include <rendering/renderer_impl.hpp>
 #include <scene/scene_internals.hpp>
 
@@ -25,6 +27,12 @@ namespace mango
     //! \brief Render data for atmospherical lights.
     struct atmosphere_cache : light_render_data
     {
+        atmospheric_light parameters;                       //!< The parameters the lookups got computed with.
+        gfx_handle<const gfx_texture> transmittance_lut;    //!< The transmittance lookup.
+        gfx_handle<const gfx_texture> multi_scattering_lut; //!< The multiple scattering lookup.
+        gfx_handle<const gfx_texture> sky_cubemap;          //!< The sky cubemap.
+        vec3 sun_direction;                                 //!< The sun direction the sky cubemap got computed for.
+        float sun_intensity;                                //!< The sun intensity the sky cubemap got computed for.
     };
 
     //! \brief Render data for skylights.
@@ -62,6 +70,7 @@ namespace mango
     class skylight_builder : render_data_builder<skylight, skylight_cache>
     {
       public:
+        skylight_builder();
         bool init(const shared_ptr<context_impl>& context) override;
         bool needs_rebuild() override;
         void build(scene_impl* scene, const skylight& light, skylight_cache* render_data) override;
@@ -75,11 +84,41 @@ namespace mango
             return m_brdf_integration_lut;
         }
 
+        //! \brief Executes pending work of incremental builds.
+        //! \details Builds are split into dispatches per cubemap face and mip level. Each call executes work items until the estimated gpu time exceeds the time budget.
+        //! Finished maps are swapped into their render data at once, the render data keeps the previous maps until then.
+        void execute_pending_work();
+
+        //! \brief Cancels the pending build of some render data.
+        //! \details Has to be called before the render data is freed.
+        //! \param[in] render_data Pointer to the render data.
+        void cancel(skylight_cache* render_data);
+
+        //! \brief Checks if some render data has a pending build.
+        //! \param[in] render_data Pointer to the render data.
+        //! \return True if the render data has a pending build, else false.
+        bool is_building(const skylight_cache* render_data) const;
+
+        //! \brief Sets the sky cubemap captured by skylights not using a texture.
+        //! \details Skylights have to be rebuild to capture a new sky.
+        //! \param[in] sky_cubemap The mipmapped sky cubemap. Can be nullptr if there is no sky.
+        //! \param[in] size The size of the sky cubemap faces.
+        inline void set_sky_cubemap(const gfx_handle<const gfx_texture>& sky_cubemap, int32 size)
+        {
+            m_sky_cubemap      = sky_cubemap;
+            m_sky_cubemap_size = size;
+        }
+
+        //! \brief Sets the gpu time budget for incremental builds.
+        //! \param[in] milliseconds The estimated gpu time in milliseconds that can be spent per call of execute_pending_work().
+        inline void set_time_budget(float milliseconds)
+        {
+            m_time_budget = milliseconds;
+        }
+
       private:
         //! \brief Compute \a shader_stage converting a equirectangular hdr to a cubemap.
         gfx_handle<const gfx_shader_stage> m_equi_to_cubemap;
-        //! \brief Compute \a shader_stage creating a cubemap with atmospheric scattering.
-        gfx_handle<const gfx_shader_stage> m_atmospheric_cubemap;
         //! \brief Compute \a shader_stage for the generation of a irradiance map from a cubemap.
         gfx_handle<const gfx_shader_stage> m_build_irradiance_map;
         //! \brief Compute \a shader_stage for the generation of the prefiltered specular map from a cubemap.
@@ -88,8 +127,6 @@ namespace mango
 
         //! \brief Compute pipeline converting a equirectangular hdr to a cubemap.
         gfx_handle<const gfx_pipeline> m_equi_to_cubemap_pipeline;
-        //! \brief Compute pipeline creating a cubemap with atmospheric scattering.
-        gfx_handle<const gfx_pipeline> m_generate_atmospheric_cubemap_pipeline;
         //! \brief Compute pipeline to generate a irradiance map from a cubemap.
         gfx_handle<const gfx_pipeline> m_build_irradiance_map_pipeline;
         //! \brief Compute pipeline to generate the prefiltered specular map from a cubemap.
@@ -109,16 +146,99 @@ namespace mango
         //! \param[out] render_data Pointer to the render data.
         void load_from_hdr(scene_impl* scene, const skylight& light, skylight_cache* render_data);
 
-        // void capture(const command_buffer_ptr<min_key>& compute_commands, skylight_cache* render_data);
+        //! \brief Builds the render data members from the sky cubemap.
+        //! \param[out] render_data Pointer to the render data.
+        void capture(skylight_cache* render_data);
+
+        //! \brief The types of \a ibl_work_items.
+        enum class ibl_work_type : uint8
+        {
+            cubemap_face,
+            cubemap_mipmaps,
+            irradiance_face,
+            specular_face
+        };
+
+        //! \brief A single dispatch of an incremental build.
+        struct ibl_work_item
+        {
+            ibl_work_type type; //!< The \a ibl_work_type.
+            int32 face;         //!< The cubemap face to build.
+            int32 mip;          //!< The mip level to build.
+            float cost;         //!< The estimated gpu time in milliseconds.
+        };
+
+        //! \brief An incremental build of skylight maps.
+        struct ibl_build_job
+        {
+            skylight_cache* target;                    //!< The render data to swap the maps into when finished.
+            skylight_cache result;                     //!< The maps being built.
+            int32 specular_size;                       //!< The size of the prefiltered specular map faces.
+            bool convert_hdr;                          //!< True if the cubemap has to be created from the hdr texture, else false.
+            gfx_handle<const gfx_texture> hdr_texture; //!< The equirectangular hdr texture.
+            gfx_handle<const gfx_sampler> hdr_sampler; //!< The \a gfx_sampler for the hdr texture.
+            std::vector<ibl_work_item> work;           //!< All work items in execution order.
+            int32 next_item;                           //!< The index of the next work item to execute.
+            uint64 bake_key;                           //!< The key to store the finished maps with or 0 if they should not be stored.
+        };
+
+        //! \brief Creates the maps of an \a ibl_build_job and splits the work into \a ibl_work_items.
+        //! \param[in,out] job The \a ibl_build_job.
+        //! \return True on success, else false.
+        bool prepare_build(ibl_build_job& job);
+
+        //! \brief Executes a single \a ibl_work_item.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \param[in] job The \a ibl_build_job the \a ibl_work_item belongs to.
+        //! \param[in] item The \a ibl_work_item to execute.
+        void execute_work_item(const graphics_device_context_handle& device_context, const ibl_build_job& job, const ibl_work_item& item);
 
-        //! \brief Calculates the convolution maps.
-        //! \param[in,out] render_data Pointer to the render data.
-        void calculate_ibl_maps(skylight_cache* render_data);
+        //! \brief Pending incremental builds, oldest first.
+        std::deque<ibl_build_job> m_jobs;
+        //! \brief The gpu time budget for incremental builds per call of execute_pending_work() in milliseconds.
+        float m_time_budget;
+        //! \brief Mipmapped \a gfx_sampler used to sample the cubemap in the convolutions.
+        gfx_handle<const gfx_sampler> m_mipmapped_cubemap_sampler;
+        //! \brief The sky cubemap captured by skylights not using a texture.
+        gfx_handle<const gfx_texture> m_sky_cubemap;
+        //! \brief The size of the sky cubemap faces.
+        int32 m_sky_cubemap_size;
 
         //! \brief Clears the data.
         //! \param[in,out] render_data Pointer to the render data to clear.
         void clear(skylight_cache* render_data);
 
+        //! \brief Loads the baked maps of a skylight from the \a ibl_bake_cache.
+        //! \param[in] key The key of the bake.
+        //! \param[out] render_data Pointer to the render data.
+        //! \return True if the maps were loaded, else false.
+        bool load_baked_maps(uint64 key, skylight_cache* render_data);
+
+        //! \brief Stores the maps of a skylight in the \a ibl_bake_cache.
+        //! \param[in] key The key of the bake.
+        //! \param[in] render_data Pointer to the render data.
+        void store_baked_maps(uint64 key, const skylight_cache* render_data);
+
+        //! \brief Reads back all mip levels of a rgba16f texture.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \param[in] texture The \a gfx_texture to read back.
+        //! \param[in] size The size of the first level in pixels.
+        //! \param[in] faces The number of faces of the \a gfx_texture.
+        //! \param[in] miplevels The number of mip levels of the \a gfx_texture.
+        //! \return The read back \a ibl_bake_texture.
+        ibl_bake_texture download_texture(const graphics_device_context_handle& device_context, const gfx_handle<const gfx_texture>& texture, int32 size, int32 faces, int32 miplevels);
+
+        //! \brief Uploads all mip levels of a \a ibl_bake_texture.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \param[in] texture The \a gfx_texture to upload to. Has to match the layout of the \a ibl_bake_texture.
+        //! \param[in] baked The \a ibl_bake_texture to upload.
+        void upload_texture(const graphics_device_context_handle& device_context, const gfx_handle<const gfx_texture>& texture, ibl_bake_texture& baked);
+
+        //! \brief On disk cache for the brdf lookup and the skylight maps.
+        ibl_bake_cache m_bake_cache;
+        //! \brief Hash of all ibl generation shader sources. Part of every bake key, so that shader changes invalidate the bakes.
+        uint64 m_ibl_shader_hash;
+
         //! \brief The size of the base cubemap faces.
         const int32 global_cubemap_size = 1024;
         //! \brief The size of the irradiance cubemap faces.
@@ -155,15 +275,76 @@ namespace mango
         gfx_handle<const gfx_buffer> m_ibl_generator_data_buffer;
     };
 
-    /*
-    class atmosphere_builder : render_data_builder<atmosphere_light, atmosphere_cache>
+    //! \brief A builder class for atmosphere render data.
+    //! \details Precomputes a transmittance and a multiple scattering lookup once per parameter set. The sky cubemap is derived from the lookups with a single ray march per texel
+    //! and is only recomputed when the sun changes noticeably.
+    class atmosphere_builder : render_data_builder<atmospheric_light, atmosphere_cache>
     {
       public:
-        bool init() override;
+        atmosphere_builder();
+        bool init(const shared_ptr<context_impl>& context) override;
         bool needs_rebuild() override;
-        void build(atmosphere_light* light, atmosphere_cache* render_data) override;
+        void build(scene_impl* scene, const atmospheric_light& light, atmosphere_cache* render_data) override;
+
+        //! \brief Recomputes the sky cubemap of an atmosphere if the sun changed more than a threshold.
+        //! \details A new cubemap is created each time, so that builds still reading the previous one are not affected.
+        //! \param[in] sun The \a directional_light contributing to the atmosphere.
+        //! \param[in,out] render_data Pointer to the render data of the atmosphere.
+        //! \return True if the sky cubemap got recomputed, else false.
+        bool update_sky(const directional_light& sun, atmosphere_cache* render_data);
+
+        //! \brief The size of the sky cubemap faces.
+        static const int32 sky_cubemap_size = 256;
+
+      private:
+        //! \brief Uploads the parameters of an atmosphere.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \param[in] light The parameters of the atmosphere.
+        //! \param[in] sun_direction The normalized direction to the sun.
+        //! \param[in] sun_intensity The intensity of the sun.
+        void set_atmosphere_data(const graphics_device_context_handle& device_context, const atmospheric_light& light, const vec3& sun_direction, float sun_intensity);
+
+        //! \brief Compute pipeline calculating the transmittance lookup.
+        gfx_handle<const gfx_pipeline> m_transmittance_lut_pipeline;
+        //! \brief Compute pipeline calculating the multiple scattering lookup.
+        gfx_handle<const gfx_pipeline> m_multi_scattering_lut_pipeline;
+        //! \brief Compute pipeline calculating the sky cubemap from the lookups.
+        gfx_handle<const gfx_pipeline> m_sky_cubemap_pipeline;
+        //! \brief Linear \a gfx_sampler for the lookups.
+        gfx_handle<const gfx_sampler> m_lut_sampler;
+
+        //! \brief The width of the transmittance lookup.
+        const int32 transmittance_lut_width = 256;
+        //! \brief The height of the transmittance lookup.
+        const int32 transmittance_lut_height = 64;
+        //! \brief The size of the multiple scattering lookup.
+        const int32 multi_scattering_lut_size = 32;
+        //! \brief Cosine of the angle the sun has to move before the sky cubemap gets recomputed. About a quarter degree.
+        const float sun_direction_threshold = 0.99999f;
+        //! \brief Relative change of the sun intensity before the sky cubemap gets recomputed.
+        const float sun_intensity_threshold = 0.01f;
+
+        //! \brief Uniform buffer struct for the atmosphere parameters.
+        //! \details Bound to binding point 4.
+        struct atmosphere_ub_data
+        {
+            std140_vec3 sun_dir;                          //!< The normalized direction to the sun.
+            std140_vec3 rayleigh_scattering_coefficients; //!< The rayleigh scattering coefficients.
+            std140_vec3 ray_origin;                       //!< The origin of the view rays.
+            std140_vec2 density_multiplier;               //!< The scale heights of rayleigh and mie scattering.
+            std140_float sun_intensity;                   //!< The intensity of the sun.
+            std140_float mie_scattering_coefficient;      //!< The mie scattering coefficient.
+            std140_float ground_radius;                   //!< The radius of the ground.
+            std140_float atmosphere_radius;               //!< The radius of the atmosphere.
+            std140_float mie_preferred_scattering_dir;    //!< The mie anisotropy.
+            std140_int scatter_points;                    //!< The number of ray march steps for the sky.
+            std140_int scatter_points_second_ray;         //!< Unused, the sun transmittance is looked up.
+        };
+        //! \brief The current \a atmosphere_ub_data.
+        atmosphere_ub_data m_current_atmosphere_data;
+        //! \brief The graphics uniform buffer for uploading \a atmosphere_ub_data.
+        gfx_handle<const gfx_buffer> m_atmosphere_data_buffer;
     };
-    */
 } // namespace mango
 
 #endif // MANGO_RENDER_DATA_BUILDER_HPP
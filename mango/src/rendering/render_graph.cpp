@@ -0,0 +1,464 @@
+//! \file      render_graph.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <mango/log.hpp>
+#include <mango/profile.hpp>
+#include <rendering/render_graph.hpp>
+#include <util/helpers.hpp>
+
+using namespace mango;
+
+//! \brief Checks if two \a texture_create_infos describe interchangeable textures.
+//! \param[in] a The first \a texture_create_info.
+//! \param[in] b The second \a texture_create_info.
+//! \return True if textures created with both are interchangeable, else false.
+static bool compatible(const texture_create_info& a, const texture_create_info& b)
+{
+    return a.texture_type == b.texture_type && a.texture_format == b.texture_format && a.width == b.width && a.height == b.height && a.miplevels == b.miplevels &&
+           a.array_layers == b.array_layers;
+}
+
+//! \brief Returns the barrier making incoherent image writes visible to an access.
+//! \param[in] access The \a render_graph_access.
+//! \return The \a gfx_barrier_bit required before the access.
+static gfx_barrier_bit barrier_for_access(render_graph_access access)
+{
+    switch (access)
+    {
+    case render_graph_access::sampled:
+        return gfx_barrier_bit::texture_fetch_barrier_bit;
+    case render_graph_access::image_load:
+    case render_graph_access::image_store:
+        return gfx_barrier_bit::shader_image_access_barrier_bit;
+    case render_graph_access::color_target:
+    case render_graph_access::depth_target:
+        return gfx_barrier_bit::framebuffer_barrier_bit;
+    default:
+        return gfx_barrier_bit::unknown_barrier_bit;
+    }
+}
+
+render_graph::render_graph()
+{
+    m_clear_color[0] = 0.0f;
+    m_clear_color[1] = 0.0f;
+    m_clear_color[2] = 0.0f;
+    m_clear_color[3] = 1.0f;
+}
+
+void render_graph::reset()
+{
+    m_textures.clear();
+    m_passes.clear();
+    m_slots.clear();
+    m_slot_textures.clear();
+}
+
+render_graph_texture render_graph::create_texture(const string& name, const texture_create_info& info)
+{
+    graph_texture tex;
+    tex.name      = name;
+    tex.info      = info;
+    tex.imported  = nullptr;
+    tex.output    = false;
+    tex.first_use = -1;
+    tex.last_use  = -1;
+    tex.slot      = -1;
+    m_textures.push_back(tex);
+    return static_cast<render_graph_texture>(m_textures.size()) - 1;
+}
+
+render_graph_texture render_graph::import_texture(const string& name, gfx_handle<const gfx_texture> texture)
+{
+    MANGO_ASSERT(texture, "Imported texture is null!");
+    graph_texture tex;
+    tex.name      = name;
+    tex.info      = texture_create_info();
+    tex.imported  = texture;
+    tex.output    = false;
+    tex.first_use = -1;
+    tex.last_use  = -1;
+    tex.slot      = -1;
+    m_textures.push_back(tex);
+    return static_cast<render_graph_texture>(m_textures.size()) - 1;
+}
+
+void render_graph::mark_output(render_graph_texture texture)
+{
+    MANGO_ASSERT(texture >= 0 && texture < static_cast<int32>(m_textures.size()), "Invalid render graph texture!");
+    m_textures[texture].output = true;
+}
+
+int32 render_graph::add_pass(const string& name, std::function<void()> execute)
+{
+    graph_pass pass;
+    pass.name         = name;
+    pass.execute      = execute;
+    pass.side_effects = false;
+    pass.culled       = false;
+    pass.barrier      = gfx_barrier_bit::unknown_barrier_bit;
+    m_passes.push_back(pass);
+    return static_cast<int32>(m_passes.size()) - 1;
+}
+
+void render_graph::set_side_effects(int32 pass)
+{
+    MANGO_ASSERT(pass >= 0 && pass < static_cast<int32>(m_passes.size()), "Invalid render graph pass!");
+    m_passes[pass].side_effects = true;
+}
+
+void render_graph::read(int32 pass, render_graph_texture texture, render_graph_access access)
+{
+    MANGO_ASSERT(pass >= 0 && pass < static_cast<int32>(m_passes.size()), "Invalid render graph pass!");
+    MANGO_ASSERT(texture >= 0 && texture < static_cast<int32>(m_textures.size()), "Invalid render graph texture!");
+    MANGO_ASSERT(access == render_graph_access::sampled || access == render_graph_access::image_load, "Access is no read!");
+
+    texture_access ta;
+    ta.texture = texture;
+    ta.access  = access;
+    ta.load_op = render_graph_load_op::load;
+    ta.write   = false;
+    ta.clear   = false;
+    m_passes[pass].accesses.push_back(ta);
+}
+
+void render_graph::write(int32 pass, render_graph_texture texture, render_graph_access access, render_graph_load_op load_op)
+{
+    MANGO_ASSERT(pass >= 0 && pass < static_cast<int32>(m_passes.size()), "Invalid render graph pass!");
+    MANGO_ASSERT(texture >= 0 && texture < static_cast<int32>(m_textures.size()), "Invalid render graph texture!");
+    MANGO_ASSERT(access == render_graph_access::image_store || access == render_graph_access::color_target || access == render_graph_access::depth_target, "Access is no write!");
+
+    texture_access ta;
+    ta.texture = texture;
+    ta.access  = access;
+    ta.load_op = load_op;
+    ta.write   = true;
+    ta.clear   = false;
+    m_passes[pass].accesses.push_back(ta);
+}
+
+void render_graph::compile()
+{
+    PROFILE_ZONE;
+    cull_passes();
+    assign_slots();
+    compute_clears_and_barriers();
+}
+
+void render_graph::cull_passes()
+{
+    // Walks the passes backwards, a pass is required if it writes content read later or has side effects.
+    std::vector<bool> required(m_textures.size(), false);
+    for (int32 i = 0; i < static_cast<int32>(m_textures.size()); ++i)
+        required[i] = m_textures[i].output;
+
+    for (auto it = m_passes.rbegin(); it != m_passes.rend(); ++it)
+    {
+        graph_pass& pass = *it;
+        pass.culled      = !pass.side_effects;
+        for (auto& ta : pass.accesses)
+        {
+            if (ta.write && required[ta.texture])
+                pass.culled = false;
+        }
+        if (pass.culled)
+            continue;
+
+        // The content before a write is only required, when it is loaded.
+        for (auto& ta : pass.accesses)
+        {
+            if (ta.write && ta.load_op != render_graph_load_op::load)
+                required[ta.texture] = false;
+        }
+        for (auto& ta : pass.accesses)
+        {
+            if (!ta.write || ta.load_op == render_graph_load_op::load)
+                required[ta.texture] = true;
+        }
+    }
+}
+
+void render_graph::assign_slots()
+{
+    m_slots.clear();
+
+    for (auto& tex : m_textures)
+    {
+        tex.first_use = -1;
+        tex.last_use  = -1;
+        tex.slot      = -1;
+    }
+
+    for (int32 p = 0; p < static_cast<int32>(m_passes.size()); ++p)
+    {
+        if (m_passes[p].culled)
+            continue;
+        for (auto& ta : m_passes[p].accesses)
+        {
+            graph_texture& tex = m_textures[ta.texture];
+            if (tex.first_use < 0)
+                tex.first_use = p;
+            tex.last_use = p;
+        }
+    }
+
+    std::vector<int32> transient;
+    for (int32 i = 0; i < static_cast<int32>(m_textures.size()); ++i)
+    {
+        if (!m_textures[i].imported && m_textures[i].first_use >= 0)
+            transient.push_back(i);
+    }
+    std::stable_sort(transient.begin(), transient.end(), [this](int32 a, int32 b) { return m_textures[a].first_use < m_textures[b].first_use; });
+
+    // Greedy assignment, a slot can be reused as soon as the last pass of its previous texture is done.
+    std::vector<int32> slot_end;
+    for (int32 idx : transient)
+    {
+        graph_texture& tex = m_textures[idx];
+        for (int32 s = 0; s < static_cast<int32>(m_slots.size()); ++s)
+        {
+            if (slot_end[s] < tex.first_use && compatible(m_slots[s], tex.info))
+            {
+                tex.slot = s;
+                break;
+            }
+        }
+        if (tex.slot < 0)
+        {
+            tex.slot = static_cast<int32>(m_slots.size());
+            m_slots.push_back(tex.info);
+            slot_end.push_back(-1);
+        }
+        slot_end[tex.slot] = tex.last_use;
+    }
+}
+
+void render_graph::compute_clears_and_barriers()
+{
+    // Aliased textures share memory, so the store state is tracked per physical slot. Imported textures get their own entry after the slots.
+    int32 slot_count   = static_cast<int32>(m_slots.size());
+    int32 memory_count = slot_count + static_cast<int32>(m_textures.size());
+    auto memory_of     = [this, slot_count](render_graph_texture texture) { return m_textures[texture].slot >= 0 ? m_textures[texture].slot : slot_count + texture; };
+
+    std::vector<bool> written(m_textures.size(), false);
+    std::vector<bool> incoherent(memory_count, false);
+    std::vector<gfx_barrier_bit> visible(memory_count, gfx_barrier_bit::unknown_barrier_bit);
+    std::vector<gfx_barrier_bit> consumers(memory_count, gfx_barrier_bit::unknown_barrier_bit);
+
+    for (int32 p = 0; p < static_cast<int32>(m_passes.size()); ++p)
+    {
+        graph_pass& pass = m_passes[p];
+        pass.barrier     = gfx_barrier_bit::unknown_barrier_bit;
+        if (pass.culled)
+            continue;
+
+        for (auto& ta : pass.accesses)
+        {
+            graph_texture& tex = m_textures[ta.texture];
+            int32 memory       = memory_of(ta.texture);
+
+            // Transient content is undefined before the first write, so loading it means clearing it.
+            ta.clear = ta.write && (ta.load_op == render_graph_load_op::clear || (ta.load_op == render_graph_load_op::load && !tex.imported && !written[ta.texture]));
+            if (!ta.write && !tex.imported && !written[ta.texture])
+                MANGO_LOG_WARN("Render graph pass {0} reads {1} before it was written!", pass.name, tex.name);
+
+            // Image stores are incoherent, every other access is ordered by the api.
+            if (incoherent[memory])
+            {
+                gfx_barrier_bit required = barrier_for_access(ta.access);
+                if (ta.clear)
+                    required = required | gfx_barrier_bit::framebuffer_barrier_bit;
+                // The first consumer makes the store visible for all following ones, so only one barrier is recorded.
+                if ((visible[memory] & required) != required)
+                    pass.barrier = pass.barrier | required | consumers[memory];
+            }
+        }
+
+        // A barrier is global, so it makes all pending stores visible.
+        for (int32 i = 0; i < memory_count; ++i)
+        {
+            if (incoherent[i])
+                visible[i] = visible[i] | pass.barrier;
+        }
+
+        for (auto& ta : pass.accesses)
+        {
+            if (!ta.write)
+                continue;
+            written[ta.texture] = true;
+            if (ta.access == render_graph_access::image_store)
+            {
+                int32 memory       = memory_of(ta.texture);
+                incoherent[memory] = true;
+                visible[memory]    = gfx_barrier_bit::unknown_barrier_bit;
+                consumers[memory]  = gfx_barrier_bit::unknown_barrier_bit;
+
+                // Collects the accesses to the same memory until the next store, including the ones of aliased textures.
+                bool stored = false;
+                for (int32 n = p + 1; n < static_cast<int32>(m_passes.size()) && !stored; ++n)
+                {
+                    if (m_passes[n].culled)
+                        continue;
+                    for (auto& next : m_passes[n].accesses)
+                    {
+                        if (memory_of(next.texture) != memory)
+                            continue;
+                        consumers[memory] = consumers[memory] | barrier_for_access(next.access);
+                        stored            = stored || next.access == render_graph_access::image_store;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool render_graph::allocate(const graphics_device_handle& graphics_device)
+{
+    PROFILE_ZONE;
+    for (auto& pt : m_pool)
+        pt.used = false;
+
+    // Slots are matched in order, so the same textures are assigned every frame while the graph does not change.
+    m_slot_textures.assign(m_slots.size(), nullptr);
+    for (int32 s = 0; s < static_cast<int32>(m_slots.size()); ++s)
+    {
+        for (auto& pt : m_pool)
+        {
+            if (!pt.used && compatible(pt.info, m_slots[s]))
+            {
+                pt.used            = true;
+                m_slot_textures[s] = pt.texture;
+                break;
+            }
+        }
+        if (m_slot_textures[s])
+            continue;
+
+        pooled_texture pt;
+        pt.info    = m_slots[s];
+        pt.texture = graphics_device->create_texture(pt.info);
+        pt.used    = true;
+        if (!check_creation(pt.texture.get(), "render graph texture"))
+            return false;
+        m_pool.push_back(pt);
+        m_slot_textures[s] = pt.texture;
+    }
+
+    m_pool.erase(std::remove_if(m_pool.begin(), m_pool.end(), [](const pooled_texture& pt) { return !pt.used; }), m_pool.end());
+
+    return true;
+}
+
+void render_graph::execute(const graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    for (auto& pass : m_passes)
+    {
+        if (pass.culled)
+            continue;
+
+        if (pass.barrier != gfx_barrier_bit::unknown_barrier_bit)
+        {
+            barrier_description bd;
+            bd.barrier_bit = pass.barrier;
+            device_context->barrier(bd);
+        }
+
+        gfx_handle<const gfx_texture> clear_colors[6];
+        gfx_handle<const gfx_texture> clear_depth = nullptr;
+        int32 clear_color_count                   = 0;
+        for (auto& ta : pass.accesses)
+        {
+            if (!ta.clear)
+                continue;
+            if (ta.access == render_graph_access::depth_target)
+                clear_depth = get_texture(ta.texture);
+            else if (clear_color_count < 6)
+                clear_colors[clear_color_count++] = get_texture(ta.texture);
+        }
+        if (clear_color_count > 0 || clear_depth)
+        {
+            device_context->set_render_targets(clear_color_count, clear_colors, clear_depth);
+            if (clear_color_count > 0)
+                device_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, m_clear_color);
+            if (clear_depth)
+                device_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
+        }
+
+        pass.execute();
+    }
+}
+
+gfx_handle<const gfx_texture> render_graph::get_texture(render_graph_texture texture) const
+{
+    MANGO_ASSERT(texture >= 0 && texture < static_cast<int32>(m_textures.size()), "Invalid render graph texture!");
+    const graph_texture& tex = m_textures[texture];
+    if (tex.imported)
+        return tex.imported;
+    if (tex.slot < 0 || tex.slot >= static_cast<int32>(m_slot_textures.size()))
+        return nullptr;
+    return m_slot_textures[tex.slot];
+}
+
+void render_graph::set_clear_color(const float color[4])
+{
+    m_clear_color[0] = color[0];
+    m_clear_color[1] = color[1];
+    m_clear_color[2] = color[2];
+    m_clear_color[3] = color[3];
+}
+
+int32 render_graph::culled_pass_count() const
+{
+    int32 count = 0;
+    for (auto& pass : m_passes)
+    {
+        if (pass.culled)
+            ++count;
+    }
+    return count;
+}
+
+bool render_graph::is_culled(int32 pass) const
+{
+    MANGO_ASSERT(pass >= 0 && pass < static_cast<int32>(m_passes.size()), "Invalid render graph pass!");
+    return m_passes[pass].culled;
+}
+
+gfx_barrier_bit render_graph::get_barrier(int32 pass) const
+{
+    MANGO_ASSERT(pass >= 0 && pass < static_cast<int32>(m_passes.size()), "Invalid render graph pass!");
+    return m_passes[pass].barrier;
+}
+
+bool render_graph::is_cleared(int32 pass, render_graph_texture texture) const
+{
+    MANGO_ASSERT(pass >= 0 && pass < static_cast<int32>(m_passes.size()), "Invalid render graph pass!");
+    for (auto& ta : m_passes[pass].accesses)
+    {
+        if (ta.texture == texture && ta.clear)
+            return true;
+    }
+    return false;
+}
+
+int32 render_graph::get_slot(render_graph_texture texture) const
+{
+    MANGO_ASSERT(texture >= 0 && texture < static_cast<int32>(m_textures.size()), "Invalid render graph texture!");
+    return m_textures[texture].slot;
+}
+
+int32 render_graph::transient_texture_count() const
+{
+    int32 count = 0;
+    for (auto& tex : m_textures)
+    {
+        if (!tex.imported)
+            ++count;
+    }
+    return count;
+}
@@ -0,0 +1,223 @@
+//! \file      render_graph.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_RENDER_GRAPH_HPP
+#define MANGO_RENDER_GRAPH_HPP
+
+#include <functional>
+#include <graphics/graphics.hpp>
+
+namespace mango
+{
+    //! \brief Handle of a texture in a \a render_graph.
+    using render_graph_texture = int32;
+
+    //! \brief The ways a pass can access a texture in a \a render_graph.
+    enum class render_graph_access : uint8
+    {
+        sampled,      //!< Read with a sampler.
+        image_load,   //!< Read as image.
+        image_store,  //!< Written as image.
+        color_target, //!< Written as color attachment.
+        depth_target  //!< Written as depth attachment.
+    };
+
+    //! \brief Describes what happens with the content of a texture before a pass writes it.
+    enum class render_graph_load_op : uint8
+    {
+        load,     //!< The content is kept and required by the pass.
+        clear,    //!< The texture is cleared before the pass.
+        dont_care //!< Every texel is written, or texels outside the written area are never read. No clear is required.
+    };
+
+    //! \brief A declarative description of the passes of a frame.
+    //! \details Passes declare the textures they read and write and are executed in the order they were added.
+    //! On compilation passes not contributing to an output are culled, clears are only issued where the content is required
+    //! and the required barriers are collected. Transient textures whose lifetimes do not overlap share one physical texture.
+    //! Physical textures are kept in a pool and reused in the following frames.
+    class render_graph
+    {
+      public:
+        render_graph();
+        ~render_graph() = default;
+
+        //! \brief Drops all passes and textures of the last frame.
+        //! \details The pool of physical textures is kept.
+        void reset();
+
+        //! \brief Declares a transient texture.
+        //! \details The texture only lives during the frame and is allocated from the pool.
+        //! \param[in] name The name of the texture.
+        //! \param[in] info The \a texture_create_info describing the texture.
+        //! \return The \a render_graph_texture.
+        render_graph_texture create_texture(const string& name, const texture_create_info& info);
+
+        //! \brief Imports a texture living outside of the \a render_graph.
+        //! \param[in] name The name of the texture.
+        //! \param[in] texture The \a gfx_texture to import.
+        //! \return The \a render_graph_texture.
+        render_graph_texture import_texture(const string& name, gfx_handle<const gfx_texture> texture);
+
+        //! \brief Marks a texture as output of the frame. Passes writing it are never culled.
+        //! \param[in] texture The \a render_graph_texture.
+        void mark_output(render_graph_texture texture);
+
+        //! \brief Adds a pass.
+        //! \param[in] name The name of the pass.
+        //! \param[in] execute The function recording the pass.
+        //! \return The index of the pass.
+        int32 add_pass(const string& name, std::function<void()> execute);
+
+        //! \brief Marks a pass as having results outside of the \a render_graph, which prevents culling.
+        //! \param[in] pass The index of the pass.
+        void set_side_effects(int32 pass);
+
+        //! \brief Declares a read of a pass.
+        //! \param[in] pass The index of the pass.
+        //! \param[in] texture The \a render_graph_texture to read.
+        //! \param[in] access The \a render_graph_access. Has to be sampled or image_load.
+        void read(int32 pass, render_graph_texture texture, render_graph_access access);
+
+        //! \brief Declares a write of a pass.
+        //! \param[in] pass The index of the pass.
+        //! \param[in] texture The \a render_graph_texture to write.
+        //! \param[in] access The \a render_graph_access. Has to be image_store, color_target or depth_target.
+        //! \param[in] load_op The \a render_graph_load_op.
+        void write(int32 pass, render_graph_texture texture, render_graph_access access, render_graph_load_op load_op);
+
+        //! \brief Culls passes, computes the lifetimes and aliasing of transient textures, clears and barriers.
+        void compile();
+
+        //! \brief Assigns physical textures from the pool to the transient textures.
+        //! \details Has to be called after compile(). Pooled textures not used in this frame are released.
+        //! \param[in] graphics_device The \a graphics_device to create new textures with.
+        //! \return True on success, else false.
+        bool allocate(const graphics_device_handle& graphics_device);
+
+        //! \brief Executes all passes not culled.
+        //! \details Has to be called after allocate(). Barriers and clears are recorded before the passes.
+        //! \param[in] device_context The \a graphics_device_context of the frame.
+        void execute(const graphics_device_context_handle& device_context);
+
+        //! \brief Returns the physical texture of a \a render_graph_texture.
+        //! \param[in] texture The \a render_graph_texture.
+        //! \return The \a gfx_texture. Null for culled transient textures or before allocate().
+        gfx_handle<const gfx_texture> get_texture(render_graph_texture texture) const;
+
+        //! \brief Sets the color transient and imported color textures are cleared to. Depth is cleared to 1.
+        //! \param[in] color The clear color.
+        void set_clear_color(const float color[4]);
+
+        //! \brief Returns the number of passes.
+        //! \return The number of passes.
+        inline int32 pass_count() const
+        {
+            return static_cast<int32>(m_passes.size());
+        }
+
+        //! \brief Returns the number of culled passes. Only valid after compile().
+        //! \return The number of culled passes.
+        int32 culled_pass_count() const;
+
+        //! \brief Checks if a pass was culled. Only valid after compile().
+        //! \param[in] pass The index of the pass.
+        //! \return True if the pass was culled, else false.
+        bool is_culled(int32 pass) const;
+
+        //! \brief Returns the barrier recorded before a pass. Only valid after compile().
+        //! \param[in] pass The index of the pass.
+        //! \return The \a gfx_barrier_bit, unknown_barrier_bit if no barrier is required.
+        gfx_barrier_bit get_barrier(int32 pass) const;
+
+        //! \brief Checks if a texture is cleared before a pass. Only valid after compile().
+        //! \param[in] pass The index of the pass.
+        //! \param[in] texture The \a render_graph_texture.
+        //! \return True if the texture is cleared before the pass, else false.
+        bool is_cleared(int32 pass, render_graph_texture texture) const;
+
+        //! \brief Returns the physical slot of a transient texture. Textures sharing a slot are aliased. Only valid after compile().
+        //! \param[in] texture The \a render_graph_texture.
+        //! \return The slot, -1 for imported or unused textures.
+        int32 get_slot(render_graph_texture texture) const;
+
+        //! \brief Returns the number of physical slots required for the transient textures. Only valid after compile().
+        //! \return The number of slots.
+        inline int32 slot_count() const
+        {
+            return static_cast<int32>(m_slots.size());
+        }
+
+        //! \brief Returns the number of transient textures.
+        //! \return The number of transient textures.
+        int32 transient_texture_count() const;
+
+      private:
+        //! \brief A texture of the \a render_graph.
+        struct graph_texture
+        {
+            string name;                            //!< The name.
+            texture_create_info info;               //!< The create info, only used for transient textures.
+            gfx_handle<const gfx_texture> imported; //!< The imported texture, null for transient textures.
+            bool output;                            //!< True if the texture is an output of the frame.
+            int32 first_use;                        //!< The index of the first pass not culled accessing the texture.
+            int32 last_use;                         //!< The index of the last pass not culled accessing the texture.
+            int32 slot;                             //!< The physical slot of a transient texture.
+        };
+
+        //! \brief An access of a pass to a texture.
+        struct texture_access
+        {
+            render_graph_texture texture;  //!< The \a render_graph_texture.
+            render_graph_access access;    //!< The \a render_graph_access.
+            render_graph_load_op load_op;  //!< The \a render_graph_load_op. Only used for writes.
+            bool write;                    //!< True for writes, else false.
+            bool clear;                    //!< True if the texture is cleared before the pass.
+        };
+
+        //! \brief A pass of the \a render_graph.
+        struct graph_pass
+        {
+            string name;                          //!< The name.
+            std::function<void()> execute;        //!< The function recording the pass.
+            bool side_effects;                    //!< True if the pass can not be culled.
+            bool culled;                          //!< True if the pass was culled.
+            gfx_barrier_bit barrier;              //!< The barrier recorded before the pass.
+            std::vector<texture_access> accesses; //!< The accesses of the pass.
+        };
+
+        //! \brief A physical texture in the pool.
+        struct pooled_texture
+        {
+            texture_create_info info;              //!< The create info of the texture.
+            gfx_handle<const gfx_texture> texture; //!< The texture.
+            bool used;                             //!< True if the texture is used in the current frame.
+        };
+
+        //! \brief Culls all passes not contributing to an output.
+        void cull_passes();
+
+        //! \brief Computes lifetimes and assigns slots to transient textures.
+        void assign_slots();
+
+        //! \brief Decides the clears and barriers of all passes.
+        void compute_clears_and_barriers();
+
+        //! \brief The textures of the current frame.
+        std::vector<graph_texture> m_textures;
+        //! \brief The passes of the current frame.
+        std::vector<graph_pass> m_passes;
+        //! \brief The create infos of the physical slots of the current frame.
+        std::vector<texture_create_info> m_slots;
+        //! \brief The physical textures assigned to the slots of the current frame.
+        std::vector<gfx_handle<const gfx_texture>> m_slot_textures;
+        //! \brief The pool of physical textures, kept between frames.
+        std::vector<pooled_texture> m_pool;
+        //! \brief The clear color.
+        float m_clear_color[4];
+    };
+} // namespace mango
+
+#endif // MANGO_RENDER_GRAPH_HPP
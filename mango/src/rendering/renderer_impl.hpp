@@ -29,6 +29,24 @@ namespace mango
 #define SHADOW_DATA_BUFFER_BINDING_POINT 5
     //! \brief The binding point for the \a luminance_data buffer.
 #define LUMINANCE_DATA_BUFFER_BINDING_POINT 6
+    //! \brief The binding point for the punctual light buffer.
+#define PUNCTUAL_LIGHT_BUFFER_BINDING_POINT 7
+    //! \brief The binding point for the light cluster buffer.
+#define LIGHT_CLUSTER_BUFFER_BINDING_POINT 8
+    //! \brief The binding point for the depth reduction buffer.
+#define DEPTH_REDUCTION_BUFFER_BINDING_POINT 9
+    //! \brief The binding point for the \a hi_z_data buffer.
+#define HI_Z_DATA_BUFFER_BINDING_POINT 10
+    //! \brief The binding point for the buffer with the bounds to test for occlusion.
+#define HI_Z_BOUNDS_BUFFER_BINDING_POINT 11
+    //! \brief The binding point for the buffer with the occlusion test results.
+#define HI_Z_VISIBILITY_BUFFER_BINDING_POINT 12
+    //! \brief The binding point for the \a tile_lighting_data buffer.
+#define TILE_DATA_BUFFER_BINDING_POINT 13
+    //! \brief The binding point for the buffer with the indirect dispatch arguments and tile lists of the tile classification.
+#define TILE_CLASSIFICATION_BUFFER_BINDING_POINT 14
+    //! \brief The binding point for the \a post_stack_data buffer.
+#define POST_STACK_DATA_BUFFER_BINDING_POINT 15
 
     //! \brief The vertex input binding point for the position vertex attribute.
 #define VERTEX_INPUT_POSITION 0
@@ -88,6 +106,16 @@ namespace mango
 
     //! \brief The image binding point for the output target color hdr attachment to compute the average luminance for.
 #define HDR_IMAGE_LUMINANCE_COMPUTE 0
+    //! \brief The sampler binding point for the geometry depth to compute the visible depth range for.
+#define DEPTH_REDUCTION_SAMPLER_DEPTH 0
+    //! \brief The sampler binding point for the input of the depth pyramid passes.
+#define HI_Z_SAMPLER_INPUT 0
+    //! \brief The image binding point for the output level of the depth pyramid passes.
+#define HI_Z_IMAGE_OUTPUT 0
+    //! \brief The image binding point for the output target color hdr attachment written by the compute lighting.
+#define HDR_IMAGE_LIGHTING_OUTPUT 0
+    //! \brief The image binding point for the output target written by the fused post-processing.
+#define POST_STACK_IMAGE_OUTPUT 0
 
     //! \brief Uniform buffer struct for renderer data.
     //! \details Bound once per frame to binding point 0.
@@ -119,19 +147,21 @@ namespace mango
         std140_float camera_near;            //!< Camera near plane depth value.
         std140_float camera_far;             //!< Camera far plane depth value.
         std140_float camera_exposure;        //!< The exposure value of the camera.
-        std140_float padding;                //!< Padding.
+        std140_float padding0;               //!< Padding.
+        std140_vec2 render_scale;            //!< The part of the internal render targets covered by the rendered sub-rectangle. (1, 1) without dynamic resolution.
+        std140_vec2 padding1;                //!< Padding.
     };
 
     //! \brief Uniform buffer struct for model data.
     //! \details Bound once per model to binding point 2.
     struct model_data
     {
-        std140_mat4 model_matrix;  //!< The model matrix.
-        std140_mat3 normal_matrix; //!< The normal matrix.
-        std140_bool has_normals;   //!< Specifies if the mesh has normals as a vertex attribute.
-        std140_bool has_tangents;  //!< Specifies if the mesh has tangents as a vertex attribute.
-        std140_float padding0;     //!< Padding.
-        std140_float padding1;     //!< Padding.
+        std140_mat4 model_matrix;       //!< The model matrix.
+        std140_mat3 normal_matrix;      //!< The normal matrix.
+        std140_bool has_normals;        //!< Specifies if the mesh has normals as a vertex attribute.
+        std140_bool has_tangents;       //!< Specifies if the mesh has tangents as a vertex attribute.
+        std140_int shadow_cascade_mask; //!< Bitmask of the shadow cascades the mesh is rendered to. Only used in the shadow pass.
+        std140_float padding1;          //!< Padding.
     };
 
     //! \brief Uniform buffer struct for material data.
@@ -160,7 +190,26 @@ namespace mango
     {
         std140_int histogram[256]; //!< The histogram data
         std140_vec4 params;        //!< Parameters used for automatic exposure calculation.
-        std140_float luminance;    //!< Smoothed out average luminance.
+        std140_float luminance;    //!< Average luminance of the frame.
+    };
+
+    //! \brief Uniform buffer struct for the tile classification and the tiled lighting.
+    //! \details Bound to binding point 13.
+    struct tile_lighting_data
+    {
+        std140_int tile_count_x; //!< The number of tiles in x direction.
+        std140_int tile_count_y; //!< The number of tiles in y direction.
+        std140_int padding0;     //!< Padding.
+        std140_int padding1;     //!< Padding.
+    };
+
+    //! \brief Uniform buffer struct for the fused post-processing.
+    //! \details Bound to binding point 15. Only uploaded when changed.
+    struct post_stack_data
+    {
+        std140_vec2 inverse_screen_size; //!< The inverse size of the output target.
+        std140_int quality_preset;       //!< The fxaa_quality_preset.
+        std140_float subpixel_filter;    //!< The fxaa filter value for subpixels.
     };
 
     //! \brief Structure to store data for light data.
@@ -183,10 +232,20 @@ namespace mango
             std140_float intensity; //!< The intensity of the skylight in cd/m^2.
             std140_bool valid;      //!< True, if buffer is valid. Does also guarantee that textures are bound.
             // local, global and if local bounds for parallax correction ....
-        } skylight;            //!< Data for the active skylight (max one atm)
-        std140_float padding0; //!< Padding.
-        std140_float padding1; //!< Padding.
-        std140_float padding2; //!< Padding.
+        } skylight;                    //!< Data for the active skylight (max one atm)
+        std140_int punctual_light_count; //!< The number of point and spot lights in the punctual light buffer.
+        std140_float padding1;           //!< Padding.
+        std140_float padding2;           //!< Padding.
+    };
+
+    //! \brief Structure to store data for a point or spot light.
+    //! \details Stored in the punctual light buffer bound to binding point 7.
+    struct punctual_light_data
+    {
+        std140_vec4 position_radius; //!< The world space position (xyz) and the radius of influence (w).
+        std140_vec4 color_intensity; //!< The light color (rgb) and the luminous intensity in candela (a).
+        std140_vec4 direction_type;  //!< The direction of spot lights (xyz) and the type, 0 for point and 1 for spot lights (w).
+        std140_vec4 spot_cone;       //!< The cosine of the outer cone angle (x) and 1 / (cos(inner cone angle) - cos(outer cone angle)) (y).
     };
 
     //! \brief The implementation of the \a renderer.
@@ -237,6 +296,12 @@ namespace mango
         //! This does not draw any window, so it needs one surrounding it.
         virtual void on_ui_widget() = 0;
 
+        //! \brief Starts creating all \a gfx_pipelines required to render geometry with a specific vertex layout.
+        //! \details Called when geometry gets loaded, so that the pipelines are compiled in the background before the geometry is rendered.
+        //! \param[in] vertex_layout The \a vertex_input_descriptor of the geometry.
+        //! \param[in] input_assembly The \a input_assembly_descriptor of the geometry.
+        virtual void warm_up_pipelines(const vertex_input_descriptor& vertex_layout, const input_assembly_descriptor& input_assembly) = 0;
+
         //! \brief Returns \a renderer related informations.
         //! \return The informations.
         inline const renderer_info& get_renderer_info() const override
@@ -9,56 +9,69 @@
 
 using namespace mango;
 
-gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe)
+void renderer_pipeline_cache::warm_up(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad)
 {
     pipeline_key key;
     key.vid       = geo_vid;
     key.iad       = geo_iad;
-    key.wireframe = wireframe;
-    auto it       = m_opaque_cache.find(key);
-    if (it != m_opaque_cache.end())
-        return it->second;
-
-    auto create_info = m_opaque_create_info;
-
-    create_info.vertex_input_state   = geo_vid;
-    create_info.input_assembly_state = geo_iad;
-    if (wireframe)
-        create_info.rasterization_state.polygon_mode = gfx_polygon_mode::polygon_mode_line;
+    key.wireframe = false;
 
     auto& graphics_device = m_shared_context->get_graphics_device();
 
-    gfx_handle<const gfx_pipeline> created_pipeline = graphics_device->create_graphics_pipeline(create_info);
+    graphics_device->is_pipeline_ready(get_pipeline(m_opaque_cache, m_opaque_create_info, key));
+    graphics_device->is_pipeline_ready(get_pipeline(m_transparent_cache, m_transparent_create_info, key));
+    graphics_device->is_pipeline_ready(get_pipeline(m_shadow_cache, m_shadow_create_info, key));
+    graphics_device->is_pipeline_ready(get_pipeline(m_opaque_prepassed_cache, m_opaque_prepassed_create_info, key));
 
-    m_opaque_cache.insert({ key, created_pipeline });
+    if (m_has_opaque_fallback)
+    {
+        auto fallback_create_info                    = m_opaque_create_info;
+        fallback_create_info.shader_stage_descriptor = m_opaque_fallback_stages;
+        graphics_device->is_pipeline_ready(get_pipeline(m_opaque_fallback_cache, fallback_create_info, key));
 
-    return created_pipeline;
+        fallback_create_info                         = m_opaque_prepassed_create_info;
+        fallback_create_info.shader_stage_descriptor = m_opaque_fallback_stages;
+        graphics_device->is_pipeline_ready(get_pipeline(m_opaque_prepassed_fallback_cache, fallback_create_info, key));
+    }
+
+    key.vid = position_only(geo_vid);
+    graphics_device->is_pipeline_ready(get_pipeline(m_depth_prepass_cache, m_depth_prepass_create_info, key));
 }
 
-gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_transparent(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe)
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe)
 {
     pipeline_key key;
     key.vid       = geo_vid;
     key.iad       = geo_iad;
     key.wireframe = wireframe;
-    auto it       = m_transparent_cache.find(key);
-    if (it != m_transparent_cache.end())
-        return it->second;
 
-    auto create_info = m_transparent_create_info;
+    return get_opaque_pipeline(m_opaque_cache, m_opaque_fallback_cache, m_opaque_create_info, key);
+}
 
-    create_info.vertex_input_state   = geo_vid;
-    create_info.input_assembly_state = geo_iad;
-    if (wireframe)
-        create_info.rasterization_state.polygon_mode = gfx_polygon_mode::polygon_mode_line;
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_opaque_prepassed(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad)
+{
+    pipeline_key key;
+    key.vid       = geo_vid;
+    key.iad       = geo_iad;
+    key.wireframe = false;
 
-    auto& graphics_device = m_shared_context->get_graphics_device();
+    return get_opaque_pipeline(m_opaque_prepassed_cache, m_opaque_prepassed_fallback_cache, m_opaque_prepassed_create_info, key);
+}
 
-    gfx_handle<const gfx_pipeline> created_pipeline = graphics_device->create_graphics_pipeline(create_info);
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_transparent(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe)
+{
+    pipeline_key key;
+    key.vid       = geo_vid;
+    key.iad       = geo_iad;
+    key.wireframe = wireframe;
 
-    m_transparent_cache.insert({ key, created_pipeline });
+    gfx_handle<const gfx_pipeline> pipeline = get_pipeline(m_transparent_cache, m_transparent_create_info, key);
 
-    return created_pipeline;
+    auto& graphics_device = m_shared_context->get_graphics_device();
+    if (!graphics_device->is_pipeline_ready(pipeline))
+        return nullptr;
+
+    return pipeline;
 }
 
 gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_shadow(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad)
@@ -67,20 +80,94 @@ gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_shadow(const vertex_
     key.vid       = geo_vid;
     key.iad       = geo_iad;
     key.wireframe = false;
-    auto it       = m_shadow_cache.find(key);
-    if (it != m_shadow_cache.end())
+
+    gfx_handle<const gfx_pipeline> pipeline = get_pipeline(m_shadow_cache, m_shadow_create_info, key);
+
+    auto& graphics_device = m_shared_context->get_graphics_device();
+    if (!graphics_device->is_pipeline_ready(pipeline))
+        return nullptr;
+
+    return pipeline;
+}
+
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_depth_prepass(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad)
+{
+    pipeline_key key;
+    key.vid       = position_only(geo_vid);
+    key.iad       = geo_iad;
+    key.wireframe = false;
+
+    gfx_handle<const gfx_pipeline> pipeline = get_pipeline(m_depth_prepass_cache, m_depth_prepass_create_info, key);
+
+    auto& graphics_device = m_shared_context->get_graphics_device();
+    if (!graphics_device->is_pipeline_ready(pipeline))
+        return nullptr;
+
+    return pipeline;
+}
+
+vertex_input_descriptor renderer_pipeline_cache::position_only(const vertex_input_descriptor& geo_vid)
+{
+    vertex_input_descriptor result     = geo_vid;
+    result.binding_description_count   = 0;
+    result.attribute_description_count = 0;
+
+    for (int32 i = 0; i < geo_vid.attribute_description_count; ++i)
+    {
+        const vertex_input_attribute_description& attribute = geo_vid.attribute_descriptions[i];
+        if (attribute.location != 0)
+            continue;
+
+        for (int32 b = 0; b < geo_vid.binding_description_count; ++b)
+        {
+            if (geo_vid.binding_descriptions[b].binding != attribute.binding)
+                continue;
+
+            result.binding_descriptions[0]     = geo_vid.binding_descriptions[b];
+            result.attribute_descriptions[0]   = attribute;
+            result.binding_description_count   = 1;
+            result.attribute_description_count = 1;
+            break;
+        }
+        break;
+    }
+
+    return result;
+}
+
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_opaque_pipeline(pipeline_cache& cache, pipeline_cache& fallback_cache, const graphics_pipeline_create_info& base_create_info,
+                                                                            const pipeline_key& key)
+{
+    gfx_handle<const gfx_pipeline> pipeline = get_pipeline(cache, base_create_info, key);
+
+    auto& graphics_device = m_shared_context->get_graphics_device();
+    if (!m_has_opaque_fallback || graphics_device->is_pipeline_ready(pipeline))
+        return pipeline;
+
+    auto fallback_create_info                    = base_create_info;
+    fallback_create_info.shader_stage_descriptor = m_opaque_fallback_stages;
+
+    return get_pipeline(fallback_cache, fallback_create_info, key);
+}
+
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_pipeline(pipeline_cache& cache, const graphics_pipeline_create_info& base_create_info, const pipeline_key& key)
+{
+    auto it = cache.find(key);
+    if (it != cache.end())
         return it->second;
 
-    auto create_info = m_shadow_create_info;
+    auto create_info = base_create_info;
 
-    create_info.vertex_input_state   = geo_vid;
-    create_info.input_assembly_state = geo_iad;
+    create_info.vertex_input_state   = key.vid;
+    create_info.input_assembly_state = key.iad;
+    if (key.wireframe)
+        create_info.rasterization_state.polygon_mode = gfx_polygon_mode::polygon_mode_line;
 
     auto& graphics_device = m_shared_context->get_graphics_device();
 
     gfx_handle<const gfx_pipeline> created_pipeline = graphics_device->create_graphics_pipeline(create_info);
 
-    m_shadow_cache.insert({ key, created_pipeline });
+    cache.insert({ key, created_pipeline });
 
     return created_pipeline;
-}
\ No newline at end of file
+}
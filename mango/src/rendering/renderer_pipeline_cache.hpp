@@ -19,15 +19,21 @@ namespace mango
         //! \brief Constructs a new \a renderer_pipeline_cache.
         //! \param[in] context The internally shared context of mango.
         renderer_pipeline_cache(const shared_ptr<context_impl>& context)
-            : m_shared_context(context){};
+            : m_has_opaque_fallback(false)
+            , m_shared_context(context){};
 
         ~renderer_pipeline_cache() = default;
 
         //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for opaque geometry.
+        //! \details Also derives the base for opaque geometry rendered after a depth pre-pass, which only passes equal depth and does not write it.
         //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
         inline void set_opaque_base(const graphics_pipeline_create_info& basic_create_info)
         {
             m_opaque_create_info = basic_create_info;
+
+            m_opaque_prepassed_create_info                                            = basic_create_info;
+            m_opaque_prepassed_create_info.depth_stencil_state.depth_compare_operator = gfx_compare_operator::compare_operator_equal;
+            m_opaque_prepassed_create_info.depth_stencil_state.enable_depth_write     = false;
         }
         //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for transparent geometry.
         //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
@@ -41,24 +47,64 @@ namespace mango
         {
             m_shadow_create_info = basic_create_info;
         }
+        //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for the depth pre-pass.
+        //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
+        inline void set_depth_prepass_base(const graphics_pipeline_create_info& basic_create_info)
+        {
+            m_depth_prepass_create_info = basic_create_info;
+        }
+        //! \brief Sets the shader stages used for opaque geometry as long as the real graphics \a gfx_pipeline is not ready.
+        //! \param[in] fallback_stages The \a graphics_shader_stage_descriptor replacing the one of the opaque base.
+        inline void set_opaque_fallback(const graphics_shader_stage_descriptor& fallback_stages)
+        {
+            m_opaque_fallback_stages = fallback_stages;
+            m_has_opaque_fallback    = true;
+        }
+
+        //! \brief Starts the creation of all graphics \a gfx_pipelines for geometry with a specific vertex layout.
+        //! \details Does not wait for the \a gfx_pipelines, so that they get compiled in the background if the driver supports it.
+        //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
+        //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
+        void warm_up(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad);
 
         //! \brief Gets a graphics \a gfx_pipeline for opaque geometry.
+        //! \details Returns a \a gfx_pipeline with the fallback shader stages as long as the real one is not ready.
         //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
         //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
         //! \param[in] wireframe True if the pipeline should render wireframe, else false.
         //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering opaque geometry.
         gfx_handle<const gfx_pipeline> get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe);
+        //! \brief Gets a graphics \a gfx_pipeline for opaque geometry already rendered in the depth pre-pass.
+        //! \details Returns a \a gfx_pipeline with the fallback shader stages as long as the real one is not ready.
+        //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
+        //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
+        //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering opaque geometry with depth equal test and no depth writes.
+        gfx_handle<const gfx_pipeline> get_opaque_prepassed(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad);
         //! \brief Gets a graphics \a gfx_pipeline for transparent geometry.
+        //! \details Returns nullptr as long as the \a gfx_pipeline is not ready.
         //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
         //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
         //! \param[in] wireframe True if the pipeline should render wireframe, else false.
-        //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering transparent geometry.
+        //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering transparent geometry or nullptr if it is not ready.
         gfx_handle<const gfx_pipeline> get_transparent(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe);
         //! \brief Gets a graphics \a gfx_pipeline for shadow pass geometry.
+        //! \details Returns nullptr as long as the \a gfx_pipeline is not ready.
         //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
         //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
-        //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering shadow pass geometry.
+        //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering shadow pass geometry or nullptr if it is not ready.
         gfx_handle<const gfx_pipeline> get_shadow(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad);
+        //! \brief Gets a graphics \a gfx_pipeline for the depth pre-pass.
+        //! \details Returns nullptr as long as the \a gfx_pipeline is not ready. Only the position attribute of the geometry is read.
+        //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
+        //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
+        //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering depth only or nullptr if it is not ready.
+        gfx_handle<const gfx_pipeline> get_depth_prepass(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad);
+
+        //! \brief Reduces a \a vertex_input_descriptor to the position attribute.
+        //! \details The binding of the position attribute is kept, so that the same vertex buffer can be bound to it.
+        //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
+        //! \return The \a vertex_input_descriptor only containing the position attribute and its binding.
+        static vertex_input_descriptor position_only(const vertex_input_descriptor& geo_vid);
 
       private:
         //! \brief Key for caching \a gfx_pipelines.
@@ -151,19 +197,55 @@ namespace mango
             };
         };
 
+        //! \brief Type of the caches mapping \a pipeline_keys to \a gfx_pipelines.
+        using pipeline_cache = std::unordered_map<pipeline_key, gfx_handle<const gfx_pipeline>, pipeline_key_hash>;
+
+        //! \brief Returns a cached graphics \a gfx_pipeline or creates it.
+        //! \param[in,out] cache The cache to search and insert in.
+        //! \param[in] base_create_info The \a graphics_pipeline_create_info used as base for the creation.
+        //! \param[in] key The \a pipeline_key of the \a gfx_pipeline.
+        //! \return A \a gfx_handle of the \a gfx_pipeline.
+        gfx_handle<const gfx_pipeline> get_pipeline(pipeline_cache& cache, const graphics_pipeline_create_info& base_create_info, const pipeline_key& key);
+
+        //! \brief Returns a cached graphics \a gfx_pipeline for opaque geometry or the fallback as long as it is not ready.
+        //! \param[in,out] cache The cache to search and insert in.
+        //! \param[in,out] fallback_cache The cache to search and insert the fallback in.
+        //! \param[in] base_create_info The \a graphics_pipeline_create_info used as base for the creation.
+        //! \param[in] key The \a pipeline_key of the \a gfx_pipeline.
+        //! \return A \a gfx_handle of the \a gfx_pipeline or its fallback.
+        gfx_handle<const gfx_pipeline> get_opaque_pipeline(pipeline_cache& cache, pipeline_cache& fallback_cache, const graphics_pipeline_create_info& base_create_info,
+                                                           const pipeline_key& key);
+
         //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering opaque geometry.
         graphics_pipeline_create_info m_opaque_create_info;
+        //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering opaque geometry after the depth pre-pass.
+        graphics_pipeline_create_info m_opaque_prepassed_create_info;
         //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering transparent geometry.
         graphics_pipeline_create_info m_transparent_create_info;
         //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering shadow pass geometry.
         graphics_pipeline_create_info m_shadow_create_info;
+        //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering the depth pre-pass.
+        graphics_pipeline_create_info m_depth_prepass_create_info;
+
+        //! \brief The shader stages used for opaque geometry as long as the real \a gfx_pipeline is not ready.
+        graphics_shader_stage_descriptor m_opaque_fallback_stages;
+        //! \brief True if fallback shader stages for opaque geometry are set, else false.
+        bool m_has_opaque_fallback;
 
         //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering opaque geometry.
-        std::unordered_map<pipeline_key, gfx_handle<const gfx_pipeline>, pipeline_key_hash> m_opaque_cache;
+        pipeline_cache m_opaque_cache;
+        //! \brief The cache mapping \a pipeline_keys to fallback \a gfx_pipelines of rendering opaque geometry.
+        pipeline_cache m_opaque_fallback_cache;
+        //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering opaque geometry after the depth pre-pass.
+        pipeline_cache m_opaque_prepassed_cache;
+        //! \brief The cache mapping \a pipeline_keys to fallback \a gfx_pipelines of rendering opaque geometry after the depth pre-pass.
+        pipeline_cache m_opaque_prepassed_fallback_cache;
         //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering transparent geometry.
-        std::unordered_map<pipeline_key, gfx_handle<const gfx_pipeline>, pipeline_key_hash> m_transparent_cache;
+        pipeline_cache m_transparent_cache;
         //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering shadow pass geometry.
-        std::unordered_map<pipeline_key, gfx_handle<const gfx_pipeline>, pipeline_key_hash> m_shadow_cache;
+        pipeline_cache m_shadow_cache;
+        //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering the depth pre-pass.
+        pipeline_cache m_depth_prepass_cache;
 
         //! \brief Mangos internal context for shared usage.
         shared_ptr<context_impl> m_shared_context;
@@ -0,0 +1,73 @@
+//! \file      resolution_scale_controller.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <cmath>
+#include <mango/assert.hpp>
+#include <rendering/resolution_scale_controller.hpp>
+
+using namespace mango;
+
+//! \brief The weight of a new measurement in the smoothed frame time.
+static const float smoothing_factor = 0.1f;
+//! \brief The scale is increased when the frame time is below this fraction of the target.
+static const float increase_threshold = 0.85f;
+//! \brief The largest change of the scale per update.
+static const float max_scale_step = 0.05f;
+
+resolution_scale_controller::resolution_scale_controller()
+    : m_target_frame_time(16.0f)
+    , m_min_scale(0.5f)
+    , m_max_scale(1.0f)
+    , m_scale(1.0f)
+    , m_frame_time(0.0f)
+{
+}
+
+void resolution_scale_controller::set_target_frame_time(float milliseconds)
+{
+    MANGO_ASSERT(milliseconds > 0.0f, "Target frame time has to be positive!");
+    m_target_frame_time = milliseconds;
+}
+
+void resolution_scale_controller::set_scale_range(float min_scale, float max_scale)
+{
+    MANGO_ASSERT(min_scale > 0.0f, "Minimum scale has to be positive!");
+    MANGO_ASSERT(max_scale >= min_scale, "Maximum scale has to be greater or equal to the minimum scale!");
+    m_min_scale = min_scale;
+    m_max_scale = max_scale;
+    m_scale     = glm::clamp(m_scale, m_min_scale, m_max_scale);
+}
+
+void resolution_scale_controller::reset()
+{
+    m_scale      = m_max_scale;
+    m_frame_time = 0.0f;
+}
+
+float resolution_scale_controller::update(float milliseconds)
+{
+    if (milliseconds <= 0.0f)
+        return m_scale;
+
+    m_frame_time = m_frame_time > 0.0f ? glm::mix(m_frame_time, milliseconds, smoothing_factor) : milliseconds;
+
+    // Inside of the band the scale is kept.
+    if (m_frame_time <= m_target_frame_time && m_frame_time >= m_target_frame_time * increase_threshold)
+        return m_scale;
+
+    float target_scale = m_scale * std::sqrt(m_target_frame_time / m_frame_time);
+    float new_scale    = glm::clamp(target_scale, m_scale - max_scale_step, m_scale + max_scale_step);
+    new_scale          = glm::clamp(new_scale, m_min_scale, m_max_scale);
+
+    // Measurements arrive a few frames late, so the smoothed time is moved to the expected time of the new scale.
+    // Else the old times would keep pushing the scale in the same direction.
+    float ratio = new_scale / m_scale;
+    m_frame_time *= ratio * ratio;
+
+    m_scale = new_scale;
+
+    return m_scale;
+}
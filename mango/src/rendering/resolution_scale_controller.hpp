@@ -0,0 +1,76 @@
+//! \file      resolution_scale_controller.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_RESOLUTION_SCALE_CONTROLLER_HPP
+#define MANGO_RESOLUTION_SCALE_CONTROLLER_HPP
+
+#include <mango/types.hpp>
+
+namespace mango
+{
+    //! \brief Controls the resolution scale of dynamic resolution rendering.
+    //! \details Measured gpu frame times are smoothed and the scale is adjusted to hold a target frame time.
+    //! The cost of a frame is assumed to scale with the number of pixels, so the scale changes with the square root of the time ratio.
+    //! The scale only changes when the frame time leaves a band around the target and each change is limited in size, which prevents oscillation.
+    class resolution_scale_controller
+    {
+      public:
+        resolution_scale_controller();
+        ~resolution_scale_controller() = default;
+
+        //! \brief Sets the frame time to hold.
+        //! \param[in] milliseconds The target gpu frame time in milliseconds. Has to be positive.
+        void set_target_frame_time(float milliseconds);
+
+        //! \brief Returns the frame time to hold.
+        //! \return The target gpu frame time in milliseconds.
+        inline float get_target_frame_time() const
+        {
+            return m_target_frame_time;
+        }
+
+        //! \brief Sets the range of the scale.
+        //! \param[in] min_scale The minimum scale. Has to be positive.
+        //! \param[in] max_scale The maximum scale. Has to be greater or equal to min_scale.
+        void set_scale_range(float min_scale, float max_scale);
+
+        //! \brief Resets the scale to the maximum and drops the measured frame times.
+        void reset();
+
+        //! \brief Adds a measured gpu frame time and adjusts the scale.
+        //! \param[in] milliseconds The gpu frame time in milliseconds, measured with the current scale.
+        //! \return The new scale.
+        float update(float milliseconds);
+
+        //! \brief Returns the current scale.
+        //! \return The scale applied to width and height of the internal render targets.
+        inline float get_scale() const
+        {
+            return m_scale;
+        }
+
+        //! \brief Returns the smoothed gpu frame time.
+        //! \return The smoothed gpu frame time in milliseconds, 0 if no time was measured.
+        inline float get_frame_time() const
+        {
+            return m_frame_time;
+        }
+
+      private:
+        //! \brief The target gpu frame time in milliseconds.
+        float m_target_frame_time;
+        //! \brief The minimum scale.
+        float m_min_scale;
+        //! \brief The maximum scale.
+        float m_max_scale;
+        //! \brief The current scale.
+        float m_scale;
+        //! \brief The smoothed gpu frame time in milliseconds.
+        float m_frame_time;
+    };
+} // namespace mango
+
+#endif // MANGO_RESOLUTION_SCALE_CONTROLLER_HPP
@@ -0,0 +1,355 @@
+//! \file      software_occlusion_culler.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mango/profile.hpp>
+#include <rendering/software_occlusion_culler.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTWARE_OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace mango;
+
+//! \brief Clip space w below which vertices are treated as behind the camera.
+static const float near_w_epsilon = 1e-5f;
+//! \brief Triangles with a smaller doubled screen space area in pixels are dropped.
+static const float min_triangle_area = 1e-6f;
+
+software_occlusion_culler::software_occlusion_culler(int32 width, int32 height, int32 worker_count)
+    : m_width(((std::max(width, 1) + tile_size - 1) / tile_size) * tile_size)
+    , m_height(((std::max(height, 1) + tile_size - 1) / tile_size) * tile_size)
+    , m_worker_count(worker_count)
+    , m_view_projection(1.0f)
+    , m_work_generation(0)
+    , m_rows_per_band(0)
+    , m_worker_bands(0)
+    , m_pending_bands(0)
+    , m_stop_workers(false)
+{
+    if (m_worker_count <= 0)
+        m_worker_count = std::max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+    m_worker_count = std::min(m_worker_count, m_height / tile_size);
+
+    m_depth.resize(m_width * m_height, 1.0f);
+    m_tile_depth.resize((m_width / tile_size) * (m_height / tile_size), 1.0f);
+
+    // Creating threads each frame costs more than rasterizing a small depth buffer, so the workers are kept alive.
+    for (int32 i = 0; i < m_worker_count - 1; ++i)
+        m_workers.emplace_back(&software_occlusion_culler::worker_loop, this, i);
+}
+
+software_occlusion_culler::~software_occlusion_culler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_work_mutex);
+        m_stop_workers = true;
+    }
+    m_work_start.notify_all();
+    for (auto& w : m_workers)
+        w.join();
+}
+
+void software_occlusion_culler::begin_frame(const mat4& view_projection)
+{
+    m_view_projection = view_projection;
+    m_triangles.clear();
+}
+
+int32 software_occlusion_culler::add_occluder(const vec3* vertices, const uint32* indices, int32 index_count, const mat4& model_matrix, bool double_sided)
+{
+    PROFILE_ZONE;
+    mat4 model_view_projection = m_view_projection * model_matrix;
+    int32 added                = 0;
+
+    for (int32 i = 0; i + 2 < index_count; i += 3)
+    {
+        vec3 window[3];
+        bool dropped    = false;
+        bool behind_far = true;
+        for (int32 v = 0; v < 3; ++v)
+        {
+            vec4 clip = model_view_projection * vec4(vertices[indices[i + v]], 1.0f);
+
+            // Parts in front of the near plane are clipped on the gpu and do not occlude anything.
+            if (clip.w <= near_w_epsilon || clip.z < -clip.w)
+            {
+                dropped = true;
+                break;
+            }
+            behind_far = behind_far && clip.z > clip.w;
+
+            vec3 ndc  = vec3(clip) / clip.w;
+            window[v] = vec3((ndc.x * 0.5f + 0.5f) * m_width, (ndc.y * 0.5f + 0.5f) * m_height, ndc.z * 0.5f + 0.5f);
+        }
+        if (dropped || behind_far)
+            continue;
+
+        vec2 d1    = vec2(window[1].x - window[0].x, window[1].y - window[0].y);
+        vec2 d2    = vec2(window[2].x - window[0].x, window[2].y - window[0].y);
+        float area = d1.x * d2.y - d1.y * d2.x;
+        if (std::abs(area) < min_triangle_area)
+            continue;
+
+        // Counter clockwise triangles are front facing. Back faces are culled on the gpu, unless the material is double sided.
+        if (area < 0.0f)
+        {
+            if (!double_sided)
+                continue;
+
+            std::swap(window[1], window[2]);
+            std::swap(d1, d2);
+            area = -area;
+        }
+
+        raster_triangle tri;
+        float min_x = std::min(window[0].x, std::min(window[1].x, window[2].x));
+        float max_x = std::max(window[0].x, std::max(window[1].x, window[2].x));
+        float min_y = std::min(window[0].y, std::min(window[1].y, window[2].y));
+        float max_y = std::max(window[0].y, std::max(window[1].y, window[2].y));
+        // Pixels are covered if their center is inside.
+        tri.min_x = std::max(0, static_cast<int32>(std::ceil(min_x - 0.5f)));
+        tri.max_x = std::min(m_width - 1, static_cast<int32>(std::floor(max_x - 0.5f)));
+        tri.min_y = std::max(0, static_cast<int32>(std::ceil(min_y - 0.5f)));
+        tri.max_y = std::min(m_height - 1, static_cast<int32>(std::floor(max_y - 0.5f)));
+        if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+            continue;
+
+        // Edge from a to b is positive on the inner side: (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x).
+        for (int32 e = 0; e < 3; ++e)
+        {
+            const vec3& a = window[e];
+            const vec3& b = window[(e + 1) % 3];
+            tri.edge_a[e] = a.y - b.y;
+            tri.edge_b[e] = b.x - a.x;
+            tri.edge_c[e] = (b.y - a.y) * a.x - (b.x - a.x) * a.y;
+        }
+
+        float dz1   = window[1].z - window[0].z;
+        float dz2   = window[2].z - window[0].z;
+        float dz_dx = (dz1 * d2.y - dz2 * d1.y) / area;
+        float dz_dy = (dz2 * d1.x - dz1 * d2.x) / area;
+        tri.depth   = vec3(dz_dx, dz_dy, window[0].z - dz_dx * window[0].x - dz_dy * window[0].y);
+
+        m_triangles.push_back(tri);
+        added++;
+    }
+
+    return added;
+}
+
+void software_occlusion_culler::rasterize()
+{
+    PROFILE_ZONE;
+    if (m_triangles.empty())
+    {
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+        std::fill(m_tile_depth.begin(), m_tile_depth.end(), 1.0f);
+        return;
+    }
+
+    // Bands are aligned to tiles, so that each tile is written by a single thread.
+    int32 tile_rows     = m_height / tile_size;
+    int32 band_count    = std::min(m_worker_count, tile_rows);
+    int32 rows_per_band = ((tile_rows + band_count - 1) / band_count) * tile_size;
+    int32 worker_bands  = (m_height + rows_per_band - 1) / rows_per_band - 1;
+
+    if (worker_bands > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_work_mutex);
+            m_rows_per_band = rows_per_band;
+            m_worker_bands  = worker_bands;
+            m_pending_bands = worker_bands;
+            m_work_generation++;
+        }
+        m_work_start.notify_all();
+    }
+
+    // The last band is rasterized on the calling thread.
+    rasterize_band(worker_bands * rows_per_band, m_height);
+
+    if (worker_bands > 0)
+    {
+        std::unique_lock<std::mutex> lock(m_work_mutex);
+        m_work_done.wait(lock, [this]() { return m_pending_bands == 0; });
+    }
+}
+
+void software_occlusion_culler::worker_loop(int32 band)
+{
+    int64 generation = 0;
+    for (;;)
+    {
+        int32 rows_per_band;
+        {
+            std::unique_lock<std::mutex> lock(m_work_mutex);
+            m_work_start.wait(lock, [this, generation]() { return m_stop_workers || m_work_generation != generation; });
+            if (m_stop_workers)
+                return;
+            generation = m_work_generation;
+            if (band >= m_worker_bands)
+                continue;
+            rows_per_band = m_rows_per_band;
+        }
+
+        rasterize_band(band * rows_per_band, (band + 1) * rows_per_band);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_work_mutex);
+            last = --m_pending_bands == 0;
+        }
+        if (last)
+            m_work_done.notify_one();
+    }
+}
+
+void software_occlusion_culler::rasterize_band(int32 first_row, int32 end_row)
+{
+    std::fill(m_depth.begin() + first_row * m_width, m_depth.begin() + end_row * m_width, 1.0f);
+
+    for (const raster_triangle& tri : m_triangles)
+    {
+        if (tri.max_y < first_row || tri.min_y >= end_row)
+            continue;
+        rasterize_triangle(tri, first_row, end_row);
+    }
+
+    int32 tiles_x = m_width / tile_size;
+    for (int32 ty = first_row / tile_size; ty < end_row / tile_size; ++ty)
+    {
+        for (int32 tx = 0; tx < tiles_x; ++tx)
+        {
+            float farthest = 0.0f;
+            for (int32 y = ty * tile_size; y < (ty + 1) * tile_size; ++y)
+            {
+                const float* row = m_depth.data() + y * m_width + tx * tile_size;
+                for (int32 x = 0; x < tile_size; ++x)
+                    farthest = std::max(farthest, row[x]);
+            }
+            m_tile_depth[ty * tiles_x + tx] = farthest;
+        }
+    }
+}
+
+void software_occlusion_culler::rasterize_triangle(const raster_triangle& tri, int32 first_row, int32 end_row)
+{
+    int32 min_y = std::max(tri.min_y, first_row);
+    int32 max_y = std::min(tri.max_y, end_row - 1);
+
+#ifdef SOFTWARE_OCCLUSION_SSE2
+    // The width is a multiple of the tile size, so groups of four pixels never leave the row.
+    int32 min_x         = tri.min_x & ~3;
+    const __m128 offset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero   = _mm_setzero_ps();
+    const __m128 a0     = _mm_set1_ps(tri.edge_a.x);
+    const __m128 a1     = _mm_set1_ps(tri.edge_a.y);
+    const __m128 a2     = _mm_set1_ps(tri.edge_a.z);
+    const __m128 za     = _mm_set1_ps(tri.depth.x);
+
+    for (int32 y = min_y; y <= max_y; ++y)
+    {
+        float fy   = static_cast<float>(y) + 0.5f;
+        __m128 r0  = _mm_set1_ps(tri.edge_b.x * fy + tri.edge_c.x);
+        __m128 r1  = _mm_set1_ps(tri.edge_b.y * fy + tri.edge_c.y);
+        __m128 r2  = _mm_set1_ps(tri.edge_b.z * fy + tri.edge_c.z);
+        __m128 rz  = _mm_set1_ps(tri.depth.y * fy + tri.depth.z);
+        float* row = m_depth.data() + y * m_width;
+
+        for (int32 x = min_x; x <= tri.max_x; x += 4)
+        {
+            __m128 fx   = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offset);
+            __m128 e0   = _mm_add_ps(_mm_mul_ps(a0, fx), r0);
+            __m128 e1   = _mm_add_ps(_mm_mul_ps(a1, fx), r1);
+            __m128 e2   = _mm_add_ps(_mm_mul_ps(a2, fx), r2);
+            __m128 mask = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+            if (_mm_movemask_ps(mask) == 0)
+                continue;
+
+            __m128 z      = _mm_add_ps(_mm_mul_ps(za, fx), rz);
+            __m128 depth  = _mm_loadu_ps(row + x);
+            __m128 nearer = _mm_min_ps(depth, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, nearer), _mm_andnot_ps(mask, depth)));
+        }
+    }
+#else
+    for (int32 y = min_y; y <= max_y; ++y)
+    {
+        float fy   = static_cast<float>(y) + 0.5f;
+        float* row = m_depth.data() + y * m_width;
+
+        for (int32 x = tri.min_x; x <= tri.max_x; ++x)
+        {
+            float fx = static_cast<float>(x) + 0.5f;
+            if (tri.edge_a.x * fx + tri.edge_b.x * fy + tri.edge_c.x < 0.0f || tri.edge_a.y * fx + tri.edge_b.y * fy + tri.edge_c.y < 0.0f ||
+                tri.edge_a.z * fx + tri.edge_b.z * fy + tri.edge_c.z < 0.0f)
+                continue;
+
+            float z = tri.depth.x * fx + tri.depth.y * fy + tri.depth.z;
+            row[x]  = std::min(row[x], z);
+        }
+    }
+#endif
+}
+
+bool software_occlusion_culler::is_occluded(const axis_aligned_bounding_box& bounding_box) const
+{
+    if (m_triangles.empty())
+        return false;
+
+    auto corners  = bounding_box.get_corners();
+    vec2 min_pos  = vec2(std::numeric_limits<float>::max());
+    vec2 max_pos  = vec2(std::numeric_limits<float>::lowest());
+    float nearest = 1.0f;
+    for (const vec3& corner : corners)
+    {
+        vec4 clip = m_view_projection * vec4(corner, 1.0f);
+        // Boxes reaching in front of the near plane are always visible.
+        if (clip.w <= near_w_epsilon || clip.z < -clip.w)
+            return false;
+
+        vec3 ndc    = vec3(clip) / clip.w;
+        vec2 screen = vec2(ndc.x, ndc.y) * 0.5f + 0.5f;
+        min_pos     = glm::min(min_pos, screen);
+        max_pos     = glm::max(max_pos, screen);
+        nearest     = std::min(nearest, ndc.z * 0.5f + 0.5f);
+    }
+
+    // Any pixel touched by the screen rectangle of the box has to be nearer than the box.
+    int32 min_x = std::max(0, static_cast<int32>(std::floor(min_pos.x * m_width)));
+    int32 max_x = std::min(m_width - 1, static_cast<int32>(std::floor(max_pos.x * m_width)));
+    int32 min_y = std::max(0, static_cast<int32>(std::floor(min_pos.y * m_height)));
+    int32 max_y = std::min(m_height - 1, static_cast<int32>(std::floor(max_pos.y * m_height)));
+    if (min_x > max_x || min_y > max_y)
+        return false;
+
+    int32 tiles_x = m_width / tile_size;
+    for (int32 ty = min_y / tile_size; ty <= max_y / tile_size; ++ty)
+    {
+        for (int32 tx = min_x / tile_size; tx <= max_x / tile_size; ++tx)
+        {
+            if (nearest > m_tile_depth[ty * tiles_x + tx])
+                continue;
+
+            int32 y_end = std::min(max_y, (ty + 1) * tile_size - 1);
+            int32 x_end = std::min(max_x, (tx + 1) * tile_size - 1);
+            for (int32 y = std::max(min_y, ty * tile_size); y <= y_end; ++y)
+            {
+                for (int32 x = std::max(min_x, tx * tile_size); x <= x_end; ++x)
+                {
+                    if (nearest <= m_depth[y * m_width + x])
+                        return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,163 @@
+//! \file      software_occlusion_culler.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_SOFTWARE_OCCLUSION_CULLER_HPP
+#define MANGO_SOFTWARE_OCCLUSION_CULLER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <util/helpers.hpp>
+#include <util/intersect.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Occlusion culling against a low resolution depth buffer rasterized on the cpu.
+    //! \details Selected occluders are rasterized into the depth buffer each frame, bounds are tested against it afterwards.
+    //! Unlike the \a hi_z_culler, results are available in the same frame and no gpu readback is required.
+    //! Rasterization samples pixel centers and splits the depth buffer into bands of rows, which are rasterized in parallel
+    //! by worker threads living as long as the \a software_occlusion_culler. Four pixels are processed at once when SSE2 is available.
+    class software_occlusion_culler
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(software_occlusion_culler)
+      public:
+        //! \brief Constructs the \a software_occlusion_culler.
+        //! \param[in] width The width of the depth buffer in pixels. Rounded up to a multiple of tile_size.
+        //! \param[in] height The height of the depth buffer in pixels. Rounded up to a multiple of tile_size.
+        //! \param[in] worker_count The maximum number of threads rasterizing in parallel. 0 uses the number of hardware threads.
+        software_occlusion_culler(int32 width = default_width, int32 height = default_height, int32 worker_count = 0);
+        ~software_occlusion_culler();
+
+        //! \brief Begins a frame and drops all occluders of the last one.
+        //! \param[in] view_projection The view projection matrix of the camera.
+        void begin_frame(const mat4& view_projection);
+
+        //! \brief Adds an indexed triangle list as occluder.
+        //! \details Triangles crossing the near plane are dropped, the rest is transformed and set up for rasterization.
+        //! Like on the gpu, back facing triangles are dropped unless the occluder is double sided.
+        //! \param[in] vertices Pointer to the object space positions.
+        //! \param[in] indices Pointer to the indices. Three per triangle.
+        //! \param[in] index_count The number of indices.
+        //! \param[in] model_matrix The transformation from object to world space.
+        //! \param[in] double_sided True if back facing triangles occlude as well, else false.
+        //! \return The number of triangles added.
+        int32 add_occluder(const vec3* vertices, const uint32* indices, int32 index_count, const mat4& model_matrix, bool double_sided = false);
+
+        //! \brief Rasterizes all added occluders into the depth buffer.
+        //! \details Has to be called after the last add_occluder() and before the first is_occluded() of the frame.
+        void rasterize();
+
+        //! \brief Tests a world space \a axis_aligned_bounding_box against the depth buffer.
+        //! \param[in] bounding_box The world space \a axis_aligned_bounding_box to test.
+        //! \return True if the box is completely behind the rasterized occluders, else false.
+        bool is_occluded(const axis_aligned_bounding_box& bounding_box) const;
+
+        //! \brief Returns the width of the depth buffer.
+        //! \return The width in pixels.
+        inline int32 width() const
+        {
+            return m_width;
+        }
+
+        //! \brief Returns the height of the depth buffer.
+        //! \return The height in pixels.
+        inline int32 height() const
+        {
+            return m_height;
+        }
+
+        //! \brief Returns the rasterized depth of a pixel.
+        //! \param[in] x The column of the pixel.
+        //! \param[in] y The row of the pixel. Row 0 is the bottom of the screen.
+        //! \return The window space depth of the pixel. 1.0 where no occluder was rasterized.
+        inline float depth_at(int32 x, int32 y) const
+        {
+            return m_depth[y * m_width + x];
+        }
+
+        //! \brief Returns the number of triangles set up for rasterization in the current frame.
+        //! \return The number of triangles.
+        inline int32 triangle_count() const
+        {
+            return static_cast<int32>(m_triangles.size());
+        }
+
+        //! \brief The default width of the depth buffer.
+        static const int32 default_width = 256;
+        //! \brief The default height of the depth buffer.
+        static const int32 default_height = 128;
+        //! \brief The width and height of the tiles storing the farthest depth.
+        static const int32 tile_size = 8;
+
+      private:
+        //! \brief A triangle set up for rasterization.
+        //! \details Edge functions and depth are stored as plane equations a * x + b * y + c evaluated at pixel centers.
+        struct raster_triangle
+        {
+            vec3 edge_a; //!< The x coefficients of the three edge functions.
+            vec3 edge_b; //!< The y coefficients of the three edge functions.
+            vec3 edge_c; //!< The constant terms of the three edge functions.
+            vec3 depth;  //!< The depth plane equation.
+            int32 min_x; //!< The first column covered by the bounds of the triangle.
+            int32 max_x; //!< The last column covered by the bounds of the triangle.
+            int32 min_y; //!< The first row covered by the bounds of the triangle.
+            int32 max_y; //!< The last row covered by the bounds of the triangle.
+        };
+
+        //! \brief Rasterizes all triangles into a band of rows and updates the tile depth of the band.
+        //! \param[in] first_row The first row of the band. Multiple of tile_size.
+        //! \param[in] end_row The row after the last of the band. Multiple of tile_size.
+        void rasterize_band(int32 first_row, int32 end_row);
+
+        //! \brief The loop of a worker thread. Waits for rasterize() and rasterizes one band per frame.
+        //! \param[in] band The index of the band rasterized by the worker.
+        void worker_loop(int32 band);
+
+        //! \brief Rasterizes a single triangle into a band of rows.
+        //! \param[in] tri The \a raster_triangle to rasterize.
+        //! \param[in] first_row The first row of the band.
+        //! \param[in] end_row The row after the last of the band.
+        void rasterize_triangle(const raster_triangle& tri, int32 first_row, int32 end_row);
+
+        //! \brief The width of the depth buffer in pixels.
+        int32 m_width;
+        //! \brief The height of the depth buffer in pixels.
+        int32 m_height;
+        //! \brief The maximum number of threads rasterizing in parallel.
+        int32 m_worker_count;
+
+        //! \brief The view projection matrix of the current frame.
+        mat4 m_view_projection;
+        //! \brief The window space depth of each pixel.
+        std::vector<float> m_depth;
+        //! \brief The farthest depth of each tile.
+        std::vector<float> m_tile_depth;
+        //! \brief The triangles of all occluders of the current frame.
+        std::vector<raster_triangle> m_triangles;
+
+        //! \brief The worker threads. The calling thread of rasterize() rasterizes the last band.
+        std::vector<std::thread> m_workers;
+        //! \brief Guards the work description shared with the workers.
+        std::mutex m_work_mutex;
+        //! \brief Signaled when a new frame should be rasterized or the workers should stop.
+        std::condition_variable m_work_start;
+        //! \brief Signaled when the last worker finished its band.
+        std::condition_variable m_work_done;
+        //! \brief Incremented by each rasterize(), so that workers notice new work.
+        int64 m_work_generation;
+        //! \brief The number of rows in each band of the current frame.
+        int32 m_rows_per_band;
+        //! \brief The number of bands rasterized by workers in the current frame.
+        int32 m_worker_bands;
+        //! \brief The number of worker bands not finished in the current frame.
+        int32 m_pending_bands;
+        //! \brief True if the workers should exit, else false.
+        bool m_stop_workers;
+    };
+} // namespace mango
+
+#endif // MANGO_SOFTWARE_OCCLUSION_CULLER_HPP
@@ -40,6 +40,20 @@ namespace mango
             m_output_target_depth_stencil = output_depth_stencil_target;
         }
 
+        //! \brief Returns the currently selected quality preset.
+        //! \return The fxaa_quality_preset as integer.
+        inline int32 get_quality_preset()
+        {
+            return m_fxaa_data.quality_preset;
+        }
+
+        //! \brief Returns the currently selected subpixel filter value.
+        //! \return The filter value for subpixels.
+        inline float get_subpixel_filter()
+        {
+            return m_fxaa_data.subpixel_filter;
+        }
+
       private:
         bool create_step_resources() override;
 
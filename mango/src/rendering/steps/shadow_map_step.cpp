@@ -15,6 +15,12 @@ using namespace mango;
 
 shadow_map_step::shadow_map_step(const shadow_settings& settings)
     : m_settings(settings)
+    , m_depth_reduction_mapping(nullptr)
+    , m_depth_reduction_pending(false)
+    , m_sample_distribution(settings.get_sample_distribution())
+    , m_depth_bounds(0.0f)
+    , m_depth_bounds_valid(false)
+    , m_caster_frame(0)
 {
     PROFILE_ZONE;
 
@@ -33,6 +39,8 @@ shadow_map_step::shadow_map_step(const shadow_settings& settings)
     MANGO_ASSERT(m_shadow_data.sample_count >= 8 && m_shadow_data.sample_count <= 64, "Sample count is not in valid range 8 - 64!");
     MANGO_ASSERT(m_shadow_data.cascade_count > 0 && m_shadow_data.cascade_count < 5, "Cascade count has to be between 1 and 4!");
     MANGO_ASSERT(m_cascade_data.lambda > 0.0f && m_cascade_data.lambda < 1.0f, "Lambda has to be between 0.0 and 1.0!");
+
+    invalidate_cascade_cache();
 }
 
 shadow_map_step::~shadow_map_step() {}
@@ -51,6 +59,22 @@ bool shadow_map_step::create_step_resources()
     if (!check_creation(m_shadow_data_buffer.get(), "shadow data buffer"))
         return false;
 
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_mapped_access_read_write;
+    buffer_info.size          = sizeof(depth_reduction_data);
+
+    m_depth_reduction_buffer = graphics_device->create_buffer(buffer_info);
+    if (!check_creation(m_depth_reduction_buffer.get(), "depth reduction buffer"))
+        return false;
+
+    graphics_device_context_handle device_context = graphics_device->create_graphics_device_context();
+    device_context->begin();
+    m_depth_reduction_mapping = static_cast<depth_reduction_data*>(device_context->map_buffer_data(m_depth_reduction_buffer, 0, sizeof(depth_reduction_data)));
+    device_context->end();
+    device_context->submit();
+    if (!check_mapping(m_depth_reduction_mapping, "depth reduction buffer"))
+        return false;
+
     // textures
     if (!create_shadow_map())
         return false;
@@ -157,6 +181,104 @@ bool shadow_map_step::create_step_resources()
 
         res_resource_desc.defines.clear();
     }
+    // depth reduction compute stage
+    {
+        res_resource_desc.path = "res/shader/shadow/c_depth_reduction.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 4;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, DEPTH_REDUCTION_BUFFER_BINDING_POINT, "depth_reduction_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_compute, DEPTH_REDUCTION_SAMPLER_DEPTH, "texture_depth_input", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, DEPTH_REDUCTION_SAMPLER_DEPTH, "sampler_depth_input", gfx_shader_resource_type::shader_resource_sampler, 1 },
+        } };
+
+        m_depth_reduction_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_depth_reduction_compute.get(), "depth reduction compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // copy vertex stage
+    {
+        res_resource_desc.path        = "res/shader/v_screen_space_triangle.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_vertex;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 0;
+
+        m_shadow_copy_vertex = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_shadow_copy_vertex.get(), "shadow copy vertex shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // copy geometry stage
+    {
+        res_resource_desc.path        = "res/shader/shadow/g_shadow_copy.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_geometry;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 1;
+
+        shader_info.resources = { { { gfx_shader_stage_type::shader_stage_geometry, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 } } };
+
+        m_shadow_copy_geometry = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_shadow_copy_geometry.get(), "shadow copy geometry shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // copy fragment stage
+    {
+        res_resource_desc.path        = "res/shader/shadow/f_shadow_copy.glsl";
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 3;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+
+            { gfx_shader_stage_type::shader_stage_fragment, 0, "texture_static_shadow_map", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, 0, "sampler_static_shadow_map", gfx_shader_resource_type::shader_resource_sampler, 1 },
+        } };
+
+        m_shadow_copy_fragment = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_shadow_copy_fragment.get(), "shadow copy fragment shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
     // Pass Pipeline Base
     {
         m_shadow_pass_pipeline_create_info_base = graphics_device->provide_graphics_pipeline_create_info();
@@ -195,6 +317,65 @@ bool shadow_map_step::create_step_resources()
 
         m_shadow_pass_pipeline_create_info_base.dynamic_state.dynamic_states = gfx_dynamic_state_flag_bits::dynamic_state_viewport | gfx_dynamic_state_flag_bits::dynamic_state_scissor;
     }
+    // Copy Pipeline
+    {
+        graphics_pipeline_create_info copy_pass_info = graphics_device->provide_graphics_pipeline_create_info();
+        auto copy_pass_pipeline_layout               = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_geometry, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, 0, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, 0, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        copy_pass_info.pipeline_layout = copy_pass_pipeline_layout;
+
+        copy_pass_info.shader_stage_descriptor.vertex_shader_stage   = m_shadow_copy_vertex;
+        copy_pass_info.shader_stage_descriptor.geometry_shader_stage = m_shadow_copy_geometry;
+        copy_pass_info.shader_stage_descriptor.fragment_shader_stage = m_shadow_copy_fragment;
+
+        copy_pass_info.vertex_input_state.attribute_description_count = 0;
+        copy_pass_info.vertex_input_state.binding_description_count   = 0;
+
+        copy_pass_info.input_assembly_state.topology = gfx_primitive_topology::primitive_topology_triangle_list;
+
+        // viewport_descriptor is dynamic
+
+        // rasterization_state -> keep default
+        copy_pass_info.depth_stencil_state.depth_compare_operator = gfx_compare_operator::compare_operator_always; // Do not disable since it writes the depth in the fragment shader.
+        // blend_state -> only depth is written
+        copy_pass_info.blend_state.blend_description.color_write_mask = gfx_color_component_flag_bits::component_none;
+
+        copy_pass_info.dynamic_state.dynamic_states = gfx_dynamic_state_flag_bits::dynamic_state_viewport | gfx_dynamic_state_flag_bits::dynamic_state_scissor;
+
+        m_shadow_copy_pipeline = graphics_device->create_graphics_pipeline(copy_pass_info);
+        if (!check_creation(m_shadow_copy_pipeline.get(), "shadow copy pipeline"))
+            return false;
+    }
+    // Depth Reduction Pipeline
+    {
+        compute_pipeline_create_info reduction_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto reduction_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_compute, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, DEPTH_REDUCTION_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+              gfx_shader_resource_access::shader_access_dynamic },
+
+            { gfx_shader_stage_type::shader_stage_compute, DEPTH_REDUCTION_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_compute, DEPTH_REDUCTION_SAMPLER_DEPTH, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        reduction_pass_info.pipeline_layout = reduction_pass_pipeline_layout;
+
+        reduction_pass_info.shader_stage_descriptor.compute_shader_stage = m_depth_reduction_compute;
+
+        m_depth_reduction_pipeline = graphics_device->create_compute_pipeline(reduction_pass_info);
+        if (!check_creation(m_depth_reduction_pipeline.get(), "depth reduction pipeline"))
+            return false;
+    }
 
     return true;
 }
@@ -215,6 +396,12 @@ bool shadow_map_step::create_shadow_map()
     if (!check_creation(m_shadow_map.get(), "shadow map texture"))
         return false;
 
+    m_static_shadow_map = graphics_device->create_texture(shadow_map_info);
+    if (!check_creation(m_static_shadow_map.get(), "static shadow map texture"))
+        return false;
+
+    invalidate_cascade_cache();
+
     return true;
 }
 
@@ -243,10 +430,19 @@ void shadow_map_step::update_cascades(float dt, float camera_near, float camera_
     const float& clip_near  = camera_near;
     const float& clip_far   = camera_far;
     const float& clip_range = clip_far - clip_near;
-    const float& min_z      = clip_near;
-    const float& max_z      = min_z + clip_range;
-    const float& ratio      = max_z / min_z;
-    const float& range      = max_z - min_z;
+    float min_z             = clip_near;
+    float max_z             = min_z + clip_range;
+
+    if (m_sample_distribution && m_depth_bounds_valid)
+    {
+        // Fit the cascades to the visible depth range.
+        // The range is quantized in log space, so that the cascades do not change with every small depth change and cached static shadows stay valid.
+        min_z = glm::clamp(std::exp2(std::floor(std::log2(m_depth_bounds.x) * 8.0f) / 8.0f), clip_near, clip_far);
+        max_z = glm::clamp(std::exp2(std::ceil(std::log2(m_depth_bounds.y) * 8.0f) / 8.0f), min_z, clip_far);
+    }
+
+    const float& ratio = max_z / min_z;
+    const float& range = max_z - min_z;
 
     float cascade_splits[max_shadow_mapping_cascades];
 
@@ -275,7 +471,7 @@ void shadow_map_step::update_cascades(float dt, float camera_near, float camera_
     }
 
     float interpolation   = (m_shadow_data.cascade_interpolation_range - clip_near) / clip_range;
-    float last_split_dist = 0.0f;
+    float last_split_dist = (min_z - clip_near) / clip_range;
     for (int32 casc = 0; casc < m_shadow_data.cascade_count; ++casc)
     {
         vec3 center = vec3(0.0f);
@@ -311,6 +507,16 @@ void shadow_map_step::update_cascades(float dt, float camera_near, float camera_
         vec3 light_to_point = -glm::normalize(m_cascade_data.directional_direction);
         if (glm::dot(up, light_to_point) < 1e-5f)
             up = GLOBAL_RIGHT;
+
+        // Snap the center to texels in light space, so that the view projection only changes when the camera moved at least one texel.
+        // This keeps the cached static shadows valid for small camera movements.
+        float texel_size    = 2.0f * radius / static_cast<float>(m_shadow_data.resolution);
+        mat3 light_rotation = mat3(glm::lookAt(vec3(0.0f), light_to_point, up));
+        vec3 light_center   = light_rotation * center;
+        light_center.x      = std::floor(light_center.x / texel_size) * texel_size;
+        light_center.y      = std::floor(light_center.y / texel_size) * texel_size;
+        light_center.z      = std::floor(light_center.z / texel_size) * texel_size;
+        center              = glm::transpose(light_rotation) * light_center;
         view                           = glm::lookAt(center - light_to_point * (-min_extends.z + m_shadow_map_offset), center, up);
         projection                     = glm::ortho(min_extends.x, max_extends.x, min_extends.y, max_extends.y, 0.0f, (max_extends.z - min_extends.z) + m_shadow_map_offset);
         m_shadow_data.far_planes[casc] = (max_extends.z - min_extends.z) + m_shadow_map_offset;
@@ -332,6 +538,184 @@ void shadow_map_step::update_cascades(float dt, float camera_near, float camera_
     }
 }
 
+void shadow_map_step::read_depth_bounds(const graphics_device_context_handle& device_context)
+{
+    if (!m_sample_distribution)
+    {
+        m_depth_bounds_valid = false;
+        return;
+    }
+    if (!m_depth_reduction_pending || !m_depth_reduction_mapping)
+        return;
+
+    device_context->client_wait(m_depth_reduction_semaphore);
+    m_depth_reduction_pending = false;
+
+    float min_depth, max_depth;
+    memcpy(&min_depth, &m_depth_reduction_mapping->min_depth, sizeof(float));
+    memcpy(&max_depth, &m_depth_reduction_mapping->max_depth, sizeof(float));
+
+    // Nothing visible results in an empty range.
+    m_depth_bounds_valid = min_depth > 0.0f && min_depth <= max_depth;
+    if (m_depth_bounds_valid)
+        m_depth_bounds = vec2(min_depth, max_depth);
+}
+
+void shadow_map_step::reduce_depth(const graphics_device_context_handle& device_context, gfx_handle<const gfx_texture> depth_texture, gfx_handle<const gfx_buffer> camera_data_buffer)
+{
+    if (!m_sample_distribution || !m_depth_reduction_pipeline || !m_depth_reduction_mapping)
+        return;
+
+    // Usually already signaled, read_depth_bounds() waited for it.
+    device_context->client_wait(m_depth_reduction_semaphore);
+
+    float max_float                      = std::numeric_limits<float>::max();
+    m_depth_reduction_mapping->max_depth = 0;
+    memcpy(&m_depth_reduction_mapping->min_depth, &max_float, sizeof(float));
+
+    device_context->bind_pipeline(m_depth_reduction_pipeline);
+
+    m_depth_reduction_pipeline->get_resource_mapping()->set("camera_data", camera_data_buffer);
+    m_depth_reduction_pipeline->get_resource_mapping()->set("depth_reduction_data", m_depth_reduction_buffer);
+    m_depth_reduction_pipeline->get_resource_mapping()->set("texture_depth_input", depth_texture);
+    m_depth_reduction_pipeline->get_resource_mapping()->set("sampler_depth_input", m_shadow_map_sampler);
+    device_context->submit_pipeline_state_resources();
+
+    vec2 size = depth_texture->get_size();
+    device_context->dispatch((static_cast<int32>(size.x) + 15) / 16, (static_cast<int32>(size.y) + 15) / 16, 1);
+
+    m_depth_reduction_semaphore = device_context->fence(semaphore_create_info());
+    m_depth_reduction_pending   = true;
+}
+
+void shadow_map_step::begin_caster_tracking()
+{
+    ++m_caster_frame;
+}
+
+bool shadow_map_step::track_caster(const sid& node_id, const mat4& transformation)
+{
+    auto it = m_casters.find(node_id);
+    if (it == m_casters.end())
+    {
+        // New casters start as dynamic and get cached when they did not move for some frames.
+        caster_state state;
+        state.transformation   = transformation;
+        state.unchanged_frames = 0;
+        state.last_frame       = m_caster_frame;
+        state.is_static        = false;
+        m_casters.insert({ node_id, state });
+        return false;
+    }
+
+    caster_state& state = it->second;
+    if (state.last_frame == m_caster_frame)
+        return state.is_static; // Multiple primitives of the same node.
+    state.last_frame = m_caster_frame;
+
+    if (state.transformation != transformation)
+    {
+        state.transformation   = transformation;
+        state.unchanged_frames = 0;
+        if (state.is_static)
+        {
+            state.is_static = false;
+            invalidate_cascade_cache();
+        }
+        return false;
+    }
+
+    if (!state.is_static && ++state.unchanged_frames >= static_caster_frame_threshold)
+    {
+        state.is_static = true;
+        invalidate_cascade_cache();
+    }
+
+    return state.is_static;
+}
+
+void shadow_map_step::end_caster_tracking()
+{
+    for (auto it = m_casters.begin(); it != m_casters.end();)
+    {
+        if (it->second.last_frame == m_caster_frame)
+        {
+            ++it;
+            continue;
+        }
+        if (it->second.is_static)
+            invalidate_cascade_cache();
+        it = m_casters.erase(it);
+    }
+}
+
+bool shadow_map_step::static_cascade_outdated(int32 cascade_idx)
+{
+    const cascade_cache& cache = m_cascade_cache[cascade_idx];
+    return !cache.static_valid || cache.view_projection != mat4(m_shadow_data.view_projection_matrices[cascade_idx]);
+}
+
+bool shadow_map_step::cascade_outdated(int32 cascade_idx, bool has_dynamic_casters)
+{
+    const cascade_cache& cache = m_cascade_cache[cascade_idx];
+    // Dynamic casters of the last frame have to be removed, even if no dynamic caster is left.
+    return has_dynamic_casters || cache.had_dynamic_casters || !cache.valid || static_cascade_outdated(cascade_idx);
+}
+
+void shadow_map_step::clear_static_cascade(const graphics_device_context_handle& device_context, int32 cascade_idx)
+{
+    draw_cascade_copy(device_context, m_static_shadow_map, cascade_idx, true);
+}
+
+void shadow_map_step::restore_static_cascade(const graphics_device_context_handle& device_context, int32 cascade_idx)
+{
+    draw_cascade_copy(device_context, m_shadow_map, cascade_idx, false);
+}
+
+void shadow_map_step::cascade_rendered(int32 cascade_idx, bool has_dynamic_casters, bool static_complete)
+{
+    cascade_cache& cache      = m_cascade_cache[cascade_idx];
+    cache.view_projection     = m_shadow_data.view_projection_matrices[cascade_idx];
+    cache.static_valid        = static_complete;
+    cache.valid               = true;
+    cache.had_dynamic_casters = has_dynamic_casters;
+}
+
+void shadow_map_step::invalidate_cascade_cache()
+{
+    for (int32 i = 0; i < max_shadow_mapping_cascades; ++i)
+    {
+        m_cascade_cache[i].view_projection     = mat4(0.0f);
+        m_cascade_cache[i].static_valid        = false;
+        m_cascade_cache[i].valid               = false;
+        m_cascade_cache[i].had_dynamic_casters = false;
+    }
+}
+
+void shadow_map_step::draw_cascade_copy(const graphics_device_context_handle& device_context, gfx_handle<const gfx_texture> render_target, int32 cascade_idx, bool clear)
+{
+    if (!m_shadow_copy_pipeline)
+        return;
+
+    m_shadow_data.cascade       = cascade_idx;
+    m_shadow_data.clear_cascade = clear;
+    device_context->set_buffer_data(m_shadow_data_buffer, 0, sizeof(shadow_data), &m_shadow_data);
+    m_shadow_data.clear_cascade = false;
+
+    device_context->set_render_targets(0, nullptr, render_target);
+    device_context->bind_pipeline(m_shadow_copy_pipeline);
+    gfx_viewport shadow_viewport{ 0.0f, 0.0f, static_cast<float>(m_shadow_data.resolution), static_cast<float>(m_shadow_data.resolution) };
+    device_context->set_viewport(0, 1, &shadow_viewport);
+
+    m_shadow_copy_pipeline->get_resource_mapping()->set("shadow_data", m_shadow_data_buffer);
+    m_shadow_copy_pipeline->get_resource_mapping()->set("texture_static_shadow_map", m_static_shadow_map);
+    m_shadow_copy_pipeline->get_resource_mapping()->set("sampler_static_shadow_map", m_shadow_map_sampler);
+
+    device_context->submit_pipeline_state_resources();
+
+    device_context->draw(3, 0, 1, 0, 0, 0);
+}
+
 void shadow_map_step::on_ui_widget()
 {
     ImGui::PushID("shadow_step");
@@ -387,5 +771,6 @@ void shadow_map_step::on_ui_widget()
     default_value[0]           = 0.5f;
     slider_float_n("Cascade Interpolation Range", &interpolation_range, 1, default_value, 0.0f, 10.0f);
     slider_float_n("Cascade Splits Lambda", &m_cascade_data.lambda, 1, default_value, 0.0f, 1.0f);
+    checkbox("Sample Distribution (SDSM)", &m_sample_distribution, false);
     ImGui::PopID();
 }
@@ -37,10 +37,17 @@ namespace mango
             std140_float shadow_width                = 1.0f;   //!< Width of the PCF shadow.
             std140_float shadow_light_size           = 4.0f;   //!< Size of the light used for PCSS shadow.
             std140_int cascade                       = 0;      //!< The currently rendered cascade. Only used in the rendering process, not required in th lookup while lighting is calculated.
-            std140_float pad1;                                 //!< Padding.
+            std140_bool clear_cascade                = false;  //!< True if the cascade of the cached static shadow map should be cleared instead of copied. Only used in the rendering process.
             std140_float pad2;                                 //!< Padding.
         };
 
+        //! \brief Storage buffer struct for the depth reduction.
+        struct depth_reduction_data
+        {
+            uint32 min_depth; //!< The minimum visible view space depth. Stored as float bits, which keep their order for positive values.
+            uint32 max_depth; //!< The maximum visible view space depth. Stored as float bits, which keep their order for positive values.
+        };
+
         //! \brief Constructs a the \a shadow_map_step.
         //! \param[in] settings The \a shadow_settings to use.
         shadow_map_step(const shadow_settings& settings);
@@ -78,6 +85,13 @@ namespace mango
             return m_shadow_map;
         }
 
+        //! \brief Returns the depth texture with multiple layers caching the shadows of static casters.
+        //! \return A \a gfx_texture containing the static shadows.
+        inline gfx_handle<const gfx_texture> get_static_shadow_maps_texture()
+        {
+            return m_static_shadow_map;
+        }
+
         //! \brief Returns the shadow depth sampler to bind as sampler2DArrayShadow.
         //! \return A \a gfx_sampler.
         inline gfx_handle<const gfx_sampler> get_shadow_maps_shadow_sampler()
@@ -116,6 +130,65 @@ namespace mango
         //! \param[in] directional_direction The direction to the light.
         void update_cascades(float dt, float camera_near, float camera_far, const mat4& camera_view_projection, const vec3& directional_direction);
 
+        //! \brief Reads back the visible depth range reduced in the last frame.
+        //! \details Only required when sample distribution shadow maps are enabled. Has to be called before update_cascades().
+        //! The reduction was issued one frame ago, so waiting for it does usually not stall.
+        //! \param[in] device_context The \a graphics_device_context to wait in.
+        void read_depth_bounds(const graphics_device_context_handle& device_context);
+
+        //! \brief Reduces the geometry depth to the visible depth range, used to fit the cascades in the next frame.
+        //! \details Only executed when sample distribution shadow maps are enabled.
+        //! \param[in] device_context The \a graphics_device_context to record the commands in.
+        //! \param[in] depth_texture The depth texture of the geometry.
+        //! \param[in] camera_data_buffer The buffer containing the camera data the depth texture was rendered with.
+        void reduce_depth(const graphics_device_context_handle& device_context, gfx_handle<const gfx_texture> depth_texture, gfx_handle<const gfx_buffer> camera_data_buffer);
+
+        //! \brief Starts the classification of shadow casters for a new frame.
+        void begin_caster_tracking();
+
+        //! \brief Classifies a shadow caster as static or dynamic.
+        //! \details Casters become static after their transformation did not change for \a static_caster_frame_threshold frames.
+        //! Casters becoming static, moving again or getting removed invalidate the cached static shadows.
+        //! \param[in] node_id The \a sid of the \a scene_node of the caster.
+        //! \param[in] transformation The world transformation of the caster.
+        //! \return True if the caster is static, else false.
+        bool track_caster(const sid& node_id, const mat4& transformation);
+
+        //! \brief Ends the classification of shadow casters and removes casters not tracked in the current frame.
+        void end_caster_tracking();
+
+        //! \brief Checks if the static shadows of a cascade have to be rendered again.
+        //! \param[in] cascade_idx The index of the cascade.
+        //! \return True if the cached static shadows of the cascade are outdated, else false.
+        bool static_cascade_outdated(int32 cascade_idx);
+
+        //! \brief Checks if a cascade of the shadow map has to be composited again.
+        //! \param[in] cascade_idx The index of the cascade.
+        //! \param[in] has_dynamic_casters True if dynamic casters intersect the cascade in the current frame, else false.
+        //! \return True if the cascade has to be composited, false if the shadow map from the last frame is still valid.
+        bool cascade_outdated(int32 cascade_idx, bool has_dynamic_casters);
+
+        //! \brief Clears a cascade of the cached static shadow map.
+        //! \details Binds the static shadow map as render target. Static casters can be rendered afterwards.
+        //! \param[in] device_context The \a graphics_device_context to record the commands in.
+        //! \param[in] cascade_idx The index of the cascade.
+        void clear_static_cascade(const graphics_device_context_handle& device_context, int32 cascade_idx);
+
+        //! \brief Copies a cascade of the cached static shadow map into the shadow map.
+        //! \details Binds the shadow map as render target. Dynamic casters can be rendered afterwards.
+        //! \param[in] device_context The \a graphics_device_context to record the commands in.
+        //! \param[in] cascade_idx The index of the cascade.
+        void restore_static_cascade(const graphics_device_context_handle& device_context, int32 cascade_idx);
+
+        //! \brief Marks a cascade as rendered with the current view projection.
+        //! \param[in] cascade_idx The index of the cascade.
+        //! \param[in] has_dynamic_casters True if dynamic casters got rendered into the cascade, else false.
+        //! \param[in] static_complete False if static casters got skipped and the static shadows have to be rendered again, else true.
+        void cascade_rendered(int32 cascade_idx, bool has_dynamic_casters, bool static_complete);
+
+        //! \brief The number of frames the transformation of a caster has to stay unchanged before it is treated as static.
+        static const int32 static_caster_frame_threshold = 30;
+
       private:
         bool create_step_resources() override;
 
@@ -123,11 +196,23 @@ namespace mango
         //! \return True on success, else false.
         bool create_shadow_map();
 
+        //! \brief Invalidates the cache of all cascades.
+        void invalidate_cascade_cache();
+
+        //! \brief Uploads the \a shadow_data and draws the cascade copy pass.
+        //! \param[in] device_context The \a graphics_device_context to record the commands in.
+        //! \param[in] render_target The depth texture to render into.
+        //! \param[in] cascade_idx The index of the cascade.
+        //! \param[in] clear True if the cascade should be cleared, false if the static cascade should be copied.
+        void draw_cascade_copy(const graphics_device_context_handle& device_context, gfx_handle<const gfx_texture> render_target, int32 cascade_idx, bool clear);
+
         //! \brief The \a shadow_settings for the step.
         shadow_settings m_settings;
 
         //! \brief The \a gfx_texture storing all shadow maps.
         gfx_handle<const gfx_texture> m_shadow_map;
+        //! \brief The \a gfx_texture caching the shadows of all static casters.
+        gfx_handle<const gfx_texture> m_static_shadow_map;
         //! \brief The \a gfx_sampler for shadow sampling with samplerShadow.
         gfx_handle<const gfx_sampler> m_shadow_map_shadow_sampler;
         //! \brief The \a gfx_sampler for shadow sampling.
@@ -139,8 +224,37 @@ namespace mango
         //! \brief The fragment \a shader_stage for the shadow map pass.
         gfx_handle<const gfx_shader_stage> m_shadow_pass_fragment;
 
+        //! \brief The compute \a shader_stage for the depth reduction.
+        gfx_handle<const gfx_shader_stage> m_depth_reduction_compute;
+        //! \brief The vertex \a shader_stage for the cascade copy pass.
+        gfx_handle<const gfx_shader_stage> m_shadow_copy_vertex;
+        //! \brief The geometry \a shader_stage for the cascade copy pass.
+        gfx_handle<const gfx_shader_stage> m_shadow_copy_geometry;
+        //! \brief The fragment \a shader_stage for the cascade copy pass.
+        gfx_handle<const gfx_shader_stage> m_shadow_copy_fragment;
+
         //! \brief The \a graphics_pipeline_create_info to use as a base for \a gfx_pipelines for shadow map rendering.
         graphics_pipeline_create_info m_shadow_pass_pipeline_create_info_base;
+        //! \brief The \a gfx_pipeline copying and clearing cascades of the cached static shadow map.
+        gfx_handle<const gfx_pipeline> m_shadow_copy_pipeline;
+        //! \brief The compute \a gfx_pipeline reducing the geometry depth to the visible depth range.
+        gfx_handle<const gfx_pipeline> m_depth_reduction_pipeline;
+
+        //! \brief The persistently mapped depth reduction buffer.
+        gfx_handle<const gfx_buffer> m_depth_reduction_buffer;
+        //! \brief The mapping of the depth reduction buffer.
+        depth_reduction_data* m_depth_reduction_mapping;
+        //! \brief The \a gfx_semaphore signaled when the last depth reduction finished.
+        gfx_handle<const gfx_semaphore> m_depth_reduction_semaphore;
+        //! \brief True if a depth reduction was issued and not read back yet, else false.
+        bool m_depth_reduction_pending;
+
+        //! \brief True if the cascades should be fitted to the visible depth range, else false.
+        bool m_sample_distribution;
+        //! \brief The visible view space depth range (x: min, y: max) read back from the last depth reduction.
+        vec2 m_depth_bounds;
+        //! \brief True if m_depth_bounds contains a valid range, else false.
+        bool m_depth_bounds_valid;
 
         //! \brief The offset for the projection.
         float m_shadow_map_offset = 0.0f; // TODO Paul: This can probably be done better.
@@ -159,6 +273,30 @@ namespace mango
             float lambda;                                         //!< Lambda used to calculate split depths uniform <-> log.
             bounding_frustum frusta[max_shadow_mapping_cascades]; //!< List of current frusta.
         } m_cascade_data;                                         //!< Data required to calculate shadow cascades.
+
+        //! \brief Cache state of a single cascade.
+        struct cascade_cache
+        {
+            mat4 view_projection;     //!< The view projection the static shadows got rendered with.
+            bool static_valid;        //!< True if the static shadows are valid for view_projection, else false.
+            bool valid;               //!< True if the cascade in the shadow map is valid for view_projection, else false.
+            bool had_dynamic_casters; //!< True if the cascade in the shadow map contains dynamic casters, else false.
+        };
+        //! \brief The cache state of all cascades.
+        cascade_cache m_cascade_cache[max_shadow_mapping_cascades];
+
+        //! \brief State of a tracked shadow caster.
+        struct caster_state
+        {
+            mat4 transformation;    //!< The last world transformation of the caster.
+            int32 unchanged_frames; //!< The number of frames the transformation did not change.
+            int64 last_frame;       //!< The frame the caster got tracked the last time.
+            bool is_static;         //!< True if the caster is static, else false.
+        };
+        //! \brief The tracked shadow casters, mapping \a sids of \a scene_nodes to \a caster_states.
+        std::unordered_map<sid, caster_state, sid_hash> m_casters;
+        //! \brief The current caster tracking frame.
+        int64 m_caster_frame;
     };
 } // namespace mango
 
@@ -7,6 +7,7 @@
 #include <mango/log.hpp>
 #include <mango/profile.hpp>
 #include <resources/resources_impl.hpp>
+#include <sstream>
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -18,173 +19,405 @@
 
 using namespace mango;
 
-resources_impl::resources_impl()
-    : m_allocator(1073741824) // 1 GiB TODO Paul: Size???
+const int64 resources_impl::default_tlsf_memory_limit;
+const int64 resources_impl::default_free_list_memory_limit;
+
+string resource_key::normalize_path(const char* path)
 {
-    m_allocator.init();
+    string separated(path);
+    std::replace(separated.begin(), separated.end(), '\\', '/');
+
+    bool absolute = !separated.empty() && separated[0] == '/';
+    std::vector<string> elements;
+    size_t start = 0;
+    while (start <= separated.size())
+    {
+        size_t end = separated.find('/', start);
+        if (end == string::npos)
+            end = separated.size();
+        string element = separated.substr(start, end - start);
+        start          = end + 1;
+
+        if (element.empty() || element == ".")
+            continue;
+        if (element == "..")
+        {
+            // Leading '..' of relative paths are kept, the root has no parent.
+            if (!elements.empty() && elements.back() != "..")
+                elements.pop_back();
+            else if (!absolute)
+                elements.push_back(element);
+            continue;
+        }
+        elements.push_back(element);
+    }
+
+    string normalized = absolute ? "/" : "";
+    for (size_t i = 0; i < elements.size(); ++i)
+    {
+        if (i > 0)
+            normalized += "/";
+        normalized += elements[i];
+    }
+    return normalized.empty() ? "." : normalized;
+}
+
+//! \brief Returns the default memory limit for an \a allocator_strategy.
+//! \param[in] strategy The \a allocator_strategy.
+//! \return The default memory limit in bytes.
+static int64 default_memory_limit(allocator_strategy strategy)
+{
+    return strategy == allocator_strategy::two_level_segregated_fit ? resources_impl::default_tlsf_memory_limit : resources_impl::default_free_list_memory_limit;
+}
+
+resources_impl::resources_impl(allocator_strategy strategy, int64 memory_limit)
+    : m_allocator(mango::make_unique<thread_safe_allocator>(strategy, memory_limit > 0 ? memory_limit : default_memory_limit(strategy)))
+    , m_next_id(1)
+    , m_memory_budget(default_memory_budget)
+    , m_cached_size(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+    , m_evicted_size(0)
+{
+    m_allocator->init();
 }
 
 resources_impl::~resources_impl()
 {
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
     for (auto it = m_resource_cache.begin(); it != m_resource_cache.end();)
     {
+        free_resource(it->second.resource, it->second.type);
         it = m_resource_cache.erase(it);
     }
-    m_allocator.reset();
+    m_resource_ids.clear();
+    m_lru.clear();
+    m_allocator->reset();
 }
 
 void resources_impl::update(float)
 {
-    // release unused resources (ref count == 0).
-    for (auto it = m_resource_cache.begin(); it != m_resource_cache.end();)
-    {
-        auto res = static_cast<resource_base*>(it->second);
-        if (!res->reference_count)
-        {
-            it = m_resource_cache.erase(it);
-        }
-        else
-            it++;
-    }
-
     // TODO Paul: Update resources on demand?
 }
 
 const image_resource* resources_impl::acquire(const image_resource_description& description)
 {
     PROFILE_ZONE;
-    resource_id res_id = resource_hash::get_id(description);
-    auto cached        = m_resource_cache.find(res_id);
-    if (cached == m_resource_cache.end())
-    {
-        image_resource* img = load_image_from_file(description);
-        if (!img)
-            return nullptr;
-        m_resource_cache.insert({ res_id, img });
-        img->reference_count = 1;
-        return img;
-    }
-    else
+    return acquire_resource(description, resource_type::image, &resources_impl::load_image_from_file);
+}
+
+void resources_impl::release(const image_resource* resource)
+{
+    PROFILE_ZONE;
+    if (!resource)
+        return;
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    release_resource(resource->id);
+}
+
+const model_resource* resources_impl::acquire(const model_resource_description& description)
+{
+    PROFILE_ZONE;
+    return acquire_resource(description, resource_type::model, &resources_impl::load_model_from_file);
+}
+
+void resources_impl::release(const model_resource* resource)
+{
+    PROFILE_ZONE;
+    if (!resource)
+        return;
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    release_resource(resource->id);
+}
+
+const shader_resource* resources_impl::acquire(const shader_resource_resource_description& description)
+{
+    PROFILE_ZONE;
+    return acquire_resource(description, resource_type::shader, &resources_impl::load_shader_from_file);
+}
+
+void resources_impl::release(const shader_resource* resource)
+{
+    PROFILE_ZONE;
+    if (!resource)
+        return;
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    release_resource(resource->id);
+}
+
+std::vector<const shader_resource*> resources_impl::acquire_variants(const char* path, const std::vector<std::vector<shader_define>>& variants)
+{
+    PROFILE_ZONE;
+    std::vector<const shader_resource*> resources;
+    resources.reserve(variants.size());
+
+    shader_resource_resource_description description;
+    description.path = path;
+    for (const std::vector<shader_define>& defines : variants)
     {
-        image_resource* img = static_cast<image_resource*>(cached->second);
-        img->reference_count++;
-        return img;
+        description.defines = defines;
+        resources.push_back(acquire(description));
     }
+
+    return resources;
 }
 
-void resources_impl::release(const image_resource* resource)
+void resources_impl::prefetch(const image_resource_description& description)
 {
     PROFILE_ZONE;
-    auto cached = std::find_if(std::begin(m_resource_cache), std::end(m_resource_cache), [&resource](std::pair<resource_id, void*>&& r) { return r.second == (void*)resource; });
+    release(acquire(description));
+}
+
+void resources_impl::prefetch(const model_resource_description& description)
+{
+    PROFILE_ZONE;
+    release(acquire(description));
+}
+
+void resources_impl::prefetch(const shader_resource_resource_description& description)
+{
+    PROFILE_ZONE;
+    release(acquire(description));
+}
+
+void resources_impl::pin(const resource_base* resource)
+{
+    if (!resource)
+        return;
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    auto cached = m_resource_cache.find(resource->id);
     if (cached == m_resource_cache.end())
+        return;
+
+    cache_entry& entry = cached->second;
+    entry.pin_count++;
+    if (entry.in_lru)
     {
+        m_lru.erase(entry.lru_entry);
+        entry.in_lru = false;
+    }
+}
+
+void resources_impl::unpin(const resource_base* resource)
+{
+    if (!resource)
+        return;
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    auto cached = m_resource_cache.find(resource->id);
+    if (cached == m_resource_cache.end() || cached->second.pin_count <= 0)
         return;
+
+    cache_entry& entry = cached->second;
+    entry.pin_count--;
+    if (entry.pin_count == 0 && entry.resource->reference_count == 0)
+    {
+        retain(entry);
+        evict_to_budget();
     }
-    else
+}
+
+void resources_impl::set_memory_budget(int64 budget)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    m_memory_budget = std::max(budget, static_cast<int64>(0));
+    evict_to_budget();
+}
+
+resource_cache_statistics resources_impl::get_cache_statistics()
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    resource_cache_statistics stats;
+    stats.memory_budget  = m_memory_budget;
+    stats.cached_size    = m_cached_size;
+    stats.retained_size  = 0;
+    stats.cached_count   = static_cast<int32>(m_resource_cache.size());
+    stats.retained_count = 0;
+    stats.pinned_count   = 0;
+    stats.hits           = m_hits;
+    stats.misses         = m_misses;
+    stats.evictions      = m_evictions;
+    stats.evicted_size   = m_evicted_size;
+
+    for (auto& cached : m_resource_cache)
     {
-        image_resource* img = static_cast<image_resource*>(cached->second);
-        img->reference_count--;
-        if (img->reference_count <= 0)
+        if (cached.second.resource->reference_count == 0)
         {
-            m_allocator.free_memory(static_cast<void*>(img->data));
-            m_allocator.free_memory(static_cast<void*>(img));
-            img->reference_count = 0;
-            m_resource_cache.erase(cached);
+            stats.retained_size += cached.second.size;
+            stats.retained_count++;
         }
+        if (cached.second.pin_count > 0)
+            stats.pinned_count++;
     }
+
+    return stats;
 }
 
-const model_resource* resources_impl::acquire(const model_resource_description& description)
+template <typename R, typename D>
+R* resources_impl::acquire_resource(const D& description, resource_type type, R* (resources_impl::*load)(const D&))
 {
-    PROFILE_ZONE;
-    resource_id res_id = resource_hash::get_id(description);
-    auto cached        = m_resource_cache.find(res_id);
-    if (cached == m_resource_cache.end())
+    string key = resource_key::get(description);
     {
-        model_resource* m = load_model_from_file(description);
-        if (!m)
-            return nullptr;
-        m_resource_cache.insert({ res_id, m });
-        m->reference_count = 1;
-        return m;
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        auto cached = m_resource_ids.find(key);
+        if (cached != m_resource_ids.end())
+        {
+            cache_entry& entry = m_resource_cache.at(cached->second);
+            if (entry.in_lru)
+            {
+                m_lru.erase(entry.lru_entry);
+                entry.in_lru = false;
+            }
+            entry.resource->reference_count++;
+            m_hits++;
+            return static_cast<R*>(entry.resource);
+        }
     }
-    else
+
+    // Loading is done without holding the lock, so that different resources can be loaded in parallel.
+    R* res = (this->*load)(description);
+    if (!res)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    auto inserted = m_resource_ids.insert({ key, m_next_id });
+    if (!inserted.second)
     {
-        model_resource* m = static_cast<model_resource*>(cached->second);
-        m->reference_count++;
-        return m;
+        // Another thread loaded the same resource in the meantime.
+        free_resource(res, type);
+        cache_entry& entry = m_resource_cache.at(inserted.first->second);
+        if (entry.in_lru)
+        {
+            m_lru.erase(entry.lru_entry);
+            entry.in_lru = false;
+        }
+        entry.resource->reference_count++;
+        m_hits++;
+        return static_cast<R*>(entry.resource);
     }
+
+    res->id              = m_next_id++;
+    res->reference_count = 1;
+
+    cache_entry entry;
+    entry.resource  = res;
+    entry.type      = type;
+    entry.key       = key;
+    entry.size      = resource_size(res, type);
+    entry.pin_count = 0;
+    entry.in_lru    = false;
+    m_resource_cache.insert({ res->id, entry });
+
+    m_cached_size += entry.size;
+    m_misses++;
+    evict_to_budget();
+
+    return res;
 }
 
-void resources_impl::release(const model_resource* resource)
+void resources_impl::release_resource(resource_id id)
 {
-    PROFILE_ZONE;
-    auto cached = std::find_if(std::begin(m_resource_cache), std::end(m_resource_cache), [&resource](std::pair<resource_id, void*>&& r) { return r.second == (void*)resource; });
+    auto cached = m_resource_cache.find(id);
     if (cached == m_resource_cache.end())
-    {
         return;
+
+    cache_entry& entry = cached->second;
+    if (entry.resource->reference_count <= 0)
+        return;
+
+    entry.resource->reference_count--;
+    if (entry.resource->reference_count == 0 && entry.pin_count == 0)
+    {
+        retain(entry);
+        evict_to_budget();
     }
-    else
+}
+
+void resources_impl::retain(cache_entry& entry)
+{
+    MANGO_ASSERT(!entry.in_lru, "Resource is already retained!");
+    entry.lru_entry = m_lru.insert(m_lru.end(), entry.resource->id);
+    entry.in_lru    = true;
+}
+
+void resources_impl::evict_to_budget()
+{
+    while (m_cached_size > m_memory_budget && !m_lru.empty())
     {
-        model_resource* m = static_cast<model_resource*>(cached->second);
-        m->reference_count--;
-        if (m->reference_count <= 0)
-        {
-            m_allocator.free_memory(static_cast<void*>(m));
-            m->reference_count = 0;
-            m_resource_cache.erase(cached);
-        }
+        auto cached = m_resource_cache.find(m_lru.front());
+        m_lru.pop_front();
+        MANGO_ASSERT(cached != m_resource_cache.end(), "Least recently used list is corrupted!");
+
+        cache_entry& entry = cached->second;
+        m_cached_size -= entry.size;
+        m_evictions++;
+        m_evicted_size += entry.size;
+
+        m_resource_ids.erase(entry.key);
+        free_resource(entry.resource, entry.type);
+        m_resource_cache.erase(cached);
     }
 }
 
-const shader_resource* resources_impl::acquire(const shader_resource_resource_description& description)
+int64 resources_impl::resource_size(resource_base* resource, resource_type type)
 {
-    PROFILE_ZONE;
-    resource_id res_id = resource_hash::get_id(description);
-    auto cached        = m_resource_cache.find(res_id);
-    if (cached == m_resource_cache.end())
+    switch (type)
     {
-        shader_resource* s = load_shader_from_file(description);
-        if (!s)
-            return nullptr;
-        m_resource_cache.insert({ res_id, s });
-        s->reference_count = 1;
-        return s;
+    case resource_type::image:
+    {
+        image_resource* img = static_cast<image_resource*>(resource);
+        int64 texel_size    = img->description.is_hdr ? sizeof(float) : img->bits / 8;
+        return sizeof(image_resource) + static_cast<int64>(img->width) * img->height * img->number_components * texel_size;
     }
-    else
+    case resource_type::model:
     {
-        shader_resource* s = static_cast<shader_resource*>(cached->second);
-        s->reference_count++;
-        return s;
+        model_resource* m = static_cast<model_resource*>(resource);
+        int64 size        = sizeof(model_resource);
+        for (const tinygltf::Buffer& buffer : m->gltf_model.buffers)
+            size += static_cast<int64>(buffer.data.size());
+        for (const tinygltf::Image& image : m->gltf_model.images)
+            size += static_cast<int64>(image.image.size());
+        return size;
+    }
+    case resource_type::shader:
+        return sizeof(shader_resource) + static_cast<int64>(static_cast<shader_resource*>(resource)->source.size());
+    default:
+        MANGO_ASSERT(false, "Unknown resource type!");
+        return 0;
     }
 }
 
-void resources_impl::release(const shader_resource* resource)
+void resources_impl::free_resource(resource_base* resource, resource_type type)
 {
-    PROFILE_ZONE;
-    auto cached = std::find_if(std::begin(m_resource_cache), std::end(m_resource_cache), [&resource](std::pair<resource_id, void*>&& r) { return r.second == (void*)resource; });
-    if (cached == m_resource_cache.end())
+    switch (type)
     {
-        return;
-    }
-    else
+    case resource_type::image:
     {
-        shader_resource* s = static_cast<shader_resource*>(cached->second);
-        s->reference_count--;
-        if (s->reference_count <= 0)
-        {
-            m_allocator.free_memory(static_cast<void*>(s));
-            s->reference_count = 0;
-            m_resource_cache.erase(cached);
-        }
+        image_resource* img = static_cast<image_resource*>(resource);
+        m_allocator->free_memory(img->data);
+        img->~image_resource();
+        break;
+    }
+    case resource_type::model:
+        static_cast<model_resource*>(resource)->~model_resource();
+        break;
+    case resource_type::shader:
+        static_cast<shader_resource*>(resource)->~shader_resource();
+        break;
+    default:
+        MANGO_ASSERT(false, "Unknown resource type!");
+        return;
     }
+    m_allocator->free_memory(static_cast<void*>(resource));
 }
 
 image_resource* resources_impl::load_image_from_file(const image_resource_description& description)
 {
     PROFILE_ZONE;
 
-    image_resource* img = static_cast<image_resource*>(m_allocator.allocate(sizeof(image_resource)));
+    void* mem           = m_allocator->allocate(sizeof(image_resource));
+    image_resource* img = new (mem) image_resource;
+    img->data           = nullptr;
 
     int width = 0, height = 0, components = 0;
     int64 img_len = sizeof(uint8);
@@ -208,11 +441,12 @@ image_resource* resources_impl::load_image_from_file(const image_resource_descri
         if (!data)
         {
             MANGO_LOG_ERROR("Could not load image from path '{0}! Image resource not valid!", description.path);
+            free_resource(img, resource_type::image);
             return nullptr;
         }
 
         img_len *= width * height * components;
-        img->data = m_allocator.allocate(img_len);
+        img->data = m_allocator->allocate(img_len);
         std::copy(data, data + img_len, static_cast<uint8*>(img->data));
         stbi_image_free(data);
     }
@@ -223,12 +457,13 @@ image_resource* resources_impl::load_image_from_file(const image_resource_descri
         if (!data)
         {
             MANGO_LOG_ERROR("Could not load image from path '{0}! Image resource not valid!", description.path);
+            free_resource(img, resource_type::image);
             return nullptr;
         }
 
         img_len   = width * height * components;
         img->bits = stbi_is_16_bit(description.path) ? 16 : 32;
-        img->data = m_allocator.allocate(img_len);
+        img->data = m_allocator->allocate(img_len * sizeof(float));
         std::copy(data, data + img_len, static_cast<float*>(img->data));
         stbi_image_free(data);
     }
@@ -245,7 +480,7 @@ model_resource* resources_impl::load_model_from_file(const model_resource_descri
 {
     PROFILE_ZONE;
 
-    void* mem         = m_allocator.allocate(sizeof(model_resource));
+    void* mem         = m_allocator->allocate(sizeof(model_resource));
     model_resource* m = new (mem) model_resource;
 
     tinygltf::TinyGLTF loader;
@@ -266,12 +501,14 @@ model_resource* resources_impl::load_model_from_file(const model_resource_descri
     if (!err.empty())
     {
         MANGO_LOG_ERROR("Error on loading gltf file {0}:\n {1}", description.path, err);
+        free_resource(m, resource_type::model);
         return nullptr;
     }
 
     if (!ret)
     {
         MANGO_LOG_ERROR("Failed parsing gltf! Model is not valid!");
+        free_resource(m, resource_type::model);
         return nullptr;
     }
 
@@ -282,7 +519,7 @@ shader_resource* resources_impl::load_shader_from_file(const shader_resource_res
 {
     PROFILE_ZONE;
 
-    void* mem          = m_allocator.allocate(sizeof(shader_resource));
+    void* mem          = m_allocator->allocate(sizeof(shader_resource));
     shader_resource* s = new (mem) shader_resource;
 
     s->description = description;
@@ -311,56 +548,88 @@ string resources_impl::load_shader_string_from_file(const string path, bool recu
 {
     string source_string = "";
 
+    shared_ptr<const string> content = get_shader_file(path);
+    if (!content)
+    {
+        MANGO_LOG_ERROR("Opening shader file failed: {0} !", path);
+        return source_string;
+    }
+
     // incl. recursive includes
     string include_id = "#include <";
-    std::ifstream input_stream;
-    input_stream.open(path, std::ios::in | std::ios::binary);
+    std::istringstream input_stream(*content);
 
     // retrieving the current folder path, because include is relative.
     auto path_end      = path.find_last_of("/\\");
     string folder_path = path.substr(0, path_end + 1);
 
-    if (input_stream.is_open())
+    string line;
+    int32 line_nr = 1;
+    while (getline(input_stream, line))
     {
-        string line;
-        int32 line_nr = 1;
-        while (getline(input_stream, line))
+        auto offset = line.find(include_id);
+        if (offset != string::npos)
         {
-            auto offset = line.find(include_id);
-            if (offset != string::npos)
+            auto include_end = line.find_first_of(">");
+            if (include_end == string::npos)
             {
-                auto include_end = line.find_first_of(">");
-                if (include_end == string::npos)
-                {
-                    MANGO_LOG_ERROR("Including shader file failed: {0} !", line);
-                    return source_string;
-                }
-
-                string new_path = folder_path + line.substr(offset + include_id.size(), include_end - (offset + include_id.size()));
-
-                // TODO Paul: Line count for included shaders is okay, but in error messages the compiled shader is shown and not the included one.
-                // reset line count
-                source_string += "#line 0\n";
-                source_string += load_shader_string_from_file(new_path, true);
-                // reset line count
-                source_string += "#line " + std::to_string(++line_nr) + "\n";
-
-                continue;
+                MANGO_LOG_ERROR("Including shader file failed: {0} !", line);
+                return source_string;
             }
 
-            source_string += line + "\n";
-            line_nr++;
-        }
+            string new_path = folder_path + line.substr(offset + include_id.size(), include_end - (offset + include_id.size()));
 
-        if (!recursive)
-            source_string += "\0";
+            // TODO Paul: Line count for included shaders is okay, but in error messages the compiled shader is shown and not the included one.
+            // reset line count
+            source_string += "#line 0\n";
+            source_string += load_shader_string_from_file(new_path, true);
+            // reset line count
+            source_string += "#line " + std::to_string(++line_nr) + "\n";
 
-        input_stream.close();
-        return source_string;
+            continue;
+        }
+
+        source_string += line + "\n";
+        line_nr++;
     }
-    else
+
+    if (!recursive)
+        source_string += "\0";
+
+    return source_string;
+}
+
+shared_ptr<const string> resources_impl::get_shader_file(const string& path)
+{
+    int64 modification_time = 0;
+    int64 size              = 0;
+    if (!get_file_status(path, modification_time, size))
+        return nullptr;
+
+    string key = resource_key::normalize_path(path.c_str());
     {
-        MANGO_LOG_ERROR("Opening shader file failed: {0} !", path);
-        return source_string;
+        std::lock_guard<std::mutex> lock(m_shader_file_mutex);
+        auto cached = m_shader_file_cache.find(key);
+        if (cached != m_shader_file_cache.end() && cached->second.modification_time == modification_time && cached->second.size == size)
+            return cached->second.content;
     }
+
+    // Read outside of the lock, so that other threads can still use the cache.
+    std::ifstream input_stream(path, std::ios::in | std::ios::binary);
+    if (!input_stream.is_open())
+        return nullptr;
+
+    std::stringstream buffer;
+    buffer << input_stream.rdbuf();
+    input_stream.close();
+
+    shared_ptr<const string> content = std::make_shared<const string>(buffer.str());
+
+    std::lock_guard<std::mutex> lock(m_shader_file_mutex);
+    shader_file_entry& entry = m_shader_file_cache[key];
+    entry.content            = content;
+    entry.modification_time  = modification_time;
+    entry.size               = size;
+
+    return content;
 }
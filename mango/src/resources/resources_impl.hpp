@@ -8,37 +8,87 @@
 #define MANGO_RESOURCES_IMPL_HPP
 
 #include <core/context_impl.hpp>
+#include <list>
 #include <mango/resources.hpp>
-#include <memory/free_list_allocator.hpp>
-#include <util/hashing.hpp>
+#include <memory/thread_safe_allocator.hpp>
 #include <util/helpers.hpp>
 
 namespace mango
 {
     //! \brief Id used for resources.
     using resource_id = uint64;
-    //! \brief Hash for \a resource_description.
-    struct resource_hash
+
+    //! \brief The types of resources in the cache.
+    enum class resource_type : uint8
+    {
+        image,
+        model,
+        shader
+    };
+
+    //! \brief Key for \a resource_descriptions.
+    //! \details The key consists of the full normalized path and all parameters changing the loaded resource.
+    struct resource_key
     {
       public:
-        //! \brief Returns a \a resource_id for a given \a resource_description.
-        //! \param[in] description The \a resource_description.
-        static inline resource_id get_id(const resource_description& description)
+        //! \brief Returns the key for a given \a image_resource_description.
+        //! \param[in] description The \a image_resource_description.
+        //! \return The key string.
+        static inline string get(const image_resource_description& description)
+        {
+            return "image:" + normalize_path(description.path) + (description.is_standard_color_space ? "|srgb" : "") + (description.is_hdr ? "|hdr" : "");
+        }
+
+        //! \brief Returns the key for a given \a model_resource_description.
+        //! \param[in] description The \a model_resource_description.
+        //! \return The key string.
+        static inline string get(const model_resource_description& description)
         {
-            auto start = string(description.path).find_last_of("\\/") + 1;
-            auto name  = string(description.path).substr(start, string(description.path).find_last_of(".") - start);
-            return djb2_string_hash::hash(name.c_str());
+            return "model:" + normalize_path(description.path);
         }
+
+        //! \brief Returns the key for a given \a shader_resource_resource_description.
+        //! \param[in] description The \a shader_resource_resource_description.
+        //! \return The key string.
+        static inline string get(const shader_resource_resource_description& description)
+        {
+            // Defines are sorted, so that the same define set always maps to the same variant.
+            std::vector<std::pair<string, string>> defines;
+            defines.reserve(description.defines.size());
+            for (const shader_define& def : description.defines)
+                defines.emplace_back(def.name, def.value);
+            std::sort(defines.begin(), defines.end());
+
+            string key = "shader:" + normalize_path(description.path);
+            for (const auto& def : defines)
+            {
+                key += "|";
+                key += def.first;
+                key += "=";
+                key += def.second;
+            }
+            return key;
+        }
+
+        //! \brief Normalizes a path lexically.
+        //! \details Separators are replaced by '/', '.' and empty elements are removed and '..' removes the preceding element.
+        //! The file system is not accessed, so symbolic links are not resolved.
+        //! \param[in] path The path to normalize.
+        //! \return The normalized path.
+        static string normalize_path(const char* path);
     };
 
     //! \brief The \a resources of mango.
-    //! \details Responsible for loading and releasing resources.
+    //! \details Responsible for loading and releasing resources. Resources can be acquired and released from multiple threads.
     class resources_impl : public resources
     {
         MANGO_DISABLE_COPY_AND_ASSIGNMENT(resources_impl)
       public:
         //! \brief Constructs the \a resources_impl.
-        resources_impl();
+        //! \param[in] strategy The \a allocator_strategy used to store the resources.
+        //! \param[in] memory_limit The maximum size in bytes the resources can occupy. The \a tlsf_allocator only reserves it and commits memory when needed, the \a free_list_allocator allocates all of it upfront.
+        //! Zero selects the default limit of the strategy.
+        resources_impl(allocator_strategy strategy = allocator_strategy::two_level_segregated_fit, int64 memory_limit = 0);
         ~resources_impl();
 
         const image_resource* acquire(const image_resource_description& description) override;
@@ -47,14 +97,29 @@ namespace mango
         void release(const model_resource* resource) override;
         const shader_resource* acquire(const shader_resource_resource_description& description) override;
         void release(const shader_resource* resource) override;
+        std::vector<const shader_resource*> acquire_variants(const char* path, const std::vector<std::vector<shader_define>>& variants) override;
+        void prefetch(const image_resource_description& description) override;
+        void prefetch(const model_resource_description& description) override;
+        void prefetch(const shader_resource_resource_description& description) override;
+        void pin(const resource_base* resource) override;
+        void unpin(const resource_base* resource) override;
+        void set_memory_budget(int64 budget) override;
+        resource_cache_statistics get_cache_statistics() override;
 
         //! \brief Updates the \a resources_impl.
         //! \param[in] dt Past time since last call.
         void update(float dt);
 
+        //! \brief The default hard limit for the memory used by resources with the \a tlsf_allocator. Only reserved address space.
+        static const int64 default_tlsf_memory_limit = 17179869184; // 16 GiB
+        //! \brief The default hard limit for the memory used by resources with the \a free_list_allocator. Allocated upfront.
+        static const int64 default_free_list_memory_limit = 1073741824; // 1 GiB
+        //! \brief The default memory budget of the resource cache.
+        static const int64 default_memory_budget = 536870912; // 512 MiB
+
       private:
-        //! \brief The allocator used to store the resources.
-        free_list_allocator m_allocator;
+        //! \brief The thread safe allocator used to store the resources.
+        unique_ptr<allocator> m_allocator;
 
         //! \brief Loads \a image_resource from file.
         //! \param[in] description The \a image_resource_description used for loading the \a image_resource.
@@ -75,8 +140,92 @@ namespace mango
         //! \return The shader source string with all includes and defines.
         string load_shader_string_from_file(const string path, bool recursive);
 
-        //! \brief Cache for resources, mapping \a resource_ids to resource pointers.
-        std::unordered_map<resource_id, void*> m_resource_cache;
+        //! \brief Returns the content of a shader source file.
+        //! \details The content is read once and cached with the modification time and size of the file. Changed files are read again.
+        //! \param[in] path The path of the shader source file.
+        //! \return The content of the file or nullptr if the file can not be opened.
+        shared_ptr<const string> get_shader_file(const string& path);
+
+        //! \brief Cached content of a shader source file.
+        struct shader_file_entry
+        {
+            shared_ptr<const string> content; //!< The content of the file.
+            int64 modification_time;          //!< The modification time of the file in nanoseconds when it got read.
+            int64 size;                       //!< The size of the file in bytes when it got read.
+        };
+
+        //! \brief Cache for shader source files and includes, mapping normalized paths to \a shader_file_entries.
+        std::unordered_map<string, shader_file_entry> m_shader_file_cache;
+        //! \brief Mutex protecting the shader file cache.
+        std::mutex m_shader_file_mutex;
+
+        //! \brief Acquires a resource from the cache or loads it.
+        //! \param[in] description The description of the resource.
+        //! \param[in] type The \a resource_type of the resource.
+        //! \param[in] load The function loading the resource from file.
+        //! \return A pointer to the resource or nullptr on failure.
+        template <typename R, typename D>
+        R* acquire_resource(const D& description, resource_type type, R* (resources_impl::*load)(const D&));
+
+        //! \brief Decrements the reference count of a resource and retains it in the least recently used list if it is not referenced anymore.
+        //! \details The cache mutex has to be locked.
+        //! \param[in] id The \a resource_id of the resource.
+        void release_resource(resource_id id);
+
+        //! \brief Entry in the resource cache.
+        struct cache_entry
+        {
+            resource_base* resource;                    //!< Pointer to the resource.
+            resource_type type;                         //!< The \a resource_type of the resource.
+            string key;                                 //!< The \a resource_key of the resource.
+            int64 size;                                 //!< The size of the resource in bytes.
+            int32 pin_count;                            //!< The number of times the resource got pinned.
+            bool in_lru;                                //!< True if the resource is in the least recently used list, else false.
+            std::list<resource_id>::iterator lru_entry; //!< The position in the least recently used list. Only valid if in_lru is true.
+        };
+
+        //! \brief Inserts an unreferenced and unpinned resource into the least recently used list.
+        //! \details The cache mutex has to be locked.
+        //! \param[in] entry The \a cache_entry of the resource.
+        void retain(cache_entry& entry);
+
+        //! \brief Evicts least recently used resources until the cached size fits into the memory budget.
+        //! \details The cache mutex has to be locked.
+        void evict_to_budget();
+
+        //! \brief Calculates the size of a resource.
+        //! \param[in] resource Pointer to the resource.
+        //! \param[in] type The \a resource_type of the resource.
+        //! \return The size of the resource in bytes.
+        int64 resource_size(resource_base* resource, resource_type type);
+
+        //! \brief Frees the memory of a resource.
+        //! \param[in] resource Pointer to the resource.
+        //! \param[in] type The \a resource_type of the resource.
+        void free_resource(resource_base* resource, resource_type type);
+
+        //! \brief Cache for resources, mapping \a resource_ids to \a cache_entries.
+        std::unordered_map<resource_id, cache_entry> m_resource_cache;
+        //! \brief Mapping \a resource_keys to \a resource_ids.
+        std::unordered_map<string, resource_id> m_resource_ids;
+        //! \brief The \a resource_id for the next loaded resource.
+        resource_id m_next_id;
+        //! \brief Unreferenced resources, least recently used first.
+        std::list<resource_id> m_lru;
+        //! \brief The memory budget of the cache in bytes.
+        int64 m_memory_budget;
+        //! \brief The size of all cached resources in bytes.
+        int64 m_cached_size;
+        //! \brief The number of acquisitions served from the cache.
+        int64 m_hits;
+        //! \brief The number of acquisitions that had to load from file.
+        int64 m_misses;
+        //! \brief The number of evicted resources.
+        int64 m_evictions;
+        //! \brief The size of all evicted resources in bytes.
+        int64 m_evicted_size;
+        //! \brief Mutex protecting the resource cache and the reference counts.
+        std::mutex m_cache_mutex;
     };
 } // namespace mango
 
@@ -14,6 +14,7 @@
 #include <glm/gtx/quaternion.hpp>
 #include <mango/profile.hpp>
 #include <mango/resources.hpp>
+#include <rendering/renderer_impl.hpp>
 #include <scene/scene_impl.hpp>
 #include <ui/dear_imgui/icons_font_awesome_5.hpp>
 #include <ui/dear_imgui/imgui_glfw.hpp>
@@ -23,6 +24,10 @@ using namespace mango;
 static int32 get_attrib_component_count_from_tinygltf_types(int32 type);
 static gfx_sampler_filter get_texture_filter_from_tinygltf(int32 filter);
 static gfx_sampler_edge_wrap get_texture_wrap_from_tinygltf(int32 wrap);
+static shared_ptr<const occluder_geometry> create_occluder_geometry_from_tinygltf(const tinygltf::Model& m, const tinygltf::Primitive& primitive);
+
+//! \brief Primitives with more triangles are not used as occluders.
+static const int32 max_occluder_triangles = 8192;
 
 scene_impl::scene_impl(const string& name, const shared_ptr<context_impl>& context)
     : m_shared_context(context)
@@ -212,6 +217,56 @@ sid scene_impl::add_atmospheric_light(atmospheric_light& new_atmospheric_light,
     return containing_node_id;
 }
 
+sid scene_impl::add_point_light(point_light& new_point_light, sid containing_node_id)
+{
+    PROFILE_ZONE;
+    packed_freelist_id node = containing_node_id.id();
+
+    if (!m_scene_nodes.contains(node))
+    {
+        MANGO_LOG_WARN("Containing node with ID {0} does not exist! Can not add point light!", containing_node_id.id().get());
+        return invalid_sid;
+    }
+
+    sid light_id                                  = sid::create(m_scene_lights.emplace(), scene_structure_type::scene_structure_point_light);
+    scene_light& l                                = m_scene_lights.back();
+    l.public_data_as_point_light                  = new_point_light;
+    l.public_data_as_point_light->instance_id     = light_id;
+    l.public_data_as_point_light->containing_node = containing_node_id;
+    l.type                                        = light_type::point;
+
+    scene_node& nd                                      = m_scene_nodes.at(node);
+    nd.light_ids[static_cast<uint8>(light_type::point)] = light_id;
+    nd.type |= node_type::light;
+
+    return containing_node_id;
+}
+
+sid scene_impl::add_spot_light(spot_light& new_spot_light, sid containing_node_id)
+{
+    PROFILE_ZONE;
+    packed_freelist_id node = containing_node_id.id();
+
+    if (!m_scene_nodes.contains(node))
+    {
+        MANGO_LOG_WARN("Containing node with ID {0} does not exist! Can not add spot light!", containing_node_id.id().get());
+        return invalid_sid;
+    }
+
+    sid light_id                                 = sid::create(m_scene_lights.emplace(), scene_structure_type::scene_structure_spot_light);
+    scene_light& l                               = m_scene_lights.back();
+    l.public_data_as_spot_light                  = new_spot_light;
+    l.public_data_as_spot_light->instance_id     = light_id;
+    l.public_data_as_spot_light->containing_node = containing_node_id;
+    l.type                                       = light_type::spot;
+
+    scene_node& nd                                     = m_scene_nodes.at(node);
+    nd.light_ids[static_cast<uint8>(light_type::spot)] = light_id;
+    nd.type |= node_type::light;
+
+    return containing_node_id;
+}
+
 sid scene_impl::build_material(material& new_material)
 {
     PROFILE_ZONE;
@@ -688,6 +743,92 @@ void scene_impl::remove_atmospheric_light(sid node_id)
     m_scene_lights.erase(light);
 }
 
+void scene_impl::remove_point_light(sid node_id)
+{
+    PROFILE_ZONE;
+    packed_freelist_id node_pf = node_id.id();
+
+    if (!m_scene_nodes.contains(node_pf))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not remove point light!", node_id.id().get());
+        return;
+    }
+
+    scene_node& node = m_scene_nodes.at(node_pf);
+
+    if ((node.type & node_type::light) == node_type::empty_leaf)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a light! Can not remove point light!", node_id.id().get());
+        return;
+    }
+
+    packed_freelist_id light = node.light_ids[static_cast<uint8>(light_type::point)].id();
+
+    if (!m_scene_lights.contains(light))
+    {
+        MANGO_LOG_WARN("Light with ID {0} does not exist! Can not remove point light!", light.get());
+        return;
+    }
+
+    scene_light& to_remove = m_scene_lights.at(light);
+
+    sid containing_node = to_remove.public_data_as_point_light->containing_node;
+
+    if (containing_node.is_valid())
+    {
+        packed_freelist_id cn = containing_node.id();
+        MANGO_ASSERT(m_scene_nodes.contains(cn), "Containing node does not exist!"); // TODO Is this assertion right?
+        scene_node& nd                                      = m_scene_nodes.at(cn);
+        nd.light_ids[static_cast<uint8>(light_type::point)] = invalid_sid;
+        nd.type &= ~node_type::light;
+    }
+
+    m_scene_lights.erase(light);
+}
+
+void scene_impl::remove_spot_light(sid node_id)
+{
+    PROFILE_ZONE;
+    packed_freelist_id node_pf = node_id.id();
+
+    if (!m_scene_nodes.contains(node_pf))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not remove spot light!", node_id.id().get());
+        return;
+    }
+
+    scene_node& node = m_scene_nodes.at(node_pf);
+
+    if ((node.type & node_type::light) == node_type::empty_leaf)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a light! Can not remove spot light!", node_id.id().get());
+        return;
+    }
+
+    packed_freelist_id light = node.light_ids[static_cast<uint8>(light_type::spot)].id();
+
+    if (!m_scene_lights.contains(light))
+    {
+        MANGO_LOG_WARN("Light with ID {0} does not exist! Can not remove spot light!", light.get());
+        return;
+    }
+
+    scene_light& to_remove = m_scene_lights.at(light);
+
+    sid containing_node = to_remove.public_data_as_spot_light->containing_node;
+
+    if (containing_node.is_valid())
+    {
+        packed_freelist_id cn = containing_node.id();
+        MANGO_ASSERT(m_scene_nodes.contains(cn), "Containing node does not exist!"); // TODO Is this assertion right?
+        scene_node& nd                                     = m_scene_nodes.at(cn);
+        nd.light_ids[static_cast<uint8>(light_type::spot)] = invalid_sid;
+        nd.type &= ~node_type::light;
+    }
+
+    m_scene_lights.erase(light);
+}
+
 optional<node&> scene_impl::get_node(sid node_id)
 {
     PROFILE_ZONE;
@@ -901,6 +1042,76 @@ optional<atmospheric_light&> scene_impl::get_atmospheric_light(sid node_id)
     return m_scene_lights.at(light).public_data_as_atmospheric_light.value();
 }
 
+optional<point_light&> scene_impl::get_point_light(sid node_id)
+{
+    PROFILE_ZONE;
+    packed_freelist_id node_pf = node_id.id();
+
+    if (!m_scene_nodes.contains(node_pf))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not retrieve point light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+
+    scene_node& node = m_scene_nodes.at(node_pf);
+
+    if ((node.type & node_type::light) == node_type::empty_leaf)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a light! Can not retrieve point light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+
+    packed_freelist_id light = node.light_ids[static_cast<uint8>(light_type::point)].id();
+
+    if (!m_scene_lights.contains(light))
+    {
+        MANGO_LOG_WARN("Light with ID {0} does not exist! Can not retrieve point light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+    if (m_scene_lights.at(light).type != light_type::point)
+    {
+        MANGO_LOG_WARN("Light with ID {0} is not a point light! Can not retrieve point light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+
+    return m_scene_lights.at(light).public_data_as_point_light.value();
+}
+
+optional<spot_light&> scene_impl::get_spot_light(sid node_id)
+{
+    PROFILE_ZONE;
+    packed_freelist_id node_pf = node_id.id();
+
+    if (!m_scene_nodes.contains(node_pf))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not retrieve spot light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+
+    scene_node& node = m_scene_nodes.at(node_pf);
+
+    if ((node.type & node_type::light) == node_type::empty_leaf)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a light! Can not retrieve spot light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+
+    packed_freelist_id light = node.light_ids[static_cast<uint8>(light_type::spot)].id();
+
+    if (!m_scene_lights.contains(light))
+    {
+        MANGO_LOG_WARN("Light with ID {0} does not exist! Can not retrieve spot light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+    if (m_scene_lights.at(light).type != light_type::spot)
+    {
+        MANGO_LOG_WARN("Light with ID {0} is not a spot light! Can not retrieve spot light!", node_id.id().get());
+        return NULL_OPTION;
+    }
+
+    return m_scene_lights.at(light).public_data_as_spot_light.value();
+}
+
 optional<model&> scene_impl::get_model(sid instance_id)
 {
     PROFILE_ZONE;
@@ -1842,7 +2053,13 @@ sid scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& mesh, const
         }
         sp.vertex_layout.binding_description_count   = description_index;
         sp.vertex_layout.attribute_description_count = description_index;
+        sp.occluder                                  = create_occluder_geometry_from_tinygltf(m, primitive);
         msh.scene_primitives.push_back(sp);
+
+        // Start compiling the pipelines early, so that they are ready when the primitive gets rendered.
+        auto& renderer = m_shared_context->get_internal_renderer();
+        if (renderer)
+            renderer->warm_up_pipelines(sp.vertex_layout, sp.input_assembly);
     }
 
     return mesh_id;
@@ -2506,6 +2723,18 @@ string scene_impl::get_display_name(sid object) // TODO Paul: Make that better!
         MANGO_ASSERT(l, "Can not get name of non existing light!");
         return string(ICON_FA_LIGHTBULB) + " " + "Atmospheric Light";
     }
+    case scene_structure_type::scene_structure_point_light:
+    {
+        optional<scene_light&> l = get_scene_light(object);
+        MANGO_ASSERT(l, "Can not get name of non existing light!");
+        return string(ICON_FA_LIGHTBULB) + " " + "Point Light";
+    }
+    case scene_structure_type::scene_structure_spot_light:
+    {
+        optional<scene_light&> l = get_scene_light(object);
+        MANGO_ASSERT(l, "Can not get name of non existing light!");
+        return string(ICON_FA_LIGHTBULB) + " " + "Spot Light";
+    }
     case scene_structure_type::scene_structure_perspective_camera:
     {
         optional<scene_camera&> cam = get_scene_camera(object);
@@ -2582,3 +2811,81 @@ static gfx_sampler_edge_wrap get_texture_wrap_from_tinygltf(int32 wrap)
         return gfx_sampler_edge_wrap::sampler_edge_wrap_unknown;
     }
 }
+
+static shared_ptr<const occluder_geometry> create_occluder_geometry_from_tinygltf(const tinygltf::Model& m, const tinygltf::Primitive& primitive)
+{
+    if (primitive.mode != TINYGLTF_MODE_TRIANGLES)
+        return nullptr;
+
+    auto position = primitive.attributes.find("POSITION");
+    if (position == primitive.attributes.end())
+        return nullptr;
+
+    const tinygltf::Accessor& accessor = m.accessors[position->second];
+    if (accessor.sparse.isSparse || accessor.bufferView < 0 || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_VEC3)
+        return nullptr;
+
+    int64 index_count = primitive.indices >= 0 ? static_cast<int64>(m.accessors[primitive.indices].count) : static_cast<int64>(accessor.count);
+    if (index_count < 3 || index_count / 3 > max_occluder_triangles)
+        return nullptr;
+
+    auto geometry = std::make_shared<occluder_geometry>();
+
+    const tinygltf::BufferView& view = m.bufferViews[accessor.bufferView];
+    const uint8* data                = m.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+    int32 stride                     = accessor.ByteStride(view);
+    if (stride <= 0)
+        return nullptr;
+
+    geometry->vertices.resize(accessor.count);
+    for (size_t i = 0; i < accessor.count; ++i)
+        std::memcpy(&geometry->vertices[i], data + i * stride, sizeof(vec3));
+
+    geometry->indices.resize(index_count);
+    if (primitive.indices < 0)
+    {
+        for (int64 i = 0; i < index_count; ++i)
+            geometry->indices[i] = static_cast<uint32>(i);
+        return geometry;
+    }
+
+    const tinygltf::Accessor& index_accessor = m.accessors[primitive.indices];
+    if (index_accessor.sparse.isSparse || index_accessor.bufferView < 0)
+        return nullptr;
+
+    const tinygltf::BufferView& index_view = m.bufferViews[index_accessor.bufferView];
+    const uint8* index_data                = m.buffers[index_view.buffer].data.data() + index_view.byteOffset + index_accessor.byteOffset;
+    int32 index_stride                     = index_accessor.ByteStride(index_view);
+    if (index_stride <= 0)
+        return nullptr;
+
+    for (int64 i = 0; i < index_count; ++i)
+    {
+        const uint8* element = index_data + i * index_stride;
+        uint32 index         = 0;
+        switch (index_accessor.componentType)
+        {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            index = *element;
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        {
+            uint16 index16;
+            std::memcpy(&index16, element, sizeof(uint16));
+            index = index16;
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            std::memcpy(&index, element, sizeof(uint32));
+            break;
+        default:
+            return nullptr;
+        }
+
+        if (index >= accessor.count)
+            return nullptr;
+        geometry->indices[i] = index;
+    }
+
+    return geometry;
+}
@@ -34,6 +34,8 @@ namespace mango
         sid add_directional_light(directional_light& new_directional_light, sid containing_node_id) override;
         sid add_skylight(skylight& new_skylight, sid containing_node_id) override;
         sid add_atmospheric_light(atmospheric_light& new_atmospheric_light, sid containing_node_id) override;
+        sid add_point_light(point_light& new_point_light, sid containing_node_id) override;
+        sid add_spot_light(spot_light& new_spot_light, sid containing_node_id) override;
 
         sid build_material(material& new_material) override;
         sid load_texture_from_image(const string& path, bool standard_color_space, bool high_dynamic_range) override;
@@ -50,6 +52,8 @@ namespace mango
         void remove_directional_light(sid node_id) override;
         void remove_skylight(sid node_id) override;
         void remove_atmospheric_light(sid node_id) override;
+        void remove_point_light(sid node_id) override;
+        void remove_spot_light(sid node_id) override;
 
         optional<node&> get_node(sid node_id) override;
         optional<transform&> get_transform(sid node_id) override;
@@ -58,6 +62,8 @@ namespace mango
         optional<directional_light&> get_directional_light(sid node_id) override;
         optional<skylight&> get_skylight(sid node_id) override;
         optional<atmospheric_light&> get_atmospheric_light(sid node_id) override;
+        optional<point_light&> get_point_light(sid node_id) override;
+        optional<spot_light&> get_spot_light(sid node_id) override;
 
         optional<model&> get_model(sid instance_id) override;
         optional<mesh&> get_mesh(sid instance_id) override;
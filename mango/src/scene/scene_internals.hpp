@@ -103,6 +103,15 @@ namespace mango
         DECLARE_SCENE_INTERNAL(scene_buffer_view);
     };
 
+    //! \brief Cpu copy of the triangles of a \a scene_primitive used for software occlusion culling.
+    struct occluder_geometry
+    {
+        //! \brief The object space positions.
+        std::vector<vec3> vertices;
+        //! \brief The triangle list indices. Three per triangle.
+        std::vector<uint32> indices;
+    };
+
     //! \brief An internal \a primitive.
     struct scene_primitive
     {
@@ -128,6 +137,9 @@ namespace mango
         //! \brief The \a axis_aligned_bounding_box of this \a scene_primitive.
         axis_aligned_bounding_box bounding_box;
 
+        //! \brief The \a occluder_geometry of this \a scene_primitive. Null for primitives not usable as occluders.
+        shared_ptr<const occluder_geometry> occluder;
+
         scene_primitive()
             : index_type(gfx_format::t_unsigned_byte)
         {
@@ -168,9 +180,13 @@ namespace mango
         //! \brief Optional \a perspective_camera if the type is orthographic.
         optional<orthographic_camera> public_data_as_orthographic;
 
+        //! \brief The average scene luminance the adaptive exposure of the camera adapted to.
+        float adapted_luminance;
+
         scene_camera()
             : type(camera_type::perspective)
             , public_data_as_perspective()
+            , adapted_luminance(1.0f)
         {
         }
         //! \brief The \a scene_camera is an internal scene structure.
@@ -182,7 +198,10 @@ namespace mango
     {
         directional = 0,
         skylight,
-        atmospheric
+        atmospheric,
+        point,
+        spot,
+        count
     };
 
     //! \brief An internal light.
@@ -197,6 +216,10 @@ namespace mango
         optional<skylight> public_data_as_skylight;
         //! \brief Optional \a atmospheric_light if the type is atmospheric.
         optional<atmospheric_light> public_data_as_atmospheric_light;
+        //! \brief Optional \a point_light if the type is point.
+        optional<point_light> public_data_as_point_light;
+        //! \brief Optional \a spot_light if the type is spot.
+        optional<spot_light> public_data_as_spot_light;
 
         scene_light()
             : type(light_type::directional)
@@ -205,6 +228,21 @@ namespace mango
         }
         //! \brief The \a scene_light is an internal scene structure.
         DECLARE_SCENE_INTERNAL(scene_light);
+
+        //! \brief Notifies that all changes were adressed. Should be called after the \a scene_light was updated.
+        inline void changes_handled()
+        {
+            if (public_data_as_directional_light)
+                public_data_as_directional_light->changed = false;
+            if (public_data_as_skylight)
+                public_data_as_skylight->changed = false;
+            if (public_data_as_atmospheric_light)
+                public_data_as_atmospheric_light->changed = false;
+            if (public_data_as_point_light)
+                public_data_as_point_light->changed = false;
+            if (public_data_as_spot_light)
+                public_data_as_spot_light->changed = false;
+        }
     };
 
     //! \brief An internal \a transform.
@@ -269,8 +307,8 @@ namespace mango
         //! \brief The \a sid of the nodes \a scene_camera, or invalid_sid.
         sid camera_id;
         //! \brief The \a sid of the nodes \a scene_lights, or invalid_sid.
-        //! \details Ordered by type: 0 = directional, 1 = skylight, 2 = atmospheric_light.
-        sid light_ids[3]; // Accessed via type.
+        //! \details Ordered by type: 0 = directional, 1 = skylight, 2 = atmospheric_light, 3 = point_light, 4 = spot_light.
+        sid light_ids[static_cast<uint8>(light_type::count)]; // Accessed via type.
 
         scene_node()
             : type(node_type::empty_leaf)
@@ -278,7 +316,8 @@ namespace mango
             , local_transformation_matrix(1.0f)
             , global_transformation_matrix(1.0f)
         {
-            light_ids[0] = light_ids[1] = light_ids[2] = invalid_sid;
+            for (int32 i = 0; i < static_cast<int32>(light_type::count); ++i)
+                light_ids[i] = invalid_sid;
         }
         //! \brief The \a scene_node is an internal scene structure.
         DECLARE_SCENE_INTERNAL(scene_node);
@@ -101,6 +101,18 @@ namespace mango
             ImGui::Text("%d", info.last_frame.draw_calls);
             column_next();
             ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
+            text_wrapped("Occlusion Culled Draws:");
+            column_next();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text("%d", info.last_frame.occluded);
+            column_next();
+            ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
+            text_wrapped("Estimated Opaque Overdraw:");
+            column_next();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text("%.2f", info.last_frame.overdraw);
+            column_next();
+            ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
             text_wrapped("Rendered Primitives:");
             column_next();
             ImGui::AlignTextToFramePadding();
@@ -234,6 +246,8 @@ namespace mango
             bool has_directional_light   = node.light_ids[static_cast<uint8>(light_type::directional)] != invalid_sid;
             bool has_skylight            = node.light_ids[static_cast<uint8>(light_type::skylight)] != invalid_sid;
             bool has_atmospheric_light   = node.light_ids[static_cast<uint8>(light_type::atmospheric)] != invalid_sid;
+            bool has_point_light         = node.light_ids[static_cast<uint8>(light_type::point)] != invalid_sid;
+            bool has_spot_light          = node.light_ids[static_cast<uint8>(light_type::spot)] != invalid_sid;
 
             if (ImGui::BeginPopup("##component_addition_popup"))
             {
@@ -262,6 +276,16 @@ namespace mango
                     auto al = atmospheric_light();
                     application_scene->add_atmospheric_light(al, node.public_data.instance_id);
                 }
+                if (!has_point_light && ImGui::Selectable("Add Point Light"))
+                {
+                    auto pl = point_light();
+                    application_scene->add_point_light(pl, node.public_data.instance_id);
+                }
+                if (!has_spot_light && ImGui::Selectable("Add Spot Light"))
+                {
+                    auto sl = spot_light();
+                    application_scene->add_spot_light(sl, node.public_data.instance_id);
+                }
 
                 ImGui::EndPopup();
             }
@@ -279,9 +303,9 @@ namespace mango
                 [object, &application_scene, &l]()
                 {
                     bool type_changed    = false;
-                    const char* types[3] = { "Directional", "Skylight", "Atmospheric" };
+                    const char* types[5] = { "Directional", "Skylight", "Atmospheric", "Point", "Spot" };
                     int32 idx            = static_cast<int32>(l->type);
-                    combo("Light Type", types, 3, idx, 0);
+                    combo("Light Type", types, 5, idx, 0);
                     if (l->type != static_cast<light_type>(idx))
                     {
                         l->type      = static_cast<light_type>(idx);
@@ -292,24 +316,30 @@ namespace mango
                     {
                         if (type_changed)
                             l->public_data_as_directional_light = directional_light();
+                        bool changed         = type_changed;
                         float default_fl3[3] = { 1.0f, 1.0f, 1.0f };
-                        drag_float_n("Direction", &l->public_data_as_directional_light->direction[0], 3, default_fl3, 0.08f, 0.0f, 0.0f, "%.2f", true);
+                        changed |= drag_float_n("Direction", &l->public_data_as_directional_light->direction[0], 3, default_fl3, 0.08f, 0.0f, 0.0f, "%.2f", true);
 
-                        color_edit("Color", &l->public_data_as_directional_light->color[0], 3, default_fl3);
+                        changed |= color_edit("Color", &l->public_data_as_directional_light->color[0], 3, default_fl3);
 
                         float default_value[1] = { mango::default_directional_intensity };
-                        slider_float_n("Intensity", &l->public_data_as_directional_light->intensity, 1, default_value, 0.0f, 500000.0f, "%.1f", false);
+                        changed |= slider_float_n("Intensity", &l->public_data_as_directional_light->intensity, 1, default_value, 0.0f, 500000.0f, "%.1f", false);
 
-                        checkbox("Cast Shadows", &l->public_data_as_directional_light->cast_shadows, false);
+                        changed |= checkbox("Cast Shadows", &l->public_data_as_directional_light->cast_shadows, false);
 
-                        checkbox("Contribute To Atmosphere", &l->public_data_as_directional_light->contribute_to_atmosphere, false);
+                        changed |= checkbox("Contribute To Atmosphere", &l->public_data_as_directional_light->contribute_to_atmosphere, false);
+
+                        if (changed)
+                            l->public_data_as_directional_light->update();
                     }
                     else if (l->type == light_type::skylight)
                     {
                         if (type_changed)
                             l->public_data_as_skylight = skylight();
                         // TODO Paul: NEXT
-                        checkbox("Use HDR Texture", &l->public_data_as_skylight->use_texture, false);
+                        bool changed    = type_changed;
+                        sid hdr_texture = l->public_data_as_skylight->hdr_texture;
+                        changed |= checkbox("Use HDR Texture", &l->public_data_as_skylight->use_texture, false);
                         if (l->public_data_as_skylight->use_texture) // hdr texture
                         {
                             if (l->public_data_as_skylight->hdr_texture == invalid_sid)
@@ -338,13 +368,62 @@ namespace mango
                                 ImGui::PopID();
                             }
                             float default_value[1] = { mango::default_skylight_intensity };
-                            slider_float_n("Skylight Intensity", &l->public_data_as_skylight->intensity, 1, default_value, 0.0f, 50000.0f, "%.1f", false);
+                            changed |= slider_float_n("Skylight Intensity", &l->public_data_as_skylight->intensity, 1, default_value, 0.0f, 50000.0f, "%.1f", false);
                         }
+
+                        if (changed || hdr_texture != l->public_data_as_skylight->hdr_texture)
+                            l->public_data_as_skylight->update();
+                    }
+                    else if (l->type == light_type::point)
+                    {
+                        if (type_changed)
+                            l->public_data_as_point_light = point_light();
+                        bool changed         = type_changed;
+                        float default_fl3[3] = { 1.0f, 1.0f, 1.0f };
+                        changed |= color_edit("Color", &l->public_data_as_point_light->color[0], 3, default_fl3);
+
+                        float default_value[1] = { mango::default_point_light_intensity };
+                        changed |= slider_float_n("Intensity", &l->public_data_as_point_light->intensity, 1, default_value, 0.0f, 50000.0f, "%.1f", false);
+
+                        default_value[0] = mango::default_light_radius;
+                        changed |= slider_float_n("Radius", &l->public_data_as_point_light->radius, 1, default_value, 0.01f, 100.0f, "%.2f", false);
+
+                        if (changed)
+                            l->public_data_as_point_light->update();
+                    }
+                    else if (l->type == light_type::spot)
+                    {
+                        if (type_changed)
+                            l->public_data_as_spot_light = spot_light();
+                        bool changed         = type_changed;
+                        float default_fl3[3] = { 0.0f, -1.0f, 0.0f };
+                        changed |= drag_float_n("Direction", &l->public_data_as_spot_light->direction[0], 3, default_fl3, 0.08f, 0.0f, 0.0f, "%.2f", true);
+
+                        default_fl3[0] = default_fl3[1] = default_fl3[2] = 1.0f;
+                        changed |= color_edit("Color", &l->public_data_as_spot_light->color[0], 3, default_fl3);
+
+                        float default_value[1] = { mango::default_spot_light_intensity };
+                        changed |= slider_float_n("Intensity", &l->public_data_as_spot_light->intensity, 1, default_value, 0.0f, 50000.0f, "%.1f", false);
+
+                        default_value[0] = mango::default_light_radius;
+                        changed |= slider_float_n("Radius", &l->public_data_as_spot_light->radius, 1, default_value, 0.01f, 100.0f, "%.2f", false);
+
+                        default_value[0] = 0.4f;
+                        changed |= slider_float_n("Inner Cone Angle", &l->public_data_as_spot_light->inner_cone_angle, 1, default_value, 0.0f, l->public_data_as_spot_light->outer_cone_angle, "%.2f", false);
+
+                        default_value[0] = 0.6f;
+                        changed |= slider_float_n("Outer Cone Angle", &l->public_data_as_spot_light->outer_cone_angle, 1, default_value, 0.01f, 1.57f, "%.2f", false);
+
+                        if (changed)
+                            l->public_data_as_spot_light->update();
                     }
                     else
                     {
                         if (type_changed)
+                        {
                             l->public_data_as_atmospheric_light = atmospheric_light();
+                            l->public_data_as_atmospheric_light->update();
+                        }
                         ImGui::Text("Not required yet!");
                         // float default_fl3[3] = { 1.0f, 1.0f, 1.0f };
                         // ImGui::PushID("atmosphere");
@@ -389,6 +468,10 @@ namespace mango
                             application_scene->remove_directional_light(l->public_data_as_directional_light->containing_node);
                         else if (l->type == light_type::skylight)
                             application_scene->remove_skylight(l->public_data_as_skylight->containing_node);
+                        else if (l->type == light_type::point)
+                            application_scene->remove_point_light(l->public_data_as_point_light->containing_node);
+                        else if (l->type == light_type::spot)
+                            application_scene->remove_spot_light(l->public_data_as_spot_light->containing_node);
                         else
                             application_scene->remove_atmospheric_light(l->public_data_as_atmospheric_light->containing_node);
                         return false;
@@ -997,10 +1080,12 @@ namespace mango
                 details::inspect_node(node.value(), application_scene);
                 bool is_camera = (node->type & node_type::camera) != node_type::empty_leaf; // Each node in the hierarchy has a transform.
                 bool is_light  = (node->type & node_type::light) != node_type::empty_leaf;  // Each node in the hierarchy has a transform.
-                details::inspect_transform(node->node_transform, application_scene, is_camera, is_light);
+                // Point and spot lights are positioned by the transform.
+                bool is_positioned_light = node->light_ids[static_cast<uint8>(light_type::point)] != invalid_sid || node->light_ids[static_cast<uint8>(light_type::spot)] != invalid_sid;
+                details::inspect_transform(node->node_transform, application_scene, is_camera, is_light && !is_positioned_light);
                 if (is_light)
                 {
-                    for (int32 i = 0; i < 3; ++i)
+                    for (int32 i = 0; i < static_cast<int32>(light_type::count); ++i)
                     {
                         if (node->light_ids[i] == invalid_sid)
                             continue;
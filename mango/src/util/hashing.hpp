@@ -33,6 +33,32 @@ namespace mango
             return hash;
         }
     };
+
+    //! \brief fnv1a_hash
+    //! \details 64 bit fnv1a hash for arbitrary data. Hashes can be chained by passing the previous hash as basis.
+    class fnv1a_hash
+    {
+      public:
+        //! \brief The offset basis for the first hash in a chain.
+        static const uint64 offset_basis = 14695981039346656037ULL;
+
+        //! \brief Calculate the hash for given data.
+        //! \param[in] data Pointer to the data to hash.
+        //! \param[in] size The size of the data in bytes.
+        //! \param[in] basis The basis to start with. Can be the hash of previous data.
+        //! \return The hash.
+        static uint64 hash(const void* data, size_t size, uint64 basis = offset_basis)
+        {
+            const uint8* bytes = static_cast<const uint8*>(data);
+            uint64 hash        = basis;
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL; // fnv prime
+            }
+            return hash;
+        }
+    };
 } // namespace mango
 
 #endif // MANGO_HASHING_HPP
\ No newline at end of file
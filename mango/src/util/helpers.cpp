@@ -7,6 +7,12 @@
 //! \copyright Apache License 2.0
 
 #include <util/helpers.hpp>
+#if defined(WIN32)
+#include <direct.h>
+#endif
+#include <cerrno>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 using namespace mango;
 
@@ -59,3 +65,50 @@ bool mango::check_acquisition(const void* ptr, const string& what)
 {
     return check_anything("Acquisition", ptr, what);
 }
+
+//! \brief Creates a single directory.
+//! \param[in] path The path of the directory.
+//! \return True if the directory exists afterwards, else false.
+static bool create_directory(const string& path)
+{
+#if defined(WIN32)
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+bool mango::create_directories(const string& path)
+{
+    // Parents are created first, failures are ignored since drive letters or existing roots can not be created.
+    for (size_t pos = path.find_first_of("/\\", 1); pos != string::npos && pos + 1 < path.size(); pos = path.find_first_of("/\\", pos + 1))
+        create_directory(path.substr(0, pos));
+
+    string full = path;
+    while (!full.empty() && (full.back() == '/' || full.back() == '\\'))
+        full.pop_back();
+    return full.empty() || create_directory(full);
+}
+
+bool mango::get_file_status(const string& path, int64& modification_time, int64& size)
+{
+#if defined(WIN32)
+    struct _stat64 status;
+    if (_stat64(path.c_str(), &status) != 0)
+        return false;
+#else
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0)
+        return false;
+#endif
+    // Whole seconds miss edits saved shortly after each other, so nanoseconds are used where the platform provides them.
+#if defined(WIN32)
+    modification_time = static_cast<int64>(status.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+    modification_time = static_cast<int64>(status.st_mtimespec.tv_sec) * 1000000000 + static_cast<int64>(status.st_mtimespec.tv_nsec);
+#else
+    modification_time = static_cast<int64>(status.st_mtim.tv_sec) * 1000000000 + static_cast<int64>(status.st_mtim.tv_nsec);
+#endif
+    size = static_cast<int64>(status.st_size);
+    return true;
+}
@@ -38,6 +38,18 @@ namespace mango
     //! \param[in] what The name of the checked object. Used for output.
     bool check_acquisition(const void* ptr, const string& what);
 
+    //! \brief Creates a directory and all missing parent directories.
+    //! \param[in] path The path of the directory. Separated with '/' or '\\'.
+    //! \return True if the directory exists afterwards, else false.
+    bool create_directories(const string& path);
+
+    //! \brief Queries the modification time and the size of a file.
+    //! \param[in] path The path of the file.
+    //! \param[out] modification_time The time of the last modification in nanoseconds. Only full seconds on windows.
+    //! \param[out] size The size of the file in bytes.
+    //! \return True if the file exists, else false.
+    bool get_file_status(const string& path, int64& modification_time, int64& size);
+
     //! \brief Macro used to disable copy and assignment for a class or structure.
 #ifndef MANGO_DISABLE_COPY_AND_ASSIGNMENT
 #define MANGO_DISABLE_COPY_AND_ASSIGNMENT(classname) \
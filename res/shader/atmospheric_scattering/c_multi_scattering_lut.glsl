@@ -0,0 +1,71 @@
+
+#include <../include/atmosphere.glsl>
+
+const int direction_count = 64;
+const int multi_scattering_steps = 20;
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0, rgba16f) uniform writeonly image2D multi_scattering_lut_out;
+
+layout(binding = 1) uniform sampler2D sampler_transmittance_lut; // texture "texture_transmittance_lut"
+
+vec3 sun_transmittance(in vec3 point, in vec3 sun_direction)
+{
+    float r = length(point);
+    return texture(sampler_transmittance_lut, transmittance_lut_uv(r - ground_radius, dot(point / r, sun_direction))).rgb;
+}
+
+// Second order scattering with an isotropic phase function for a sun with illuminance one.
+// The infinite series of higher orders is approximated by the geometric series 1 / (1 - f_ms).
+void main()
+{
+    ivec2 coords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 out_size = imageSize(multi_scattering_lut_out);
+    if (coords.x >= out_size.x || coords.y >= out_size.y)
+        return;
+
+    float height;
+    float cos_sun_zenith;
+    multi_scattering_lut_parameters((vec2(coords) + 0.5) / vec2(out_size), height, cos_sun_zenith);
+
+    vec3 origin = vec3(0.0, ground_radius + max(height, 1.0), 0.0);
+    vec3 sun_direction = vec3(sqrt(saturate(1.0 - cos_sun_zenith * cos_sun_zenith)), cos_sun_zenith, 0.0);
+    const float isotropic_phase = 1.0 / (4.0 * PI);
+
+    vec3 second_order = vec3(0.0);
+    vec3 transfer = vec3(0.0);
+    for (int d = 0; d < direction_count; ++d)
+    {
+        // fibonacci sphere
+        float z = 1.0 - (2.0 * float(d) + 1.0) / float(direction_count);
+        float phi = float(d) * 2.399963;
+        vec3 dir = vec3(sqrt(saturate(1.0 - z * z)) * vec2(cos(phi), sin(phi)), z).xzy;
+
+        float ray_length = atmosphere_ray_length(origin, dir);
+        if (ray_length <= 0.0)
+            continue;
+
+        float step_size = ray_length / float(multi_scattering_steps);
+        vec3 view_transmittance = vec3(1.0);
+        vec3 sample_point = origin + dir * (step_size * 0.5);
+        for (int i = 0; i < multi_scattering_steps; ++i)
+        {
+            vec2 densities = atmosphere_densities(length(sample_point) - ground_radius);
+            vec3 scattering = atmosphere_scattering(densities);
+            vec3 step_transmittance = exp(-atmosphere_extinction(densities) * step_size);
+
+            second_order += view_transmittance * scattering * sun_transmittance(sample_point, sun_direction) * isotropic_phase * step_size;
+            transfer += view_transmittance * scattering * step_size;
+
+            view_transmittance *= step_transmittance;
+            sample_point += dir * step_size;
+        }
+    }
+
+    second_order /= float(direction_count);
+    transfer /= float(direction_count);
+
+    vec3 multi_scattering = second_order / max(vec3(1.0) - transfer, vec3(1e-4));
+    imageStore(multi_scattering_lut_out, coords, vec4(multi_scattering, 1.0));
+}
@@ -0,0 +1,42 @@
+
+#include <../include/atmosphere.glsl>
+
+const int transmittance_steps = 40;
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0, rgba16f) uniform writeonly image2D transmittance_lut_out;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 out_size = imageSize(transmittance_lut_out);
+    if (coords.x >= out_size.x || coords.y >= out_size.y)
+        return;
+
+    float height;
+    float cos_zenith;
+    transmittance_lut_parameters((vec2(coords) + 0.5) / vec2(out_size), height, cos_zenith);
+
+    vec3 origin = vec3(0.0, ground_radius + height, 0.0);
+    vec3 dir = vec3(sqrt(saturate(1.0 - cos_zenith * cos_zenith)), cos_zenith, 0.0);
+
+    // Rays hitting the ground do not get any light from the sun.
+    vec2 ground_intersect = intersect_ray_sphere(origin, dir, ground_radius);
+    if (ground_intersect.x <= ground_intersect.y && ground_intersect.x > 0.0)
+    {
+        imageStore(transmittance_lut_out, coords, vec4(0.0, 0.0, 0.0, 1.0));
+        return;
+    }
+
+    float step_size = intersect_ray_sphere(origin, dir, atmosphere_radius).y / float(transmittance_steps);
+    vec3 optical_depth = vec3(0.0);
+    vec3 sample_point = origin + dir * (step_size * 0.5);
+    for (int i = 0; i < transmittance_steps; ++i)
+    {
+        optical_depth += atmosphere_extinction(atmosphere_densities(length(sample_point) - ground_radius)) * step_size;
+        sample_point += dir * step_size;
+    }
+
+    imageStore(transmittance_lut_out, coords, vec4(exp(-optical_depth), 1.0));
+}
@@ -14,7 +14,7 @@ layout(binding = 1, rgba16f) uniform writeonly imageCube cubemap_out;
 layout(binding = 3) uniform ibl_generation_data
 {
     vec2 out_size;
-    vec2 data;
+    vec2 data; // y -> first cubemap face
 };
 
 vec2 cube_to_equi(in vec3 v);
@@ -22,7 +22,7 @@ vec2 cube_to_equi(in vec3 v);
 void main()
 {
     vec4 pixel = vec4(0.0, 0.0, 0.0, 1.0);
-    ivec3 coords = ivec3(gl_GlobalInvocationID);
+    ivec3 coords = ivec3(gl_GlobalInvocationID.xy, gl_GlobalInvocationID.z + uint(data.y));
 
     vec3 pos = cube_to_world(coords, out_size);
 
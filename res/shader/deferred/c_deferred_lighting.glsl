@@ -0,0 +1,44 @@
+#include <../include/deferred_lighting_functions.glsl>
+#include <../include/tile_lighting.glsl>
+
+layout(local_size_x = LIGHTING_TILE_SIZE, local_size_y = LIGHTING_TILE_SIZE) in;
+
+layout(binding = HDR_IMAGE_LIGHTING_OUTPUT, rgba32f) uniform writeonly image2D image_hdr_output;
+
+// One variant per tile class. The work group id indexes the tile list of the class.
+#ifdef TILE_SHADOWED
+const bool tile_shadowed = true;
+#else
+const bool tile_shadowed = false;
+#endif // TILE_SHADOWED
+#ifdef TILE_SKYLIGHT
+const bool tile_skylight = true;
+#else
+const bool tile_skylight = false;
+#endif // TILE_SKYLIGHT
+const uint tile_class = (tile_shadowed ? TILE_CLASS_SHADOWED : 0u) | (tile_skylight ? TILE_CLASS_SKYLIGHT : 0u);
+
+void main()
+{
+    uint tile   = tile_list[tile_list_offset(tile_class) + gl_WorkGroupID.x];
+    ivec2 pixel = ivec2(tile & 0xFFFFu, tile >> 16) * LIGHTING_TILE_SIZE + ivec2(gl_LocalInvocationID.xy);
+    ivec2 size  = ivec2(vec2(imageSize(image_hdr_output)) * render_scale + 0.5); // The rendered sub-rectangle.
+    if(pixel.x >= size.x || pixel.y >= size.y)
+        return;
+
+    frag_coord = vec2(pixel) + 0.5;
+    texcoord   = frag_coord / vec2(size);
+
+    float depth = get_logarithmic_depth();
+    if(depth >= 1.0)
+        return;
+
+    if(debug_view_enabled)
+    {
+        draw_debug_views();
+        imageStore(image_hdr_output, pixel, frag_color);
+        return;
+    }
+
+    imageStore(image_hdr_output, pixel, calculate_deferred_lighting(depth, tile_shadowed, tile_skylight));
+}
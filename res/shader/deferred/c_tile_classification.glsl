@@ -0,0 +1,60 @@
+#include <../include/bindings.glsl>
+#include <../include/common_constants_and_functions.glsl>
+#include <../include/renderer.glsl>
+#include <../include/camera.glsl>
+#include <../include/light.glsl>
+#include <../include/tile_lighting.glsl>
+
+layout(local_size_x = LIGHTING_TILE_SIZE, local_size_y = LIGHTING_TILE_SIZE) in;
+
+layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET1) uniform sampler2D sampler_gbuffer_c1; // normal (rgb10a2 or octahedral rg16) // texture "texture_gbuffer_c1"
+layout(binding = GBUFFER_TEXTURE_SAMPLER_DEPTH) uniform sampler2D sampler_gbuffer_depth; // depth (d32) // texture "texture_gbuffer_depth"
+
+shared uint tile_geometry; // Non zero if any pixel of the tile contains geometry.
+shared uint tile_lit;      // Non zero if any pixel of the tile faces the directional light.
+
+void main()
+{
+    if(gl_LocalInvocationIndex == 0)
+    {
+        tile_geometry = 0;
+        tile_lit      = 0;
+    }
+
+    groupMemoryBarrier();
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size  = ivec2(vec2(textureSize(sampler_gbuffer_depth, 0)) * render_scale + 0.5); // The rendered sub-rectangle.
+    if(pixel.x < size.x && pixel.y < size.y)
+    {
+        float depth = texelFetch(sampler_gbuffer_depth, pixel, 0).r;
+        if(depth < 1.0)
+        {
+            atomicOr(tile_geometry, 1u);
+            // Pixels facing away from the light get no directional contribution, so their shadow is irrelevant.
+#ifdef COMPACT_GBUFFER
+            vec3 normal = octahedral_decode(texelFetch(sampler_gbuffer_c1, pixel, 0).rg);
+#else
+            vec3 normal = texelFetch(sampler_gbuffer_c1, pixel, 0).rgb * 2.0 - 1.0;
+#endif // COMPACT_GBUFFER
+            if(dot(normal, directional_direction.xyz) > 0.0)
+                atomicOr(tile_lit, 1u);
+        }
+    }
+
+    groupMemoryBarrier();
+    barrier();
+
+    if(gl_LocalInvocationIndex != 0 || tile_geometry == 0)
+        return;
+
+    bool shadows_possible = shadow_step_enabled && directional_valid && directional_cast_shadows && directional_intensity >= 1e-5;
+    bool shadowed         = shadows_possible && (tile_lit != 0 || show_cascades);
+    // Without a valid skylight the ambient term is a constant and no irradiance, radiance or lookup map is sampled.
+    bool skylit     = skylight_valid && skylight_intensity >= 1e-5;
+    uint tile_class = (shadowed ? TILE_CLASS_SHADOWED : 0u) | (skylit ? TILE_CLASS_SKYLIGHT : 0u);
+
+    uint index = atomicAdd(tile_dispatch[tile_class].x, 1u);
+    tile_list[tile_list_offset(tile_class) + index] = gl_WorkGroupID.x | (gl_WorkGroupID.y << 16);
+}
@@ -0,0 +1,10 @@
+#include <../include/bindings.glsl>
+
+layout(binding = GBUFFER_TEXTURE_SAMPLER_DEPTH) uniform sampler2D sampler_gbuffer_depth; // depth (d32) // texture "texture_gbuffer_depth"
+
+void main()
+{
+    // The compute lighting can not write the depth attachment, so the geometry depth is copied for transparent objects and cubemap.
+    // Both targets have the same size, so the texel is fetched directly, which also works for a scaled sub-rectangle.
+    gl_FragDepth = texelFetch(sampler_gbuffer_depth, ivec2(gl_FragCoord.xy), 0).r;
+}
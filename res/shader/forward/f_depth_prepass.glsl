@@ -0,0 +1,4 @@
+// Depth only, color writes are disabled in the pipeline.
+void main()
+{
+}
@@ -0,0 +1,12 @@
+#include <../include/scene_geometry.glsl>
+
+// Used while the geometry pass shader is compiled in the background. Only uses material constants, so it is cheap to compile.
+void main()
+{
+    vec3 normal = has_normals ? normalize(fs_in.normal) : normalize(cross(dFdx(fs_in.position), dFdy(fs_in.position)));
+
+    gbuffer_color_target0 = encode_gbuffer_base_color(vec4(base_color.rgb, 1.0));
+    gbuffer_color_target1 = encode_gbuffer_normal(normal);
+    gbuffer_color_target2 = vec4(emissive_color.rgb * emissive_intensity, 1.0);
+    gbuffer_color_target3 = vec4(1.0, roughness, metallic, 1.0);
+}
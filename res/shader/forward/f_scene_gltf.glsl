@@ -2,8 +2,8 @@
 
 void main()
 {
-    gbuffer_color_target0 = vec4(get_base_color());
-    gbuffer_color_target1 = vec4(get_normal() * 0.5 + 0.5, 1.0);
+    gbuffer_color_target0 = encode_gbuffer_base_color(get_base_color());
+    gbuffer_color_target1 = encode_gbuffer_normal(get_normal());
     gbuffer_color_target2 = vec4(get_emissive() * emissive_intensity, 1.0);
     gbuffer_color_target3 = vec4(get_occlusion_roughness_metallic(), 1.0);
 }
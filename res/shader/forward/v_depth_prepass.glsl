@@ -0,0 +1,16 @@
+#include <../include/bindings.glsl>
+
+layout(location = VERTEX_INPUT_POSITION) in vec3 vertex_data_position;
+
+#include <../include/camera.glsl>
+#include <../include/model.glsl>
+
+// Has to match v_scene_gltf.glsl exactly, the geometry pass only passes equal depth.
+invariant gl_Position;
+
+void main()
+{
+    vec4 world_position = model_matrix * vec4(vertex_data_position, 1.0);
+
+    gl_Position = view_projection_matrix * world_position;
+}
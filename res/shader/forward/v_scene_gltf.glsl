@@ -1,5 +1,8 @@
 #include <../include/scene_geometry.glsl>
 
+// The depth pre-pass has to produce the exact same depth.
+invariant gl_Position;
+
 void get_normal_tangent_bitangent(out vec3 normal, out vec3 tangent, out vec3 bitangent)
 {
     if(has_normals)
@@ -0,0 +1,74 @@
+#include <../include/bindings.glsl>
+#include <../include/camera.glsl>
+
+layout(local_size_x = 64) in;
+
+layout(binding = HI_Z_SAMPLER_INPUT) uniform sampler2D sampler_hi_z_input; // texture "texture_hi_z_input"
+
+layout(binding = HI_Z_DATA_BUFFER_BINDING_POINT, std140) uniform hi_z_data
+{
+    int source_level; // The level of the input texture to reduce.
+    int draw_count;   // The number of bounds to test.
+    int level_count;  // The number of levels of the depth pyramid.
+    int padding0;     // Padding.
+};
+
+layout(std430, binding = HI_Z_BOUNDS_BUFFER_BINDING_POINT) readonly buffer hi_z_bounds
+{
+    vec4 bounds[]; // World space center (xyz) followed by the extents (xyz) for each draw.
+};
+
+layout(std430, binding = HI_Z_VISIBILITY_BUFFER_BINDING_POINT) writeonly buffer hi_z_visibility
+{
+    uint visibility[]; // 1 if the draw is visible, else 0.
+};
+
+void main()
+{
+    int id = int(gl_GlobalInvocationID.x);
+    if (id >= draw_count)
+        return;
+
+    vec3 center  = bounds[id * 2].xyz;
+    vec3 extents = bounds[id * 2 + 1].xyz;
+
+    // screen space rectangle and nearest depth of the box.
+    vec3 box_min = vec3(1.0);
+    vec3 box_max = vec3(0.0);
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = center + extents * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip   = view_projection_matrix * vec4(corner, 1.0);
+        if (clip.w <= 0.0)
+        {
+            // Behind the camera, can not be tested.
+            visibility[id] = 1u;
+            return;
+        }
+        vec3 window = clip.xyz / clip.w * 0.5 + 0.5;
+        box_min     = min(box_min, window);
+        box_max     = max(box_max, window);
+    }
+    box_min = clamp(box_min, vec3(0.0), vec3(1.0));
+    box_max = clamp(box_max, vec3(0.0), vec3(1.0));
+
+    // The level where the rectangle covers at most two texels in each direction.
+    ivec2 size       = textureSize(sampler_hi_z_input, 0);
+    ivec2 texel_min  = min(ivec2(box_min.xy * render_scale * vec2(size)), size - 1); // Only the rendered sub-rectangle contains depth.
+    ivec2 texel_max  = min(ivec2(box_max.xy * render_scale * vec2(size)), size - 1);
+    ivec2 extent     = texel_max - texel_min + 1;
+    int level        = clamp(int(ceil(log2(float(max(extent.x, extent.y))))), 0, level_count - 1);
+    ivec2 level_size = textureSize(sampler_hi_z_input, level);
+    // Each texel covers 2^level texels of level 0, the last one additionally covers the remainder.
+    texel_min = min(texel_min >> level, level_size - 1);
+    texel_max = min(texel_max >> level, level_size - 1);
+
+    float farthest_depth = 0.0;
+    for (int y = texel_min.y; y <= texel_max.y; ++y)
+    {
+        for (int x = texel_min.x; x <= texel_max.x; ++x)
+            farthest_depth = max(farthest_depth, texelFetch(sampler_hi_z_input, ivec2(x, y), level).r);
+    }
+
+    visibility[id] = box_min.z <= farthest_depth ? 1u : 0u;
+}
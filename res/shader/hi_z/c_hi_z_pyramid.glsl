@@ -0,0 +1,42 @@
+#include <../include/bindings.glsl>
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = HI_Z_SAMPLER_INPUT) uniform sampler2D sampler_hi_z_input; // texture "texture_hi_z_input"
+layout(binding = HI_Z_IMAGE_OUTPUT, r32f) uniform writeonly image2D image_hi_z_output;
+
+layout(binding = HI_Z_DATA_BUFFER_BINDING_POINT, std140) uniform hi_z_data
+{
+    int source_level; // The level of the input texture to reduce.
+    int draw_count;   // The number of bounds to test.
+    int level_count;  // The number of levels of the depth pyramid.
+    int padding0;     // Padding.
+};
+
+void main()
+{
+    ivec2 coord       = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 source_size = textureSize(sampler_hi_z_input, source_level);
+    ivec2 output_size = imageSize(image_hi_z_output);
+    if (coord.x >= output_size.x || coord.y >= output_size.y)
+        return;
+
+    float depth = 0.0;
+    if (source_size == output_size)
+        depth = texelFetch(sampler_hi_z_input, coord, source_level).r;
+    else
+    {
+        // The last texel in a row or column also covers the odd texel left by a source size not divisible by two.
+        ivec2 extent = ivec2(2) + ivec2(equal(coord, output_size - 1)) * (source_size & 1);
+        for (int y = 0; y < extent.y; ++y)
+        {
+            for (int x = 0; x < extent.x; ++x)
+            {
+                ivec2 source_coord = min(coord * 2 + ivec2(x, y), source_size - 1);
+                depth = max(depth, texelFetch(sampler_hi_z_input, source_coord, source_level).r);
+            }
+        }
+    }
+
+    imageStore(image_hi_z_output, coord, vec4(depth));
+}
@@ -0,0 +1,80 @@
+#ifndef MANGO_ATMOSPHERE_GLSL
+#define MANGO_ATMOSPHERE_GLSL
+
+#include <common_constants_and_functions.glsl>
+
+// Uniform Buffer Atmosphere Compute.
+layout(binding = 4, std140) uniform atmosphere_data
+{
+    vec4 sun_dir; // vec3 -> vec4
+    vec4 rayleigh_scattering_coefficients; // vec3 -> vec4
+    vec4 ray_origin; // vec3 -> vec4
+    vec2 density_multiplier;
+    float sun_intensity;
+    float mie_scattering_coefficient;
+    float ground_radius;
+    float atmosphere_radius;
+    float mie_preferred_scattering_dir;
+    int scatter_points;
+    int scatter_points_second_ray; // unused, the sun transmittance is looked up
+};
+
+// Rayleigh and mie densities at a height above the ground.
+vec2 atmosphere_densities(in float height)
+{
+    return exp(-max(height, 0.0) / density_multiplier);
+}
+
+vec3 atmosphere_scattering(in vec2 densities)
+{
+    return rayleigh_scattering_coefficients.xyz * densities.x + vec3(mie_scattering_coefficient * densities.y);
+}
+
+// No absorption, so the extinction is equal to the scattering.
+vec3 atmosphere_extinction(in vec2 densities)
+{
+    return atmosphere_scattering(densities);
+}
+
+// Transmittance lut: x -> cosine of the zenith angle, y -> sqrt of the normalized height.
+vec2 transmittance_lut_uv(in float height, in float cos_zenith)
+{
+    float atmosphere_height = atmosphere_radius - ground_radius;
+    return vec2(cos_zenith * 0.5 + 0.5, sqrt(saturate(height / atmosphere_height)));
+}
+
+void transmittance_lut_parameters(in vec2 uv, out float height, out float cos_zenith)
+{
+    float atmosphere_height = atmosphere_radius - ground_radius;
+    cos_zenith = uv.x * 2.0 - 1.0;
+    height = uv.y * uv.y * atmosphere_height;
+}
+
+// Multiple scattering lut: x -> cosine of the sun zenith angle, y -> normalized height.
+vec2 multi_scattering_lut_uv(in float height, in float cos_sun_zenith)
+{
+    float atmosphere_height = atmosphere_radius - ground_radius;
+    return vec2(cos_sun_zenith * 0.5 + 0.5, saturate(height / atmosphere_height));
+}
+
+void multi_scattering_lut_parameters(in vec2 uv, out float height, out float cos_sun_zenith)
+{
+    float atmosphere_height = atmosphere_radius - ground_radius;
+    cos_sun_zenith = uv.x * 2.0 - 1.0;
+    height = uv.y * atmosphere_height;
+}
+
+// Length of the ray inside the atmosphere or until the ground is hit. Negative if the atmosphere is missed.
+float atmosphere_ray_length(in vec3 origin, in vec3 dir)
+{
+    vec2 atmosphere_intersect = intersect_ray_sphere(origin, dir, atmosphere_radius);
+    if (atmosphere_intersect.x > atmosphere_intersect.y || atmosphere_intersect.y < 0.0)
+        return -1.0;
+    vec2 ground_intersect = intersect_ray_sphere(origin, dir, ground_radius);
+    float ray_end = atmosphere_intersect.y;
+    if (ground_intersect.x <= ground_intersect.y && ground_intersect.x > 0.0)
+        ray_end = min(ray_end, ground_intersect.x);
+    return ray_end - max(atmosphere_intersect.x, 0.0);
+}
+
+#endif // MANGO_ATMOSPHERE_GLSL
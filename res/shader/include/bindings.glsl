@@ -8,6 +8,15 @@
 #define LIGHT_DATA_BUFFER_BINDING_POINT 4
 #define SHADOW_DATA_BUFFER_BINDING_POINT 5
 #define LUMINANCE_DATA_BUFFER_BINDING_POINT 6
+#define PUNCTUAL_LIGHT_BUFFER_BINDING_POINT 7
+#define LIGHT_CLUSTER_BUFFER_BINDING_POINT 8
+#define DEPTH_REDUCTION_BUFFER_BINDING_POINT 9
+#define HI_Z_DATA_BUFFER_BINDING_POINT 10
+#define HI_Z_BOUNDS_BUFFER_BINDING_POINT 11
+#define HI_Z_VISIBILITY_BUFFER_BINDING_POINT 12
+#define TILE_DATA_BUFFER_BINDING_POINT 13
+#define TILE_CLASSIFICATION_BUFFER_BINDING_POINT 14
+#define POST_STACK_DATA_BUFFER_BINDING_POINT 15
 
 #define VERTEX_INPUT_POSITION 0
 #define VERTEX_INPUT_NORMAL 1
@@ -41,5 +50,10 @@
 #define COMPOSING_DEPTH_SAMPLER 1
 
 #define HDR_IMAGE_LUMINANCE_COMPUTE 0
+#define DEPTH_REDUCTION_SAMPLER_DEPTH 0
+#define HI_Z_SAMPLER_INPUT 0
+#define HI_Z_IMAGE_OUTPUT 0
+#define HDR_IMAGE_LIGHTING_OUTPUT 0
+#define POST_STACK_IMAGE_OUTPUT 0
 
 #endif // MANGO_BINDINGS_GLSL
\ No newline at end of file
@@ -13,6 +13,7 @@ layout(binding = CAMERA_DATA_BUFFER_BINDING_POINT, std140) uniform camera_data
     float camera_near;             // Camera near plane depth value.
     float camera_far;              // Camera far plane depth value.
     float camera_exposure;         // The exposure value of the camera.
+    vec2  render_scale;            // The part of the internal render targets covered by the rendered sub-rectangle. (1, 1) without dynamic resolution.
 };
 
 #endif // MANGO_CAMERA_GLSL
\ No newline at end of file
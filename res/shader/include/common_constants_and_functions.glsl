@@ -122,6 +122,25 @@ vec4 linear_to_srgb(in vec4 linear)
     return vec4(pow(linear.rgb, vec3(1.0 / 2.2)), linear.a);
 }
 
+// Octahedral normal encoding, see: https://knarkowicz.wordpress.com/2014/04/16/octahedron-normal-vector-encoding/
+// Maps a unit vector to [0, 1] in two components.
+vec2 octahedral_encode(in vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 sign_not_zero = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    vec2 encoded = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * sign_not_zero;
+    return encoded * 0.5 + 0.5;
+}
+
+vec3 octahedral_decode(in vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-n.z);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
 // See: http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
 float radical_inverse_VdC(in uint bits)
 {
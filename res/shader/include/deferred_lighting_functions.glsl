@@ -0,0 +1,55 @@
+#ifndef MANGO_DEFERRED_LIGHTING_FUNCTIONS_GLSL
+#define MANGO_DEFERRED_LIGHTING_FUNCTIONS_GLSL
+
+#include <scene_deferred_lighting.glsl>
+#include <lighting_functions.glsl>
+#include <shadow_functions.glsl>
+
+// Lights the gbuffer pixel at texcoord and returns the premultiplied color.
+// Shadow filtering is skipped completely when shadowed is false.
+// The skylight maps are not sampled when skylight is false, only the constant ambient is added.
+vec4 calculate_deferred_lighting(in float depth, in bool shadowed, in bool skylight)
+{
+    vec3 position = world_space_from_depth(depth, texcoord, inverse_view_projection);
+    vec4 base_color = get_base_color();
+    vec3 normal = get_normal();
+    vec3 view = normalize(camera_position.xyz - position);
+    float n_dot_v = clamp(dot(normal, view), 1e-5, 1.0 - 1e-5);
+    vec3 o_r_m = get_occlusion_roughness_metallic();
+    float occlusion = o_r_m.x;
+    float perceptual_roughness = o_r_m.y;
+    float metallic = o_r_m.z;
+    float reflectance = 0.5; // TODO Paul: Make tweakable.
+    vec3 f0 = 0.16 * reflectance * reflectance * (1.0 - metallic) + base_color.rgb * metallic;
+
+
+    // skylight
+    vec3 skylight_contribution = skylight ? calculate_skylight(base_color.rgb, normal, view, n_dot_v, perceptual_roughness, metallic, f0, occlusion) : calculate_ambient(base_color.rgb, metallic);
+
+    // lights
+    vec3 directional_contribution = calculate_directional_light(base_color.rgb, normal, view, n_dot_v, perceptual_roughness, metallic, f0, occlusion);
+    vec3 punctual_contribution = calculate_punctual_lights(position, base_color.rgb, normal, view, n_dot_v, perceptual_roughness, metallic, f0, occlusion);
+
+    float shadow = 1.0;
+    vec3 cascade_color = vec3(1.0);
+
+    // shadows (directional)
+    if(shadowed && shadow_step_enabled && directional_valid && directional_cast_shadows)
+    {
+        shadow = directional_shadow(position, normal);
+        if(show_cascades)
+            cascade_color = get_shadow_cascade_debug_color(position);
+    }
+
+    vec3 lighting = vec3(0.0);
+    lighting += skylight_contribution;
+    lighting += directional_contribution * shadow;
+    lighting += punctual_contribution;
+    lighting += get_emissive();
+
+    lighting *= cascade_color;
+
+    return vec4(lighting * base_color.a, base_color.a); // Premultiplied alpha?
+}
+
+#endif // MANGO_DEFERRED_LIGHTING_FUNCTIONS_GLSL
@@ -0,0 +1,32 @@
+#ifndef MANGO_FXAA_GLSL
+#define MANGO_FXAA_GLSL
+
+#define FXAA_SEARCH_THRESHOLD 1.0 / 4.0
+
+#define LOW_Q_FXAA_EDGE_THRESHOLD 1.0 / 4.0
+#define HIGH_Q_FXAA_EDGE_THRESHOLD 1.0 / 8.0
+
+#define FXAA_EDGE_THRESHOLD_MIN 1.0 / 16.0
+
+#define FXAA_SEARCH_STEPS_LOW 4
+#define FXAA_SEARCH_STEPS_DEFAULT 6
+#define FXAA_SEARCH_STEPS_HIGH 7
+
+struct quality
+{
+    float edge_threshold;
+    float edge_threshold_min;
+    int search_steps;
+    float step_sizes[FXAA_SEARCH_STEPS_HIGH];
+};
+
+const quality quality_settings[3] = {
+    { LOW_Q_FXAA_EDGE_THRESHOLD, FXAA_EDGE_THRESHOLD_MIN, FXAA_SEARCH_STEPS_LOW,
+    { 1.0, 1.5, 3.0, 12.0, 0.0, 0.0, 0.0 } },
+    { HIGH_Q_FXAA_EDGE_THRESHOLD, FXAA_EDGE_THRESHOLD_MIN, FXAA_SEARCH_STEPS_DEFAULT,
+    { 1.0, 1.5, 2.0, 2.0, 4.0, 12.0, 0.0 } },
+    { HIGH_Q_FXAA_EDGE_THRESHOLD, FXAA_EDGE_THRESHOLD_MIN, FXAA_SEARCH_STEPS_HIGH,
+    { 1.0, 1.5, 2.0, 2.0, 2.0, 3.0, 8.0 } },
+};
+
+#endif // MANGO_FXAA_GLSL
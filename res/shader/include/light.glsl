@@ -13,6 +13,8 @@ layout(binding = LIGHT_DATA_BUFFER_BINDING_POINT, std140) uniform light_data
 
     float skylight_intensity;
     bool  skylight_valid;
+
+    int   punctual_light_count;
 };
 
 #endif // MANGO_LIGHT_GLSL
\ No newline at end of file
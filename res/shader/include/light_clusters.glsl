@@ -0,0 +1,63 @@
+#ifndef MANGO_LIGHT_CLUSTERS_GLSL
+#define MANGO_LIGHT_CLUSTERS_GLSL
+
+#include <bindings.glsl>
+#include <common_constants_and_functions.glsl>
+#include <camera.glsl>
+
+// These have to match the values in light_stack.hpp.
+#define CLUSTER_COUNT_X 16
+#define CLUSTER_COUNT_Y 9
+#define CLUSTER_COUNT_Z 24
+#define CLUSTER_COUNT (CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+#define PUNCTUAL_LIGHT_TYPE_POINT 0.0
+#define PUNCTUAL_LIGHT_TYPE_SPOT 1.0
+
+struct punctual_light
+{
+    vec4 position_radius; // World space position (xyz), radius of influence (w).
+    vec4 color_intensity; // Color (rgb), luminous intensity in candela (a).
+    vec4 direction_type;  // Spot direction (xyz), type (w).
+    vec4 spot_cone;       // Cosine of the outer cone angle (x), 1 / (cos(inner cone angle) - cos(outer cone angle)) (y).
+};
+
+layout(binding = PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, std430) readonly buffer punctual_light_data
+{
+    punctual_light punctual_lights[];
+};
+
+layout(binding = LIGHT_CLUSTER_BUFFER_BINDING_POINT, std430) buffer light_cluster_data
+{
+    uint cluster_light_counts[CLUSTER_COUNT];
+    uint cluster_light_indices[CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER];
+};
+
+// Depth slices are distributed exponentially between near and far plane, so that clusters keep roughly cubic in view space.
+float cluster_near()
+{
+    return max(camera_near, 0.01);
+}
+
+float cluster_slice_depth(in uint slice)
+{
+    float near = cluster_near();
+    return near * pow(max(camera_far, near + 0.01) / near, float(slice) / float(CLUSTER_COUNT_Z));
+}
+
+uint get_cluster_index(in vec3 world_position)
+{
+    vec4 clip        = view_projection_matrix * vec4(world_position, 1.0);
+    vec2 uv          = saturate(clip.xy / clip.w * 0.5 + 0.5);
+    float view_depth = -(view_matrix * vec4(world_position, 1.0)).z;
+
+    float near  = cluster_near();
+    float slice = log(max(view_depth, near) / near) * float(CLUSTER_COUNT_Z) / log(max(camera_far, near + 0.01) / near);
+
+    uvec2 tile = min(uvec2(uv * vec2(CLUSTER_COUNT_X, CLUSTER_COUNT_Y)), uvec2(CLUSTER_COUNT_X - 1, CLUSTER_COUNT_Y - 1));
+    uint z     = min(uint(slice), uint(CLUSTER_COUNT_Z - 1));
+    return tile.x + tile.y * CLUSTER_COUNT_X + z * CLUSTER_COUNT_X * CLUSTER_COUNT_Y;
+}
+
+#endif // MANGO_LIGHT_CLUSTERS_GLSL
@@ -4,11 +4,17 @@
 #include <common_constants_and_functions.glsl>
 #include <pbr_functions.glsl>
 
+// The constant ambient used without a valid skylight.
+vec3 calculate_ambient(in vec3 base_color, in float metallic)
+{
+    return vec3(300.0) * base_color * (1.0 - metallic); // TODO Paul: Hardcoded -.-
+}
+
 vec3 calculate_skylight(in vec3 base_color, in vec3 normal, in vec3 view, in float n_dot_v, in float perceptual_roughness, in float metallic, in vec3 f0, in float occlusion)
 {
     vec3 albedo      = base_color * (1.0 - metallic);
     if(!skylight_valid || skylight_intensity < 1e-5)
-        return vec3(300.0) * albedo; // TODO Paul: Hardcoded -.-
+        return calculate_ambient(base_color, metallic);
 
     n_dot_v = max(n_dot_v , 0.5 / DFG_TEXTURE_SIZE);
     vec3 dfg = textureLod(sampler_brdf_integration_lut, saturate(vec2(n_dot_v, perceptual_roughness)), 0.0).xyz;
@@ -76,4 +82,67 @@ vec3 calculate_directional_light(in vec3 base_color, in vec3 normal, in vec3 vie
     return lighting;
 }
 
+float distance_attenuation(in float distance_sqr, in float inv_radius_sqr)
+{
+    // inverse square falloff windowed to reach zero at the radius of influence.
+    float factor        = distance_sqr * inv_radius_sqr;
+    float smooth_factor = saturate(1.0 - factor * factor);
+    return smooth_factor * smooth_factor / max(distance_sqr, 1e-4);
+}
+
+vec3 calculate_punctual_lights(in vec3 position, in vec3 base_color, in vec3 normal, in vec3 view, in float n_dot_v, in float perceptual_roughness, in float metallic, in vec3 f0, in float occlusion)
+{
+    if(punctual_light_count <= 0)
+        return vec3(0.0);
+
+    // only the lights binned into the cluster of the position are evaluated.
+    uint cluster = get_cluster_index(position);
+    uint count   = min(cluster_light_counts[cluster], uint(MAX_LIGHTS_PER_CLUSTER));
+    uint offset  = cluster * MAX_LIGHTS_PER_CLUSTER;
+
+    float alpha = perceptual_roughness * perceptual_roughness;
+    vec3 albedo = base_color * (1.0 - metallic);
+
+    vec3 lighting = vec3(0.0);
+    for(uint i = 0; i < count; ++i)
+    {
+        punctual_light light = punctual_lights[cluster_light_indices[offset + i]];
+
+        vec3 to_light      = light.position_radius.xyz - position;
+        float distance_sqr = dot(to_light, to_light);
+        float radius       = light.position_radius.w;
+        if(distance_sqr >= radius * radius)
+            continue;
+
+        vec3 light_dir    = to_light * inversesqrt(max(distance_sqr, 1e-8));
+        float attenuation = distance_attenuation(distance_sqr, 1.0 / (radius * radius));
+
+        if(light.direction_type.w == PUNCTUAL_LIGHT_TYPE_SPOT)
+        {
+            float cd = dot(-light_dir, light.direction_type.xyz);
+            float a  = saturate((cd - light.spot_cone.x) * light.spot_cone.y);
+            attenuation *= a * a;
+        }
+
+        float n_dot_l = saturate(dot(normal, light_dir));
+        if(attenuation * n_dot_l <= 0.0)
+            continue;
+
+        vec3 halfway  = normalize(light_dir + view);
+        float n_dot_h = saturate(dot(normal, halfway));
+        float l_dot_h = saturate(dot(light_dir, halfway));
+
+        float D = D_GGX(n_dot_h, alpha);
+        vec3 F  = F_Schlick(l_dot_h, f0, 1.0);
+        float V = V_SmithGGXCorrelated(n_dot_v, n_dot_l, alpha);
+
+        vec3 Fr = D * V * F * INV_PI;
+        vec3 Fd = albedo * Fd_BurleyRenormalized(n_dot_v, n_dot_l, l_dot_h, alpha) * INV_PI;
+
+        lighting += (Fd * occlusion + Fr) * n_dot_l * light.color_intensity.rgb * light.color_intensity.a * attenuation;
+    }
+
+    return lighting;
+}
+
 #endif // MANGO_LIGHTING_FUNCTIONS_GLSL
@@ -4,13 +4,27 @@
 #include <bindings.glsl>
 #include <common_constants_and_functions.glsl>
 
+#ifdef COMPUTE
+// The compute lighting sets these per invocation and stores frag_color itself.
+vec4 frag_color;
+vec2 texcoord;
+vec2 frag_coord;
+#define FRAG_COORD frag_coord
+#else
 out vec4 frag_color;
 
 in vec2 texcoord;
+#endif // COMPUTE
 
+#ifdef COMPACT_GBUFFER
+layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET0) uniform sampler2D sampler_gbuffer_c0; // base color rgb in srgb, alpha linear (rgba8) // texture "texture_gbuffer_c0"
+layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET1) uniform sampler2D sampler_gbuffer_c1; // octahedral normal rg (rg16) // texture "texture_gbuffer_c1"
+layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET2) uniform sampler2D sampler_gbuffer_c2; // emissive rgb (r11f_g11f_b10f) // texture "texture_gbuffer_c2"
+#else
 layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET0) uniform sampler2D sampler_gbuffer_c0; // base color rgba (rgba8) // texture "texture_gbuffer_c0"
 layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET1) uniform sampler2D sampler_gbuffer_c1; // normal rgb, alpha unused (rgb10a2) // texture "texture_gbuffer_c1"
-layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET2) uniform sampler2D sampler_gbuffer_c2; // emissive rgb, alpha unused (rgba8) // texture "texture_gbuffer_c2"
+layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET2) uniform sampler2D sampler_gbuffer_c2; // emissive rgb, alpha unused (rgba32f) // texture "texture_gbuffer_c2"
+#endif // COMPACT_GBUFFER
 layout(binding = GBUFFER_TEXTURE_SAMPLER_TARGET3) uniform sampler2D sampler_gbuffer_c3; // occlusion r, roughness g, metallic b, alpha unutexture_sed (rgba8) // texture "texture_gbuffer_c3"
 layout(binding = GBUFFER_TEXTURE_SAMPLER_DEPTH) uniform sampler2D sampler_gbuffer_depth; // depth (d32) // texture "texture_gbuffer_depth"
 
@@ -27,33 +41,43 @@ layout(binding = SAMPLER_SHADOW_MAP) uniform sampler2DArray sampler_shadow_map;
 
 #include <light.glsl>
 
+#include <light_clusters.glsl>
+
 #include <shadow.glsl>
 
 vec4 get_base_color()
 {
-    return texture(sampler_gbuffer_c0, texcoord);
+#ifdef COMPACT_GBUFFER
+    return srgb_to_linear(texture(sampler_gbuffer_c0, texcoord * render_scale));
+#else
+    return texture(sampler_gbuffer_c0, texcoord * render_scale);
+#endif // COMPACT_GBUFFER
 }
 
 vec3 get_emissive()
 {
-    return texture(sampler_gbuffer_c2, texcoord).rgb;
+    return texture(sampler_gbuffer_c2, texcoord * render_scale).rgb;
 }
 
 vec3 get_occlusion_roughness_metallic()
 {
-    vec3 o_r_m = texture(sampler_gbuffer_c3, texcoord).rgb;
+    vec3 o_r_m = texture(sampler_gbuffer_c3, texcoord * render_scale).rgb;
     o_r_m.x = max(o_r_m.x, 0.089f);
     return o_r_m;
 }
 
 vec3 get_normal()
 {
-    return normalize(texture(sampler_gbuffer_c1, texcoord).rgb * 2.0 - 1.0);
+#ifdef COMPACT_GBUFFER
+    return octahedral_decode(texture(sampler_gbuffer_c1, texcoord * render_scale).rg);
+#else
+    return normalize(texture(sampler_gbuffer_c1, texcoord * render_scale).rgb * 2.0 - 1.0);
+#endif // COMPACT_GBUFFER
 }
 
 float get_logarithmic_depth()
 {
-    return texture(sampler_gbuffer_depth, texcoord).r;
+    return texture(sampler_gbuffer_depth, texcoord * render_scale).r;
 }
 
 void draw_debug_views()
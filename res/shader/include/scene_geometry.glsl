@@ -28,10 +28,17 @@ out shared_data
 
 #ifdef GBUFFER_FRAGMENT
 
+#ifdef COMPACT_GBUFFER
+layout(location = GBUFFER_OUTPUT_TARGET0) out vec4 gbuffer_color_target0; // base color rgb in srgb, alpha linear (rgba8)
+layout(location = GBUFFER_OUTPUT_TARGET1) out vec4 gbuffer_color_target1; // octahedral normal rg (rg16)
+layout(location = GBUFFER_OUTPUT_TARGET2) out vec4 gbuffer_color_target2; // emissive rgb (r11f_g11f_b10f)
+layout(location = GBUFFER_OUTPUT_TARGET3) out vec4 gbuffer_color_target3; // occlusion r, roughness g, metallic b, alpha unused (rgba8)
+#else
 layout(location = GBUFFER_OUTPUT_TARGET0) out vec4 gbuffer_color_target0; // base color rgba (rgba8)
 layout(location = GBUFFER_OUTPUT_TARGET1) out vec4 gbuffer_color_target1; // normal rgb, alpha unused (rgb10a2)
 layout(location = GBUFFER_OUTPUT_TARGET2) out vec4 gbuffer_color_target2; // emissive rgb, alpha unused (rgba32f)
 layout(location = GBUFFER_OUTPUT_TARGET3) out vec4 gbuffer_color_target3; // occlusion r, roughness g, metallic b, alpha unused (rgba8)
+#endif // COMPACT_GBUFFER
 
 in shared_data
 {
@@ -110,6 +117,24 @@ vec3 get_normal()
     return normal;
 }
 
+vec4 encode_gbuffer_base_color(in vec4 color)
+{
+#ifdef COMPACT_GBUFFER
+    return linear_to_srgb(color); // More precision for dark colors in eight bits.
+#else
+    return color;
+#endif // COMPACT_GBUFFER
+}
+
+vec4 encode_gbuffer_normal(in vec3 normal)
+{
+#ifdef COMPACT_GBUFFER
+    return vec4(octahedral_encode(normal), 0.0, 0.0);
+#else
+    return vec4(normal * 0.5 + 0.5, 1.0);
+#endif // COMPACT_GBUFFER
+}
+
 #endif // GBUFFER_FRAGMENT
 
 #ifdef FORWARD_LIGHTING_FRAGMENT
@@ -148,6 +173,8 @@ layout(binding = SAMPLER_SHADOW_MAP) uniform sampler2DArray sampler_shadow_map;
 
 #include <light.glsl>
 
+#include <light_clusters.glsl>
+
 #include <shadow.glsl>
 
 vec4 get_base_color()
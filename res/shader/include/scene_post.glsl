@@ -19,4 +19,22 @@ layout(binding = COMPOSING_DEPTH_SAMPLER) uniform sampler2D sampler_geometry_dep
 
 #endif // COMPOSING
 
+#ifdef POST_STACK
+
+layout(binding = COMPOSING_HDR_SAMPLER) uniform sampler2D sampler_hdr_input; // texture "texture_hdr_input"
+layout(binding = POST_STACK_IMAGE_OUTPUT, rgba8) uniform writeonly image2D image_post_output;
+
+layout(binding = POST_STACK_DATA_BUFFER_BINDING_POINT, std140) uniform post_stack_data
+{
+    vec2 inverse_screen_size;
+    int quality_preset;
+    float subpixel_filter;
+};
+
+#include <renderer.glsl>
+
+#include <camera.glsl>
+
+#endif // POST_STACK
+
 #endif // MANGO_SCENE_POST_GLSL
\ No newline at end of file
@@ -20,6 +20,7 @@ layout(binding = SHADOW_DATA_BUFFER_BINDING_POINT, std140) uniform shadow_data
     float shadow_width;
     float shadow_light_size;
     int   cascade;
+    bool  shadow_clear_cascade;
 };
 
 #endif // MANGO_SHADOW_GLSL
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include <camera.glsl>
 #include <common_constants_and_functions.glsl>
 
+#ifndef FRAG_COORD
+#define FRAG_COORD gl_FragCoord
+#endif // FRAG_COORD
+
 // interpolation_mode: 0 -> no interpolation | 1 -> interpolation from cascade_id to cascade_id + 1 - shadow_cascade_interpolation_range | 2 -> interpolation from cascade_id - 1  + shadow_cascade_interpolation_range to cascade_id
 int compute_cascade_id(in float view_depth, out float interpolation_factor, out int interpolation_mode) // xy texcoords, z depth
 {
@@ -46,7 +50,7 @@ vec2 sample_blocker(in vec2 shadow_uv, in float receiver_z, in int cascade_id, i
 {
     float average_depth = 0.0;
     int blocker_count = 0;
-    float theta = interleaved_gradient_noise(gl_FragCoord.xy);
+    float theta = interleaved_gradient_noise(FRAG_COORD.xy);
     mat2 rotation = mat2(vec2(cos(theta), sin(theta)), vec2(-sin(theta), cos(theta)));
     for(int i = 0; i < sample_count; ++i)
     {
@@ -69,7 +73,7 @@ vec2 sample_blocker(in vec2 shadow_uv, in float receiver_z, in int cascade_id, i
 float pcf(in vec2 shadow_uv, in float receiver_z, in int cascade_id, in int sample_count, in float filter_radius)
 {
     float sum = 0.0;
-    float theta = interleaved_gradient_noise(gl_FragCoord.xy);
+    float theta = interleaved_gradient_noise(FRAG_COORD.xy);
     mat2 rotation = mat2(vec2(cos(theta), sin(theta)), vec2(-sin(theta), cos(theta)));
     for(int i = 0; i < sample_count; ++i)
     {
@@ -0,0 +1,32 @@
+#ifndef MANGO_TILE_LIGHTING_GLSL
+#define MANGO_TILE_LIGHTING_GLSL
+
+#include <bindings.glsl>
+
+#define LIGHTING_TILE_SIZE 16
+
+// Tile classes are combinations of the class flags, each class has a specialized lighting variant. Tiles without any geometry (sky) are not listed at all.
+#define TILE_CLASS_SHADOWED 1u // At least one pixel requires the directional shadow.
+#define TILE_CLASS_SKYLIGHT 2u // The tile requires image based lighting from the skylight.
+#define TILE_CLASS_COUNT 4
+
+layout(binding = TILE_DATA_BUFFER_BINDING_POINT, std140) uniform tile_lighting_data
+{
+    int tile_count_x; // The number of tiles in x direction.
+    int tile_count_y; // The number of tiles in y direction.
+    int padding0;     // Padding.
+    int padding1;     // Padding.
+};
+
+layout(std430, binding = TILE_CLASSIFICATION_BUFFER_BINDING_POINT) buffer tile_classification
+{
+    uvec4 tile_dispatch[TILE_CLASS_COUNT]; // Indirect dispatch arguments for each class. x is the number of tiles, y and z are one.
+    uint tile_list[];                      // Tile coordinates packed as x | y << 16. The list of class c starts at c * tile_count_x * tile_count_y.
+};
+
+uint tile_list_offset(in uint tile_class)
+{
+    return tile_class * uint(tile_count_x * tile_count_y);
+}
+
+#endif // MANGO_TILE_LIGHTING_GLSL
@@ -0,0 +1,103 @@
+#include <../include/common_constants_and_functions.glsl>
+#include <../include/light.glsl>
+#include <../include/light_clusters.glsl>
+
+#define CLUSTER_SLICES_PER_GROUP 4
+#define THREAD_COUNT (CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_SLICES_PER_GROUP)
+
+layout(local_size_x = CLUSTER_COUNT_X, local_size_y = CLUSTER_COUNT_Y, local_size_z = CLUSTER_SLICES_PER_GROUP) in;
+
+// Bounding spheres of the lights in view space (xyz center, w radius), loaded in batches by all threads of the group.
+shared vec4 shared_light_spheres[THREAD_COUNT];
+
+vec3 view_space_from_ndc(in vec2 ndc, in float depth);
+vec4 light_bounding_sphere(in punctual_light light);
+bool sphere_intersects_aabb(in vec4 sphere, in vec3 aabb_min, in vec3 aabb_max);
+
+void main()
+{
+    uvec3 cluster = gl_GlobalInvocationID;
+    uint cluster_index = cluster.x + cluster.y * CLUSTER_COUNT_X + cluster.z * CLUSTER_COUNT_X * CLUSTER_COUNT_Y;
+
+    // view space bounds of the cluster
+    vec2 ndc_min = vec2(cluster.xy) / vec2(CLUSTER_COUNT_X, CLUSTER_COUNT_Y) * 2.0 - 1.0;
+    vec2 ndc_max = vec2(cluster.xy + 1) / vec2(CLUSTER_COUNT_X, CLUSTER_COUNT_Y) * 2.0 - 1.0;
+    float depth_near = cluster_slice_depth(cluster.z);
+    float depth_far  = cluster_slice_depth(cluster.z + 1);
+
+    vec3 c0 = view_space_from_ndc(ndc_min, depth_near);
+    vec3 c1 = view_space_from_ndc(ndc_max, depth_near);
+    vec3 c2 = view_space_from_ndc(ndc_min, depth_far);
+    vec3 c3 = view_space_from_ndc(ndc_max, depth_far);
+    vec3 aabb_min = min(min(c0, c1), min(c2, c3));
+    vec3 aabb_max = max(max(c0, c1), max(c2, c3));
+
+    uint light_count = uint(punctual_light_count);
+    uint count = 0;
+    uint offset = cluster_index * MAX_LIGHTS_PER_CLUSTER;
+    for (uint batch = 0; batch < light_count; batch += THREAD_COUNT)
+    {
+        uint to_load = batch + gl_LocalInvocationIndex;
+        if (to_load < light_count)
+            shared_light_spheres[gl_LocalInvocationIndex] = light_bounding_sphere(punctual_lights[to_load]);
+
+        groupMemoryBarrier();
+        barrier();
+
+        uint batch_size = min(uint(THREAD_COUNT), light_count - batch);
+        for (uint i = 0; i < batch_size && count < MAX_LIGHTS_PER_CLUSTER; ++i)
+        {
+            if (sphere_intersects_aabb(shared_light_spheres[i], aabb_min, aabb_max))
+            {
+                cluster_light_indices[offset + count] = batch + i;
+                count++;
+            }
+        }
+
+        groupMemoryBarrier();
+        barrier();
+    }
+
+    cluster_light_counts[cluster_index] = count;
+}
+
+vec3 view_space_from_ndc(in vec2 ndc, in float depth)
+{
+    // orthographic projection
+    if (projection_matrix[3][3] == 1.0)
+        return vec3((ndc - vec2(projection_matrix[3][0], projection_matrix[3][1])) / vec2(projection_matrix[0][0], projection_matrix[1][1]), -depth);
+
+    return vec3((ndc + vec2(projection_matrix[2][0], projection_matrix[2][1])) * depth / vec2(projection_matrix[0][0], projection_matrix[1][1]), -depth);
+}
+
+vec4 light_bounding_sphere(in punctual_light light)
+{
+    vec3 position = light.position_radius.xyz;
+    float radius  = light.position_radius.w;
+
+    if (light.direction_type.w == PUNCTUAL_LIGHT_TYPE_SPOT)
+    {
+        // Tighter bounding sphere of the cone.
+        vec3 direction = light.direction_type.xyz;
+        float cos_angle = light.spot_cone.x;
+        if (cos_angle < sqrt(0.5)) // wider than 45 degrees
+        {
+            position += direction * radius * cos_angle;
+            radius   *= sqrt(1.0 - cos_angle * cos_angle);
+        }
+        else
+        {
+            radius   *= 0.5 / cos_angle;
+            position += direction * radius;
+        }
+    }
+
+    return vec4((view_matrix * vec4(position, 1.0)).xyz, radius);
+}
+
+bool sphere_intersects_aabb(in vec4 sphere, in vec3 aabb_min, in vec3 aabb_max)
+{
+    vec3 closest = clamp(sphere.xyz, aabb_min, aabb_max);
+    vec3 d       = closest - sphere.xyz;
+    return dot(d, d) <= sphere.w * sphere.w;
+}
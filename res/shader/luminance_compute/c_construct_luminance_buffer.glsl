@@ -7,7 +7,7 @@ layout(binding = HDR_IMAGE_LUMINANCE_COMPUTE, rgba32f) uniform readonly image2D
 layout(std430, binding = LUMINANCE_DATA_BUFFER_BINDING_POINT) buffer luminance_data
 {
     uint histogram[256];
-    vec4 params; // min_log_luminance (x), inverse_log_luminance_range (y), time coefficient (z), pixel_count (w)
+    vec4 params; // min_log_luminance (x), inverse_log_luminance_range (y), unused (z), pixel_count (w)
     float luminance;
 };
 
@@ -6,13 +6,12 @@ layout(local_size_x = 16, local_size_y = 16) in;
 layout(std430, binding = LUMINANCE_DATA_BUFFER_BINDING_POINT) buffer luminance_data
 {
     uint histogram[256];
-    vec4 params; // min_log_luminance (x), inverse_log_luminance_range (y), time coefficient (z), pixel_count (w)
+    vec4 params; // min_log_luminance (x), inverse_log_luminance_range (y), unused (z), pixel_count (w)
     float luminance;
 };
 
 #define min_log_luminance params.x
 #define log_luminance_range (1.0 / params.y)
-#define time_coefficient params.z
 #define pixel_count params.w
 
 shared uint shared_histogram[256];
@@ -90,9 +89,7 @@ void main()
 
         float luminance_weighted_average = exp2(((weighted_log_average / 254.0) * log_luminance_range) + min_log_luminance);
 
-        // smooth out with last frames luminance
-        float last_frame = luminance;
-        float smoothed = last_frame + (luminance_weighted_average - last_frame) * time_coefficient;
-        luminance = smoothed;
+        // Smoothed out on the cpu, since the results are read back with some frames latency.
+        luminance = luminance_weighted_average;
     }
 }
@@ -4,7 +4,6 @@
 
 const uint sample_count = 512; // sufficient because of the mipmap optimization -> we would need more without!
 const float inverse_sample_count = 1.0 / float(sample_count);
-const float width_sqr = 1024.0 * 1024.0;
 
 layout(local_size_x = 32, local_size_y = 32) in;
 
@@ -14,17 +13,21 @@ layout(binding = 1, rgba16f) uniform writeonly imageCube irradiance_map_out;
 layout(binding = 3) uniform ibl_generation_data
 {
     vec2 out_size;
-    vec2 data;
+    vec2 data; // y -> first cubemap face
 };
 
 void main()
 {
-    ivec3 cube_coords = ivec3(gl_GlobalInvocationID.xyz);
+    ivec3 cube_coords = ivec3(gl_GlobalInvocationID.xy, gl_GlobalInvocationID.z + uint(data.y));
     if (cube_coords.x >= out_size.x || cube_coords.y >= out_size.y)
         return;
     vec3 pos = cube_to_world(cube_coords, out_size);
     vec3 normal = normalize(pos);
 
+    // the solid angle of the input texels depends on the size of the input cubemap
+    float width_sqr = float(textureSize(sampler_cubemap_in, 0).x);
+    width_sqr *= width_sqr;
+
     vec3 up = abs(normal.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
     vec3 tangent_x = normalize(cross(up, normal));
     vec3 tangent_y = normalize(cross(normal, tangent_x));
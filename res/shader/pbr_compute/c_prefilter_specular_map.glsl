@@ -2,7 +2,6 @@
 #include <../include/common_constants_and_functions.glsl>
 #include <../include/pbr_functions.glsl>
 
-const float width_sqr = 1024.0 * 1024.0; // TODO Paul: Hardcoded -.-
 const uint sample_count = 512 - 32;
 
 layout(local_size_x = 32, local_size_y = 32) in;
@@ -13,17 +12,21 @@ layout(binding = 1, rgba16f) uniform writeonly imageCube prefiltered_spec_out;
 layout(binding = 3) uniform ibl_generation_data
 {
     vec2 out_size;
-    vec2 data; // x -> perceptual roughness
+    vec2 data; // x -> perceptual roughness, y -> first cubemap face
 };
 
 void main()
 {
-    ivec3 cube_coords = ivec3(gl_GlobalInvocationID.xyz);
+    ivec3 cube_coords = ivec3(gl_GlobalInvocationID.xy, gl_GlobalInvocationID.z + uint(data.y));
     if (cube_coords.x >= out_size.x || cube_coords.y >= out_size.y)
         return;
     vec3 pos = cube_to_world(cube_coords, out_size);
     vec3 normal = normalize(pos);
 
+    // the solid angle of the input texels depends on the size of the input cubemap
+    float width_sqr = float(textureSize(sampler_cubemap_in, 0).x);
+    width_sqr *= width_sqr;
+
     // assume view direction always equal to outgoing direction
     vec3 view = normal;
 
@@ -0,0 +1,219 @@
+#include <../include/scene_post.glsl>
+#include <../include/tonemapping.glsl>
+#include <../include/fxaa.glsl>
+
+#define POST_TILE_SIZE 16
+#define POST_TILE_BORDER 1
+#define POST_CACHE_SIZE (POST_TILE_SIZE + 2 * POST_TILE_BORDER)
+
+layout(local_size_x = POST_TILE_SIZE, local_size_y = POST_TILE_SIZE) in;
+
+// Composed color of the tile and a one pixel border. FXAA reads its neighborhood and the final sample from here,
+// so the composed image never goes through memory. The luma is stored in the alpha channel.
+shared vec4 shared_tile[POST_CACHE_SIZE * POST_CACHE_SIZE];
+
+ivec2 output_size;
+ivec2 tile_origin;
+
+vec4 compose(in vec2 position);
+vec4 tile_texel(in ivec2 local, in ivec2 offset);
+vec4 sample_tile(in vec2 position);
+bool inside_tile(in vec2 position);
+float sample_luma(in vec2 position);
+
+void main()
+{
+    output_size = imageSize(image_post_output);
+    tile_origin = ivec2(gl_WorkGroupID.xy) * POST_TILE_SIZE - POST_TILE_BORDER;
+
+    // Texels outside of the output are clamped like the clamp to edge sampler of the fxaa step does.
+    for (int i = int(gl_LocalInvocationIndex); i < POST_CACHE_SIZE * POST_CACHE_SIZE; i += POST_TILE_SIZE * POST_TILE_SIZE)
+    {
+        ivec2 pixel    = clamp(tile_origin + ivec2(i % POST_CACHE_SIZE, i / POST_CACHE_SIZE), ivec2(0), output_size - 1);
+        vec4 color     = compose(vec2(pixel) + 0.5);
+        shared_tile[i] = vec4(color.rgb, luma(color));
+    }
+
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (pixel.x >= output_size.x || pixel.y >= output_size.y)
+        return;
+
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    quality q   = quality_settings[quality_preset];
+
+    // Same filter as the fxaa step, but in pixel units.
+    vec4 rgba_center = tile_texel(local, ivec2(0, 0));
+
+    float luma_center = rgba_center.a;
+    float luma_north  = tile_texel(local, ivec2( 0, -1)).a;
+    float luma_west   = tile_texel(local, ivec2(-1,  0)).a;
+    float luma_east   = tile_texel(local, ivec2( 1,  0)).a;
+    float luma_south  = tile_texel(local, ivec2( 0,  1)).a;
+    float min_luma    = min(luma_center, min(min(luma_west, luma_east), min(luma_north, luma_south)));
+    float max_luma    = max(luma_center, max(max(luma_west, luma_east), max(luma_north, luma_south)));
+    float luma_range  = max_luma - min_luma;
+
+    if(luma_range < max(q.edge_threshold_min, max_luma * q.edge_threshold))
+    {
+        imageStore(image_post_output, pixel, vec4(rgba_center.rgb, 1.0));
+        return;
+    }
+
+    float luma_north_west = tile_texel(local, ivec2(-1, -1)).a;
+    float luma_north_east = tile_texel(local, ivec2( 1, -1)).a;
+    float luma_south_west = tile_texel(local, ivec2(-1,  1)).a;
+    float luma_south_east = tile_texel(local, ivec2( 1,  1)).a;
+
+    float vertical =
+        abs((0.25 * luma_north_west) + (-0.5 * luma_north) + (0.25 * luma_north_east)) +
+        abs((0.50 * luma_west ) + (-1.0 * luma_center) + (0.50 * luma_east )) +
+        abs((0.25 * luma_south_west) + (-0.5 * luma_south) + (0.25 * luma_south_east));
+    float horizontal =
+        abs((0.25 * luma_north_west) + (-0.5 * luma_west) + (0.25 * luma_south_west)) +
+        abs((0.50 * luma_north ) + (-1.0 * luma_center) + (0.50 * luma_south )) +
+        abs((0.25 * luma_north_east) + (-0.5 * luma_east) + (0.25 * luma_south_east));
+
+    bool horizontal_span = horizontal >= vertical;
+
+    // opposite lumas
+    float luma0 = horizontal_span ? luma_north : luma_west;
+    float luma1 = horizontal_span ? luma_south : luma_east;
+
+    float length_sign = 1.0;
+
+    float gradient0 = abs(luma0 - luma_center);
+    float gradient1 = abs(luma1 - luma_center);
+
+    bool steeper_on0 = gradient0 >= gradient1;
+    float scaled_gradient = FXAA_SEARCH_THRESHOLD * max(gradient0, gradient1);
+
+    float luma0c = (luma0 + luma_center);
+    float luma1c = (luma1 + luma_center);
+
+    if(steeper_on0) // switch direction
+        length_sign = -length_sign;
+    else // switch luma
+        luma0c = luma1c;
+
+    float half_luma0c = luma0c * 0.5;
+
+    vec2 center = vec2(pixel) + 0.5;
+
+    vec2 length_sign_vec = vec2(length_sign * 0.5,  0.0);
+    vec2 sample_position = center + (horizontal_span ? length_sign_vec.yx : length_sign_vec.xy);
+    vec2 offset = horizontal_span ? vec2(1.0, 0.0) : vec2(0.0, 1.0);
+
+    vec2 sample_dir0 = sample_position - (offset * q.step_sizes[0]);
+    vec2 sample_dir1 = sample_position + (offset * q.step_sizes[0]);
+
+    float luma_end0 = sample_luma(sample_dir0) - half_luma0c;
+    float luma_end1 = sample_luma(sample_dir1) - half_luma0c;
+
+    bool done0 = (abs(luma_end0) >= scaled_gradient);
+    bool done1 = (abs(luma_end1) >= scaled_gradient);
+
+    if(!done0) sample_dir0 -= offset * q.step_sizes[1];
+    if(!done1) sample_dir1 += offset * q.step_sizes[1];
+    bool not_done = true;
+
+    for(int i = 2; i < q.search_steps; ++i)
+    {
+        if(!done0) luma_end0 = sample_luma(sample_dir0) - half_luma0c;
+        if(!done1) luma_end1 = sample_luma(sample_dir1) - half_luma0c;
+
+        done0 = done0 || (abs(luma_end0) >= scaled_gradient);
+        done1 = done1 || (abs(luma_end1) >= scaled_gradient);
+
+        if(!done0) sample_dir0 -= offset * q.step_sizes[i];
+        if(!done1) sample_dir1 += offset * q.step_sizes[i];
+
+        not_done = (!done0) || (!done1);
+        if(!not_done) break;
+    }
+
+    float direction0 = horizontal_span ? center.x - sample_dir0.x : center.y - sample_dir0.y;
+    float direction1 = horizontal_span ? sample_dir1.x - center.x : sample_dir1.y - center.y;
+
+    float span_length = (direction0 + direction1);
+    float inverse_span_length = 1.0 / span_length;
+
+    bool end0_is_closer = direction0 < direction1;
+    float distance_to_end = min(direction0, direction1);
+    float pixel_offset = (distance_to_end * (-inverse_span_length)) + 0.5;
+
+    float local_average_luma = luma_center - (luma0c * 0.5);
+    bool average_lt_zero = local_average_luma < 0.0;
+
+    bool is_valid_correction = (((end0_is_closer ? luma_end0 : luma_end1) < 0.0) != average_lt_zero);
+
+    float final_offset = is_valid_correction ? pixel_offset : 0.0;
+
+    if(subpixel_filter > 1e-5)
+    {
+        float full_average_luma =
+            (1.0 / 12.0) *
+            (2.0 * (luma_north + luma_south + luma_west + luma_east)
+            + (luma_north_west + luma_north_east + luma_south_west + luma_south_east));
+
+        float subpixel_offset0 = saturate(abs(full_average_luma - luma_center) / luma_range);
+        float subpixel_offset1 = ((-2.0 * subpixel_offset0) + 3.0) * (subpixel_offset0 * subpixel_offset0);
+        float subpixel_offset = subpixel_offset1 * subpixel_filter;
+
+        final_offset = max(pixel_offset, subpixel_offset);
+    }
+
+    // The final offset is at most one pixel, so the sample is always inside of the tile.
+    final_offset *= length_sign;
+    vec2 final_offset_vec = vec2(final_offset, 0.0);
+    vec2 final_position = center + (horizontal_span ? final_offset_vec.yx : final_offset_vec.xy);
+
+    imageStore(image_post_output, pixel, vec4(sample_tile(final_position).rgb, 1.0));
+}
+
+// Tonemapped color at a position in output pixels. The input is upscaled from the rendered sub-rectangle like in the composing pass.
+vec4 compose(in vec2 position)
+{
+    position = clamp(position, vec2(0.5), vec2(output_size) - 0.5);
+    vec2 uv  = min(position * inverse_screen_size * render_scale, render_scale - 0.5 / vec2(textureSize(sampler_hdr_input, 0)));
+
+    vec4 color = textureLod(sampler_hdr_input, uv, 0.0);
+    color      = debug_view_enabled ? color : tonemap_with_gamma_correction(color, camera_exposure);
+
+    return vec4(saturate(color.rgb), 1.0); // The separate steps clamp when writing the rgba8 target.
+}
+
+vec4 tile_texel(in ivec2 local, in ivec2 offset)
+{
+    ivec2 texel = local + POST_TILE_BORDER + offset;
+    return shared_tile[texel.y * POST_CACHE_SIZE + texel.x];
+}
+
+// Bilinear sample of the cached tile, position in output pixels.
+vec4 sample_tile(in vec2 position)
+{
+    vec2 texel = position - vec2(tile_origin) - 0.5;
+    ivec2 base = min(ivec2(floor(texel)), ivec2(POST_CACHE_SIZE - 2)); // A weight of one at the last texel.
+    vec2 f     = texel - vec2(base);
+
+    vec4 c00 = shared_tile[base.y * POST_CACHE_SIZE + base.x];
+    vec4 c10 = shared_tile[base.y * POST_CACHE_SIZE + base.x + 1];
+    vec4 c01 = shared_tile[(base.y + 1) * POST_CACHE_SIZE + base.x];
+    vec4 c11 = shared_tile[(base.y + 1) * POST_CACHE_SIZE + base.x + 1];
+
+    return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+}
+
+bool inside_tile(in vec2 position)
+{
+    vec2 texel = position - vec2(tile_origin) - 0.5;
+    return texel.x >= 0.0 && texel.y >= 0.0 && texel.x <= float(POST_CACHE_SIZE - 1) && texel.y <= float(POST_CACHE_SIZE - 1);
+}
+
+// The edge search can leave the tile, there the input is sampled again.
+// Filtering before tonemapping differs slightly from filtering the composed image, but only decides where the edge ends.
+float sample_luma(in vec2 position)
+{
+    return inside_tile(position) ? sample_tile(position).a : luma(compose(position));
+}
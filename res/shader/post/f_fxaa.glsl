@@ -1,20 +1,10 @@
 #include <../include/common_constants_and_functions.glsl>
+#include <../include/fxaa.glsl>
 
 out vec4 frag_color;
 
 in noperspective vec2 texcoord;
 
-#define FXAA_SEARCH_THRESHOLD 1.0 / 4.0
-
-#define LOW_Q_FXAA_EDGE_THRESHOLD 1.0 / 4.0
-#define HIGH_Q_FXAA_EDGE_THRESHOLD 1.0 / 8.0
-
-#define FXAA_EDGE_THRESHOLD_MIN 1.0 / 16.0
-
-#define FXAA_SEARCH_STEPS_LOW 4
-#define FXAA_SEARCH_STEPS_DEFAULT 6
-#define FXAA_SEARCH_STEPS_HIGH 7
-
 layout(binding = 0) uniform sampler2D sampler_input; // texture "texture_input"
 
 layout(binding = 1, std140) uniform fxaa_data
@@ -24,23 +14,6 @@ layout(binding = 1, std140) uniform fxaa_data
     float subpixel_filter;
 };
 
-struct quality
-{
-    float edge_threshold;
-    float edge_threshold_min;
-    int search_steps;
-    float step_sizes[FXAA_SEARCH_STEPS_HIGH];
-};
-
-const quality quality_settings[3] = {
-    { LOW_Q_FXAA_EDGE_THRESHOLD, FXAA_EDGE_THRESHOLD_MIN, FXAA_SEARCH_STEPS_LOW,
-    { 1.0, 1.5, 3.0, 12.0, 0.0, 0.0, 0.0 } },
-    { HIGH_Q_FXAA_EDGE_THRESHOLD, FXAA_EDGE_THRESHOLD_MIN, FXAA_SEARCH_STEPS_DEFAULT,
-    { 1.0, 1.5, 2.0, 2.0, 4.0, 12.0, 0.0 } },
-    { HIGH_Q_FXAA_EDGE_THRESHOLD, FXAA_EDGE_THRESHOLD_MIN, FXAA_SEARCH_STEPS_HIGH,
-    { 1.0, 1.5, 2.0, 2.0, 2.0, 3.0, 8.0 } },
-};
-
 void main()
 {
     quality q = quality_settings[quality_preset];
@@ -0,0 +1,53 @@
+#include <../include/common_constants_and_functions.glsl>
+#include <../include/bindings.glsl>
+#include <../include/camera.glsl>
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = DEPTH_REDUCTION_SAMPLER_DEPTH) uniform sampler2D sampler_depth_input; // texture "texture_depth_input"
+
+layout(std430, binding = DEPTH_REDUCTION_BUFFER_BINDING_POINT) buffer depth_reduction_data
+{
+    uint min_depth; // The minimum visible view space depth. Stored as float bits, which keep their order for positive values.
+    uint max_depth; // The maximum visible view space depth. Stored as float bits, which keep their order for positive values.
+};
+
+shared uint shared_min_depth;
+shared uint shared_max_depth;
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+    {
+        shared_min_depth = floatBitsToUint(camera_far);
+        shared_max_depth = 0;
+    }
+
+    groupMemoryBarrier();
+    barrier();
+
+    ivec2 dim = ivec2(vec2(textureSize(sampler_depth_input, 0)) * render_scale + 0.5); // The rendered sub-rectangle.
+    if (gl_GlobalInvocationID.x < dim.x && gl_GlobalInvocationID.y < dim.y)
+    {
+        float depth = texelFetch(sampler_depth_input, ivec2(gl_GlobalInvocationID.xy), 0).r;
+        if (depth < 1.0) // Skip the background.
+        {
+            vec2 uv = (vec2(gl_GlobalInvocationID.xy) + 0.5) / vec2(dim);
+            vec4 world_position = inverse_view_projection * vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+            world_position /= world_position.w;
+            float view_depth = clamp(-(view_matrix * world_position).z, camera_near, camera_far);
+
+            atomicMin(shared_min_depth, floatBitsToUint(view_depth));
+            atomicMax(shared_max_depth, floatBitsToUint(view_depth));
+        }
+    }
+
+    groupMemoryBarrier();
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        atomicMin(min_depth, shared_min_depth);
+        atomicMax(max_depth, shared_max_depth);
+    }
+}
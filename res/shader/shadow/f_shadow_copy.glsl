@@ -0,0 +1,9 @@
+#include <../include/shadow.glsl>
+
+layout(binding = 0) uniform sampler2DArray sampler_static_shadow_map; // texture "texture_static_shadow_map"
+
+void main()
+{
+    // Copies the cascade of the cached static shadow map or clears it to the far plane.
+    gl_FragDepth = shadow_clear_cascade ? 1.0 : texelFetch(sampler_static_shadow_map, ivec3(gl_FragCoord.xy, cascade), 0).r;
+}
@@ -0,0 +1,15 @@
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+#include <../include/shadow.glsl>
+
+void main()
+{
+    gl_Layer = cascade;
+    for(int i = 0; i < gl_in.length(); ++i)
+    {
+        gl_Position = gl_in[i].gl_Position;
+        EmitVertex();
+    }
+    EndPrimitive();
+}
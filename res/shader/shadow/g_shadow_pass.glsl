@@ -6,6 +6,7 @@ layout(triangle_strip, max_vertices = 3) out;
 in shared_data
 {
     vec2 texcoord;
+    flat int cascade;
 } gs_in[];
 
 out shared_data
@@ -15,8 +16,8 @@ out shared_data
 
 void main()
 {
-    gl_Layer = cascade;
-    mat4 view_projection_matrix = shadow_view_projection_matrices[cascade];
+    gl_Layer = gs_in[0].cascade;
+    mat4 view_projection_matrix = shadow_view_projection_matrices[gs_in[0].cascade];
     for(int i = 0; i < gl_in.length(); ++i)
     {
         vec4 pos = view_projection_matrix * gl_in[i].gl_Position;
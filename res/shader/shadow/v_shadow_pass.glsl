@@ -10,6 +10,7 @@ layout(location = VERTEX_INPUT_TANGENT) in vec4 vertex_data_tangent;
 out shared_data
 {
     vec2 texcoord;
+    flat int cascade;
 } vs_out;
 
 vec4 get_world_position()
@@ -20,6 +21,14 @@ vec4 get_world_position()
 void main()
 {
     vs_out.texcoord = vertex_data_texcoord;
+    // The cascades of one primitive instance are consecutive: gl_InstanceID / cascade_count is the instance of the primitive,
+    // gl_InstanceID % cascade_count selects the next cascade set in the mask.
+    int mask = shadow_cascade_mask;
+    int cascade_count = max(bitCount(mask), 1);
+    int cascade_instance = gl_InstanceID % cascade_count;
+    for(int i = 0; i < cascade_instance; ++i)
+        mask &= mask - 1;
+    vs_out.cascade = findLSB(mask);
     vec4 world_position = get_world_position();
     gl_Position = world_position;
 }
@@ -0,0 +1,330 @@
+//! \file      allocator_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <memory/thread_linear_allocator.hpp>
+#include <memory/thread_safe_allocator.hpp>
+#include <random>
+#include <thread>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class allocator_test : public ::testing::TestWithParam<allocator_strategy>
+    {
+      protected:
+        allocator_test() {}
+
+        ~allocator_test() override {}
+
+        void SetUp() override
+        {
+            m_allocator = create_allocator(GetParam(), 1048576);
+            m_allocator->init();
+        }
+
+        void TearDown() override
+        {
+            m_allocator.reset();
+        }
+
+        unique_ptr<allocator> m_allocator;
+    };
+
+    using namespace mango;
+
+    TEST_P(allocator_test, allocate_and_free)
+    {
+        allocator_statistics initial = m_allocator->get_statistics();
+        EXPECT_EQ(0, initial.used_size);
+        EXPECT_EQ(0, initial.allocation_count);
+
+        void* a = m_allocator->allocate(100);
+        void* b = m_allocator->allocate(2000);
+        void* c = m_allocator->allocate_aligned(64, 16);
+        ASSERT_NE(nullptr, a);
+        ASSERT_NE(nullptr, b);
+        ASSERT_NE(nullptr, c);
+        EXPECT_EQ(0, reinterpret_cast<int64>(c) % 16);
+
+        memset(a, 0xAB, 100);
+        memset(b, 0xCD, 2000);
+        memset(c, 0xEF, 64);
+        EXPECT_EQ(0xAB, static_cast<uint8*>(a)[99]);
+        EXPECT_EQ(0xCD, static_cast<uint8*>(b)[0]);
+
+        allocator_statistics stats = m_allocator->get_statistics();
+        EXPECT_EQ(3, stats.allocation_count);
+        EXPECT_GE(stats.used_size, 2164);
+
+        m_allocator->free_memory(b);
+        m_allocator->free_memory(a);
+        m_allocator->free_memory_aligned(c);
+
+        stats = m_allocator->get_statistics();
+        EXPECT_EQ(0, stats.used_size);
+        EXPECT_EQ(0, stats.allocation_count);
+    }
+
+    TEST_P(allocator_test, coalesces_free_blocks)
+    {
+        allocator_statistics initial = m_allocator->get_statistics();
+
+        std::vector<void*> blocks;
+        for (int32 i = 0; i < 64; ++i)
+            blocks.push_back(m_allocator->allocate(1024 + i * 16));
+        for (int32 i = 0; i < 64; i += 2)
+            m_allocator->free_memory(blocks[i]);
+
+        allocator_statistics fragmented = m_allocator->get_statistics();
+        EXPECT_GT(fragmented.free_block_count, 1);
+        EXPECT_GT(fragmented.fragmentation, 0.0f);
+
+        for (int32 i = 1; i < 64; i += 2)
+            m_allocator->free_memory(blocks[i]);
+
+        allocator_statistics stats = m_allocator->get_statistics();
+        EXPECT_EQ(1, stats.free_block_count);
+        EXPECT_EQ(initial.largest_free_block, stats.largest_free_block);
+        EXPECT_FLOAT_EQ(0.0f, stats.fragmentation);
+    }
+
+    TEST_P(allocator_test, out_of_memory_returns_nullptr)
+    {
+        EXPECT_EQ(nullptr, m_allocator->allocate(2097152));
+
+        std::vector<void*> blocks;
+        void* mem;
+        while ((mem = m_allocator->allocate(65536)) != nullptr)
+            blocks.push_back(mem);
+        EXPECT_GE(blocks.size(), 14u);
+
+        m_allocator->free_memory(blocks.back());
+        EXPECT_NE(nullptr, m_allocator->allocate(65536));
+    }
+
+    TEST_P(allocator_test, reset_releases_everything)
+    {
+        allocator_statistics initial = m_allocator->get_statistics();
+        for (int32 i = 0; i < 32; ++i)
+            m_allocator->allocate(4096);
+        m_allocator->reset();
+
+        allocator_statistics stats = m_allocator->get_statistics();
+        EXPECT_EQ(0, stats.allocation_count);
+        EXPECT_EQ(initial.free_size, stats.free_size);
+    }
+
+    //! Replays a resource load/unload trace. Mixes small resource headers with large image and buffer data.
+    //! Every allocation is tagged and checked on free, so overlapping blocks fail the test.
+    TEST_P(allocator_test, resource_load_unload_trace)
+    {
+        unique_ptr<allocator> trace_allocator = create_allocator(GetParam(), 268435456);
+        trace_allocator->init();
+
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int32> kind(0, 9);
+        std::uniform_int_distribution<int64> small_size(32, 512);
+        std::uniform_int_distribution<int64> large_size(16384, 1048576);
+
+        std::vector<void*> live;
+        std::vector<int64> live_sizes;
+        int64 failed    = 0;
+        int32 corrupted = 0;
+
+        for (int32 i = 0; i < 20000; ++i)
+        {
+            if (live.empty() || (live.size() < 1024 && kind(generator) < 5))
+            {
+                int64 size = kind(generator) < 8 ? small_size(generator) : large_size(generator);
+                void* mem  = trace_allocator->allocate(size);
+                if (mem)
+                {
+                    // Tag first and last byte with the index of the allocation.
+                    static_cast<uint8*>(mem)[0] = static_cast<uint8*>(mem)[size - 1] = static_cast<uint8>(i);
+                    live.push_back(mem);
+                    live_sizes.push_back(size);
+                }
+                else
+                    failed++;
+            }
+            else
+            {
+                std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+                size_t idx = pick(generator);
+                uint8* mem = static_cast<uint8*>(live[idx]);
+                if (mem[0] != mem[live_sizes[idx] - 1])
+                    corrupted++;
+                trace_allocator->free_memory(mem);
+                live[idx]       = live.back();
+                live_sizes[idx] = live_sizes.back();
+                live.pop_back();
+                live_sizes.pop_back();
+            }
+        }
+
+        allocator_statistics stats = trace_allocator->get_statistics();
+        EXPECT_EQ(0, failed);
+        EXPECT_EQ(0, corrupted);
+        EXPECT_EQ(static_cast<int64>(live.size()), stats.allocation_count);
+
+        for (void* mem : live)
+            trace_allocator->free_memory(mem);
+        EXPECT_EQ(0, trace_allocator->get_statistics().allocation_count);
+    }
+
+    TEST(tlsf_allocator_test, commits_lazily_up_to_limit)
+    {
+        tlsf_allocator tlsf(67108864); // 64 MiB
+        tlsf.init();
+
+        allocator_statistics stats = tlsf.get_statistics();
+        EXPECT_EQ(67108864, stats.total_size);
+        EXPECT_LT(stats.committed_size, stats.total_size);
+
+        void* big = tlsf.allocate(16777216);
+        ASSERT_NE(nullptr, big);
+        memset(big, 0xAB, 16777216);
+        EXPECT_GT(tlsf.get_statistics().committed_size, 16777216);
+
+        EXPECT_EQ(nullptr, tlsf.allocate(67108864));
+        void* rest = tlsf.allocate(33554432);
+        EXPECT_NE(nullptr, rest);
+
+        tlsf.free_memory(big);
+        tlsf.free_memory(rest);
+        stats = tlsf.get_statistics();
+        EXPECT_EQ(0, stats.allocation_count);
+        EXPECT_EQ(1, stats.free_block_count);
+
+        tlsf.reset();
+        EXPECT_LT(tlsf.get_statistics().committed_size, 16777216);
+    }
+
+    TEST(tlsf_allocator_test, discarded_blocks_stay_usable)
+    {
+        tlsf_allocator tlsf(268435456); // 256 MiB
+        tlsf.init();
+
+        // Freeing more than discard_high_water trims automatically, the explicit trim() skips the already discarded block.
+        void* big = tlsf.allocate(134217728);
+        ASSERT_NE(nullptr, big);
+        memset(big, 0xAB, 134217728);
+        tlsf.free_memory(big);
+        tlsf.trim();
+
+        allocator_statistics stats = tlsf.get_statistics();
+        EXPECT_EQ(0, stats.allocation_count);
+        EXPECT_EQ(1, stats.free_block_count);
+        EXPECT_EQ(stats.free_size, stats.largest_free_block);
+
+        void* again = tlsf.allocate(134217728);
+        ASSERT_NE(nullptr, again);
+        memset(again, 0xCD, 134217728);
+        EXPECT_EQ(0xCD, static_cast<uint8*>(again)[134217727]);
+        tlsf.free_memory(again);
+    }
+
+    TEST(thread_safe_allocator_test, allocate_and_free_from_multiple_threads)
+    {
+        thread_safe_allocator shared(allocator_strategy::two_level_segregated_fit, 67108864);
+        shared.init();
+
+        std::vector<std::thread> threads;
+        for (int32 t = 0; t < 4; ++t)
+        {
+            threads.push_back(std::thread([&shared, t]() {
+                std::mt19937 generator(t);
+                std::uniform_int_distribution<int64> size(1, 8192);
+                std::vector<uint8*> live;
+                for (int32 i = 0; i < 10000; ++i)
+                {
+                    if (live.size() < 64 && (i % 3) != 2)
+                    {
+                        int64 s    = size(generator);
+                        uint8* mem = static_cast<uint8*>(shared.allocate(s));
+                        ASSERT_NE(nullptr, mem);
+                        mem[0] = mem[s - 1] = static_cast<uint8>(t);
+                        live.push_back(mem);
+                    }
+                    else if (!live.empty())
+                    {
+                        EXPECT_EQ(static_cast<uint8>(t), live.back()[0]);
+                        shared.free_memory(live.back());
+                        live.pop_back();
+                    }
+                }
+                for (uint8* mem : live)
+                    shared.free_memory(mem);
+            }));
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        EXPECT_EQ(0, shared.get_statistics().allocation_count);
+    }
+
+    //! Blocks freed on a thread stay in its magazines. They have to be returned to the shared allocator when the thread exits.
+    TEST(thread_safe_allocator_test, flushes_magazines_on_thread_exit)
+    {
+        thread_safe_allocator shared(allocator_strategy::two_level_segregated_fit, 1048576);
+        shared.init();
+        allocator_statistics initial = shared.get_statistics();
+
+        std::thread worker([&shared, &initial]() {
+            std::vector<void*> blocks;
+            for (int32 i = 0; i < 48; ++i)
+            {
+                blocks.push_back(shared.allocate(100));
+                ASSERT_NE(nullptr, blocks.back());
+            }
+            for (void* mem : blocks)
+                shared.free_memory(mem);
+            // Still cached in the magazines of the thread.
+            EXPECT_LT(shared.get_statistics().free_size, initial.free_size);
+        });
+        worker.join();
+
+        allocator_statistics stats = shared.get_statistics();
+        EXPECT_EQ(0, stats.allocation_count);
+        EXPECT_EQ(initial.used_size, stats.used_size);
+        EXPECT_EQ(initial.free_size, stats.free_size);
+        EXPECT_EQ(initial.largest_free_block, stats.largest_free_block);
+
+        // The returned blocks are reusable by other threads.
+        void* large = shared.allocate(stats.largest_free_block / 2);
+        ASSERT_NE(nullptr, large);
+        shared.free_memory(large);
+    }
+
+    TEST(thread_linear_allocator_test, uses_one_arena_per_thread)
+    {
+        thread_linear_allocator transient(65536);
+        transient.init();
+
+        uint8* main_mem = static_cast<uint8*>(transient.allocate(1024));
+        ASSERT_NE(nullptr, main_mem);
+
+        uint8* worker_mem = nullptr;
+        std::thread worker([&transient, &worker_mem]() { worker_mem = static_cast<uint8*>(transient.allocate(1024)); });
+        worker.join();
+        ASSERT_NE(nullptr, worker_mem);
+        EXPECT_TRUE(worker_mem + 1024 <= main_mem || main_mem + 1024 <= worker_mem);
+
+        allocator_statistics stats = transient.get_statistics();
+        EXPECT_EQ(131072, stats.total_size);
+        EXPECT_EQ(2048, stats.used_size);
+
+        transient.reset();
+        EXPECT_EQ(0, transient.get_statistics().used_size);
+        EXPECT_EQ(main_mem, transient.allocate(16));
+    }
+
+    INSTANTIATE_TEST_CASE_P(allocators, allocator_test, ::testing::Values(allocator_strategy::first_fit_free_list, allocator_strategy::two_level_segregated_fit));
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,186 @@
+//! \file      render_graph_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <rendering/render_graph.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class render_graph_test : public ::testing::Test
+    {
+      protected:
+        void SetUp() override
+        {
+            m_info.texture_type   = gfx_texture_type::texture_type_2d;
+            m_info.texture_format = gfx_format::rgba8;
+            m_info.width          = 64;
+            m_info.height         = 64;
+            m_info.miplevels      = 1;
+            m_info.array_layers   = 1;
+        }
+
+        //! \brief Adds a pass doing nothing.
+        int32 add_pass(const string& name)
+        {
+            return m_graph.add_pass(name, []() {});
+        }
+
+        texture_create_info m_info;
+        render_graph m_graph;
+    };
+
+    TEST_F(render_graph_test, pass_without_consumer_is_culled)
+    {
+        render_graph_texture a = m_graph.create_texture("a", m_info);
+        render_graph_texture b = m_graph.create_texture("b", m_info);
+        m_graph.mark_output(b);
+
+        int32 unused = add_pass("unused");
+        m_graph.write(unused, a, render_graph_access::color_target, render_graph_load_op::clear);
+        int32 used = add_pass("used");
+        m_graph.write(used, b, render_graph_access::color_target, render_graph_load_op::clear);
+        int32 side_effects = add_pass("side effects");
+        m_graph.read(side_effects, a, render_graph_access::sampled);
+        m_graph.set_side_effects(side_effects);
+        m_graph.compile();
+
+        ASSERT_FALSE(m_graph.is_culled(unused)); // Read by the pass with side effects.
+        ASSERT_FALSE(m_graph.is_culled(used));
+        ASSERT_FALSE(m_graph.is_culled(side_effects));
+
+        m_graph.reset();
+        a      = m_graph.create_texture("a", m_info);
+        b      = m_graph.create_texture("b", m_info);
+        unused = add_pass("unused");
+        m_graph.write(unused, a, render_graph_access::color_target, render_graph_load_op::clear);
+        used = add_pass("used");
+        m_graph.write(used, b, render_graph_access::color_target, render_graph_load_op::clear);
+        m_graph.mark_output(b);
+        m_graph.compile();
+
+        ASSERT_TRUE(m_graph.is_culled(unused));
+        ASSERT_FALSE(m_graph.is_culled(used));
+        ASSERT_EQ(m_graph.culled_pass_count(), 1);
+        ASSERT_EQ(m_graph.get_slot(a), -1);
+    }
+
+    TEST_F(render_graph_test, overwritten_content_does_not_keep_writer)
+    {
+        render_graph_texture a = m_graph.create_texture("a", m_info);
+        m_graph.mark_output(a);
+
+        int32 first = add_pass("first");
+        m_graph.write(first, a, render_graph_access::color_target, render_graph_load_op::clear);
+        int32 second = add_pass("second");
+        m_graph.write(second, a, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_graph.compile();
+
+        ASSERT_TRUE(m_graph.is_culled(first));
+        ASSERT_FALSE(m_graph.is_culled(second));
+        ASSERT_FALSE(m_graph.is_cleared(second, a));
+    }
+
+    TEST_F(render_graph_test, clears_only_where_required)
+    {
+        render_graph_texture a = m_graph.create_texture("a", m_info);
+        render_graph_texture b = m_graph.create_texture("b", m_info);
+        render_graph_texture c = m_graph.create_texture("c", m_info);
+        m_graph.mark_output(a);
+        m_graph.mark_output(b);
+        m_graph.mark_output(c);
+
+        int32 first = add_pass("first");
+        m_graph.write(first, a, render_graph_access::color_target, render_graph_load_op::clear);
+        m_graph.write(first, b, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_graph.write(first, c, render_graph_access::color_target, render_graph_load_op::load);
+        int32 second = add_pass("second");
+        m_graph.write(second, c, render_graph_access::color_target, render_graph_load_op::load);
+        m_graph.compile();
+
+        ASSERT_TRUE(m_graph.is_cleared(first, a));
+        ASSERT_FALSE(m_graph.is_cleared(first, b));
+        ASSERT_TRUE(m_graph.is_cleared(first, c)); // Transient content is undefined before the first write.
+        ASSERT_FALSE(m_graph.is_cleared(second, c));
+    }
+
+    TEST_F(render_graph_test, textures_with_disjoint_lifetimes_are_aliased)
+    {
+        render_graph_texture a = m_graph.create_texture("a", m_info);
+        render_graph_texture b = m_graph.create_texture("b", m_info);
+        render_graph_texture c = m_graph.create_texture("c", m_info);
+        texture_create_info depth_info = m_info;
+        depth_info.texture_format      = gfx_format::depth_component32f;
+        render_graph_texture d         = m_graph.create_texture("d", depth_info);
+        m_graph.mark_output(c);
+
+        int32 first = add_pass("first");
+        m_graph.write(first, a, render_graph_access::color_target, render_graph_load_op::dont_care);
+        int32 second = add_pass("second");
+        m_graph.read(second, a, render_graph_access::sampled);
+        m_graph.write(second, b, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_graph.write(second, d, render_graph_access::depth_target, render_graph_load_op::clear);
+        int32 third = add_pass("third");
+        m_graph.read(third, b, render_graph_access::sampled);
+        m_graph.read(third, d, render_graph_access::sampled);
+        m_graph.write(third, c, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_graph.compile();
+
+        ASSERT_NE(m_graph.get_slot(a), m_graph.get_slot(b)); // Both used in the second pass.
+        ASSERT_NE(m_graph.get_slot(b), m_graph.get_slot(c));
+        ASSERT_EQ(m_graph.get_slot(a), m_graph.get_slot(c));
+        ASSERT_NE(m_graph.get_slot(d), m_graph.get_slot(a)); // Different format.
+        ASSERT_EQ(m_graph.slot_count(), 3);
+        ASSERT_EQ(m_graph.transient_texture_count(), 4);
+    }
+
+    TEST_F(render_graph_test, barrier_after_image_store)
+    {
+        render_graph_texture a = m_graph.create_texture("a", m_info);
+        render_graph_texture b = m_graph.create_texture("b", m_info);
+        m_graph.mark_output(b);
+
+        int32 store = add_pass("store");
+        m_graph.write(store, a, render_graph_access::image_store, render_graph_load_op::dont_care);
+        int32 draw = add_pass("draw");
+        m_graph.write(draw, a, render_graph_access::color_target, render_graph_load_op::load);
+        int32 sample = add_pass("sample");
+        m_graph.read(sample, a, render_graph_access::sampled);
+        m_graph.write(sample, b, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_graph.compile();
+
+        ASSERT_EQ(m_graph.get_barrier(store), gfx_barrier_bit::unknown_barrier_bit);
+        // One barrier covers all accesses following the store.
+        ASSERT_EQ(m_graph.get_barrier(draw), gfx_barrier_bit::framebuffer_barrier_bit | gfx_barrier_bit::texture_fetch_barrier_bit);
+        ASSERT_EQ(m_graph.get_barrier(sample), gfx_barrier_bit::unknown_barrier_bit);
+    }
+
+    TEST_F(render_graph_test, barrier_covers_aliased_textures)
+    {
+        render_graph_texture a = m_graph.create_texture("a", m_info);
+        render_graph_texture b = m_graph.create_texture("b", m_info);
+        render_graph_texture c = m_graph.create_texture("c", m_info);
+        m_graph.mark_output(c);
+
+        int32 store = add_pass("store");
+        m_graph.write(store, a, render_graph_access::image_store, render_graph_load_op::dont_care);
+        int32 sample = add_pass("sample");
+        m_graph.read(sample, a, render_graph_access::sampled);
+        m_graph.write(sample, b, render_graph_access::color_target, render_graph_load_op::dont_care);
+        int32 draw = add_pass("draw");
+        m_graph.read(draw, b, render_graph_access::sampled);
+        m_graph.write(draw, c, render_graph_access::color_target, render_graph_load_op::dont_care);
+        m_graph.compile();
+
+        ASSERT_EQ(m_graph.get_slot(a), m_graph.get_slot(c));
+        // The store to a has to be finished before c is drawn into the same memory.
+        ASSERT_EQ(m_graph.get_barrier(sample), gfx_barrier_bit::texture_fetch_barrier_bit | gfx_barrier_bit::framebuffer_barrier_bit);
+        ASSERT_EQ(m_graph.get_barrier(draw), gfx_barrier_bit::unknown_barrier_bit);
+    }
+} // namespace mango
+
+//! \endcond
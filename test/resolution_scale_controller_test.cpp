@@ -0,0 +1,75 @@
+//! \file      resolution_scale_controller_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <rendering/resolution_scale_controller.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class resolution_scale_controller_test : public ::testing::Test
+    {
+      protected:
+        void SetUp() override
+        {
+            m_controller.set_target_frame_time(10.0f);
+            m_controller.set_scale_range(0.5f, 1.0f);
+        }
+
+        //! \brief Feeds frame times of a frame costing full_resolution_time milliseconds at scale 1.
+        void simulate(float full_resolution_time, int32 frames)
+        {
+            for (int32 i = 0; i < frames; ++i)
+            {
+                float scale = m_controller.get_scale();
+                m_controller.update(full_resolution_time * scale * scale);
+            }
+        }
+
+        resolution_scale_controller m_controller;
+    };
+
+    TEST_F(resolution_scale_controller_test, scale_is_kept_inside_of_band)
+    {
+        simulate(9.5f, 100);
+
+        ASSERT_FLOAT_EQ(m_controller.get_scale(), 1.0f);
+    }
+
+    TEST_F(resolution_scale_controller_test, scale_drops_to_hold_target)
+    {
+        simulate(16.0f, 200);
+
+        float scale = m_controller.get_scale();
+        ASSERT_LT(scale, 0.8f);
+        ASSERT_GT(scale, 0.7f);
+        ASSERT_LE(16.0f * scale * scale, 10.0f);
+    }
+
+    TEST_F(resolution_scale_controller_test, scale_recovers_when_cheaper)
+    {
+        simulate(16.0f, 200);
+        simulate(5.0f, 200);
+
+        ASSERT_FLOAT_EQ(m_controller.get_scale(), 1.0f);
+    }
+
+    TEST_F(resolution_scale_controller_test, scale_is_clamped_and_changes_gradually)
+    {
+        m_controller.update(1000.0f);
+        ASSERT_FLOAT_EQ(m_controller.get_scale(), 0.95f);
+
+        simulate(1000.0f, 100);
+        ASSERT_FLOAT_EQ(m_controller.get_scale(), 0.5f);
+
+        m_controller.reset();
+        ASSERT_FLOAT_EQ(m_controller.get_scale(), 1.0f);
+        ASSERT_FLOAT_EQ(m_controller.get_frame_time(), 0.0f);
+    }
+} // namespace mango
+
+//! \endcond
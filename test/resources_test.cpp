@@ -0,0 +1,306 @@
+//! \file      resources_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <resources/resources_impl.hpp>
+#include <thread>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class resources_test : public ::testing::Test
+    {
+      protected:
+        resources_test() {}
+
+        ~resources_test() override {}
+
+        void SetUp() override
+        {
+            m_resources = mango::make_unique<resources_impl>();
+        }
+
+        void TearDown() override
+        {
+            m_resources.reset();
+            for (const string& path : m_files)
+                std::remove(path.c_str());
+        }
+
+        string write_shader(const string& name, const string& source)
+        {
+            string path = testing::TempDir() + name;
+            std::ofstream out(path, std::ios::out | std::ios::binary);
+            out << source;
+            m_files.push_back(path);
+            return path;
+        }
+
+        unique_ptr<resources_impl> m_resources;
+        std::vector<string> m_files;
+    };
+
+    using namespace mango;
+
+    TEST_F(resources_test, cache_is_keyed_by_full_path_and_parameters)
+    {
+        string path_a = write_shader("resources_test_shader.vert", "void main() { a(); }\n");
+        string path_b = write_shader("resources_test_shader.frag", "void main() { b(); }\n");
+
+        shader_resource_resource_description desc_a;
+        desc_a.path = path_a.c_str();
+        shader_resource_resource_description desc_b;
+        desc_b.path = path_b.c_str();
+
+        const shader_resource* a = m_resources->acquire(desc_a);
+        const shader_resource* b = m_resources->acquire(desc_b);
+        ASSERT_NE(nullptr, a);
+        ASSERT_NE(nullptr, b);
+        EXPECT_NE(a, b);
+        EXPECT_NE(string::npos, a->source.find("a();"));
+        EXPECT_NE(string::npos, b->source.find("b();"));
+
+        EXPECT_EQ(a, m_resources->acquire(desc_a));
+
+        shader_resource_resource_description desc_a_defined = desc_a;
+        desc_a_defined.defines.push_back({ "SOME_DEFINE", "1" });
+        const shader_resource* a_defined = m_resources->acquire(desc_a_defined);
+        ASSERT_NE(nullptr, a_defined);
+        EXPECT_NE(a, a_defined);
+        EXPECT_NE(string::npos, a_defined->source.find("#define SOME_DEFINE 1"));
+
+        m_resources->release(a);
+        m_resources->release(a);
+        m_resources->release(b);
+        m_resources->release(a_defined);
+    }
+
+    TEST_F(resources_test, variants_are_keyed_by_sorted_defines)
+    {
+        string path = write_shader("resources_test_variants.glsl", "void main() {}\n");
+        shader_resource_resource_description desc_ab;
+        desc_ab.path    = path.c_str();
+        desc_ab.defines = { { "A", "1" }, { "B", "2" } };
+        shader_resource_resource_description desc_ba;
+        desc_ba.path    = path.c_str();
+        desc_ba.defines = { { "B", "2" }, { "A", "1" } };
+
+        const shader_resource* ab = m_resources->acquire(desc_ab);
+        const shader_resource* ba = m_resources->acquire(desc_ba);
+        ASSERT_NE(nullptr, ab);
+        EXPECT_EQ(ab, ba);
+
+        std::vector<const shader_resource*> variants = m_resources->acquire_variants(path.c_str(), { { { "B", "2" }, { "A", "1" } }, { { "A", "2" } }, {} });
+        ASSERT_EQ(3u, variants.size());
+        EXPECT_EQ(ab, variants[0]);
+        ASSERT_NE(nullptr, variants[1]);
+        ASSERT_NE(nullptr, variants[2]);
+        EXPECT_NE(variants[1], variants[2]);
+        EXPECT_NE(string::npos, variants[1]->source.find("#define A 2"));
+        EXPECT_EQ(string::npos, variants[2]->source.find("#define"));
+
+        m_resources->release(ab);
+        m_resources->release(ba);
+        for (const shader_resource* res : variants)
+            m_resources->release(res);
+    }
+
+    TEST_F(resources_test, paths_are_normalized_lexically)
+    {
+        EXPECT_EQ("res/shader/a.glsl", resource_key::normalize_path("res\\shader\\a.glsl"));
+        EXPECT_EQ("res/shader/a.glsl", resource_key::normalize_path("./res/include/../shader//./a.glsl"));
+        EXPECT_EQ("../res/a.glsl", resource_key::normalize_path("../res/shader/../a.glsl"));
+        EXPECT_EQ("/a.glsl", resource_key::normalize_path("/../res/../a.glsl"));
+        EXPECT_EQ(".", resource_key::normalize_path("res/.."));
+
+        string path        = write_shader("resources_test_normalized.glsl", "void main() {}\n");
+        string dir         = path.substr(0, path.find_last_of('/') + 1);
+        string alternative = dir + "./unused/../resources_test_normalized.glsl";
+
+        shader_resource_resource_description desc_a;
+        desc_a.path = path.c_str();
+        shader_resource_resource_description desc_b;
+        desc_b.path = alternative.c_str();
+        EXPECT_EQ(resource_key::get(desc_a), resource_key::get(desc_b));
+    }
+
+    TEST_F(resources_test, changed_includes_are_read_again)
+    {
+        string include_path = write_shader("resources_test_include.glsl", "float a() { return 1.0; }\n");
+        string path         = write_shader("resources_test_including.glsl", "#include <resources_test_include.glsl>\nvoid main() {}\n");
+        m_resources->set_memory_budget(0);
+
+        shader_resource_resource_description desc;
+        desc.path                    = path.c_str();
+        const shader_resource* first = m_resources->acquire(desc);
+        ASSERT_NE(nullptr, first);
+        EXPECT_NE(string::npos, first->source.find("return 1.0;"));
+        m_resources->release(first);
+
+        write_shader("resources_test_include.glsl", "float a() { return 2.0 * 1.0; }\n");
+        const shader_resource* second = m_resources->acquire(desc);
+        ASSERT_NE(nullptr, second);
+        EXPECT_NE(string::npos, second->source.find("return 2.0 * 1.0;"));
+        m_resources->release(second);
+    }
+
+    TEST_F(resources_test, includes_edited_without_size_change_are_read_again)
+    {
+        string include_path = write_shader("resources_test_same_size.glsl", "float a() { return 1.0; }\n");
+        string path         = write_shader("resources_test_same_size_including.glsl", "#include <resources_test_same_size.glsl>\nvoid main() {}\n");
+        m_resources->set_memory_budget(0);
+
+        shader_resource_resource_description desc;
+        desc.path                    = path.c_str();
+        const shader_resource* first = m_resources->acquire(desc);
+        ASSERT_NE(nullptr, first);
+        EXPECT_NE(string::npos, first->source.find("return 1.0;"));
+        m_resources->release(first);
+
+        // Same size and usually the same second, only the sub second modification time changes.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        write_shader("resources_test_same_size.glsl", "float a() { return 2.0; }\n");
+        const shader_resource* second = m_resources->acquire(desc);
+        ASSERT_NE(nullptr, second);
+        EXPECT_NE(string::npos, second->source.find("return 2.0;"));
+        m_resources->release(second);
+    }
+
+    TEST_F(resources_test, release_and_reacquire)
+    {
+        string path = write_shader("resources_test_release.glsl", "void main() {}\n");
+        shader_resource_resource_description desc;
+        desc.path = path.c_str();
+
+        const shader_resource* first  = m_resources->acquire(desc);
+        const shader_resource* second = m_resources->acquire(desc);
+        EXPECT_EQ(first, second);
+
+        m_resources->release(first);
+        EXPECT_EQ(first, m_resources->acquire(desc));
+        m_resources->release(first);
+        m_resources->release(first);
+        m_resources->release(static_cast<const shader_resource*>(nullptr));
+
+        const shader_resource* reloaded = m_resources->acquire(desc);
+        ASSERT_NE(nullptr, reloaded);
+        m_resources->release(reloaded);
+    }
+
+    TEST_F(resources_test, unreferenced_resources_are_retained_until_budget_is_exceeded)
+    {
+        string path_a = write_shader("resources_test_lru_a.glsl", "void main() { a(); }\n");
+        string path_b = write_shader("resources_test_lru_b.glsl", "void main() { b(); }\n");
+        string path_c = write_shader("resources_test_lru_c.glsl", "void main() { c(); }\n");
+        shader_resource_resource_description desc_a, desc_b, desc_c;
+        desc_a.path = path_a.c_str();
+        desc_b.path = path_b.c_str();
+        desc_c.path = path_c.c_str();
+
+        const shader_resource* a = m_resources->acquire(desc_a);
+        ASSERT_NE(nullptr, a);
+        m_resources->release(a);
+
+        resource_cache_statistics stats = m_resources->get_cache_statistics();
+        EXPECT_EQ(1, stats.cached_count);
+        EXPECT_EQ(1, stats.retained_count);
+        EXPECT_EQ(stats.cached_size, stats.retained_size);
+
+        EXPECT_EQ(a, m_resources->acquire(desc_a));
+        EXPECT_EQ(1, m_resources->get_cache_statistics().hits);
+        m_resources->release(a);
+
+        // Budget for two resources, the least recently used one gets evicted.
+        int64 single_size = m_resources->get_cache_statistics().cached_size;
+        m_resources->set_memory_budget(single_size * 2 + single_size / 2);
+        m_resources->release(m_resources->acquire(desc_b));
+        m_resources->release(m_resources->acquire(desc_c));
+
+        stats = m_resources->get_cache_statistics();
+        EXPECT_EQ(2, stats.cached_count);
+        EXPECT_EQ(1, stats.evictions);
+        EXPECT_EQ(3, stats.misses);
+
+        m_resources->release(m_resources->acquire(desc_a));
+        EXPECT_EQ(4, m_resources->get_cache_statistics().misses);
+
+        m_resources->set_memory_budget(0);
+        stats = m_resources->get_cache_statistics();
+        EXPECT_EQ(0, stats.cached_count);
+        EXPECT_EQ(0, stats.cached_size);
+    }
+
+    TEST_F(resources_test, pinned_and_prefetched_resources)
+    {
+        string path = write_shader("resources_test_pin.glsl", "void main() {}\n");
+        shader_resource_resource_description desc;
+        desc.path = path.c_str();
+
+        m_resources->prefetch(desc);
+        resource_cache_statistics stats = m_resources->get_cache_statistics();
+        EXPECT_EQ(1, stats.retained_count);
+        EXPECT_EQ(1, stats.misses);
+
+        const shader_resource* res = m_resources->acquire(desc);
+        EXPECT_EQ(1, m_resources->get_cache_statistics().hits);
+
+        m_resources->pin(res);
+        m_resources->release(res);
+        m_resources->set_memory_budget(0);
+        stats = m_resources->get_cache_statistics();
+        EXPECT_EQ(1, stats.cached_count);
+        EXPECT_EQ(1, stats.pinned_count);
+
+        m_resources->unpin(res);
+        stats = m_resources->get_cache_statistics();
+        EXPECT_EQ(0, stats.cached_count);
+        EXPECT_EQ(1, stats.evictions);
+    }
+
+    //! Acquires and releases N and 4N resources. Each release evicts exactly the released resource, so the work grows linear.
+    TEST_F(resources_test, teardown_scales_linear)
+    {
+        string path = write_shader("resources_test_teardown.glsl", "void main() {}\n");
+        m_resources->set_memory_budget(0);
+
+        int64 evictions[2] = { 0, 0 };
+        int32 counts[2]    = { 512, 2048 };
+        for (int32 run = 0; run < 2; ++run)
+        {
+            int32 count = counts[run];
+            std::vector<string> values(count);
+            std::vector<const shader_resource*> acquired(count);
+            for (int32 i = 0; i < count; ++i)
+            {
+                values[i] = std::to_string(i);
+                shader_resource_resource_description desc;
+                desc.path = path.c_str();
+                desc.defines.push_back({ "VARIANT", values[i].c_str() });
+                acquired[i] = m_resources->acquire(desc);
+                ASSERT_NE(nullptr, acquired[i]);
+            }
+            ASSERT_EQ(count, m_resources->get_cache_statistics().cached_count);
+
+            int64 before = m_resources->get_cache_statistics().evictions;
+            for (const shader_resource* res : acquired)
+                m_resources->release(res);
+
+            resource_cache_statistics stats = m_resources->get_cache_statistics();
+            evictions[run]                  = stats.evictions - before;
+            EXPECT_EQ(0, stats.cached_count);
+            EXPECT_EQ(0, stats.retained_count);
+        }
+
+        EXPECT_EQ(counts[0], evictions[0]);
+        EXPECT_EQ(4 * evictions[0], evictions[1]);
+    }
+} // namespace mango
+
+//! \endcond
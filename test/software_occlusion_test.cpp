@@ -0,0 +1,108 @@
+//! \file      software_occlusion_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2021
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <rendering/software_occlusion_culler.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class software_occlusion_test : public ::testing::Test
+    {
+      protected:
+        software_occlusion_test()
+            : m_culler(software_occlusion_culler::default_width, software_occlusion_culler::default_height, 2)
+        {
+        }
+
+        void SetUp() override
+        {
+            // Camera at the origin looking down the negative z axis.
+            mat4 view       = glm::lookAt(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+            mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+            m_culler.begin_frame(projection * view);
+        }
+
+        //! \brief Adds a quad at depth z covering [-size, size] in x and y.
+        void add_quad(float z, float size)
+        {
+            vec3 vertices[4]  = { vec3(-size, -size, z), vec3(size, -size, z), vec3(size, size, z), vec3(-size, size, z) };
+            uint32 indices[6] = { 0, 1, 2, 0, 2, 3 };
+            ASSERT_EQ(m_culler.add_occluder(vertices, indices, 6, mat4(1.0f)), 2);
+        }
+
+        software_occlusion_culler m_culler;
+    };
+
+    TEST_F(software_occlusion_test, empty_depth_buffer_occludes_nothing)
+    {
+        m_culler.rasterize();
+
+        ASSERT_EQ(m_culler.triangle_count(), 0);
+        ASSERT_FLOAT_EQ(m_culler.depth_at(0, 0), 1.0f);
+        ASSERT_FALSE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -10.0f), vec3(1.0f))));
+    }
+
+    TEST_F(software_occlusion_test, box_behind_occluder_is_occluded)
+    {
+        add_quad(-5.0f, 5.0f);
+        m_culler.rasterize();
+
+        ASSERT_LT(m_culler.depth_at(m_culler.width() / 2, m_culler.height() / 2), 1.0f);
+        ASSERT_TRUE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -20.0f), vec3(1.0f))));
+    }
+
+    TEST_F(software_occlusion_test, box_in_front_of_occluder_is_visible)
+    {
+        add_quad(-20.0f, 20.0f);
+        m_culler.rasterize();
+
+        ASSERT_FALSE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -5.0f), vec3(1.0f))));
+    }
+
+    TEST_F(software_occlusion_test, box_intersecting_occluder_is_visible)
+    {
+        add_quad(-10.0f, 10.0f);
+        m_culler.rasterize();
+
+        ASSERT_FALSE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -10.0f), vec3(1.0f))));
+    }
+
+    TEST_F(software_occlusion_test, box_beside_occluder_is_visible)
+    {
+        add_quad(-5.0f, 1.0f);
+        m_culler.rasterize();
+
+        ASSERT_FALSE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(20.0f, 0.0f, -20.0f), vec3(1.0f))));
+        // Partially covered.
+        ASSERT_FALSE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(4.0f, 0.0f, -20.0f), vec3(1.0f))));
+    }
+
+    TEST_F(software_occlusion_test, triangles_in_front_of_near_plane_are_dropped)
+    {
+        add_quad(-5.0f, 5.0f);
+        vec3 vertices[3]  = { vec3(-1.0f, -1.0f, 1.0f), vec3(1.0f, -1.0f, 1.0f), vec3(0.0f, 1.0f, 1.0f) };
+        uint32 indices[3] = { 0, 1, 2 };
+
+        ASSERT_EQ(m_culler.add_occluder(vertices, indices, 3, mat4(1.0f)), 0);
+        ASSERT_EQ(m_culler.triangle_count(), 2);
+    }
+
+    TEST_F(software_occlusion_test, back_facing_triangles_only_occlude_when_double_sided)
+    {
+        vec3 vertices[4]  = { vec3(-5.0f, -5.0f, -5.0f), vec3(5.0f, -5.0f, -5.0f), vec3(5.0f, 5.0f, -5.0f), vec3(-5.0f, 5.0f, -5.0f) };
+        uint32 indices[6] = { 0, 2, 1, 0, 3, 2 };
+
+        ASSERT_EQ(m_culler.add_occluder(vertices, indices, 6, mat4(1.0f)), 0);
+        ASSERT_EQ(m_culler.add_occluder(vertices, indices, 6, mat4(1.0f), true), 2);
+        m_culler.rasterize();
+
+        ASSERT_TRUE(m_culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -20.0f), vec3(1.0f))));
+    }
+} // namespace mango
+
+//! \endcond